@@ -0,0 +1,70 @@
+// app_resources.h — COLOSSUS embedded resources (GResource) + dev override
+
+#ifndef COLOSSUS_APP_RESOURCES_H
+#define COLOSSUS_APP_RESOURCES_H
+
+#include <string>
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+// browser.js, gtk-colossus.css and the icon are compiled into the binary
+// from resources/colossus-nan.gresource.xml. Setting COLOSSUS_RESOURCES_DIR
+// (e.g. to ./resources) reads them from disk instead, so edits show up
+// without a rebuild.
+#define COLOSSUS_RESOURCE_PREFIX "/tech/will/colossus/"
+
+// Path of the development override for `name`, or "" when not in use
+inline std::string colossus_resource_override(const char* name)
+{
+    const gchar* dir = g_getenv("COLOSSUS_RESOURCES_DIR");
+    if (!dir || !*dir) return {};
+
+    gchar* path = g_build_filename(dir, name, nullptr);
+    std::string out = g_file_test(path, G_FILE_TEST_IS_REGULAR) ? path : "";
+    if (out.empty()) {
+        g_printerr("COLOSSUS-NAN: %s not found in COLOSSUS_RESOURCES_DIR, using the built-in copy\n",
+                   name);
+    }
+    g_free(path);
+    return out;
+}
+
+inline std::string colossus_resource_path(const char* name)
+{
+    return std::string(COLOSSUS_RESOURCE_PREFIX) + name;
+}
+
+// Contents of a text resource (override first), "" if missing
+inline std::string colossus_resource_text(const char* name)
+{
+    std::string override_path = colossus_resource_override(name);
+    if (!override_path.empty()) {
+        gchar* contents = nullptr;
+        gsize length = 0;
+        if (g_file_get_contents(override_path.c_str(), &contents, &length, nullptr)) {
+            std::string out(contents, length);
+            g_free(contents);
+            return out;
+        }
+    }
+
+    GError* error = nullptr;
+    GBytes* bytes = g_resources_lookup_data(colossus_resource_path(name).c_str(),
+                                            G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+    if (!bytes) {
+        g_printerr("COLOSSUS-NAN: Resource not found: '%s': %s\n",
+                   name, error ? error->message : "unknown error");
+        g_clear_error(&error);
+        return {};
+    }
+
+    gsize size = 0;
+    const char* data = static_cast<const char*>(g_bytes_get_data(bytes, &size));
+    std::string out(data ? data : "", size);
+    g_bytes_unref(bytes);
+    return out;
+}
+
+#endif // COLOSSUS_APP_RESOURCES_H
@@ -0,0 +1,156 @@
+// append_log.cpp — COLOSSUS crash-safe append-only record file
+
+#include "append_log.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+namespace {
+
+// Native endianness
+struct FileHeader {
+    char magic[8];
+    guint64 committed;
+    guint64 reserved[2];
+};
+
+static_assert(sizeof(FileHeader) == AppendLog::HEADER_SIZE, "header layout");
+
+bool write_all(int fd, const char* data, size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+} // namespace
+
+AppendLog::AppendLog(const std::string& p, const char (&m)[8], const char* what)
+    : path(p), name(what)
+{
+    memcpy(magic, m, sizeof(magic));
+}
+
+AppendLog::~AppendLog()
+{
+    if (fd >= 0) close(fd);
+}
+
+bool AppendLog::start_fresh()
+{
+    FileHeader header = {};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.committed = sizeof(FileHeader);
+
+    if (ftruncate(fd, 0) != 0 ||
+        !write_all(fd, reinterpret_cast<const char*>(&header), sizeof(header), 0) ||
+        fdatasync(fd) != 0) {
+        return false;
+    }
+    committed = header.committed;
+    return true;
+}
+
+// Constant time: header read and optional tail truncation
+bool AppendLog::open()
+{
+    gchar* dir = g_path_get_dirname(path.c_str());
+    g_mkdir_with_parents(dir, 0700);
+    g_free(dir);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    guint64 size = static_cast<guint64>(st.st_size);
+
+    FileHeader header = {};
+    bool valid = size >= sizeof(FileHeader) &&
+                 pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                 memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+                 header.committed >= sizeof(FileHeader) &&
+                 header.committed <= size;
+
+    if (!valid) {
+        if (size > 0) {
+            // Keep the unreadable file for inspection, start a new one
+            std::string aside = path + ".corrupt";
+            g_printerr("COLOSSUS-NAN: Unreadable %s, moved to %s\n", name, aside.c_str());
+            g_rename(path.c_str(), aside.c_str());
+            close(fd);
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+            if (fd < 0) return false;
+        }
+        return start_fresh();
+    }
+
+    committed = header.committed;
+
+    // Bytes past the committed length are an append torn by a crash
+    return size == committed || ftruncate(fd, static_cast<off_t>(committed)) == 0;
+}
+
+// Data, then the new committed length; each step synced
+bool AppendLog::append(const std::string& data)
+{
+    if (fd < 0 || data.empty()) return fd >= 0;
+
+    bool ok = write_all(fd, data.data(), data.size(), static_cast<off_t>(committed)) &&
+              fdatasync(fd) == 0;
+    if (ok) {
+        guint64 new_committed = committed + data.size();
+        ok = write_all(fd, reinterpret_cast<const char*>(&new_committed), sizeof(new_committed),
+                       offsetof(FileHeader, committed)) &&
+             fdatasync(fd) == 0;
+        if (ok) committed = new_committed;
+    }
+    if (!ok && ftruncate(fd, static_cast<off_t>(committed)) != 0) {
+        // The header still bounds the log; the tail is dropped on open
+    }
+    return ok;
+}
+
+int AppendLog::write_replacement(std::string& out)
+{
+    if (out.size() < sizeof(FileHeader)) return -1;
+
+    FileHeader header = {};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.committed = out.size();
+    memcpy(&out[0], &header, sizeof(header));
+
+    std::string tmp_path = path + ".tmp";
+    int tmp = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (tmp < 0) return -1;
+
+    if (!write_all(tmp, out.data(), out.size(), 0) || fsync(tmp) != 0 ||
+        g_rename(tmp_path.c_str(), path.c_str()) != 0) {
+        close(tmp);
+        g_unlink(tmp_path.c_str());
+        return -1;
+    }
+    return tmp;
+}
+
+void AppendLog::adopt(int new_fd, guint64 new_committed)
+{
+    if (fd >= 0) close(fd);
+    fd = new_fd;
+    committed = new_committed;
+}
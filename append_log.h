@@ -0,0 +1,53 @@
+// append_log.h — COLOSSUS crash-safe append-only record file
+
+#ifndef COLOSSUS_APPEND_LOG_H
+#define COLOSSUS_APPEND_LOG_H
+
+#include <string>
+
+extern "C" {
+#include <glib.h>
+}
+
+// The file layout shared by the history log and the offline archive: a
+// 32-byte header (8-byte magic, committed length, reserved) followed by
+// 8-byte aligned records whose format belongs to the owner.
+//
+//  * open() reads the header only. A file that does not carry the magic is
+//    moved aside to <path>.corrupt; bytes past the committed length (an
+//    append torn by a crash) are truncated.
+//  * append() writes the data, fdatasync, then the new committed length,
+//    fdatasync: a record is either wholly in the log or not at all.
+//  * write_replacement() writes a compacted copy next to the log and renames
+//    it over; adopt() then switches to it. Mappings of the old file stay
+//    readable until unmapped.
+//
+// Not locked: owners serialize access themselves.
+struct AppendLog {
+    static constexpr size_t HEADER_SIZE = 32;
+
+    std::string path;
+    const char* name;           // for messages: "history log", ...
+    char magic[8];
+    int fd = -1;
+    guint64 committed = 0;      // bytes of valid data, header included
+
+    AppendLog(const std::string& p, const char (&m)[8], const char* what);
+    ~AppendLog();
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    static size_t padded(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+    bool open();
+    bool start_fresh();
+    bool append(const std::string& data);
+
+    // `out` holds HEADER_SIZE bytes of room followed by the records to keep;
+    // the header is filled in. Returns the new file's descriptor, or -1.
+    int write_replacement(std::string& out);
+    void adopt(int new_fd, guint64 new_committed);
+};
+
+#endif // COLOSSUS_APPEND_LOG_H
@@ -0,0 +1,328 @@
+// archiver.cpp — COLOSSUS background saving of pages for offline reading
+
+#include "archiver.h"
+#include "load_profile.h"
+#include "process_model.h"
+#include "trace.h"
+#include "view_cache.h"
+
+#include <algorithm>
+
+namespace {
+
+// A page that has not handed over its model by then (no terminal view,
+// stalled load) is given up on
+const guint JOB_TIMEOUT_S = 45;
+
+// Thumbnails saved per page, at the inline-image size browser.js requests
+const size_t MAX_IMAGES_PER_PAGE = 64;
+const char* IMAGE_SIZE = "amber/320x240/";
+
+bool is_http(const std::string& url)
+{
+    return g_str_has_prefix(url.c_str(), "http://") || g_str_has_prefix(url.c_str(), "https://");
+}
+
+std::string string_property(JSCValue* object, const char* name)
+{
+    std::string out;
+    JSCValue* value = jsc_value_object_get_property(object, name);
+    if (value && jsc_value_is_string(value)) {
+        gchar* utf8 = jsc_value_to_string(value);
+        if (utf8) out = utf8;
+        g_free(utf8);
+    }
+    if (value) g_object_unref(value);
+    return out;
+}
+
+// Calls fn(item) for each element of model[name]
+template <typename Fn>
+void for_each_item(JSCValue* model, const char* name, Fn&& fn)
+{
+    JSCValue* array = jsc_value_object_get_property(model, name);
+    if (array && jsc_value_is_array(array)) {
+        JSCValue* length = jsc_value_object_get_property(array, "length");
+        gint32 count = length ? jsc_value_to_int32(length) : 0;
+        if (length) g_object_unref(length);
+
+        for (gint32 i = 0; i < count; ++i) {
+            JSCValue* item = jsc_value_object_get_property_at_index(array, static_cast<guint>(i));
+            if (item && jsc_value_is_object(item)) fn(item);
+            if (item) g_object_unref(item);
+        }
+    }
+    if (array) g_object_unref(array);
+}
+
+// model.links without anything but http(s) targets: a javascript: href
+// would run in the saved page when followed
+void keep_http_links(JSCValue* model)
+{
+    GPtrArray* kept = g_ptr_array_new_with_free_func(g_object_unref);
+    for_each_item(model, "links", [&](JSCValue* link) {
+        if (is_http(string_property(link, "url"))) g_ptr_array_add(kept, g_object_ref(link));
+    });
+
+    JSCValue* links = jsc_value_new_array_from_garray(jsc_value_get_context(model), kept);
+    jsc_value_object_set_property(model, "links", links);
+    g_object_unref(links);
+    g_ptr_array_unref(kept);
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+Archiver::Archiver(ProcessModel& processes,
+                   ImageProxy& images,
+                   PageArchive& archive,
+                   guint max_jobs)
+    : processes_(processes),
+      images_(images),
+      archive_(archive),
+      max_jobs_(max_jobs ? max_jobs : 1)
+{
+}
+
+Archiver::~Archiver()
+{
+    alive_.reset();
+
+    for (auto& job : jobs_) {
+        if (job->timeout) g_source_remove(job->timeout);
+        g_signal_handlers_disconnect_by_data(job->webview, job.get());
+        gtk_widget_destroy(job->holder);
+    }
+    jobs_.clear();
+
+    for (auto& save : saves_) {
+        for (auto& image : save->images) g_bytes_unref(image.second);
+    }
+    saves_.clear();
+}
+
+// ───────────────────────────────────────────────
+//  Background loads
+// ───────────────────────────────────────────────
+
+bool Archiver::enqueue(const std::string& url)
+{
+    if (!is_http(url)) return false;
+
+    std::string key = url.substr(0, url.find('#'));
+    if (!pending_urls_.insert(key).second) return false;
+
+    queued_.push_back(key);
+    start_jobs();
+    notify_changed();
+    return true;
+}
+
+void Archiver::start_jobs()
+{
+    while (jobs_.size() < max_jobs_ && !queued_.empty()) {
+        std::string url = queued_.front();
+        queued_.pop_front();
+        start_job(url);
+    }
+}
+
+// Laid out in an offscreen window like a pre-warmed view, so browser.js
+// builds the terminal view exactly as it would in a tab
+void Archiver::start_job(const std::string& url)
+{
+    auto job = std::make_unique<Job>();
+    job->owner = this;
+    job->url = url;
+
+    gchar* token = g_uuid_string_random();
+    job->token = token;
+    g_free(token);
+
+    job->webview = processes_.create_view();
+    webkit_web_view_set_settings(job->webview,
+                                 processes_.settings_for(load_profile_for_uri(url)));
+    webkit_web_view_set_is_muted(job->webview, TRUE);
+
+    job->holder = gtk_offscreen_window_new();
+    gtk_window_set_default_size(GTK_WINDOW(job->holder), 1100, 700);
+    gtk_container_add(GTK_CONTAINER(job->holder), GTK_WIDGET(job->webview));
+    gtk_widget_show_all(job->holder);
+
+    g_signal_connect(job->webview, "load-changed", G_CALLBACK(s_load_changed), job.get());
+    g_signal_connect(job->webview, "load-failed", G_CALLBACK(s_load_failed), job.get());
+    job->timeout = g_timeout_add_seconds(JOB_TIMEOUT_S, s_timeout, job.get());
+
+    COLOSSUS_TRACE("archiving %s\n", url.c_str());
+    webkit_web_view_load_uri(job->webview, url.c_str());
+    jobs_.push_back(std::move(job));
+}
+
+// The view goes at once, whatever the outcome: thumbnails are fetched
+// without it
+void Archiver::finish_job(Job* job, bool ok)
+{
+    auto it = std::find_if(jobs_.begin(), jobs_.end(),
+                           [job](const std::unique_ptr<Job>& j) { return j.get() == job; });
+    if (it == jobs_.end()) return;
+
+    std::unique_ptr<Job> done = std::move(*it);
+    jobs_.erase(it);
+
+    if (done->timeout) g_source_remove(done->timeout);
+    g_signal_handlers_disconnect_by_data(done->webview, done.get());
+    gtk_widget_destroy(done->holder);
+
+    pending_urls_.erase(done->url);
+    if (!ok) {
+        ++failed_;
+        COLOSSUS_TRACE("archiving failed: %s\n", done->url.c_str());
+    }
+
+    start_jobs();
+    notify_changed();
+}
+
+Archiver::Job* Archiver::job_for_view(WebKitWebView* view)
+{
+    for (auto& job : jobs_) {
+        if (job->webview == view) return job.get();
+    }
+    return nullptr;
+}
+
+void Archiver::on_load_changed(WebKitWebView* view, WebKitLoadEvent event)
+{
+    if (event != WEBKIT_LOAD_COMMITTED) return;
+
+    Job* job = job_for_view(view);
+    if (!job) return;
+
+    std::string js = ViewCache::begin_script(job->token, nullptr);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(view, js.c_str(), nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+}
+
+void Archiver::on_load_failed(WebKitWebView* view, GError* error)
+{
+    // Cancelled: replaced by a redirect or a script navigation
+    if (g_error_matches(error, WEBKIT_NETWORK_ERROR, WEBKIT_NETWORK_ERROR_CANCELLED)) return;
+
+    if (Job* job = job_for_view(view)) finish_job(job, false);
+}
+
+bool Archiver::on_model(const std::string& token, JSCValue* model)
+{
+    for (auto& job : jobs_) {
+        if (job->token != token) continue;
+
+        bool ok = model && jsc_value_is_object(model);
+        if (ok) save_model(job->url, model);
+        finish_job(job.get(), ok);
+        return true;
+    }
+    return false;
+}
+
+// ───────────────────────────────────────────────
+//  Saving
+// ───────────────────────────────────────────────
+
+void Archiver::save_model(const std::string& url, JSCValue* model)
+{
+    if (!is_http(url) || !model || !jsc_value_is_object(model)) return;
+
+    keep_http_links(model);
+    gchar* json = jsc_value_to_json(model, 0);
+    if (!json) return;
+
+    auto owned = std::make_unique<Save>();
+    Save* save = owned.get();
+    save->url = url;
+    save->model = json;
+    g_free(json);
+    saves_.push_back(std::move(owned));
+
+    // Link thumbnails and inline images, each once; those already in the
+    // archive are not saved again
+    std::vector<std::string> sources;
+    std::unordered_set<std::string> seen;
+    auto add = [&](const std::string& src) {
+        if (sources.size() >= MAX_IMAGES_PER_PAGE || !is_http(src) ||
+            archive_.has_image(src) || !seen.insert(src).second) {
+            return;
+        }
+        sources.push_back(src);
+    };
+    for_each_item(model, "links", [&](JSCValue* link) { add(string_property(link, "thumb")); });
+    for_each_item(model, "flow", [&](JSCValue* item) {
+        if (string_property(item, "tag") == "img") add(string_property(item, "src"));
+    });
+
+    // One extra count, dropped below, so a cache hit answered inside fetch()
+    // cannot finish the save while it is still being set up
+    save->waiting = sources.size() + 1;
+
+    std::weak_ptr<bool> alive = alive_;
+    for (const std::string& src : sources) {
+        gchar* escaped = g_uri_escape_string(src.c_str(), nullptr, FALSE);
+        std::string uri = images_.prefix() + IMAGE_SIZE + escaped;
+        g_free(escaped);
+
+        images_.fetch(uri, [this, alive, save, src](GBytes* png) {
+            if (alive.expired()) return;
+            on_image(save, src, png);
+        });
+    }
+
+    on_image(save, {}, nullptr);
+}
+
+void Archiver::on_image(Save* save, const std::string& src, GBytes* png)
+{
+    if (png) save->images.emplace_back(src, g_bytes_ref(png));
+    if (--save->waiting == 0) finish_save(save);
+}
+
+void Archiver::finish_save(Save* save)
+{
+    archive_.add_page(save->url, std::move(save->model), save->images);
+    ++saved_;
+
+    for (auto& image : save->images) g_bytes_unref(image.second);
+    saves_.remove_if([save](const std::unique_ptr<Save>& s) { return s.get() == save; });
+}
+
+void Archiver::notify_changed()
+{
+    if (changed_callback_) changed_callback_();
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+void Archiver::s_load_changed(WebKitWebView* view, WebKitLoadEvent event, gpointer user_data)
+{
+    static_cast<Job*>(user_data)->owner->on_load_changed(view, event);
+}
+
+gboolean Archiver::s_load_failed(WebKitWebView* view, WebKitLoadEvent, gchar*,
+                                 GError* error, gpointer user_data)
+{
+    static_cast<Job*>(user_data)->owner->on_load_failed(view, error);
+    return TRUE;    // no error page in a view nobody sees
+}
+
+gboolean Archiver::s_timeout(gpointer user_data)
+{
+    auto* job = static_cast<Job*>(user_data);
+    job->timeout = 0;
+    job->owner->finish_job(job, false);
+    return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,111 @@
+// archiver.h — COLOSSUS background saving of pages for offline reading
+
+#ifndef COLOSSUS_ARCHIVER_H
+#define COLOSSUS_ARCHIVER_H
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+#include <jsc/jsc.h>
+}
+
+#include "image_proxy.h"
+#include "page_archive.h"
+
+class ProcessModel;
+
+// Fills the PageArchive. A page model either comes straight from a tab
+// (save_model: what is on screen) or from loading the URL in a muted,
+// offscreen webview; at most `max_jobs` of those exist at once, and each
+// is destroyed as soon as its page has handed over its model (through the
+// view-cache handshake, see ViewCache::begin_script) or after a timeout.
+// The page's thumbnails are then fetched through the image proxy, at the
+// size of the terminal view's inline images, and saved with it.
+class Archiver {
+public:
+    Archiver(ProcessModel& processes,
+             ImageProxy& images,
+             PageArchive& archive,
+             guint max_jobs);
+    ~Archiver();
+
+    Archiver(const Archiver&) = delete;
+    Archiver& operator=(const Archiver&) = delete;
+
+    // Queue `url` for a background load; false if it is not http(s) or
+    // already queued or loading
+    bool enqueue(const std::string& url);
+
+    // Save a page model browser.js handed over for `url`
+    void save_model(const std::string& url, JSCValue* model);
+
+    // A viewCache message: true if `token` belongs to one of our loads
+    bool on_model(const std::string& token, JSCValue* model);
+
+    guint pending() const { return static_cast<guint>(queued_.size() + jobs_.size()); }
+    guint64 saved() const { return saved_; }
+    guint64 failed() const { return failed_; }
+
+    // Runs whenever pending() changes
+    void set_changed_callback(std::function<void()> callback) { changed_callback_ = std::move(callback); }
+
+private:
+    struct Job {
+        Archiver* owner = nullptr;
+        std::string url;
+        std::string token;
+        GtkWidget* holder = nullptr;        // GtkOffscreenWindow
+        WebKitWebView* webview = nullptr;
+        guint timeout = 0;
+    };
+
+    // A model waiting for its thumbnails
+    struct Save {
+        std::string url;
+        std::string model;
+        std::vector<PageArchive::Image> images;     // one ref each
+        size_t waiting = 0;
+    };
+
+    ProcessModel& processes_;
+    ImageProxy& images_;
+    PageArchive& archive_;
+    guint max_jobs_ = 0;
+
+    std::deque<std::string> queued_;
+    std::unordered_set<std::string> pending_urls_;      // queued or loading
+    std::list<std::unique_ptr<Job>> jobs_;
+    std::list<std::unique_ptr<Save>> saves_;
+
+    guint64 saved_ = 0;
+    guint64 failed_ = 0;
+    std::function<void()> changed_callback_;
+
+    // Image proxy callbacks can outlive us
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+
+    void start_jobs();
+    void start_job(const std::string& url);
+    void finish_job(Job* job, bool ok);
+    Job* job_for_view(WebKitWebView* view);
+    void on_load_changed(WebKitWebView* view, WebKitLoadEvent event);
+    void on_load_failed(WebKitWebView* view, GError* error);
+    void on_image(Save* save, const std::string& src, GBytes* png);
+    void finish_save(Save* save);
+    void notify_changed();
+
+    static void s_load_changed(WebKitWebView* view, WebKitLoadEvent event, gpointer user_data);
+    static gboolean s_load_failed(WebKitWebView* view, WebKitLoadEvent event,
+                                  gchar* failing_uri, GError* error, gpointer user_data);
+    static gboolean s_timeout(gpointer user_data);
+};
+
+#endif // COLOSSUS_ARCHIVER_H
@@ -0,0 +1,692 @@
+// bench.cpp — COLOSSUS offline page-handling benchmark
+
+#include "bench.h"
+#include "proc_stats.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace {
+
+// Bump when the generated pages change, so stale fixtures are rewritten
+const char* FIXTURE_VERSION = "1";
+const guint32 FIXTURE_SEED = 421;
+
+struct Fixture {
+    const char* name;
+    const char* file;
+};
+
+const Fixture FIXTURES[] = {
+    { "article",   "article.html" },
+    { "index-10k", "index-10k.html" },
+    { "gallery",   "gallery.html" },
+    { "nested",    "nested.html" },
+};
+const size_t FIXTURE_COUNT = G_N_ELEMENTS(FIXTURES);
+
+const guint INDEX_LINKS = 10000;
+const guint GALLERY_IMAGES = 120;
+const int GALLERY_IMAGE_W = 480;
+const int GALLERY_IMAGE_H = 360;
+const guint NESTED_CHAINS = 20;
+const guint NESTED_DEPTH = 300;     // under WebKit's 512-deep parser limit
+
+const guint TICK_MS = 5;
+const double STALL_MS = 50.0;       // three frames
+const guint SETTLE_MS = 300;
+const guint PAGE_TIMEOUT_S = 30;
+
+// Compared against the baseline. A metric regresses when it is worse by
+// more than the threshold AND by more than its floor, so a 2 ms page does
+// not fail for taking 3 ms.
+struct MetricSpec {
+    const char* name;
+    double BenchRunner::Sample::*field;
+    double noise_floor;
+};
+
+const MetricSpec METRICS[] = {
+    { "committed_ms", &BenchRunner::Sample::committed_ms, 5.0 },
+    { "finished_ms",  &BenchRunner::Sample::finished_ms,  5.0 },
+    { "terminal_ms",  &BenchRunner::Sample::terminal_ms,  5.0 },
+    { "web_rss_kb",   &BenchRunner::Sample::web_rss_kb,   4096.0 },
+    { "ui_rss_kb",    &BenchRunner::Sample::ui_rss_kb,    4096.0 },
+    { "stall_max_ms", &BenchRunner::Sample::stall_max_ms, 16.0 },
+    { "stalls",       &BenchRunner::Sample::stalls,       1.0 },
+};
+
+const char* WORDS[] = {
+    "colossus", "forbin", "network", "access", "node", "terminal", "amber",
+    "signal", "relay", "archive", "protocol", "operator", "index", "vector",
+    "lattice", "carrier", "uplink", "sector", "cipher", "beacon", "orbit",
+    "console", "buffer", "channel", "station", "monitor", "output", "record",
+    "the", "of", "and", "to", "in", "for", "with", "on", "at", "from",
+};
+
+std::string words(GRand* rand, guint count)
+{
+    std::string out;
+    for (guint i = 0; i < count; ++i) {
+        if (i) out += ' ';
+        out += WORDS[g_rand_int_range(rand, 0, G_N_ELEMENTS(WORDS))];
+    }
+    return out;
+}
+
+std::string page_head(const char* title)
+{
+    return std::string("<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+                       "<title>") + title + "</title></head>\n<body>\n";
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+BenchRunner::BenchRunner(Browser& browser, const Options& options)
+    : browser_(browser),
+      options_(options)
+{
+    if (options_.runs == 0) options_.runs = 1;
+
+    gchar* dir = g_build_filename(options_.out_dir.c_str(), "fixtures", nullptr);
+    fixtures_dir_ = dir;
+    g_free(dir);
+}
+
+BenchRunner::~BenchRunner()
+{
+    clear_sources();
+    if (tick_source_) {
+        g_source_remove(tick_source_);
+        tick_source_ = 0;
+    }
+    browser_.set_page_event_callback(nullptr);
+
+    if (server_) {
+        g_socket_service_stop(server_);
+        g_socket_listener_close(G_SOCKET_LISTENER(server_));
+        g_object_unref(server_);
+        server_ = nullptr;
+    }
+}
+
+void BenchRunner::clear_sources()
+{
+    if (timeout_source_) {
+        g_source_remove(timeout_source_);
+        timeout_source_ = 0;
+    }
+    if (settle_source_) {
+        g_source_remove(settle_source_);
+        settle_source_ = 0;
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Fixtures
+// ───────────────────────────────────────────────
+//
+//   article.html     12 sections of headings and paragraphs
+//   index-10k.html   10,000 distinct links in one list
+//   gallery.html     120 linked 480×360 PNGs with captions
+//   nested.html      20 chains of divs 300 deep, text every 10 levels
+
+bool BenchRunner::write_fixtures()
+{
+    gchar* version_path = g_build_filename(fixtures_dir_.c_str(), "VERSION", nullptr);
+    gchar* version = nullptr;
+    bool current = g_file_get_contents(version_path, &version, nullptr, nullptr) &&
+                   g_strcmp0(version, FIXTURE_VERSION) == 0;
+    g_free(version);
+    if (current) {
+        g_free(version_path);
+        return true;
+    }
+
+    gchar* img_dir = g_build_filename(fixtures_dir_.c_str(), "img", nullptr);
+    g_mkdir_with_parents(img_dir, 0755);
+
+    GRand* rand = g_rand_new_with_seed(FIXTURE_SEED);
+    std::string pages[FIXTURE_COUNT];
+
+    std::string& article = pages[0];
+    article = page_head("Bench: article");
+    article += "<h1>" + words(rand, 8) + "</h1>\n";
+    for (guint section = 0; section < 12; ++section) {
+        article += "<h2>" + words(rand, 6) + "</h2>\n";
+        for (guint p = 0; p < 5; ++p) {
+            article += "<p>" + words(rand, 40) + " <a href=\"/index-10k.html#" +
+                       std::to_string(section * 5 + p) + "\">" + words(rand, 3) +
+                       "</a> " + words(rand, 20) + ".</p>\n";
+        }
+    }
+
+    std::string& index = pages[1];
+    index = page_head("Bench: 10k-link index");
+    index += "<h1>Index</h1>\n<ul>\n";
+    for (guint i = 0; i < INDEX_LINKS; ++i) {
+        index += "<li><a href=\"/item/" + std::to_string(i) + "\">" +
+                 std::to_string(i) + ": " + words(rand, 5) + "</a></li>\n";
+    }
+    index += "</ul>\n";
+
+    std::string& gallery = pages[2];
+    gallery = page_head("Bench: gallery");
+    gallery += "<h1>Gallery</h1>\n";
+    bool images_ok = true;
+    for (guint i = 0; i < GALLERY_IMAGES && images_ok; ++i) {
+        std::string name = "img/" + std::to_string(i) + ".png";
+
+        // A gradient per image, so sizes and decode costs are realistic
+        GdkPixbuf* pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8,
+                                           GALLERY_IMAGE_W, GALLERY_IMAGE_H);
+        int stride = gdk_pixbuf_get_rowstride(pixbuf);
+        guchar* pixels = gdk_pixbuf_get_pixels(pixbuf);
+        guint8 tint = static_cast<guint8>(g_rand_int(rand));
+        for (int y = 0; y < GALLERY_IMAGE_H; ++y) {
+            guchar* row = pixels + y * stride;
+            for (int x = 0; x < GALLERY_IMAGE_W; ++x) {
+                row[x * 3] = static_cast<guchar>(x * 255 / GALLERY_IMAGE_W);
+                row[x * 3 + 1] = static_cast<guchar>(y * 255 / GALLERY_IMAGE_H);
+                row[x * 3 + 2] = static_cast<guchar>(tint ^ (x + y));
+            }
+        }
+
+        gchar* path = g_build_filename(fixtures_dir_.c_str(), name.c_str(), nullptr);
+        GError* error = nullptr;
+        if (!gdk_pixbuf_save(pixbuf, path, "png", &error, nullptr)) {
+            g_printerr("COLOSSUS-NAN: bench: Failed to write %s: %s\n", path,
+                       error ? error->message : "unknown error");
+            g_clear_error(&error);
+            images_ok = false;
+        }
+        g_free(path);
+        g_object_unref(pixbuf);
+
+        gallery += "<figure><a href=\"/" + name + "\"><img src=\"/" + name +
+                   "\" width=\"480\" height=\"360\" alt=\"" + words(rand, 3) +
+                   "\"></a><figcaption>" + words(rand, 10) + "</figcaption></figure>\n";
+    }
+
+    std::string& nested = pages[3];
+    nested = page_head("Bench: nested DOM");
+    for (guint chain = 0; chain < NESTED_CHAINS; ++chain) {
+        for (guint depth = 0; depth < NESTED_DEPTH; ++depth) {
+            nested += "<div>";
+            if (depth % 10 == 0) {
+                nested += "<p>" + words(rand, 12) + "</p>";
+            }
+        }
+        nested += "<a href=\"/item/" + std::to_string(chain) + "\">" + words(rand, 4) + "</a>";
+        for (guint depth = 0; depth < NESTED_DEPTH; ++depth) nested += "</div>";
+        nested += "\n";
+    }
+
+    g_rand_free(rand);
+    g_free(img_dir);
+
+    bool ok = images_ok;
+    for (size_t i = 0; i < FIXTURE_COUNT && ok; ++i) {
+        pages[i] += "</body></html>\n";
+        gchar* path = g_build_filename(fixtures_dir_.c_str(), FIXTURES[i].file, nullptr);
+        GError* error = nullptr;
+        if (!g_file_set_contents(path, pages[i].c_str(),
+                                 static_cast<gssize>(pages[i].size()), &error)) {
+            g_printerr("COLOSSUS-NAN: bench: Failed to write %s: %s\n", path,
+                       error ? error->message : "unknown error");
+            g_clear_error(&error);
+            ok = false;
+        }
+        g_free(path);
+    }
+
+    // Written last: an interrupted run regenerates everything
+    if (ok) g_file_set_contents(version_path, FIXTURE_VERSION, -1, nullptr);
+    g_free(version_path);
+    return ok;
+}
+
+// ───────────────────────────────────────────────
+//  Fixture server (127.0.0.1, one request per connection)
+// ───────────────────────────────────────────────
+
+bool BenchRunner::start_server()
+{
+    server_ = g_threaded_socket_service_new(4);
+
+    GInetAddress* loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    GSocketAddress* address = g_inet_socket_address_new(loopback, 0);
+    GSocketAddress* effective = nullptr;
+    GError* error = nullptr;
+    bool ok = g_socket_listener_add_address(G_SOCKET_LISTENER(server_), address,
+                                            G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP,
+                                            nullptr, &effective, &error);
+    g_object_unref(address);
+    g_object_unref(loopback);
+
+    if (!ok) {
+        g_printerr("COLOSSUS-NAN: bench: Cannot listen on 127.0.0.1: %s\n",
+                   error ? error->message : "unknown error");
+        g_clear_error(&error);
+        return false;
+    }
+
+    port_ = g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(effective));
+    g_object_unref(effective);
+
+    // Handlers run on the service's threads; they get their own copy of
+    // the root, released with the service
+    g_signal_connect_data(server_, "run", G_CALLBACK(BenchRunner::s_serve),
+                          g_strdup(fixtures_dir_.c_str()),
+                          +[](gpointer root, GClosure*) { g_free(root); }, GConnectFlags(0));
+    g_socket_service_start(server_);
+    return true;
+}
+
+gboolean BenchRunner::s_serve(GThreadedSocketService*, GSocketConnection* connection,
+                              GObject*, gpointer user_data)
+{
+    const auto* root = static_cast<const gchar*>(user_data);
+
+    GDataInputStream* lines = g_data_input_stream_new(
+        g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    g_filter_input_stream_set_close_base_stream(G_FILTER_INPUT_STREAM(lines), FALSE);
+
+    gchar* request = g_data_input_stream_read_line(lines, nullptr, nullptr, nullptr);
+    for (;;) {
+        gchar* header = g_data_input_stream_read_line(lines, nullptr, nullptr, nullptr);
+        bool end = !header || !*header || (header[0] == '\r' && !header[1]);
+        g_free(header);
+        if (end) break;
+    }
+    g_object_unref(lines);
+
+    // "GET /path?query HTTP/1.1"
+    std::string path;
+    if (request && g_str_has_prefix(request, "GET /")) {
+        path = request + 5;
+        path = path.substr(0, path.find_first_of(" ?#\r"));
+    }
+    g_free(request);
+
+    gchar* body = nullptr;
+    gsize length = 0;
+    bool found = false;
+    if (!path.empty() && path.find("..") == std::string::npos) {
+        gchar* file = g_build_filename(root, path.c_str(), nullptr);
+        found = g_file_get_contents(file, &body, &length, nullptr);
+        g_free(file);
+    }
+
+    const char* type = g_str_has_suffix(path.c_str(), ".png") ? "image/png"
+                                                              : "text/html; charset=utf-8";
+    gchar* head = found
+        ? g_strdup_printf("HTTP/1.1 200 OK\r\nContent-Type: %s\r\n"
+                          "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                          "Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+                          type, length)
+        : g_strdup("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                   "Connection: close\r\n\r\n");
+
+    GOutputStream* out = g_io_stream_get_output_stream(G_IO_STREAM(connection));
+    if (g_output_stream_write_all(out, head, strlen(head), nullptr, nullptr, nullptr) && found) {
+        g_output_stream_write_all(out, body, length, nullptr, nullptr, nullptr);
+    }
+    g_free(head);
+    g_free(body);
+    return FALSE;
+}
+
+// ───────────────────────────────────────────────
+//  Driving the browser
+// ───────────────────────────────────────────────
+
+void BenchRunner::start()
+{
+    g_mkdir_with_parents(fixtures_dir_.c_str(), 0755);
+    if (!write_fixtures() || !start_server()) {
+        exit_status_ = 1;
+        g_application_quit(g_application_get_default());
+        return;
+    }
+
+    g_print("bench: %zu pages × %u runs from http://127.0.0.1:%u/\n",
+            FIXTURE_COUNT, options_.runs, port_);
+
+    browser_.set_page_event_callback(
+        [this](Browser::PageEvent event, const std::string& uri, double ms, int web_pid) {
+            on_page_event(event, uri, ms, web_pid);
+        });
+
+    last_tick_ = g_get_monotonic_time();
+    tick_source_ = g_timeout_add_full(G_PRIORITY_HIGH, TICK_MS, BenchRunner::s_tick, this, nullptr);
+
+    next_load();
+}
+
+// Every run starts from about:blank, so no load pays for tearing down the
+// page before it
+void BenchRunner::next_load()
+{
+    if (page_ >= FIXTURE_COUNT) {
+        finish();
+        return;
+    }
+    phase_ = Phase::Blanking;
+    browser_.open_uri("about:blank");
+}
+
+void BenchRunner::begin_page_load()
+{
+    sample_ = Sample();
+    web_pid_ = 0;
+    page_uri_ = "http://127.0.0.1:" + std::to_string(port_) + "/" + FIXTURES[page_].file;
+
+    phase_ = Phase::Loading;
+    last_tick_ = g_get_monotonic_time();
+    timeout_source_ = g_timeout_add_seconds(PAGE_TIMEOUT_S, BenchRunner::s_timeout, this);
+    browser_.open_uri(page_uri_);
+}
+
+void BenchRunner::on_page_event(Browser::PageEvent event, const std::string& uri,
+                                double ms, int web_pid)
+{
+    if (phase_ == Phase::Blanking) {
+        // Not from inside the view's own load-changed emission
+        if (event == Browser::PageEvent::Finished && uri == "about:blank") {
+            g_idle_add(+[](gpointer data) -> gboolean {
+                static_cast<BenchRunner*>(data)->begin_page_load();
+                return G_SOURCE_REMOVE;
+            }, this);
+            phase_ = Phase::Idle;
+        }
+        return;
+    }
+
+    // Posted right after the terminal view, so usually while settling
+    if (event == Browser::PageEvent::ExtractorsAgree ||
+        event == Browser::PageEvent::ExtractorsDiffer) {
+        if ((phase_ == Phase::Loading || phase_ == Phase::Settling) && uri == page_uri_) {
+            extract_checks_++;
+            if (event == Browser::PageEvent::ExtractorsDiffer) extract_mismatches_++;
+        }
+        return;
+    }
+
+    if (phase_ != Phase::Loading || uri != page_uri_) return;
+
+    if (web_pid > 0) web_pid_ = web_pid;
+    switch (event) {
+    case Browser::PageEvent::Committed:
+        if (sample_.committed_ms < 0) sample_.committed_ms = ms;
+        break;
+    case Browser::PageEvent::Finished:
+        if (sample_.finished_ms < 0) sample_.finished_ms = ms;
+        break;
+    case Browser::PageEvent::TerminalView:
+        if (sample_.terminal_ms < 0) sample_.terminal_ms = ms;
+        break;
+    default:
+        break;
+    }
+
+    if (sample_.finished_ms >= 0 && sample_.terminal_ms >= 0) {
+        phase_ = Phase::Settling;
+        settle_source_ = g_timeout_add(SETTLE_MS, BenchRunner::s_settled, this);
+    }
+}
+
+// A high-priority timer runs ahead of everything else that is ready, so
+// how late it fires is how long the main loop was busy with something else
+void BenchRunner::on_tick()
+{
+    gint64 now = g_get_monotonic_time();
+    double late_ms = colossus_ms_between(last_tick_, now) - TICK_MS;
+    last_tick_ = now;
+
+    if ((phase_ == Phase::Loading || phase_ == Phase::Settling) && late_ms > STALL_MS) {
+        sample_.stalls += 1.0;
+        sample_.stall_max_ms = std::max(sample_.stall_max_ms, late_ms);
+    }
+}
+
+void BenchRunner::settle()
+{
+    sample_.web_rss_kb = colossus_process_rss_kb(web_pid_);
+    sample_.ui_rss_kb = colossus_process_rss_kb(getpid());
+    finish_load(true);
+}
+
+void BenchRunner::finish_load(bool ok)
+{
+    clear_sources();
+    phase_ = Phase::Idle;
+
+    const char* name = FIXTURES[page_].name;
+    if (ok) {
+        g_print("bench: %-10s run %u/%u  committed %s  finished %s  terminal %s ms  "
+                "web %s kB  stall %s ms\n", name, run_ + 1, options_.runs,
+                colossus_format_metric(sample_.committed_ms).c_str(),
+                colossus_format_metric(sample_.finished_ms).c_str(),
+                colossus_format_metric(sample_.terminal_ms).c_str(),
+                colossus_format_metric(sample_.web_rss_kb).c_str(),
+                colossus_format_metric(sample_.stall_max_ms).c_str());
+        samples_.push_back(sample_);
+    } else {
+        g_printerr("COLOSSUS-NAN: bench: %s run %u/%u timed out (finished %s, terminal %s)\n",
+                   name, run_ + 1, options_.runs,
+                   sample_.finished_ms >= 0 ? "yes" : "no",
+                   sample_.terminal_ms >= 0 ? "yes" : "no");
+        failed_++;
+    }
+
+    if (++run_ == options_.runs) {
+        results_.push_back({ name, median_of(samples_) });
+        samples_.clear();
+        run_ = 0;
+        page_++;
+    }
+    next_load();
+}
+
+BenchRunner::Metrics BenchRunner::median_of(const std::vector<Sample>& samples)
+{
+    Metrics out;
+    for (const auto& metric : METRICS) {
+        std::vector<double> values;
+        for (const auto& sample : samples) {
+            double value = sample.*metric.field;
+            if (value >= 0) values.push_back(value);
+        }
+        if (values.empty()) continue;
+
+        std::sort(values.begin(), values.end());
+        size_t mid = values.size() / 2;
+        out[metric.name] = values.size() % 2 ? values[mid]
+                                              : (values[mid - 1] + values[mid]) / 2.0;
+    }
+    return out;
+}
+
+// ───────────────────────────────────────────────
+//  Results
+// ───────────────────────────────────────────────
+//
+//   { "version": 1, "runs": 3, "failed_loads": 0,
+//     "extractor_checks": 12, "extractor_mismatches": 0,
+//     "pages": { "article": { "committed_ms": 12.3, ... }, ... } }
+
+void BenchRunner::finish()
+{
+    clear_sources();
+    if (tick_source_) {
+        g_source_remove(tick_source_);
+        tick_source_ = 0;
+    }
+    browser_.set_page_event_callback(nullptr);
+
+    gchar* path = g_build_filename(options_.out_dir.c_str(), "results.json", nullptr);
+    if (write_results(path)) {
+        g_print("bench: results in %s\n", path);
+    } else {
+        exit_status_ = 1;
+    }
+    g_free(path);
+
+    if (failed_) {
+        g_printerr("COLOSSUS-NAN: bench: %u loads failed\n", failed_);
+        exit_status_ = 1;
+    }
+    if (!extract_checks_) {
+        g_printerr("COLOSSUS-NAN: bench: native extractor not loaded; "
+                   "walker output was not compared\n");
+    } else if (extract_mismatches_) {
+        g_printerr("COLOSSUS-NAN: bench: walker and native extractor differ on %u of %u loads\n",
+                   extract_mismatches_, extract_checks_);
+        exit_status_ = 1;
+    } else {
+        g_print("bench: walker and native extractor agree on %u loads\n", extract_checks_);
+    }
+    if (!options_.baseline.empty() && !compare_with_baseline()) {
+        exit_status_ = 1;
+    }
+
+    g_application_quit(g_application_get_default());
+}
+
+bool BenchRunner::write_results(const std::string& path) const
+{
+    std::string json = "{\n  \"version\": 1,\n  \"runs\": " + std::to_string(options_.runs) +
+                       ",\n  \"failed_loads\": " + std::to_string(failed_) +
+                       ",\n  \"extractor_checks\": " + std::to_string(extract_checks_) +
+                       ",\n  \"extractor_mismatches\": " +
+                       std::to_string(extract_mismatches_) +
+                       ",\n  \"pages\": {";
+
+    for (size_t i = 0; i < results_.size(); ++i) {
+        json += i ? ",\n    \"" : "\n    \"";
+        json += results_[i].first + "\": {";
+
+        bool first = true;
+        for (const auto& metric : METRICS) {
+            auto it = results_[i].second.find(metric.name);
+            if (it == results_[i].second.end()) continue;
+            json += first ? " \"" : ", \"";
+            json += std::string(metric.name) + "\": " + colossus_format_metric(it->second);
+            first = false;
+        }
+        json += " }";
+    }
+    json += "\n  }\n}\n";
+
+    GError* error = nullptr;
+    if (!g_file_set_contents(path.c_str(), json.c_str(),
+                             static_cast<gssize>(json.size()), &error)) {
+        g_printerr("COLOSSUS-NAN: bench: Failed to write %s: %s\n", path.c_str(),
+                   error ? error->message : "unknown error");
+        g_clear_error(&error);
+        return false;
+    }
+    return true;
+}
+
+// Prints one line per metric against the baseline; false on any regression
+bool BenchRunner::compare_with_baseline() const
+{
+    gchar* text = nullptr;
+    GError* error = nullptr;
+    if (!g_file_get_contents(options_.baseline.c_str(), &text, nullptr, &error)) {
+        g_printerr("COLOSSUS-NAN: bench: Cannot read baseline %s: %s\n",
+                   options_.baseline.c_str(), error ? error->message : "unknown error");
+        g_clear_error(&error);
+        return false;
+    }
+
+    JSCContext* context = jsc_context_new();
+    JSCValue* root = jsc_value_new_from_json(context, text);
+    g_free(text);
+
+    JSCValue* pages = root && jsc_value_is_object(root)
+        ? jsc_value_object_get_property(root, "pages") : nullptr;
+    if (!pages || !jsc_value_is_object(pages)) {
+        g_printerr("COLOSSUS-NAN: bench: %s is not a bench result\n", options_.baseline.c_str());
+        if (pages) g_object_unref(pages);
+        if (root) g_object_unref(root);
+        g_object_unref(context);
+        return false;
+    }
+
+    bool ok = true;
+    g_print("bench: against %s (threshold %s%%)\n", options_.baseline.c_str(),
+            colossus_format_metric(options_.threshold_pct).c_str());
+
+    for (const auto& result : results_) {
+        JSCValue* base = jsc_value_object_get_property(pages, result.first.c_str());
+        if (!base || !jsc_value_is_object(base)) {
+            g_print("bench: %-10s not in baseline\n", result.first.c_str());
+            if (base) g_object_unref(base);
+            continue;
+        }
+
+        for (const auto& metric : METRICS) {
+            auto it = result.second.find(metric.name);
+            JSCValue* value = jsc_value_object_get_property(base, metric.name);
+            bool comparable = it != result.second.end() && value && jsc_value_is_number(value);
+            double before = comparable ? jsc_value_to_double(value) : 0.0;
+            if (value) g_object_unref(value);
+            if (!comparable) continue;
+
+            double now = it->second;
+            double change_pct = before > 0 ? (now - before) * 100.0 / before : 0.0;
+            bool regressed = now - before > metric.noise_floor &&
+                             now > before * (1.0 + options_.threshold_pct / 100.0);
+            if (regressed) ok = false;
+
+            g_print("bench: %-10s %-13s %10s → %10s  %+6.1f%%%s\n",
+                    result.first.c_str(), metric.name,
+                    colossus_format_metric(before).c_str(), colossus_format_metric(now).c_str(),
+                    change_pct, regressed ? "  REGRESSION" : "");
+        }
+        g_object_unref(base);
+    }
+
+    g_object_unref(pages);
+    g_object_unref(root);
+    g_object_unref(context);
+
+    g_print("bench: %s\n", ok ? "no regressions" : "FAILED: regressions over threshold");
+    return ok;
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+gboolean BenchRunner::s_tick(gpointer user_data)
+{
+    static_cast<BenchRunner*>(user_data)->on_tick();
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean BenchRunner::s_timeout(gpointer user_data)
+{
+    auto* self = static_cast<BenchRunner*>(user_data);
+    self->timeout_source_ = 0;
+    self->finish_load(false);
+    return G_SOURCE_REMOVE;
+}
+
+gboolean BenchRunner::s_settled(gpointer user_data)
+{
+    auto* self = static_cast<BenchRunner*>(user_data);
+    self->settle_source_ = 0;
+    self->settle();
+    return G_SOURCE_REMOVE;
+}
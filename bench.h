@@ -0,0 +1,122 @@
+// bench.h — COLOSSUS offline page-handling benchmark
+
+#ifndef COLOSSUS_BENCH_H
+#define COLOSSUS_BENCH_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+#include "browser.h"
+
+// Drives a Browser through a generated corpus of local pages (an article,
+// a 10k-link index, an image gallery, deeply nested markup) served from
+// 127.0.0.1, so the diet profile, browser.js and colossus-img:// all run as
+// they would for a real site. Each page is loaded `runs` times, from
+// about:blank, and the median of every metric is kept:
+//
+//   committed_ms / finished_ms   LOAD_COMMITTED / LOAD_FINISHED
+//   terminal_ms                  browser.js finished the terminal view
+//   web_rss_kb / ui_rss_kb       resident size once the page has settled
+//   stall_max_ms / stalls        main-loop dispatch delays over STALL_MS
+//
+// Every load also compares browser.js's walker with the native extractor on
+// the page's original content (COLOSSUS_EXTRACT_CHECK); any difference
+// fails the run.
+//
+// Results go to <out>/results.json. Given a baseline in the same format,
+// a metric worse than both the threshold and its noise floor fails the run.
+class BenchRunner {
+public:
+    // One load of one page; -1 where a milestone was not reached
+    struct Sample {
+        double committed_ms = -1.0;
+        double finished_ms = -1.0;
+        double terminal_ms = -1.0;
+        double web_rss_kb = -1.0;
+        double ui_rss_kb = -1.0;
+        double stall_max_ms = 0.0;
+        double stalls = 0.0;
+    };
+
+    struct Options {
+        std::string out_dir = "bench-out";
+        std::string baseline;           // empty: no comparison
+        double threshold_pct = 10.0;
+        guint runs = 3;
+    };
+
+    BenchRunner(Browser& browser, const Options& options);
+    ~BenchRunner();
+
+    BenchRunner(const BenchRunner&) = delete;
+    BenchRunner& operator=(const BenchRunner&) = delete;
+
+    // Writes the fixtures if needed, starts serving them and begins loading;
+    // quits the default GApplication when done
+    void start();
+
+    int exit_status() const { return exit_status_; }
+
+private:
+    using Metrics = std::map<std::string, double>;
+
+    enum class Phase {
+        Idle,
+        Blanking,       // loading about:blank between runs
+        Loading,        // waiting for LOAD_FINISHED and the terminal view
+        Settling        // both seen; still counting stalls
+    };
+
+    Browser& browser_;
+    Options options_;
+    std::string fixtures_dir_;
+    int exit_status_ = 0;
+
+    GSocketService* server_ = nullptr;
+    guint16 port_ = 0;
+
+    size_t page_ = 0;
+    guint run_ = 0;
+    Phase phase_ = Phase::Idle;
+    std::string page_uri_;
+    Sample sample_;
+    std::vector<Sample> samples_;       // runs of the current page
+    std::vector<std::pair<std::string, Metrics>> results_;
+    guint failed_ = 0;
+    guint extract_checks_ = 0;
+    guint extract_mismatches_ = 0;
+
+    guint tick_source_ = 0;
+    gint64 last_tick_ = 0;
+    guint timeout_source_ = 0;
+    guint settle_source_ = 0;
+    int web_pid_ = 0;
+
+    bool write_fixtures();
+    bool start_server();
+    void next_load();
+    void begin_page_load();
+    void on_page_event(Browser::PageEvent event, const std::string& uri, double ms, int web_pid);
+    void on_tick();
+    void settle();
+    void finish_load(bool ok);
+    void finish();
+    bool write_results(const std::string& path) const;
+    bool compare_with_baseline() const;
+    void clear_sources();
+
+    static Metrics median_of(const std::vector<Sample>& samples);
+
+    static gboolean s_tick(gpointer user_data);
+    static gboolean s_timeout(gpointer user_data);
+    static gboolean s_settled(gpointer user_data);
+    static gboolean s_serve(GThreadedSocketService* service, GSocketConnection* connection,
+                            GObject* source, gpointer user_data);
+};
+
+#endif // COLOSSUS_BENCH_H
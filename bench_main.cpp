@@ -0,0 +1,146 @@
+// bench_main.cpp — entry point for the COLOSSUS page-handling benchmark
+//
+//   colossus-bench [--out DIR] [--runs N] [--baseline FILE] [--threshold PCT]
+//
+// Exits non-zero when a page fails to load or, with --baseline, when any
+// metric regressed past the threshold. `make bench` runs it (under xvfb-run
+// when available).
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include "bench.h"
+#include "browser.h"
+
+static Browser* g_browser = nullptr;
+static BenchRunner* g_bench = nullptr;
+static BenchRunner::Options g_options;
+
+// ───────────────────────────────────────────────
+//  Scratch profile
+// ───────────────────────────────────────────────
+
+static void remove_tree(const gchar* path)
+{
+    if (g_file_test(path, G_FILE_TEST_IS_DIR) && !g_file_test(path, G_FILE_TEST_IS_SYMLINK)) {
+        GDir* dir = g_dir_open(path, 0, nullptr);
+        if (dir) {
+            while (const gchar* name = g_dir_read_name(dir)) {
+                gchar* child = g_build_filename(path, name, nullptr);
+                remove_tree(child);
+                g_free(child);
+            }
+            g_dir_close(dir);
+        }
+    }
+    g_remove(path);
+}
+
+// History, session, caches and filter lists all live under the XDG
+// directories; pointing them at a fresh directory gives every bench run the
+// same cold profile and keeps the fixtures out of the user's history
+static gchar* use_scratch_profile()
+{
+    gchar* profile = g_dir_make_tmp("colossus-bench-XXXXXX", nullptr);
+    if (!profile) return nullptr;
+
+    const char* dirs[][2] = {
+        { "XDG_DATA_HOME", "data" },
+        { "XDG_CACHE_HOME", "cache" },
+        { "XDG_CONFIG_HOME", "config" },
+    };
+    for (const auto& dir : dirs) {
+        gchar* path = g_build_filename(profile, dir[1], nullptr);
+        g_mkdir_with_parents(path, 0700);
+        g_setenv(dir[0], path, TRUE);
+        g_free(path);
+    }
+    return profile;
+}
+
+// ───────────────────────────────────────────────
+//  Application
+// ───────────────────────────────────────────────
+
+static void on_app_activate(GtkApplication* app, gpointer)
+{
+    if (g_browser) return;
+
+    // No network: nothing but about:blank until the runner takes over
+    g_browser = new Browser(app, "about:blank");
+    g_browser->show();
+
+    g_bench = new BenchRunner(*g_browser, g_options);
+    g_bench->start();
+}
+
+int main(int argc, char** argv)
+{
+    gchar* out_dir = nullptr;
+    gchar* baseline = nullptr;
+    gint runs = 3;
+    gdouble threshold = 10.0;
+
+    GOptionEntry entries[] = {
+        { "out", 'o', 0, G_OPTION_ARG_FILENAME, &out_dir,
+          "Directory for fixtures and results.json (default bench-out)", "DIR" },
+        { "runs", 'n', 0, G_OPTION_ARG_INT, &runs,
+          "Loads per page; the median is kept (default 3)", "N" },
+        { "baseline", 'b', 0, G_OPTION_ARG_FILENAME, &baseline,
+          "results.json to compare against", "FILE" },
+        { "threshold", 't', 0, G_OPTION_ARG_DOUBLE, &threshold,
+          "Allowed slowdown in percent (default 10)", "PCT" },
+        { nullptr, 0, 0, G_OPTION_ARG_NONE, nullptr, nullptr, nullptr }
+    };
+
+    GOptionContext* context = g_option_context_new("- COLOSSUS page-handling benchmark");
+    g_option_context_add_main_entries(context, entries, nullptr);
+    GError* error = nullptr;
+    if (!g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("colossus-bench: %s\n", error->message);
+        g_error_free(error);
+        g_option_context_free(context);
+        return 2;
+    }
+    g_option_context_free(context);
+
+    if (out_dir) g_options.out_dir = out_dir;
+    if (baseline) g_options.baseline = baseline;
+    g_options.runs = runs > 0 ? static_cast<guint>(runs) : 1;
+    g_options.threshold_pct = threshold;
+    g_free(out_dir);
+    g_free(baseline);
+
+    gchar* profile = use_scratch_profile();
+    if (!profile) {
+        g_printerr("colossus-bench: Cannot create a scratch profile\n");
+        return 2;
+    }
+
+    // Measure page handling alone: no restored tabs, no pre-warmed views
+    // loading the homepage, no startup budget warning, no cached views on
+    // repeat runs
+    g_setenv("COLOSSUS_SESSION", "0", TRUE);
+    g_setenv("COLOSSUS_WARM_TABS", "0", TRUE);
+    g_setenv("COLOSSUS_STARTUP_BUDGET_MS", "0", TRUE);
+    g_setenv("COLOSSUS_VIEW_CACHE_MB", "0", TRUE);
+
+    // Back the walker's "same output as the native extractor" on every page
+    g_setenv("COLOSSUS_EXTRACT_CHECK", "1", TRUE);
+
+    GtkApplication* app =
+        gtk_application_new("tech.will.colossus.bench", G_APPLICATION_NON_UNIQUE);
+    g_signal_connect(app, "activate", G_CALLBACK(on_app_activate), nullptr);
+
+    int status = g_application_run(G_APPLICATION(app), 1, argv);
+    if (status == 0 && g_bench) status = g_bench->exit_status();
+
+    delete g_bench;
+    g_bench = nullptr;
+    delete g_browser;
+    g_browser = nullptr;
+    g_object_unref(app);
+
+    remove_tree(profile);
+    g_free(profile);
+    return status;
+}
@@ -1,74 +1,295 @@
 // browser.cpp — COLOSSUS Terminal Browser with tabs + bottom command bar
 
 #include "browser.h"
+#include "app_resources.h"
+#include "trace.h"
 
-#include <fstream>
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 
 #include <gdk/gdkkeysyms.h>
 
 // Default homepage
 static const char* COLOSSUS_HOMEPAGE = "https://search.brave.com/";
 
+// about:colossus refresh interval while it is the current tab
+static const guint DASHBOARD_REFRESH_S = 1;
+
+// Notebook pages and tab labels carry their tab's ID under this key
+static const char* TAB_ID_KEY = "colossus-tab-id";
+
+// Command-bar completion rows
+enum {
+    COMPLETION_COL_URL,
+    COMPLETION_COL_TITLE,
+    COMPLETION_N_COLS
+};
+static const size_t COMPLETION_ROWS = 10;
+
+// CRT effect tiers of browser.js's render-quality controller, richest first
+static const char* RENDER_TIERS[] = { "full", "single", "flat" };
+
+// Background loads queued by one "archive all links" action
+static const guint MAX_ARCHIVED_LINKS = 200;
+
+// WebKit's API::Error::Policy::FrameLoadBlockedByContentBlocker (Source/
+// WebKit/Shared/API/APIError.h), what filtered subresources fail with in the
+// WEBKIT_POLICY_ERROR domain. WebKitGTK does not export it: the public
+// WebKitPolicyError enum stops at CANNOT_USE_RESTRICTED_PORT (103) and the
+// private codes follow it, so the assert catches a renumbered enum.
+static const gint POLICY_ERROR_BLOCKED_BY_CONTENT_BLOCKER = 104;
+static_assert(WEBKIT_POLICY_ERROR_CANNOT_USE_RESTRICTED_PORT + 1 == 104,
+              "WebKitPolicyError was renumbered; check APIError.h");
+
 // ───────────────────────────────────────────────
 //  Utility
 // ───────────────────────────────────────────────
 
-std::string Browser::load_text_file(const std::string& path)
+// Read an unsigned tunable from the environment, falling back to `fallback`
+static guint env_uint(const char* name, guint fallback)
+{
+    const gchar* value = g_getenv(name);
+    if (!value || !*value)
+        return fallback;
+
+    gchar* end = nullptr;
+    guint64 parsed = g_ascii_strtoull(value, &end, 10);
+    if (end == value || *end != '\0') {
+        g_printerr("COLOSSUS-NAN: Ignoring invalid %s='%s'\n", name, value);
+        return fallback;
+    }
+    return static_cast<guint>(parsed);
+}
+
+// printf into a std::string (status bar fragments)
+static std::string format_status(const char* format, ...) G_GNUC_PRINTF(1, 2);
+static std::string format_status(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    gchar* text = g_strdup_vprintf(format, args);
+    va_end(args);
+
+    std::string out(text);
+    g_free(text);
+    return out;
+}
+
+// Directory holding the native web-process extension (web_extension.cpp).
+// Empty when it is not installed or disabled; browser.js then falls back to
+// its JS extractor.
+std::string Browser::find_web_extensions_dir()
 {
-    auto try_read = [](const std::string& p) -> std::string {
-        std::ifstream in(p);
-        if (!in.is_open())
-            return {};
-        std::ostringstream ss;
-        ss << in.rdbuf();
-        return ss.str();
+    const gchar* native = g_getenv("COLOSSUS_NATIVE_EXTRACT");
+    if (native && g_strcmp0(native, "0") == 0)
+        return {};
+
+    static const char* EXTENSION_FILE = "libcolossus-nan-ext.so";
+
+    const gchar* env_dir = g_getenv("COLOSSUS_WEB_EXTENSIONS_DIR");
+    std::string candidates[] = {
+        env_dir ? env_dir : "",
+        "web-extensions",                                   // developer build
+        "/usr/local/lib/colossus-nan/web-extensions"        // installed
     };
 
-    // 1) Try relative path (developer mode, run from project directory)
-    std::string p1 = path;
-    std::string data = try_read(p1);
-    if (!data.empty())
-        return data;
+    for (const auto& dir : candidates) {
+        if (dir.empty()) continue;
 
-    // 2) Try installed system path
-    std::string p2 = "/usr/local/share/colossus-nan/" + path;
-    data = try_read(p2);
-    if (!data.empty())
-        return data;
+        gchar* file = g_build_filename(dir.c_str(), EXTENSION_FILE, nullptr);
+        bool found = g_file_test(file, G_FILE_TEST_IS_REGULAR);
+        g_free(file);
 
-    // 3) Report failure (helpful for debugging)
-    g_printerr("COLOSSUS-NAN: Resource not found: '%s' (tried '%s' and '%s')\n",
-               path.c_str(), p1.c_str(), p2.c_str());
+        if (found) {
+            // The web process does not share our working directory
+            gchar* abs = g_canonicalize_filename(dir.c_str(), nullptr);
+            std::string result(abs);
+            g_free(abs);
+            return result;
+        }
+    }
 
     return {};
 }
 
-
 // ───────────────────────────────────────────────
 //  Constructor / destructor
 // ───────────────────────────────────────────────
 
-Browser::Browser(GtkApplication* app)
-    : app_(app)
+Browser::Browser(GtkApplication* app, const std::string& homepage,
+                 const std::vector<std::string>& open_first)
+    : app_(app),
+      homepage_(homepage.empty() ? COLOSSUS_HOMEPAGE : homepage)
 {
-    script_source_ = load_text_file("resources/browser.js");
+    script_source_ = colossus_resource_text("browser.js");
     if (script_source_.empty()) {
-        std::cerr << "Warning: resources/browser.js is empty or missing. "
+        std::cerr << "Warning: browser.js is empty or missing. "
                   << "Terminal view + MPV / Telehack integration will not work.\n";
     }
 
+    if (const gchar* tier = g_getenv("COLOSSUS_CRT_TIER")) {
+        for (const char* known : RENDER_TIERS) {
+            if (g_strcmp0(tier, known) == 0) render_tier_pin_ = known;
+        }
+        if (render_tier_pin_.empty() && *tier) {
+            g_printerr("COLOSSUS-NAN: Ignoring invalid COLOSSUS_CRT_TIER='%s'\n", tier);
+        }
+    }
+
+    // History opens in constant time; the index is built on a worker and
+    // swapped in (visits made meanwhile are replayed into it)
+    gchar* history_path = g_build_filename(g_get_user_data_dir(), "colossus-nan",
+                                           "history.log", nullptr);
+    history_store_ = std::make_unique<HistoryStore>(history_path,
+                                                    env_uint("COLOSSUS_HISTORY_DAYS", 90));
+    g_free(history_path);
+    history_store_->load([this](HistoryIndex&& index) {
+        history_index_ = std::move(index);
+    });
+
+    media_ = std::make_unique<MediaController>();
+    media_->set_changed_callback([this] { update_tab_status(); });
+
+    stream_resolver_ = std::make_unique<StreamResolver>(
+        MediaController::YTDL_FORMAT, env_uint("COLOSSUS_RESOLVE_JOBS", 2),
+        static_cast<guint64>(env_uint("COLOSSUS_STREAM_CACHE_MB", 4)) * 1024 * 1024);
+
+    // COLOSSUS_MAX_WEB_PROCESSES is the old name of the hint
+    process_model_ = std::make_unique<ProcessModel>(
+        env_uint("COLOSSUS_WEB_PROCESS_HINT", env_uint("COLOSSUS_MAX_WEB_PROCESSES", 4)));
+
+    // Resolve the first page's host while the rest of startup, window
+    // included, is built
+    if (env_uint("COLOSSUS_SESSION", 1)) {
+        gchar* session_path = g_build_filename(g_get_user_data_dir(), "colossus-nan",
+                                               "session", nullptr);
+        session_store_ = std::make_unique<SessionStore>(session_path);
+        g_free(session_path);
+    }
+    SessionStore::Session session;
+    bool have_session = session_store_ && session_store_->load(session);
+    std::string first_uri = open_first.empty() ? std::string() : uri_for_input(open_first[0]);
+    if (first_uri.empty()) {
+        first_uri = have_session ? session.tabs[session.active].uri : homepage_;
+    }
+    prefetch_dns(first_uri);
+    colossus_startup_mark("web context");
+
+    std::string extensions_dir = find_web_extensions_dir();
+    if (!extensions_dir.empty()) {
+        process_model_->set_web_extensions_directory(extensions_dir);
+    }
+
+    // Registered before any view exists so the first page can use it
+    image_proxy_ = std::make_unique<ImageProxy>(
+        process_model_->context(),
+        env_uint("COLOSSUS_IMG_FETCHES", 6),
+        static_cast<guint64>(env_uint("COLOSSUS_IMG_CACHE_MB", 64)) * 1024 * 1024);
+
+    dashboard_ = std::make_unique<Dashboard>(process_model_->context());
+
+    if (guint view_cache_mb = env_uint("COLOSSUS_VIEW_CACHE_MB", 16)) {
+        const gchar* skip = g_getenv("COLOSSUS_VIEW_CACHE_SKIP");
+        view_cache_ = std::make_unique<ViewCache>(
+            static_cast<guint64>(view_cache_mb) * 1024 * 1024,
+            static_cast<guint64>(env_uint("COLOSSUS_VIEW_CACHE_DISK_MB", 128)) * 1024 * 1024,
+            skip ? skip : "");
+    }
+
+    gchar* archive_path = g_build_filename(g_get_user_data_dir(), "colossus-nan",
+                                           "archive", nullptr);
+    page_archive_ = std::make_unique<PageArchive>(process_model_->context(), archive_path);
+    g_free(archive_path);
+    archiver_ = std::make_unique<Archiver>(*process_model_, *image_proxy_, *page_archive_,
+                                           env_uint("COLOSSUS_ARCHIVE_JOBS", 2));
+    archiver_->set_changed_callback([this] { update_tab_status(); });
+
+    setup_content_manager();
+
+    // Compiled asynchronously; unchanged lists load from the on-disk store
+    diet_enabled_ = env_uint("COLOSSUS_DIET", 1) != 0;
+    content_filters_ = std::make_unique<ContentFilters>(process_model_->content_manager());
+    if (diet_enabled_) {
+        content_filters_->add_builtin(
+            "colossus-diet",
+            load_profile_diet_rules(env_uint("COLOSSUS_DIET_BLOCK_SCRIPTS", 0) != 0));
+    }
+    content_filters_->load();
+
+    webview_pool_ = std::make_unique<WebviewPool>(
+        *process_model_, homepage_, env_uint("COLOSSUS_WARM_TABS", 2));
+
+    speculator_ = std::make_unique<Speculator>(
+        *process_model_, diet_enabled_,
+        env_uint("COLOSSUS_SPECULATE_DNS", 500),
+        env_uint("COLOSSUS_SPECULATE_PRELOADS", 50),
+        env_uint("COLOSSUS_SPECULATE_VIEWS", 1));
+
+    gchar* downloads_path = g_build_filename(g_get_user_data_dir(), "colossus-nan",
+                                             "downloads", nullptr);
+    downloads_ = std::make_unique<DownloadManager>(
+        process_model_->context(), downloads_path,
+        env_uint("COLOSSUS_DOWNLOAD_JOBS", 3),
+        env_uint("COLOSSUS_DOWNLOAD_SEGMENTS", 4));
+    g_free(downloads_path);
+    downloads_->set_changed_callback([this] { update_tab_status(); });
+    g_signal_connect(process_model_->context(), "download-started",
+                     G_CALLBACK(Browser::s_download_started), this);
+
+    colossus_startup_mark("browser services");
+
     setup_ui();
-    load_homepage();
+    setup_lifecycle();
+    colossus_startup_mark("window built");
+
+    // Arguments load instead of the homepage or the saved active tab,
+    // which stays as an unloaded placeholder
+    if (have_session) {
+        restore_session(session, open_first.empty());
+    }
+    open_uris(open_first);
+    if (!current_tab()) {
+        load_homepage();
+    }
+    colossus_startup_mark("first load started");
+
+    // Warm the pool only after the first tab has started loading
+    webview_pool_->schedule_refill();
 }
 
+// The session was saved on the way out (save_session_now); by now the
+// window and the tabs' views are gone
 Browser::~Browser()
 {
+    if (session_save_source_) {
+        g_source_remove(session_save_source_);
+        session_save_source_ = 0;
+    }
+    drop_pending_preload_swap();
+
+    if (lifecycle_timer_) {
+        g_source_remove(lifecycle_timer_);
+        lifecycle_timer_ = 0;
+    }
+    if (dashboard_timer_) {
+        g_source_remove(dashboard_timer_);
+        dashboard_timer_ = 0;
+    }
+    if (memory_monitor_) {
+        g_signal_handlers_disconnect_by_data(memory_monitor_, this);
+        g_object_unref(memory_monitor_);
+        memory_monitor_ = nullptr;
+    }
+    if (process_model_) {
+        g_signal_handlers_disconnect_by_data(process_model_->content_manager(), this);
+        g_signal_handlers_disconnect_by_data(process_model_->context(), this);
+    }
+
     if (window_) {
         gtk_widget_destroy(window_);
         window_ = nullptr;
     }
+    g_clear_object(&completion_store_);
 }
 
 
@@ -84,8 +305,15 @@ void Browser::setup_ui()
     gtk_window_set_default_size(GTK_WINDOW(window_), 1100, 700);
     gtk_window_set_title(GTK_WINDOW(window_), "COLOSSUS: NETWORK ACCESS NODE");
 
+    // Decoding the 1024px icon can wait until after the first paint
+    g_idle_add_full(G_PRIORITY_LOW, Browser::s_load_icon, nullptr, nullptr);
+
     g_signal_connect(window_, "key-press-event",
                      G_CALLBACK(Browser::s_key_press), this);
+    g_signal_connect(window_, "delete-event",
+                     G_CALLBACK(Browser::s_window_delete), this);
+    g_signal_connect(window_, "destroy",
+                     G_CALLBACK(Browser::s_window_destroy), this);
 
     // Vertical layout: notebook + bottom command bar
     GtkWidget* vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
@@ -145,16 +373,44 @@ void Browser::setup_ui()
                      G_CALLBACK(Browser::s_url_entry_activate), this);
     gtk_box_pack_start(GTK_BOX(bottom_bar_), url_entry_, TRUE, TRUE, 0);
 
+    // History completion. The store is refilled from history_index_ on every
+    // keystroke, so "changed" is connected before the completion attaches
+    // (handlers run in connection order) and its own filtering is a no-op.
+    g_signal_connect(url_entry_, "changed",
+                     G_CALLBACK(Browser::s_url_entry_changed), this);
+
+    completion_store_ = gtk_list_store_new(COMPLETION_N_COLS, G_TYPE_STRING, G_TYPE_STRING);
+    GtkEntryCompletion* completion = gtk_entry_completion_new();
+    gtk_entry_completion_set_model(completion, GTK_TREE_MODEL(completion_store_));
+    gtk_entry_completion_set_text_column(completion, COMPLETION_COL_URL);
+    gtk_entry_completion_set_minimum_key_length(completion, 1);
+    gtk_entry_completion_set_match_func(completion, Browser::s_completion_match, nullptr, nullptr);
+
+    GtkCellRenderer* title_cell = gtk_cell_renderer_text_new();
+    g_object_set(title_cell, "ellipsize", PANGO_ELLIPSIZE_END, "width-chars", 40, nullptr);
+    gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(completion), title_cell, FALSE);
+    gtk_cell_layout_add_attribute(GTK_CELL_LAYOUT(completion), title_cell,
+                                  "text", COMPLETION_COL_TITLE);
+
+    g_signal_connect(completion, "match-selected",
+                     G_CALLBACK(Browser::s_completion_selected), this);
+    gtk_entry_set_completion(GTK_ENTRY(url_entry_), completion);
+    g_object_unref(completion);
+
     // New tab button
     new_tab_button_ = gtk_button_new_with_label("+");
     g_signal_connect(new_tab_button_, "clicked",
                      G_CALLBACK(+[](GtkButton*, gpointer data) {
                          auto* self = static_cast<Browser*>(data);
-                         if (self) self->new_tab(COLOSSUS_HOMEPAGE);
+                         if (self) self->new_tab(self->homepage_);
                      }),
                      this);
     gtk_box_pack_start(GTK_BOX(bottom_bar_), new_tab_button_, FALSE, FALSE, 0);
 
+    // Tab tier counters (active / throttled / frozen / discarded)
+    tab_status_label_ = gtk_label_new("");
+    gtk_box_pack_start(GTK_BOX(bottom_bar_), tab_status_label_, FALSE, FALSE, 4);
+
     apply_shell_theme();
 
     // Initial tab created in load_homepage()
@@ -181,9 +437,11 @@ void Browser::apply_shell_theme()
 //  Tabs / WebViews
 // ───────────────────────────────────────────────
 
-WebKitUserContentManager* Browser::create_content_manager()
+// Every tab shares this one manager, so handlers are registered and the
+// user script is compiled exactly once.
+void Browser::setup_content_manager()
 {
-    WebKitUserContentManager* manager = webkit_user_content_manager_new();
+    WebKitUserContentManager* manager = process_model_->content_manager();
 
     // MPV bridge
     webkit_user_content_manager_register_script_message_handler(manager, "mpvPlayer");
@@ -199,17 +457,78 @@ WebKitUserContentManager* Browser::create_content_manager()
                      G_CALLBACK(Browser::s_xterm_message),
                      this);
 
+    // Page timings reported by browser.js
+    webkit_user_content_manager_register_script_message_handler(manager, "colossusMetrics");
+    g_signal_connect(manager,
+                     "script-message-received::colossusMetrics",
+                     G_CALLBACK(Browser::s_metrics_message),
+                     this);
+
+    // Hover / viewport hints for yt-dlp pre-resolution
+    webkit_user_content_manager_register_script_message_handler(manager, "streamResolver");
+    g_signal_connect(manager,
+                     "script-message-received::streamResolver",
+                     G_CALLBACK(Browser::s_resolver_message),
+                     this);
+
+    // Finished page models for the view cache
+    webkit_user_content_manager_register_script_message_handler(manager, "viewCache");
+    g_signal_connect(manager,
+                     "script-message-received::viewCache",
+                     G_CALLBACK(Browser::s_view_cache_message),
+                     this);
+
+    // Hover / viewport hints for link speculation
+    webkit_user_content_manager_register_script_message_handler(manager, "speculation");
+    g_signal_connect(manager,
+                     "script-message-received::speculation",
+                     G_CALLBACK(Browser::s_speculation_message),
+                     this);
+
     inject_user_script(manager);
-    return manager;
 }
 
 void Browser::inject_user_script(WebKitUserContentManager* manager)
 {
     if (script_source_.empty()) return;
 
+    // Frames never get a terminal view; skipping them saves a script
+    // evaluation per iframe at the cost of their mpv badges.
+    WebKitUserContentInjectedFrames frames =
+        env_uint("COLOSSUS_INJECT_TOP_FRAME_ONLY", 0)
+            ? WEBKIT_USER_CONTENT_INJECT_TOP_FRAME
+            : WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES;
+
+    // The image proxy's token stays inside browser.js's closure
+    std::string source = script_source_;
+    const std::string token_mark = "@COLOSSUS_IMG_TOKEN@";
+    size_t mark = source.find(token_mark);
+    if (mark != std::string::npos && image_proxy_) {
+        source.replace(mark, token_mark.size(), image_proxy_->token());
+    }
+
+    // The Full-profile host list lives in load_profile.cpp only
+    const std::string hosts_mark = "@COLOSSUS_FULL_PROFILE_HOSTS@";
+    mark = source.find(hosts_mark);
+    if (mark != std::string::npos) {
+        source.replace(mark, hosts_mark.size(), load_profile_full_hosts());
+    }
+
+    // colossus-bench compares browser.js's walker with the native extractor
+    const std::string check_mark = "@COLOSSUS_EXTRACT_CHECK@";
+    mark = source.find(check_mark);
+    if (mark != std::string::npos && env_uint("COLOSSUS_EXTRACT_CHECK", 0)) {
+        source.replace(mark, check_mark.size(), "1");
+    }
+
+    // A pinned tier is read by browser.js when it starts
+    if (!render_tier_pin_.empty()) {
+        source = "window.colossusRenderTier = '" + render_tier_pin_ + "';\n" + source;
+    }
+
     WebKitUserScript* script = webkit_user_script_new(
-        script_source_.c_str(),
-        WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES,
+        source.c_str(),
+        frames,
         WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START,
         nullptr,
         nullptr
@@ -219,19 +538,42 @@ void Browser::inject_user_script(WebKitUserContentManager* manager)
     webkit_user_script_unref(script);
 }
 
-Browser::Tab& Browser::create_tab(const std::string& uri)
+// Adaptive → full → single → flat → adaptive. Later pages get the pin
+// from the user script, pages already open through pin().
+void Browser::cycle_render_tier_pin()
 {
-    Tab tab;
+    const size_t n_tiers = G_N_ELEMENTS(RENDER_TIERS);
+    size_t next = 0;
+    while (next < n_tiers && render_tier_pin_ != RENDER_TIERS[next]) ++next;
+    next = next == n_tiers ? 0 : next + 1;
+    render_tier_pin_ = next < n_tiers ? RENDER_TIERS[next] : "";
+
+    WebKitUserContentManager* manager = process_model_->content_manager();
+    webkit_user_content_manager_remove_all_scripts(manager);
+    inject_user_script(manager);
 
-    tab.scrolled = gtk_scrolled_window_new(nullptr, nullptr);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab.scrolled),
-                                   GTK_POLICY_AUTOMATIC,
-                                   GTK_POLICY_AUTOMATIC);
+    std::string tier = render_tier_pin_.empty() ? "undefined" : "'" + render_tier_pin_ + "'";
+    std::string js = "window.colossusRenderTier = " + tier + ";"
+                     " if (window.colossusRenderQuality)"
+                     " window.colossusRenderQuality.pin(window.colossusRenderTier);";
+    for (auto& entry : tabs_) {
+        if (!entry.second->webview) continue;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        webkit_web_view_run_javascript(entry.second->webview, js.c_str(),
+                                       nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+    }
+
+    COLOSSUS_TRACE("CRT tier %s\n", render_tier_pin_.empty() ? "adaptive"
+                                                             : render_tier_pin_.c_str());
+    update_tab_status();
+}
 
-    WebKitUserContentManager* manager = create_content_manager();
-    tab.webview = WEBKIT_WEB_VIEW(
-        webkit_web_view_new_with_user_content_manager(manager));
-    g_object_unref(manager);
+void Browser::attach_webview(Tab& tab)
+{
+    tab.webview = process_model_->create_view();
+    tab.profile = LoadProfile::Full;
 
     // Force black backing store to avoid white flashes between loads
     GdkRGBA black;
@@ -244,311 +586,1725 @@ Browser::Tab& Browser::create_tab(const std::string& uri)
     gtk_container_add(GTK_CONTAINER(tab.scrolled),
                       GTK_WIDGET(tab.webview));
 
-    // Tab label
-    tab.label = gtk_label_new("New Tab");
+    connect_webview(tab);
+}
+
+void Browser::connect_webview(Tab& tab)
+{
+    tab_by_view_[tab.webview] = &tab;
+    tab_by_page_id_[webkit_web_view_get_page_id(tab.webview)] = &tab;
 
-    // Signals
     g_signal_connect(tab.webview, "load-changed",
                      G_CALLBACK(Browser::s_load_changed), this);
     g_signal_connect(tab.webview, "notify::uri",
                      G_CALLBACK(Browser::s_uri_changed), this);
     g_signal_connect(tab.webview, "notify::title",
                      G_CALLBACK(Browser::s_title_changed), this);
+    g_signal_connect(tab.webview, "load-failed",
+                     G_CALLBACK(Browser::s_load_failed), this);
+    g_signal_connect(tab.webview, "decide-policy",
+                     G_CALLBACK(Browser::s_decide_policy), this);
+    g_signal_connect(tab.webview, "resource-load-started",
+                     G_CALLBACK(Browser::s_resource_load_started), this);
+}
+
+// Signals go first so nothing reaches the tab from a view it no longer
+// has; destroying the view lets its web process exit once no other view
+// shares it (ProcessModel drops the slot on "destroy")
+void Browser::release_webview(Tab& tab)
+{
+    if (!tab.webview) return;
+
+    g_signal_handlers_disconnect_by_data(tab.webview, this);
+    tab_by_view_.erase(tab.webview);
+    tab_by_page_id_.erase(webkit_web_view_get_page_id(tab.webview));
+    gtk_widget_destroy(GTK_WIDGET(tab.webview));
+    tab.webview = nullptr;
+    tab.web_pid = 0;
+    tab.view_token.clear();
+}
+
+// The preload replaces the tab's view wherever its load has got to; its
+// milestones so far become the tab's
+void Browser::swap_in_preload(Tab& tab, Speculator::Entry& entry)
+{
+    tab.history_before_swap = serialize_history(tab.webview);
+    release_webview(tab);
+
+    tab.webview = entry.webview;
+    tab.profile = entry.profile;
+    gtk_container_add(GTK_CONTAINER(tab.scrolled), GTK_WIDGET(tab.webview));
+    g_object_unref(tab.webview);    // the scrolled window holds it now
+    gtk_widget_show(GTK_WIDGET(tab.webview));
+    connect_webview(tab);
+
+    const gchar* uri = webkit_web_view_get_uri(tab.webview);
+    if (uri && *uri) tab.uri = uri;
+    tab.history_dirty = true;
+
+    tab.load_started_at = entry.started_at;
+    tab.committed_ms = entry.committed_at
+        ? colossus_ms_between(entry.started_at, entry.committed_at) : -1.0;
+    tab.finished_ms = entry.finished_at
+        ? colossus_ms_between(entry.started_at, entry.finished_at) : -1.0;
+    tab.first_row_ms = -1.0;
+    tab.terminal_ms = -1.0;
+    tab.extract_ms = -1.0;
+    tab.render_tier.clear();
+    tab.frame_ms = -1.0;
+    tab.requests_blocked = 0;
+    tab.requests_loaded = 0;
+    tab.bytes_loaded = 0;
+    tab.bytes_saved = 0;
+
+    if (tab.id == current_tab_id_) gtk_widget_grab_focus(GTK_WIDGET(tab.webview));
+    update_url_entry_for(tab.webview);
+    update_tab_title_for(tab.webview);
+
+    // Whatever has not happened yet arrives through on_load_changed
+    if (entry.committed_at) begin_cached_view(tab);
+    if (entry.finished_at) record_visit(tab.webview);
+    schedule_session_save();
+}
+
+void Browser::drop_pending_preload_swap()
+{
+    if (preload_swap_source_) {
+        g_source_remove(preload_swap_source_);
+        preload_swap_source_ = 0;
+    }
+    if (preload_swap_.webview) {
+        gtk_widget_destroy(GTK_WIDGET(preload_swap_.webview));
+        g_object_unref(preload_swap_.webview);
+        preload_swap_ = Speculator::Entry();
+    }
+}
+
+Browser::Tab& Browser::create_tab(const std::string& uri)
+{
+    Tab& tab = add_tab();
+    tab.opened_at = g_get_monotonic_time();
+    tab.first_paint_pending = true;
+    tab.uri = uri;
+
+    // Prefer a pre-warmed view: already realized, process already running
+    WebviewPool::Entry warm;
+    if (webview_pool_ && webview_pool_->take(warm)) {
+        tab.scrolled = warm.scrolled;
+        tab.webview = warm.webview;
+        tab.warm = true;
+        connect_webview(tab);
+    } else {
+        tab.scrolled = gtk_scrolled_window_new(nullptr, nullptr);
+        gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab.scrolled),
+                                       GTK_POLICY_AUTOMATIC,
+                                       GTK_POLICY_AUTOMATIC);
+        attach_webview(tab);
+    }
+    apply_load_profile(tab, uri);
+
+    // Tagged before it is added, so the switch-page emitted for a first
+    // page already finds its tab
+    make_tab_label(tab, "New Tab");
+    g_object_set_data(G_OBJECT(tab.scrolled), TAB_ID_KEY, GUINT_TO_POINTER(tab.id));
 
-    // Add to notebook and vector
     gint page_num = gtk_notebook_append_page(GTK_NOTEBOOK(notebook_),
                                              tab.scrolled,
-                                             tab.label);
+                                             tab.tab_widget);
     gtk_widget_show_all(tab.scrolled);
 
-    tabs_.push_back(tab);
-    current_tab_ = static_cast<int>(tabs_.size()) - 1;
+    // The notebook holds its own reference now
+    if (tab.warm) {
+        g_object_unref(tab.scrolled);
+    }
 
+    // Switching pages backgrounds the previous tab via on_tab_switched
     gtk_notebook_set_current_page(GTK_NOTEBOOK(notebook_), page_num);
-
-    if (!uri.empty()) {
+    update_tab_status();
+
+    // A warm view may already be showing exactly what was asked for. Its
+    // milestones so far become the tab's; the rest arrive through
+    // on_load_changed.
+    bool preloaded = tab.warm && !warm.failed && uri == webview_pool_->preload_uri();
+    if (preloaded) {
+        tab.load_started_at = warm.started_at;
+        tab.committed_ms = warm.committed_at
+            ? colossus_ms_between(warm.started_at, warm.committed_at) : -1.0;
+        tab.finished_ms = warm.finished_at
+            ? colossus_ms_between(warm.started_at, warm.finished_at) : -1.0;
+
+        update_url_entry_for(tab.webview);
+        update_tab_title_for(tab.webview);
+        if (warm.committed_at) begin_cached_view(tab);
+        if (warm.finished_at) record_visit(tab.webview);
+        if (!webkit_web_view_is_loading(tab.webview)) {
+            note_first_paint(tab, "preloaded");
+        }
+    } else if (!uri.empty()) {
         webkit_web_view_load_uri(tab.webview, uri.c_str());
     }
 
-    return tabs_.back();
+    return tab;
 }
 
-WebKitWebView* Browser::current_webview()
+Browser::Tab& Browser::add_tab()
 {
-    if (current_tab_ < 0 || current_tab_ >= static_cast<int>(tabs_.size())) {
-        return nullptr;
-    }
-    return tabs_[current_tab_].webview;
+    auto owned = std::make_unique<Tab>();
+    Tab& tab = *owned;
+    tab.id = next_tab_id_++;
+    tabs_.emplace(tab.id, std::move(owned));
+    return tab;
 }
 
-Browser::Tab* Browser::get_tab_for_webview(WebKitWebView* view)
+// A discarded tab (no webview) at the end of the notebook; it loads `uri`
+// when first selected
+Browser::Tab& Browser::add_placeholder_tab(const std::string& uri, const std::string& title)
 {
-    for (auto& t : tabs_) {
-        if (t.webview == view) return &t;
-    }
-    return nullptr;
-}
+    Tab& tab = add_tab();
+    tab.state = TabState::Discarded;
+    tab.uri = uri;
+    tab.title = title;
+    tab.history_dirty = false;
 
-// ───────────────────────────────────────────────
-//  Navigation / loading
-// ───────────────────────────────────────────────
+    tab.scrolled = gtk_scrolled_window_new(nullptr, nullptr);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(tab.scrolled),
+                                   GTK_POLICY_AUTOMATIC,
+                                   GTK_POLICY_AUTOMATIC);
+    make_tab_label(tab, "");
 
-void Browser::load_homepage()
+    gtk_notebook_append_page(GTK_NOTEBOOK(notebook_), tab.scrolled, tab.tab_widget);
+    gtk_widget_show_all(tab.scrolled);
+
+    // Tagged after the append, so a first page is not activated (loaded)
+    // just for being selected first
+    g_object_set_data(G_OBJECT(tab.scrolled), TAB_ID_KEY, GUINT_TO_POINTER(tab.id));
+    update_tab_label(tab);
+    return tab;
+}
+
+// The notebook tab is the label in an event box, for middle-click close
+void Browser::make_tab_label(Tab& tab, const char* text)
 {
-    if (tabs_.empty()) {
-        new_tab(COLOSSUS_HOMEPAGE);
-    } else {
-        load_uri(COLOSSUS_HOMEPAGE);
-    }
+    tab.label = gtk_label_new(text);
+    tab.tab_widget = gtk_event_box_new();
+    gtk_event_box_set_visible_window(GTK_EVENT_BOX(tab.tab_widget), FALSE);
+    gtk_container_add(GTK_CONTAINER(tab.tab_widget), tab.label);
+    g_object_set_data(G_OBJECT(tab.tab_widget), TAB_ID_KEY, GUINT_TO_POINTER(tab.id));
+    g_signal_connect(tab.tab_widget, "button-press-event",
+                     G_CALLBACK(Browser::s_tab_label_pressed), this);
+    gtk_widget_show_all(tab.tab_widget);
 }
 
-void Browser::load_uri(const std::string& uri)
+// Swap the view's settings when a navigation crosses between profiles,
+// from decide-policy so they are in place before the request goes out.
+// Resource blocking for the diet profile is the built-in content filter,
+// which keys on the same top-level URL.
+void Browser::apply_load_profile(Tab& tab, const std::string& uri)
 {
-    WebKitWebView* view = current_webview();
-    if (!view) {
-        new_tab(uri);
-        return;
-    }
-    webkit_web_view_load_uri(view, uri.c_str());
+    if (!tab.webview) return;
+
+    LoadProfile profile = diet_enabled_ ? load_profile_for_uri(uri) : LoadProfile::Full;
+    if (profile == tab.profile) return;
+
+    tab.profile = profile;
+    webkit_web_view_set_settings(tab.webview, process_model_->settings_for(profile));
+    COLOSSUS_TRACE("load profile %s: %s\n", load_profile_name(profile), uri.c_str());
 }
 
-void Browser::update_url_entry_for(WebKitWebView* view)
+void Browser::note_first_paint(Tab& tab, const char* phase)
 {
-    if (!view) return;
+    if (!tab.first_paint_pending) return;
+    tab.first_paint_pending = false;
 
-    const gchar* uri = webkit_web_view_get_uri(view);
-    if (!uri) uri = "";
+    COLOSSUS_TRACE("new tab %s in %.1f ms (%s view)\n", phase,
+                   colossus_ms_between(tab.opened_at, g_get_monotonic_time()),
+                   tab.warm ? "warm" : "cold");
 
-    if (view == current_webview() && url_entry_) {
-        gtk_entry_set_text(GTK_ENTRY(url_entry_), uri);
+    if (!startup_painted_) {
+        startup_painted_ = true;
+        check_startup_budget();
     }
 }
 
-void Browser::update_tab_title_for(WebKitWebView* view)
+void Browser::emit_page_event(Tab& tab, PageEvent event)
 {
-    if (!view) return;
+    if (!page_event_callback_ || !tab.load_started_at) return;
 
-    const gchar* title = webkit_web_view_get_title(view);
-    if (!title || !*title) {
-        title = webkit_web_view_get_uri(view);
-        if (!title) title = "Tab";
+    const gchar* uri = tab.webview ? webkit_web_view_get_uri(tab.webview) : nullptr;
+    page_event_callback_(event, uri ? uri : tab.uri,
+                         colossus_ms_between(tab.load_started_at, g_get_monotonic_time()),
+                         tab.web_pid);
+}
+
+// Time from main() to the first tab's first paint, against
+// COLOSSUS_STARTUP_BUDGET_MS (0 disables the check)
+void Browser::check_startup_budget()
+{
+    colossus_startup_mark("first paint");
+
+    const auto& marks = colossus_startup_marks();
+    double total_ms = colossus_ms_between(marks.front().at, marks.back().at);
+    guint budget_ms = env_uint("COLOSSUS_STARTUP_BUDGET_MS", 1000);
+
+    if (budget_ms && total_ms > budget_ms) {
+        g_printerr("COLOSSUS-NAN: Startup over budget: first paint at %.1f ms > %u ms (%s)\n",
+                   total_ms, budget_ms, colossus_startup_summary().c_str());
     }
+}
 
-    Tab* tab = get_tab_for_webview(view);
-    if (tab && tab->label) {
-        gtk_label_set_text(GTK_LABEL(tab->label), title);
+void Browser::prefetch_dns(const std::string& uri)
+{
+    std::string host = host_of(uri);
+    if (!host.empty()) {
+        webkit_web_context_prefetch_dns(process_model_->context(), host.c_str());
     }
 }
 
-// ───────────────────────────────────────────────
-//  Actions
-// ───────────────────────────────────────────────
+Browser::Tab* Browser::current_tab()
+{
+    return get_tab(current_tab_id_);
+}
 
-void Browser::new_tab(const std::string& uri)
+WebKitWebView* Browser::current_webview()
 {
-    create_tab(uri);
+    Tab* tab = current_tab();
+    return tab ? tab->webview : nullptr;
 }
 
-void Browser::go_back()
+Browser::Tab* Browser::get_tab(guint id)
 {
-    WebKitWebView* view = current_webview();
-    if (view && webkit_web_view_can_go_back(view)) {
-        webkit_web_view_go_back(view);
-    }
+    auto it = tabs_.find(id);
+    return it == tabs_.end() ? nullptr : it->second.get();
 }
 
-void Browser::go_forward()
+Browser::Tab* Browser::get_tab_for_webview(WebKitWebView* view)
 {
-    WebKitWebView* view = current_webview();
-    if (view && webkit_web_view_can_go_forward(view)) {
-        webkit_web_view_go_forward(view);
-    }
+    auto it = tab_by_view_.find(view);
+    return it == tab_by_view_.end() ? nullptr : it->second;
 }
 
-void Browser::go_home()
+Browser::Tab* Browser::get_tab_for_notebook_page(GtkWidget* page)
 {
-    load_homepage();
+    if (!page) return nullptr;
+    return get_tab(GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(page), TAB_ID_KEY)));
 }
 
-void Browser::reload()
+// Left to right, as shown
+std::vector<Browser::Tab*> Browser::tabs_in_order()
 {
-    WebKitWebView* view = current_webview();
-    if (view) {
-        webkit_web_view_reload(view);
+    std::vector<Tab*> out;
+    out.reserve(tabs_.size());
+
+    GtkNotebook* notebook = GTK_NOTEBOOK(notebook_);
+    gint pages = gtk_notebook_get_n_pages(notebook);
+    for (gint i = 0; i < pages; ++i) {
+        Tab* tab = get_tab_for_notebook_page(gtk_notebook_get_nth_page(notebook, i));
+        if (tab) out.push_back(tab);
     }
+    return out;
 }
 
-// ───────────────────────────────────────────────
-//  Public API
-// ───────────────────────────────────────────────
-
-void Browser::show()
+// Script messages arrive on the shared content manager without a view.
+// With the web-process extension they carry their WebKitWebPage's id, which
+// is the view's page id (indexed as views are connected); without it pages
+// can only be told apart by URL, and the current tab wins on duplicates.
+Browser::Tab* Browser::get_tab_for_page_id(guint64 page_id)
 {
-    if (window_) {
-        gtk_widget_show_all(window_);
-    }
+    auto it = tab_by_page_id_.find(page_id);
+    return it == tab_by_page_id_.end() ? nullptr : it->second;
 }
 
-void Browser::open_uri(const std::string& uri)
+// Only without the extension: the current tab is checked first, since
+// that is where nearly every message comes from, before all the others
+Browser::Tab* Browser::get_tab_for_page(const std::string& uri)
 {
-    load_uri(uri);
+    WebKitWebView* current = current_webview();
+    if (current) {
+        const gchar* current_uri = webkit_web_view_get_uri(current);
+        if (current_uri && uri == current_uri) return current_tab();
+    }
+
+    for (auto& entry : tabs_) {
+        Tab& t = *entry.second;
+        if (!t.webview) continue;
+
+        const gchar* view_uri = webkit_web_view_get_uri(t.webview);
+        if (view_uri && uri == view_uri) return &t;
+    }
+    return nullptr;
 }
 
 // ───────────────────────────────────────────────
-//  Event handlers (instance)
+//  Session
 // ───────────────────────────────────────────────
 
-void Browser::on_url_entry_activate()
+// Every saved tab comes back as a discarded placeholder (a page with no
+// webview); only the active one is activated, so restoring 60 tabs costs
+// about what restoring one does. The rest load when first selected.
+bool Browser::restore_session(const SessionStore::Session& session, bool select)
 {
-    if (!url_entry_) return;
-
-    const gchar* text = gtk_entry_get_text(GTK_ENTRY(url_entry_));
-    if (!text) return;
+    if (session.tabs.empty()) return false;
+
+    gint64 started = g_get_monotonic_time();
+
+    std::vector<Tab*> restored;
+    for (const auto& saved : session.tabs) {
+        Tab& tab = add_placeholder_tab(saved.uri, saved.title);
+        tab.opened_at = started;
+        tab.scroll_y = saved.scroll_y;
+        tab.history = saved.history;
+        tab.history_dirty = false;
+        restored.push_back(&tab);
+    }
 
-    std::string input(text);
-    if (input.empty()) return;
+    // The caller opens and selects its own tab
+    if (!select) {
+        COLOSSUS_TRACE("session restored: %zu tabs unloaded in %.1f ms\n", tabs_.size(),
+                       colossus_ms_between(started, g_get_monotonic_time()));
+        return true;
+    }
 
-    // Very simple URL vs search detection
-    std::string uri;
-    if (input.find("://") != std::string::npos ||
-        input.rfind("about:", 0) == 0 ||
-        input.rfind("file:", 0) == 0) {
-        uri = input;
-    } else if (input.rfind("www.", 0) == 0) {
-        uri = "https://" + input;
-    } else if (input.find('.') != std::string::npos && input.find(' ') == std::string::npos) {
-        uri = "https://" + input;
+    current_tab_id_ = 0;
+    if (gtk_notebook_get_current_page(GTK_NOTEBOOK(notebook_)) == session.active) {
+        on_tab_switched(restored[session.active]->scrolled);
     } else {
-        // Treat as search query (Brave)
-        std::string encoded;
-        for (char c : input) {
-            if (c == ' ') encoded += '+';
-            else encoded += c;
-        }
-        uri = "https://search.brave.com/search?q=" + encoded;
+        gtk_notebook_set_current_page(GTK_NOTEBOOK(notebook_), session.active);
     }
 
-    load_uri(uri);
+    restored[session.active]->first_paint_pending = true;
+
+    COLOSSUS_TRACE("session restored: %zu tabs in %.1f ms\n", tabs_.size(),
+                   colossus_ms_between(started, g_get_monotonic_time()));
+    return true;
 }
 
-void Browser::on_load_changed(WebKitWebView* view, WebKitLoadEvent event)
+// Coalesce bursts (a page load changes URI, title and history at once)
+void Browser::schedule_session_save()
 {
-    if (event == WEBKIT_LOAD_FINISHED) {
-        update_url_entry_for(view);
-        update_tab_title_for(view);
-    }
+    if (!session_store_ || session_save_source_ || !window_) return;
+    session_save_source_ = g_timeout_add_seconds(2, Browser::s_session_save, this);
 }
 
-void Browser::on_uri_changed(WebKitWebView* view)
+// Once the window is destroyed the tabs' views are too, and there is
+// nothing left to read: the save made on delete-event stands
+void Browser::save_session_now()
 {
-    update_url_entry_for(view);
+    if (session_save_source_) {
+        g_source_remove(session_save_source_);
+        session_save_source_ = 0;
+    }
+    if (session_store_ && window_ && !tabs_.empty()) {
+        session_store_->save_now(collect_session());
+    }
 }
 
-void Browser::on_title_changed(WebKitWebView* view)
+// Back/forward lists are only re-serialized for tabs that changed
+SessionStore::Session Browser::collect_session()
 {
-    update_tab_title_for(view);
+    SessionStore::Session session;
+
+    for (Tab* ordered : tabs_in_order()) {
+        Tab& tab = *ordered;
+        if (tab.id == current_tab_id_) {
+            session.active = static_cast<int>(session.tabs.size());
+        }
+
+        SessionStore::Tab saved;
+        if (tab.webview) {
+            const gchar* uri = webkit_web_view_get_uri(tab.webview);
+            if (uri && *uri) tab.uri = uri;
+            if (tab.history_dirty) {
+                tab.history = serialize_history(tab.webview);
+                tab.history_dirty = false;
+            }
+        }
+        saved.uri = tab.uri;
+        saved.title = tab.title;
+        saved.scroll_y = tab.scroll_y;
+        saved.history = tab.history;
+        session.tabs.push_back(std::move(saved));
+    }
+    return session;
 }
 
-void Browser::on_tab_switched(guint page_num)
+std::string Browser::serialize_history(WebKitWebView* view)
 {
-    current_tab_ = static_cast<int>(page_num);
-    update_url_entry_for(current_webview());
+    WebKitWebViewSessionState* state = webkit_web_view_get_session_state(view);
+    if (!state) return "";
+
+    GBytes* bytes = webkit_web_view_session_state_serialize(state);
+    webkit_web_view_session_state_unref(state);
+    if (!bytes) return "";
+
+    gsize size = 0;
+    gconstpointer data = g_bytes_get_data(bytes, &size);
+    gchar* encoded = g_base64_encode(static_cast<const guchar*>(data), size);
+    std::string out(encoded ? encoded : "");
+    g_free(encoded);
+    g_bytes_unref(bytes);
+    return out;
 }
 
-gboolean Browser::on_key_press(GdkEventKey* event)
+// Put a placeholder's back/forward list into its new view and go to the
+// current entry; false if there was none to restore
+bool Browser::restore_history(Tab& tab)
 {
-    if (!event) return FALSE;
+    if (tab.history.empty() || !tab.webview) return false;
 
-    // Ctrl+L: focus URL entry
-    if ((event->state & GDK_CONTROL_MASK) && event->keyval == GDK_KEY_l) {
-        if (url_entry_) {
-            gtk_widget_grab_focus(url_entry_);
-            gtk_editable_select_region(GTK_EDITABLE(url_entry_), 0, -1);
-        }
-        return TRUE;
-    }
+    gsize size = 0;
+    guchar* decoded = g_base64_decode(tab.history.c_str(), &size);
+    GBytes* bytes = g_bytes_new_take(decoded, size);
+    WebKitWebViewSessionState* state = webkit_web_view_session_state_new(bytes);
+    g_bytes_unref(bytes);
+    if (!state) return false;
 
-    // Ctrl+R or F5: reload
-    if (((event->state & GDK_CONTROL_MASK) && event->keyval == GDK_KEY_r) ||
-        event->keyval == GDK_KEY_F5) {
-        reload();
-        return TRUE;
-    }
+    webkit_web_view_restore_session_state(tab.webview, state);
+    webkit_web_view_session_state_unref(state);
+    tab.history_dirty = true;
 
-    // Alt+Left / Alt+Right: back/forward
-    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_Left) {
-        go_back();
-        return TRUE;
-    }
-    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_Right) {
-        go_forward();
-        return TRUE;
-    }
+    WebKitBackForwardList* list = webkit_web_view_get_back_forward_list(tab.webview);
+    WebKitBackForwardListItem* item = webkit_back_forward_list_get_current_item(list);
+    if (!item) return false;
 
-    // Alt+H: home
-    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_h) {
-        go_home();
-        return TRUE;
-    }
+    webkit_web_view_go_to_back_forward_list_item(tab.webview, item);
+    return true;
+}
+
+// ───────────────────────────────────────────────
+//  Navigation / loading
+// ───────────────────────────────────────────────
+
+void Browser::load_homepage()
+{
+    if (tabs_.empty()) {
+        new_tab(homepage_);
+    } else {
+        load_uri(homepage_);
+    }
+}
+
+void Browser::load_uri(const std::string& uri)
+{
+    WebKitWebView* view = current_webview();
+    if (!view) {
+        new_tab(uri);
+        return;
+    }
+
+    Tab* tab = get_tab_for_webview(view);
+    if (tab) apply_load_profile(*tab, uri);
+    webkit_web_view_load_uri(view, uri.c_str());
+}
+
+void Browser::update_url_entry_for(WebKitWebView* view)
+{
+    if (!view) return;
+
+    const gchar* uri = webkit_web_view_get_uri(view);
+    if (!uri) uri = "";
+    if (Dashboard::is_dashboard(uri)) uri = Dashboard::ALIAS;
+
+    if (view == current_webview() && url_entry_) {
+        updating_url_entry_ = true;
+        gtk_entry_set_text(GTK_ENTRY(url_entry_), uri);
+        updating_url_entry_ = false;
+    }
+}
+
+void Browser::update_tab_title_for(WebKitWebView* view)
+{
+    if (!view) return;
+
+    const gchar* title = webkit_web_view_get_title(view);
+    if (!title || !*title) {
+        title = webkit_web_view_get_uri(view);
+        if (!title) title = "Tab";
+    }
+
+    Tab* tab = get_tab_for_webview(view);
+    if (tab) {
+        tab->title = title;
+        update_tab_label(*tab);
+    }
+}
+
+// One history visit per finished load, with its timings; typed if it came
+// from the command bar
+void Browser::record_visit(WebKitWebView* view)
+{
+    const gchar* uri = webkit_web_view_get_uri(view);
+    if (!uri || !HistoryIndex::indexable(uri)) return;
+
+    HistoryStore::Visit visit;
+    visit.url = uri;
+    visit.when = g_get_real_time();
+    visit.typed = !typed_uri_.empty() && typed_uri_ == uri;
+    if (visit.typed) typed_uri_.clear();
+
+    const gchar* title = webkit_web_view_get_title(view);
+    if (title) visit.title = title;
+
+    Tab* tab = get_tab_for_webview(view);
+    if (tab) {
+        // A warm or preloaded view finished before the tab took it over
+        if (tab->finished_ms >= 0) {
+            visit.load_ms = static_cast<float>(tab->finished_ms);
+        } else if (tab->load_started_at) {
+            visit.load_ms = static_cast<float>(
+                colossus_ms_between(tab->load_started_at, g_get_monotonic_time()));
+        }
+        visit.first_row_ms = static_cast<float>(tab->first_row_ms);
+        visit.requests = tab->requests_loaded;
+        visit.blocked = tab->requests_blocked;
+        visit.bytes = tab->bytes_loaded;
+    }
+
+    history_index_.add_visit(visit.url, visit.when, visit.typed);
+    if (!visit.title.empty()) {
+        history_index_.set_title(visit.url, visit.title);
+    }
+    history_store_->add_visit(visit);
+}
+
+// Every committed page gets a fresh token to post its model back with
+// (on_view_cache_message) and, on a hit, the cached model, which browser.js
+// shows at once while the live page is extracted behind it
+void Browser::begin_cached_view(Tab& tab)
+{
+    tab.view_token.clear();
+    if (!view_cache_ || !tab.webview) return;
+
+    const gchar* uri = webkit_web_view_get_uri(tab.webview);
+    if (!uri || !view_cache_->enabled_for(uri)) return;
+
+    gchar* token = g_uuid_string_random();
+    tab.view_token = token;
+    g_free(token);
+
+    const std::string* model = view_cache_->lookup(uri);
+    COLOSSUS_TRACE("view cache %s: %s\n", model ? "hit" : "miss", uri);
+
+    std::string js = ViewCache::begin_script(tab.view_token, model);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(tab.webview, js.c_str(), nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+}
+
+// ───────────────────────────────────────────────
+//  Offline archive
+// ───────────────────────────────────────────────
+
+// The page as browser.js shows it: nothing is loaded again
+void Browser::save_current_page()
+{
+    WebKitWebView* view = current_webview();
+    if (!view || !archiver_) return;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(view,
+                                   "window.colossusArchive ? window.colossusArchive.model() : null;",
+                                   nullptr, Browser::s_save_page_finished, this);
+#pragma GCC diagnostic pop
+}
+
+// Every link target in the background, at most MAX_ARCHIVED_LINKS per call
+void Browser::archive_page_links()
+{
+    WebKitWebView* view = current_webview();
+    if (!view || !archiver_) return;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(view,
+                                   "window.colossusArchive ? window.colossusArchive.links() : [];",
+                                   nullptr, Browser::s_page_links_finished, this);
+#pragma GCC diagnostic pop
+}
+
+void Browser::toggle_offline_copy()
+{
+    WebKitWebView* view = current_webview();
+    const gchar* uri = view ? webkit_web_view_get_uri(view) : nullptr;
+    if (!uri || !page_archive_) return;
+
+    if (PageArchive::is_archive(uri)) {
+        std::string original = PageArchive::original_uri(uri);
+        if (!original.empty()) webkit_web_view_load_uri(view, original.c_str());
+    } else if (page_archive_->has_page(uri)) {
+        webkit_web_view_load_uri(view, PageArchive::page_uri(uri).c_str());
+    }
+}
+
+void Browser::on_save_page_finished(WebKitWebView* view, GAsyncResult* result)
+{
+    GError* error = nullptr;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    WebKitJavascriptResult* js_result =
+        webkit_web_view_run_javascript_finish(view, result, &error);
+#pragma GCC diagnostic pop
+
+    if (!js_result) {
+        if (error) g_error_free(error);
+        return;
+    }
+
+    // A saved copy is not saved again
+    const gchar* uri = webkit_web_view_get_uri(view);
+    JSCValue* model = webkit_javascript_result_get_js_value(js_result);
+    if (uri && !PageArchive::is_archive(uri) && model && jsc_value_is_object(model)) {
+        archiver_->save_model(uri, model);
+    }
+
+    webkit_javascript_result_unref(js_result);
+}
+
+void Browser::on_page_links_finished(WebKitWebView* view, GAsyncResult* result)
+{
+    GError* error = nullptr;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    WebKitJavascriptResult* js_result =
+        webkit_web_view_run_javascript_finish(view, result, &error);
+#pragma GCC diagnostic pop
+
+    if (!js_result) {
+        if (error) g_error_free(error);
+        return;
+    }
+
+    JSCValue* links = webkit_javascript_result_get_js_value(js_result);
+    if (links && jsc_value_is_array(links)) {
+        JSCValue* length = jsc_value_object_get_property(links, "length");
+        gint32 count = length ? jsc_value_to_int32(length) : 0;
+        if (length) g_object_unref(length);
+
+        guint queued = 0;
+        for (gint32 i = 0; i < count && queued < MAX_ARCHIVED_LINKS; ++i) {
+            JSCValue* link = jsc_value_object_get_property_at_index(links, static_cast<guint>(i));
+            if (link && jsc_value_is_string(link)) {
+                gchar* url = jsc_value_to_string(link);
+                if (url && archiver_->enqueue(url)) ++queued;
+                g_free(url);
+            }
+            if (link) g_object_unref(link);
+        }
+        COLOSSUS_TRACE("archiving %u of %d links\n", queued, count);
+    }
+
+    webkit_javascript_result_unref(js_result);
+}
+
+void Browser::update_tab_label(Tab& tab)
+{
+    if (!tab.label) return;
+
+    // Tier marker in front of the title so frozen/discarded tabs stand out
+    std::string text;
+    if (tab.state == TabState::Frozen) {
+        text = "[F] ";
+    } else if (tab.state == TabState::Discarded) {
+        text = "[D] ";
+    }
+    text += tab.title.empty() ? (tab.uri.empty() ? "Tab" : tab.uri) : tab.title;
+
+    gtk_label_set_text(GTK_LABEL(tab.label), text.c_str());
+    gtk_widget_set_tooltip_text(tab.label, tab_state_name(tab.state));
+}
+
+// ───────────────────────────────────────────────
+//  about:colossus
+// ───────────────────────────────────────────────
+
+// Nothing runs for the dashboard unless it is the current tab
+void Browser::update_dashboard_timer()
+{
+    WebKitWebView* view = current_webview();
+    bool showing = view && Dashboard::is_dashboard(webkit_web_view_get_uri(view));
+
+    if (showing && !dashboard_timer_) {
+        dashboard_timer_ = g_timeout_add_seconds(DASHBOARD_REFRESH_S,
+                                                 Browser::s_dashboard_tick, this);
+    } else if (!showing && dashboard_timer_) {
+        g_source_remove(dashboard_timer_);
+        dashboard_timer_ = 0;
+    }
+
+    if (showing) refresh_dashboard();
+}
+
+void Browser::refresh_dashboard()
+{
+    if (dashboard_) dashboard_->refresh(current_webview(), collect_dashboard());
+}
+
+Dashboard::Snapshot Browser::collect_dashboard()
+{
+    Dashboard::Snapshot snapshot;
+
+    for (const Tab* ordered : tabs_in_order()) {
+        const Tab& tab = *ordered;
+        Dashboard::TabRow row;
+        row.state = tab_state_name(tab.state);
+        row.uri = tab.uri;
+        row.title = tab.title;
+        row.current = tab.id == current_tab_id_;
+        row.committed_ms = tab.committed_ms;
+        row.finished_ms = tab.finished_ms;
+        row.first_row_ms = tab.first_row_ms;
+        row.terminal_ms = tab.terminal_ms;
+        row.extract_ms = tab.extract_ms;
+        row.render_tier = tab.render_tier;
+        row.frame_ms = tab.frame_ms;
+        row.web_pid = tab.web_pid;
+        row.requests = tab.requests_loaded;
+        row.blocked = tab.requests_blocked;
+        row.bytes = tab.bytes_loaded;
+        row.bytes_saved = tab.bytes_saved;
+        snapshot.tabs.push_back(std::move(row));
+    }
+
+    snapshot.processes = web_process_count();
+    snapshot.process_hint = process_model_->process_hint();
+    if (webview_pool_) {
+        snapshot.pool_size = webview_pool_->size();
+        snapshot.pool_target = webview_pool_->target();
+    }
+    if (image_proxy_) {
+        snapshot.img_hits = image_proxy_->cache_hits();
+        snapshot.img_transcoded = image_proxy_->transcoded();
+        snapshot.img_failures = image_proxy_->failures();
+    }
+    if (stream_resolver_) {
+        snapshot.stream_hits = stream_resolver_->hits();
+        snapshot.stream_misses = stream_resolver_->misses();
+        snapshot.streams_cached = stream_resolver_->cached();
+    }
+    if (view_cache_) {
+        snapshot.view_hits = view_cache_->hits();
+        snapshot.view_misses = view_cache_->misses();
+        snapshot.views_cached = view_cache_->cached();
+    }
+    if (speculator_) {
+        snapshot.speculation_hits = speculator_->hits();
+        snapshot.speculation_misses = speculator_->misses();
+        snapshot.preloads = speculator_->preloads();
+        snapshot.preloads_wasted = speculator_->wasted();
+        snapshot.speculation_saved_ms = speculator_->saved_ms();
+    }
+    snapshot.history_entries = history_index_.size();
+    return snapshot;
+}
+
+// ───────────────────────────────────────────────
+//  Actions
+// ───────────────────────────────────────────────
+
+void Browser::new_tab(const std::string& uri)
+{
+    create_tab(uri);
+}
+
+void Browser::go_back()
+{
+    Tab* tab = current_tab();
+    if (!tab || !tab->webview) return;
+
+    if (webkit_web_view_can_go_back(tab->webview)) {
+        webkit_web_view_go_back(tab->webview);
+        return;
+    }
+
+    // Back from a swapped-in preload: the earlier list, in a fresh view
+    if (!tab->history_before_swap.empty()) {
+        tab->history = std::move(tab->history_before_swap);
+        tab->history_before_swap.clear();
+        release_webview(*tab);
+        attach_webview(*tab);
+        gtk_widget_show_all(tab->scrolled);
+        restore_history(*tab);
+    }
+}
+
+void Browser::go_forward()
+{
+    WebKitWebView* view = current_webview();
+    if (view && webkit_web_view_can_go_forward(view)) {
+        webkit_web_view_go_forward(view);
+    }
+}
+
+void Browser::go_home()
+{
+    load_homepage();
+}
+
+void Browser::reload()
+{
+    WebKitWebView* view = current_webview();
+    if (view) {
+        webkit_web_view_reload(view);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Public API
+// ───────────────────────────────────────────────
+
+void Browser::show()
+{
+    if (window_) {
+        gtk_widget_show_all(window_);
+        gtk_window_present(GTK_WINDOW(window_));
+    }
+}
+
+void Browser::open_uri(const std::string& uri)
+{
+    load_uri(uri);
+}
+
+void Browser::open_uris(const std::vector<std::string>& inputs)
+{
+    gint64 started = g_get_monotonic_time();
+    guint opened = 0;
+
+    for (const auto& input : inputs) {
+        std::string uri = uri_for_input(input);
+        if (uri.empty()) continue;
+
+        if (opened++ == 0) {
+            new_tab(uri);
+        } else {
+            add_placeholder_tab(uri, "");
+        }
+    }
+    if (!opened) return;
+
+    COLOSSUS_TRACE("opened %u tabs in %.1f ms\n", opened,
+                   colossus_ms_between(started, g_get_monotonic_time()));
+    update_tab_status();
+    schedule_session_save();
+}
+
+std::string Browser::uri_for_input(const std::string& input)
+{
+    // Very simple URL vs search detection
+    if (input.empty()) return {};
+    if (input == Dashboard::ALIAS) return Dashboard::URI;
+
+    if (input.find("://") != std::string::npos ||
+        input.rfind("about:", 0) == 0 ||
+        input.rfind("file:", 0) == 0) {
+        return input;
+    }
+    if (looks_like_uri(input)) return "https://" + input;
+
+    // Treat as search query (Brave)
+    std::string encoded;
+    for (char c : input) {
+        if (c == ' ') encoded += '+';
+        else encoded += c;
+    }
+    return "https://search.brave.com/search?q=" + encoded;
+}
+
+bool Browser::looks_like_uri(const std::string& input)
+{
+    if (input.find("://") != std::string::npos ||
+        input.rfind("about:", 0) == 0 ||
+        input.rfind("file:", 0) == 0 ||
+        input.rfind("www.", 0) == 0) {
+        return true;
+    }
+    return input.find('.') != std::string::npos && input.find(' ') == std::string::npos;
+}
+
+// The view goes first (release_webview), then the notebook page. The
+// window always keeps one tab: closing the last one opens the homepage.
+void Browser::close_tab(guint id)
+{
+    auto it = tabs_.find(id);
+    if (it == tabs_.end()) return;
+
+    std::unique_ptr<Tab> tab = std::move(it->second);
+    tabs_.erase(it);
+    if (current_tab_id_ == id) current_tab_id_ = 0;
+
+    release_webview(*tab);
+    g_signal_handlers_disconnect_by_data(tab->tab_widget, this);
+
+    // The notebook holds the only references to the page and its label;
+    // removing the current page selects a neighbour (on_tab_switched)
+    gint page = gtk_notebook_page_num(GTK_NOTEBOOK(notebook_), tab->scrolled);
+    if (page >= 0) {
+        gtk_notebook_remove_page(GTK_NOTEBOOK(notebook_), page);
+    }
+
+    if (tabs_.empty()) {
+        new_tab(homepage_);
+    }
+
+    update_tab_status();
+    update_dashboard_timer();
+    schedule_session_save();
+}
+
+void Browser::close_current_tab()
+{
+    if (current_tab_id_) close_tab(current_tab_id_);
+}
+
+// ───────────────────────────────────────────────
+//  Event handlers (instance)
+// ───────────────────────────────────────────────
+
+void Browser::on_url_entry_activate()
+{
+    if (!url_entry_) return;
+
+    const gchar* text = gtk_entry_get_text(GTK_ENTRY(url_entry_));
+    if (!text) return;
+
+    std::string uri = uri_for_input(text);
+    if (uri.empty()) return;
+
+    typed_uri_ = uri;
+    load_uri(uri);
+}
+
+// Completion rows for the text being typed. When the entry just follows
+// navigation the store is emptied, which keeps the popup closed.
+void Browser::on_url_entry_changed()
+{
+    if (!url_entry_ || !completion_store_) return;
+
+    if (updating_url_entry_ || !gtk_widget_has_focus(url_entry_)) {
+        gtk_list_store_clear(completion_store_);
+        return;
+    }
+
+    const gchar* text = gtk_entry_get_text(GTK_ENTRY(url_entry_));
+    gint64 started = g_get_monotonic_time();
+    std::vector<HistoryIndex::Match> matches =
+        history_index_.query(text ? text : "", COMPLETION_ROWS);
+
+    gtk_list_store_clear(completion_store_);
+    for (const auto& match : matches) {
+        gtk_list_store_insert_with_values(completion_store_, nullptr, -1,
+                                          COMPLETION_COL_URL, match.url.c_str(),
+                                          COMPLETION_COL_TITLE, match.title.c_str(),
+                                          -1);
+    }
+
+    COLOSSUS_TRACE("completion: %zu of %zu entries in %.3f ms\n",
+                   matches.size(), history_index_.size(),
+                   colossus_ms_between(started, g_get_monotonic_time()));
+}
+
+void Browser::on_completion_selected(GtkTreeModel* model, GtkTreeIter* iter)
+{
+    gchar* url = nullptr;
+    gtk_tree_model_get(model, iter, COMPLETION_COL_URL, &url, -1);
+    if (url && *url) {
+        typed_uri_ = url;
+        load_uri(url);
+    }
+    g_free(url);
+}
+
+void Browser::on_load_changed(WebKitWebView* view, WebKitLoadEvent event)
+{
+    if (event == WEBKIT_LOAD_STARTED) {
+        Tab* tab = get_tab_for_webview(view);
+        if (tab) {
+            // Normally already done in decide-policy; this catches the
+            // navigations not attributed to the main frame there
+            const gchar* uri = webkit_web_view_get_uri(view);
+            apply_load_profile(*tab, uri ? uri : "");
+
+            tab->load_started_at = g_get_monotonic_time();
+            tab->committed_ms = -1.0;
+            tab->finished_ms = -1.0;
+            tab->first_row_ms = -1.0;
+            tab->terminal_ms = -1.0;
+            tab->extract_ms = -1.0;
+            tab->render_tier.clear();
+            tab->frame_ms = -1.0;
+            tab->requests_blocked = 0;
+            tab->requests_loaded = 0;
+            tab->bytes_loaded = 0;
+            tab->bytes_saved = 0;
+        }
+    }
+
+    // Committed is the earliest point WebKit can paint new content
+    if (event == WEBKIT_LOAD_COMMITTED || event == WEBKIT_LOAD_FINISHED) {
+        Tab* tab = get_tab_for_webview(view);
+        if (tab && tab->load_started_at) {
+            double ms = colossus_ms_between(tab->load_started_at, g_get_monotonic_time());
+            if (event == WEBKIT_LOAD_COMMITTED) tab->committed_ms = ms;
+            else tab->finished_ms = ms;
+        }
+        if (tab && event == WEBKIT_LOAD_COMMITTED) {
+            begin_cached_view(*tab);
+        }
+        if (tab) {
+            note_first_paint(*tab, "committed");
+            emit_page_event(*tab, event == WEBKIT_LOAD_COMMITTED ? PageEvent::Committed
+                                                                 : PageEvent::Finished);
+        }
+    }
+
+    if (event == WEBKIT_LOAD_FINISHED) {
+        update_url_entry_for(view);
+        update_tab_title_for(view);
+        record_visit(view);
+
+        // Same-URI navigations (reloads, history.pushState back to it) still
+        // change the back/forward list
+        if (Tab* tab = get_tab_for_webview(view)) {
+            tab->history_dirty = true;
+            schedule_session_save();
+
+            // A background load brought a new, unthrottled document
+            if (tab->state == TabState::Throttled || tab->state == TabState::Frozen) {
+                throttle_page(*tab);
+            }
+        }
+
+        update_dashboard_timer();
+
+        Tab* finished = get_tab_for_webview(view);
+        if (finished && finished->load_started_at) {
+            COLOSSUS_TRACE("load finished in %.1f ms, first terminal row at %.1f ms, "
+                           "%u requests (%" G_GUINT64_FORMAT " KB), %u blocked "
+                           "(~%" G_GUINT64_FORMAT " KB saved): %s\n",
+                           colossus_ms_between(finished->load_started_at,
+                                               g_get_monotonic_time()),
+                           finished->first_row_ms,
+                           finished->requests_loaded, finished->bytes_loaded / 1024,
+                           finished->requests_blocked, finished->bytes_saved / 1024,
+                           finished->uri.c_str());
+        }
+
+        // Put a restored (previously discarded) tab back where it was
+        Tab* tab = get_tab_for_webview(view);
+        if (tab && tab->restore_scroll) {
+            tab->restore_scroll = false;
+            std::string js = "window.scrollTo(0, " +
+                             std::to_string(static_cast<long>(tab->scroll_y)) + ");";
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+            webkit_web_view_run_javascript(view, js.c_str(),
+                                           nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+        }
+    }
+}
+
+void Browser::on_uri_changed(WebKitWebView* view)
+{
+    Tab* tab = get_tab_for_webview(view);
+    if (tab) {
+        const gchar* uri = webkit_web_view_get_uri(view);
+        tab->uri = uri ? uri : "";
+        tab->history_dirty = true;
+        schedule_session_save();
+    }
+
+    update_url_entry_for(view);
+    if (view == current_webview()) update_dashboard_timer();
+}
+
+void Browser::on_title_changed(WebKitWebView* view)
+{
+    update_tab_title_for(view);
+    schedule_session_save();
+
+    const gchar* uri = webkit_web_view_get_uri(view);
+    const gchar* title = webkit_web_view_get_title(view);
+    if (uri && title && *title) {
+        history_index_.set_title(uri, title);
+        history_store_->set_title(uri, title);
+    }
+}
+
+// A page that cannot be loaded (offline, DNS failure, server down) opens
+// from the archive when it was saved
+gboolean Browser::on_load_failed(WebKitWebView* view, const gchar* failing_uri, GError* error)
+{
+    // Stopped, replaced by another navigation, blocked, or a download
+    if (!failing_uri || !page_archive_ ||
+        g_error_matches(error, WEBKIT_NETWORK_ERROR, WEBKIT_NETWORK_ERROR_CANCELLED) ||
+        (error && error->domain == WEBKIT_POLICY_ERROR)) {
+        return FALSE;
+    }
+    if (!page_archive_->has_page(failing_uri)) return FALSE;
+
+    COLOSSUS_TRACE("load failed (%s), opening the saved copy of %s\n",
+                   error ? error->message : "unknown error", failing_uri);
+    webkit_web_view_load_uri(view, PageArchive::page_uri(failing_uri).c_str());
+    return TRUE;
+}
+
+// A followed link whose target is preloaded swaps the preloaded view in
+// instead of loading it again. Only user-initiated navigations count
+// (link clicks and the terminal view's location changes); reloads,
+// history and form submissions always load.
+gboolean Browser::on_decide_policy(WebKitWebView* view, WebKitPolicyDecision* decision,
+                                   WebKitPolicyDecisionType type)
+{
+    if (type == WEBKIT_POLICY_DECISION_TYPE_RESPONSE) {
+        return on_decide_response(view, WEBKIT_RESPONSE_POLICY_DECISION(decision));
+    }
+    if (type != WEBKIT_POLICY_DECISION_TYPE_NAVIGATION_ACTION) return FALSE;
+
+    Tab* tab = get_tab_for_webview(view);
+    if (!tab) return FALSE;
+
+    WebKitNavigationAction* action = webkit_navigation_policy_decision_get_navigation_action(
+        WEBKIT_NAVIGATION_POLICY_DECISION(decision));
+    WebKitNavigationType nav_type = webkit_navigation_action_get_navigation_type(action);
+    WebKitURIRequest* request = webkit_navigation_action_get_request(action);
+    const gchar* uri = webkit_uri_request_get_uri(request);
+
+    // The decision carries no frame. User gestures, history and reloads
+    // come from the top document (browser.js builds the terminal view there
+    // and frames get no rows); scripted loads without a gesture may be a
+    // subframe's and wait for LOAD_STARTED.
+    bool top_level = webkit_navigation_action_is_user_gesture(action) ||
+                     nav_type == WEBKIT_NAVIGATION_TYPE_BACK_FORWARD ||
+                     nav_type == WEBKIT_NAVIGATION_TYPE_RELOAD;
+    if (uri && top_level) apply_load_profile(*tab, uri);
+
+    if (!speculator_ || !webkit_navigation_action_is_user_gesture(action) ||
+        (nav_type != WEBKIT_NAVIGATION_TYPE_LINK_CLICKED &&
+         nav_type != WEBKIT_NAVIGATION_TYPE_OTHER)) {
+        return FALSE;
+    }
+
+    const gchar* method = webkit_uri_request_get_http_method(request);
+    if (!uri || (method && g_strcmp0(method, "GET") != 0)) return FALSE;
+
+    // Fragment links stay in the page
+    std::string target(uri);
+    const gchar* current = webkit_web_view_get_uri(view);
+    if (current) {
+        std::string here(current);
+        if (target.substr(0, target.find('#')) == here.substr(0, here.find('#'))) return FALSE;
+    }
+
+    Speculator::Entry entry;
+    if (!speculator_->take(target, entry)) return FALSE;
+
+    // `view` is still emitting this signal; it is replaced from idle
+    webkit_policy_decision_ignore(decision);
+    drop_pending_preload_swap();
+    preload_swap_ = entry;
+    preload_swap_tab_ = tab->id;
+    preload_swap_source_ = g_idle_add(s_preload_swap, this);
+    return TRUE;
+}
+
+// A page WebKit cannot show (an archive, an ISO, octet-stream) is a
+// download; WebKit's default ignores it unless it is sent as an attachment
+gboolean Browser::on_decide_response(WebKitWebView* view, WebKitResponsePolicyDecision* decision)
+{
+    if (!get_tab_for_webview(view) ||
+        webkit_response_policy_decision_is_mime_type_supported(decision)) {
+        return FALSE;
+    }
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+    if (!webkit_response_policy_decision_is_main_frame_main_resource(decision)) return FALSE;
+#else
+    // Before 2.40 there is no frame flag: the main resource is the one the
+    // view is loading
+    WebKitURIRequest* request = webkit_response_policy_decision_get_request(decision);
+    if (g_strcmp0(webkit_uri_request_get_uri(request), webkit_web_view_get_uri(view)) != 0) {
+        return FALSE;
+    }
+#endif
+
+    webkit_policy_decision_download(WEBKIT_POLICY_DECISION(decision));
+    return TRUE;
+}
+
+// Resources carry no back-pointer to their view; remember it for the
+// finished/failed handlers below.
+void Browser::on_resource_load_started(WebKitWebView* view, WebKitWebResource* resource)
+{
+    g_object_set_data(G_OBJECT(resource), "colossus-view", view);
+    g_signal_connect(resource, "finished",
+                     G_CALLBACK(Browser::s_resource_finished), this);
+    g_signal_connect(resource, "failed",
+                     G_CALLBACK(Browser::s_resource_failed), this);
+}
+
+void Browser::on_resource_finished(WebKitWebResource* resource)
+{
+    g_signal_handlers_disconnect_by_data(resource, this);
+
+    auto* view = static_cast<WebKitWebView*>(
+        g_object_get_data(G_OBJECT(resource), "colossus-view"));
+    Tab* tab = get_tab_for_webview(view);
+    if (!tab) return;
+
+    tab->requests_loaded++;
+    WebKitURIResponse* response = webkit_web_resource_get_response(resource);
+    guint64 length = response ? webkit_uri_response_get_content_length(response) : 0;
+    tab->bytes_loaded += length;
+    if (length > 0) {
+        sized_responses_++;
+        sized_response_bytes_ += length;
+    }
+}
+
+void Browser::on_resource_failed(WebKitWebResource* resource, GError* error)
+{
+    // "finished" follows "failed"; count the resource only once
+    g_signal_handlers_disconnect_by_data(resource, this);
+
+    if (!error || error->domain != WEBKIT_POLICY_ERROR ||
+        error->code != POLICY_ERROR_BLOCKED_BY_CONTENT_BLOCKER)
+        return;
+
+    auto* view = static_cast<WebKitWebView*>(
+        g_object_get_data(G_OBJECT(resource), "colossus-view"));
+    Tab* tab = get_tab_for_webview(view);
+    if (!tab) return;
+
+    tab->requests_blocked++;
+    if (sized_responses_) tab->bytes_saved += sized_response_bytes_ / sized_responses_;
+    if (tab->webview == current_webview()) update_tab_status();
+}
+
+void Browser::on_tab_switched(GtkWidget* page)
+{
+    Tab* next = get_tab_for_notebook_page(page);
+    Tab* previous = current_tab();
+
+    if (previous && previous != next) {
+        background_tab(*previous);
+    }
+
+    current_tab_id_ = next ? next->id : 0;
+
+    // Restored pages are untagged while the session is being rebuilt
+    if (next) {
+        activate_tab(*next);
+    }
+
+    update_url_entry_for(current_webview());
+    update_tab_status();
+    update_dashboard_timer();
+    schedule_session_save();
+}
+
+gboolean Browser::on_key_press(GdkEventKey* event)
+{
+    if (!event) return FALSE;
+
+    // Ctrl+L: focus URL entry
+    if ((event->state & GDK_CONTROL_MASK) && event->keyval == GDK_KEY_l) {
+        if (url_entry_) {
+            gtk_widget_grab_focus(url_entry_);
+            gtk_editable_select_region(GTK_EDITABLE(url_entry_), 0, -1);
+        }
+        return TRUE;
+    }
+
+    // Ctrl+R or F5: reload
+    if (((event->state & GDK_CONTROL_MASK) && event->keyval == GDK_KEY_r) ||
+        event->keyval == GDK_KEY_F5) {
+        reload();
+        return TRUE;
+    }
+
+    // Alt+Left / Alt+Right: back/forward
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_Left) {
+        go_back();
+        return TRUE;
+    }
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_Right) {
+        go_forward();
+        return TRUE;
+    }
+
+    // Alt+H: home
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_h) {
+        go_home();
+        return TRUE;
+    }
+
+    // Alt+T: new tab
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_t) {
+        new_tab(homepage_);
+        return TRUE;
+    }
+
+    // Ctrl+W or Alt+W: close tab
+    if ((event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK)) && event->keyval == GDK_KEY_w) {
+        close_current_tab();
+        return TRUE;
+    }
+
+    // Alt+V: send current page to mpv
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_v) {
+        WebKitWebView* view = current_webview();
+        if (view) {
+            const gchar* uri = webkit_web_view_get_uri(view);
+            if (uri && *uri) {
+                play_media(uri, true);
+            }
+        }
+        return TRUE;
+    }
+
+    // Alt+S: save the current page for offline reading
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_s) {
+        save_current_page();
+        return TRUE;
+    }
+
+    // Alt+A: save every page the current one links to
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_a) {
+        archive_page_links();
+        return TRUE;
+    }
+
+    // Alt+O: switch between the current page and its saved copy
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_o) {
+        toggle_offline_copy();
+        return TRUE;
+    }
+
+    // Alt+G: pin the CRT effect tier, or let pages adapt again
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_g) {
+        cycle_render_tier_pin();
+        return TRUE;
+    }
+
+    // Alt+D: retry failed downloads
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_d) {
+        downloads_->retry_failed();
+        return TRUE;
+    }
+
+    // Alt+P: pause / resume mpv
+    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_p) {
+        media_->toggle_pause();
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+// ───────────────────────────────────────────────
+//  Tab lifecycle (active → throttled → frozen → discarded)
+// ───────────────────────────────────────────────
+
+void Browser::setup_lifecycle()
+{
+    freeze_after_s_ = env_uint("COLOSSUS_FREEZE_AFTER", freeze_after_s_);
+    discard_after_s_ = env_uint("COLOSSUS_DISCARD_AFTER", discard_after_s_);
+
+    lifecycle_timer_ = g_timeout_add_seconds(5, Browser::s_lifecycle_tick, this);
+
+    memory_monitor_ = g_memory_monitor_dup_default();
+    if (memory_monitor_) {
+        g_signal_connect(memory_monitor_, "low-memory-warning",
+                         G_CALLBACK(Browser::s_low_memory_warning), this);
+    }
+}
+
+const char* Browser::tab_state_name(TabState state)
+{
+    switch (state) {
+    case TabState::Active:    return "active";
+    case TabState::Throttled: return "throttled";
+    case TabState::Frozen:    return "frozen";
+    case TabState::Discarded: return "discarded";
+    }
+    return "unknown";
+}
+
+void Browser::background_tab(Tab& tab)
+{
+    if (tab.state != TabState::Active) return;
+
+    tab.state = TabState::Throttled;
+    tab.background_since = g_get_monotonic_time();
+    throttle_page(tab);
+    update_tab_label(tab);
+}
+
+// WebKit only slows the timers of an unmapped view down after a while, and
+// leaves rendering of its own effects to the page; browser.js batches page
+// timers from now on. The scroll offset is captured here too, while the
+// page is still there: a throttled tab may be discarded without freezing.
+void Browser::throttle_page(Tab& tab)
+{
+    if (!tab.webview) return;
+
+    static const char* throttle_js =
+        "(function () {"
+        "  document.dispatchEvent(new Event('colossus:throttle'));"
+        "  return window.scrollY || 0;"
+        "})();";
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(tab.webview, throttle_js, nullptr,
+                                   Browser::s_scroll_captured, this);
+#pragma GCC diagnostic pop
+}
+
+void Browser::activate_tab(Tab& tab)
+{
+    if (tab.state == TabState::Discarded) {
+        attach_webview(tab);
+        gtk_widget_show_all(tab.scrolled);
+        tab.restore_scroll = tab.scroll_y > 0.0;
+        if (!restore_history(tab) && !tab.uri.empty()) {
+            webkit_web_view_load_uri(tab.webview, tab.uri.c_str());
+        }
+    } else if (tab.state != TabState::Active && tab.webview) {
+        if (tab.state == TabState::Frozen) webkit_web_view_set_is_muted(tab.webview, FALSE);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        webkit_web_view_run_javascript(
+            tab.webview,
+            "document.dispatchEvent(new Event('colossus:resume'));",
+            nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+    }
+
+    tab.state = TabState::Active;
+    tab.background_since = 0;
+    update_tab_label(tab);
+}
+
+void Browser::freeze_tab(Tab& tab)
+{
+    if (tab.state != TabState::Throttled || !tab.webview) return;
+
+    // Let background loads finish; a half-loaded page is worse than a
+    // throttled one.
+    if (webkit_web_view_is_loading(tab.webview)) return;
+
+    webkit_web_view_set_is_muted(tab.webview, TRUE);
+
+    // Pause media, tell browser.js, and take the scroll offset again for a
+    // later discard (the page may have scrolled itself since).
+    static const char* freeze_js =
+        "(function () {"
+        "  document.querySelectorAll('video, audio').forEach(function (m) {"
+        "    try { m.pause(); } catch (e) { }"
+        "  });"
+        "  document.dispatchEvent(new Event('colossus:freeze'));"
+        "  return window.scrollY || 0;"
+        "})();";
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(tab.webview, freeze_js, nullptr,
+                                   Browser::s_scroll_captured, this);
+#pragma GCC diagnostic pop
+
+    tab.state = TabState::Frozen;
+    update_tab_label(tab);
+}
+
+void Browser::discard_tab(Tab& tab)
+{
+    if (tab.state == TabState::Active || tab.state == TabState::Discarded) return;
+
+    if (tab.webview) {
+        const gchar* uri = webkit_web_view_get_uri(tab.webview);
+        if (uri && *uri) tab.uri = uri;
+        tab.history = serialize_history(tab.webview);
+        tab.history_dirty = false;
+        release_webview(tab);
+    }
+
+    tab.state = TabState::Discarded;
+    update_tab_label(tab);
+}
+
+void Browser::lifecycle_tick()
+{
+    gint64 now = g_get_monotonic_time();
+
+    for (auto& entry : tabs_) {
+        if (entry.first == current_tab_id_) continue;
+
+        Tab& tab = *entry.second;
+        if (tab.state == TabState::Active || tab.state == TabState::Discarded)
+            continue;
+
+        gint64 idle_s = (now - tab.background_since) / G_USEC_PER_SEC;
+
+        if (discard_after_s_ && idle_s >= discard_after_s_) {
+            discard_tab(tab);
+        } else if (freeze_after_s_ && idle_s >= freeze_after_s_) {
+            freeze_tab(tab);
+        }
+    }
+
+    webview_pool_->trim();
+    update_tab_status();
+}
+
+// Distinct PIDs reported by the web extension; views that have not
+// reported one (no extension, nothing committed yet) are not counted
+guint Browser::web_process_count() const
+{
+    std::vector<gint> pids;
+    for (const auto& entry : tabs_) {
+        gint pid = entry.second->web_pid;
+        if (pid > 0 && std::find(pids.begin(), pids.end(), pid) == pids.end()) {
+            pids.push_back(pid);
+        }
+    }
+    return static_cast<guint>(pids.size());
+}
+
+void Browser::update_tab_status()
+{
+    if (!tab_status_label_) return;
+
+    int counts[4] = { 0, 0, 0, 0 };
+    for (const auto& entry : tabs_) {
+        counts[static_cast<int>(entry.second->state)]++;
+    }
+
+    Tab* current = current_tab();
+    guint blocked = current ? current->requests_blocked : 0;
+
+    std::string text = format_status("ACT %d  THR %d  FRZ %d  DSC %d  PROC %u  POOL %u  BLK %u",
+                                     counts[0], counts[1], counts[2], counts[3],
+                                     web_process_count(),
+                                     webview_pool_->size(),
+                                     blocked);
+    if (current && current->bytes_saved >= 1024) {
+        text += format_status(" (~%" G_GUINT64_FORMAT " KB)", current->bytes_saved / 1024);
+    }
 
-    // Alt+T: new tab
-    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_t) {
-        new_tab(COLOSSUS_HOMEPAGE);
-        return TRUE;
+    if (archiver_ && archiver_->pending()) {
+        text += format_status("  ARC %u", archiver_->pending());
     }
 
-    // Alt+V: send current page to mpv
-    if ((event->state & GDK_MOD1_MASK) && event->keyval == GDK_KEY_v) {
-        WebKitWebView* view = current_webview();
-        if (view) {
-            const gchar* uri = webkit_web_view_get_uri(view);
-            if (uri && *uri) {
-                launch_mpv(uri);
+    if (downloads_) {
+        DownloadManager::Summary downloads = downloads_->summary();
+        if (downloads.running || downloads.queued) {
+            text += format_status("  DL %u", downloads.running);
+            if (downloads.queued) text += format_status("+%u", downloads.queued);
+            if (downloads.total) {
+                int percent = downloads.received >= downloads.total
+                                  ? 100
+                                  : static_cast<int>(100 * downloads.received / downloads.total);
+                text += format_status(" %d%%", percent);
             }
+            text += format_status(" %.1fMB/s", downloads.bytes_per_s / (1024.0 * 1024.0));
+        }
+        if (downloads.failed) {
+            text += format_status("  DL FAIL %u", downloads.failed);
         }
-        return TRUE;
     }
 
-    return FALSE;
+    if (!render_tier_pin_.empty()) {
+        text += format_status("  FX %s PIN", render_tier_pin_.c_str());
+    } else if (current && !current->render_tier.empty() && current->render_tier != "full") {
+        text += format_status("  FX %s", current->render_tier.c_str());
+    }
+
+    if (media_->state() != MediaController::State::Stopped) {
+        text += format_status("  MPV %s %d/%u",
+                              MediaController::state_name(media_->state()),
+                              media_->playlist_pos() + 1,
+                              media_->playlist_count());
+    }
+
+    gtk_label_set_text(GTK_LABEL(tab_status_label_), text.c_str());
+}
+
+void Browser::on_scroll_captured(WebKitWebView* view, GAsyncResult* result)
+{
+    GError* error = nullptr;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    WebKitJavascriptResult* js_result =
+        webkit_web_view_run_javascript_finish(view, result, &error);
+#pragma GCC diagnostic pop
+
+    if (!js_result) {
+        if (error) g_error_free(error);
+        return;
+    }
+
+    // The view may have been discarded while the script ran
+    Tab* tab = get_tab_for_webview(view);
+    JSCValue* value = webkit_javascript_result_get_js_value(js_result);
+    if (tab && value && jsc_value_is_number(value)) {
+        tab->scroll_y = jsc_value_to_double(value);
+    }
+
+    webkit_javascript_result_unref(js_result);
+}
+
+void Browser::on_low_memory_warning(GMemoryMonitorWarningLevel level)
+{
+    // Low: drop frozen tabs. Medium and above: drop every background tab.
+    bool aggressive = level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM;
+
+    webview_pool_->drain();
+    speculator_->drain();
+
+    for (auto& entry : tabs_) {
+        if (entry.first == current_tab_id_) continue;
+
+        Tab& tab = *entry.second;
+        if (tab.state == TabState::Frozen ||
+            (aggressive && tab.state == TabState::Throttled)) {
+            discard_tab(tab);
+        }
+    }
+
+    update_tab_status();
 }
 
 // ───────────────────────────────────────────────
-//  MPV / xterm bridges
+//  Downloads
 // ───────────────────────────────────────────────
 
-void Browser::launch_mpv(const std::string& url)
+// The image proxy's own fetches have no view; preloads and background
+// archive loads are not the user's to download from
+void Browser::on_download_started(WebKitDownload* download)
 {
-    std::string cmd;
+    WebKitWebView* view = webkit_download_get_web_view(download);
+    if (!view) return;
 
-    // Special-case Telehack Radio: audio-only, no ytdl-format, no filters
-    if (url.find("telehack.com/radio") != std::string::npos ||
-        url.find("telehack/radio") != std::string::npos) {
-        cmd =
-            "mpv --quiet "
-            "--no-video "
-            "--cache=yes --cache-secs=10 "
-            "'" + url + "'";
-    } else {
-        // Default: 480p-preferred, software decode, amber/sepia filter for video
-        cmd =
-            "mpv --quiet "
-            "--hwdec=no "
-            "--vo=gpu "
-            "--ytdl-format=bv*[height<=480]+ba/best[height<=480]/best "
-            "--cache=yes --cache-secs=10 "
-            "--vf=format=rgb24,hue=s=0,eq=brightness=-0.05:contrast=1.35:saturation=1.8 "
-            "'" + url + "'";
+    if (!get_tab_for_webview(view)) {
+        webkit_download_cancel(download);
+        return;
     }
 
-    GError* error = nullptr;
-    if (!g_spawn_command_line_async(cmd.c_str(), &error)) {
-        std::cerr << "Failed to launch mpv: "
-                  << (error ? error->message : "unknown error")
-                  << std::endl;
-        if (error) g_error_free(error);
-    }
+    WebKitSettings* settings = webkit_web_view_get_settings(view);
+    const gchar* user_agent = settings ? webkit_settings_get_user_agent(settings) : nullptr;
+    downloads_->adopt(download, user_agent ? user_agent : "");
 }
 
+// ───────────────────────────────────────────────
+//  MPV / xterm bridges
+// ───────────────────────────────────────────────
+
 void Browser::launch_xterm(const std::string& target)
 {
     std::string cmd;
@@ -583,9 +2339,147 @@ void Browser::on_mpv_message(WebKitJavascriptResult* js_result)
     std::string url(utf8);
     g_free(utf8);
 
+    // Badges queue up; playback starts right away when mpv is idle
     if (!url.empty()) {
-        launch_mpv(url);
+        play_media(url, false);
+    }
+}
+
+void Browser::play_media(const std::string& url, bool replace)
+{
+    MediaController::Item item = MediaController::item_for_url(url);
+
+    // Pages use the streams the hover / viewport prefetch resolved; anything
+    // else starts now from its URL (mpv's ytdl hook resolves pages itself),
+    // so items reach the playlist in click order
+    if (!item.audio_only) {
+        if (const StreamResolver::Streams* streams = stream_resolver_->for_play(url)) {
+            item.streams = streams->urls;
+            item.title = streams->title;
+        }
+    }
+
+    if (replace) media_->play_now(item);
+    else media_->enqueue(item);
+}
+
+void Browser::on_resolver_message(WebKitJavascriptResult* js_result)
+{
+    if (!js_result) return;
+
+    JSCValue* value = webkit_javascript_result_get_js_value(js_result);
+    if (!value || !jsc_value_is_object(value)) {
+        return;
+    }
+
+    auto string_prop = [value](const char* name) {
+        std::string out;
+        JSCValue* prop = jsc_value_object_get_property(value, name);
+        if (prop && jsc_value_is_string(prop)) {
+            gchar* utf8 = jsc_value_to_string(prop);
+            if (utf8) out = utf8;
+            g_free(utf8);
+        }
+        if (prop) g_object_unref(prop);
+        return out;
+    };
+
+    std::string url = string_prop("url");
+    if (url.empty() || !StreamResolver::needs_resolution(url)) return;
+
+    stream_resolver_->prefetch(url, string_prop("reason") == "hover"
+                                        ? StreamResolver::Priority::Hover
+                                        : StreamResolver::Priority::Viewport);
+}
+
+// Hints from terminal-view link rows: { url, reason } with reason one of
+// viewport, hover or dwell
+void Browser::on_speculation_message(WebKitJavascriptResult* js_result)
+{
+    if (!js_result || !speculator_) return;
+
+    JSCValue* value = webkit_javascript_result_get_js_value(js_result);
+    if (!value || !jsc_value_is_object(value)) {
+        return;
+    }
+
+    auto string_prop = [value](const char* name) {
+        std::string out;
+        JSCValue* prop = jsc_value_object_get_property(value, name);
+        if (prop && jsc_value_is_string(prop)) {
+            gchar* utf8 = jsc_value_to_string(prop);
+            if (utf8) out = utf8;
+            g_free(utf8);
+        }
+        if (prop) g_object_unref(prop);
+        return out;
+    };
+
+    std::string url = string_prop("url");
+    std::string reason = string_prop("reason");
+    if (url.empty()) return;
+
+    // Hints follow the pointer and the scroll position, so they come from
+    // the tab on screen; its URI is the page's, whatever the page claims
+    WebKitWebView* view = current_webview();
+    const gchar* page = view ? webkit_web_view_get_uri(view) : nullptr;
+    if (!page) return;
+
+    speculator_->hint(url, page, string_prop("text"),
+                      reason == "dwell" ? Speculator::Hint::Dwell
+                    : reason == "hover" ? Speculator::Hint::Hover
+                                        : Speculator::Hint::Viewport);
+}
+
+// browser.js posts the finished page model with the token begin_cached_view()
+// gave the page, so a page can only ever fill the entry of the URL its own
+// view is showing. No model means the cached one was still accurate. The
+// archiver's background loads hand over their models the same way.
+void Browser::on_view_cache_message(WebKitJavascriptResult* js_result)
+{
+    if (!js_result) return;
+
+    JSCValue* value = webkit_javascript_result_get_js_value(js_result);
+    if (!value || !jsc_value_is_object(value)) {
+        return;
+    }
+
+    std::string token;
+    JSCValue* token_prop = jsc_value_object_get_property(value, "token");
+    if (token_prop && jsc_value_is_string(token_prop)) {
+        gchar* utf8 = jsc_value_to_string(token_prop);
+        if (utf8) token = utf8;
+        g_free(utf8);
+    }
+    if (token_prop) g_object_unref(token_prop);
+    if (token.empty()) return;
+
+    JSCValue* model = jsc_value_object_get_property(value, "model");
+    bool archived = archiver_ && archiver_->on_model(token, model);
+    if (archived || !view_cache_) {
+        if (model) g_object_unref(model);
+        return;
+    }
+
+    Tab* tab = nullptr;
+    for (auto& entry : tabs_) {
+        if (entry.second->view_token == token) {
+            tab = entry.second.get();
+            break;
+        }
+    }
+    const gchar* uri = tab && tab->webview ? webkit_web_view_get_uri(tab->webview) : nullptr;
+    if (uri) {
+        tab->view_token.clear();
+        if (model && jsc_value_is_object(model)) {
+            gchar* json = jsc_value_to_json(model, 0);
+            if (json) view_cache_->store(uri, json);
+            g_free(json);
+        } else {
+            view_cache_->touch(uri);
+        }
     }
+    if (model) g_object_unref(model);
 }
 
 void Browser::on_xterm_message(WebKitJavascriptResult* js_result)
@@ -608,6 +2502,88 @@ void Browser::on_xterm_message(WebKitJavascriptResult* js_result)
     }
 }
 
+void Browser::on_metrics_message(WebKitJavascriptResult* js_result)
+{
+    if (!js_result) return;
+
+    JSCValue* value = webkit_javascript_result_get_js_value(js_result);
+    if (!value || !jsc_value_is_object(value)) {
+        return;
+    }
+
+    auto string_prop = [value](const char* name) {
+        std::string out;
+        JSCValue* prop = jsc_value_object_get_property(value, name);
+        if (prop && jsc_value_is_string(prop)) {
+            gchar* utf8 = jsc_value_to_string(prop);
+            if (utf8) out = utf8;
+            g_free(utf8);
+        }
+        if (prop) g_object_unref(prop);
+        return out;
+    };
+
+    auto number_prop = [value](const char* name) {
+        double out = -1.0;
+        JSCValue* prop = jsc_value_object_get_property(value, name);
+        if (prop && jsc_value_is_number(prop)) {
+            out = jsc_value_to_double(prop);
+        }
+        if (prop) g_object_unref(prop);
+        return out;
+    };
+
+    std::string event = string_prop("event");
+    double page_id = number_prop("page");
+    Tab* tab = page_id > 0 ? get_tab_for_page_id(static_cast<guint64>(page_id))
+                           : get_tab_for_page(string_prop("url"));
+    if (!tab) return;
+
+    // `ms` is performance.now(): the page's own clock, from its navigation
+    // start in the web process. Milestones are kept on the UI clock instead,
+    // stamped on arrival, so they line up with committed / finished.
+    double ms = number_prop("ms");
+    double ui_ms = tab->load_started_at
+                       ? colossus_ms_between(tab->load_started_at, g_get_monotonic_time())
+                       : -1.0;
+    if (event == "web-process") {
+        // From the web-process extension, not browser.js
+        double pid = number_prop("pid");
+        if (pid > 0) tab->web_pid = static_cast<gint>(pid);
+    } else if (event == "first-row") {
+        tab->first_row_ms = ui_ms;
+        COLOSSUS_TRACE("first terminal row at %.1f ms (page clock %.1f ms): %s\n", ui_ms, ms,
+                       tab->uri.c_str());
+    } else if (event == "first-screen") {
+        COLOSSUS_TRACE("first screen revealed at %.1f ms (page clock %.1f ms): %s\n", ui_ms, ms,
+                       tab->uri.c_str());
+    } else if (event == "terminal-view") {
+        tab->terminal_ms = ui_ms;
+        tab->extract_ms = number_prop("extractMs");
+        COLOSSUS_TRACE("terminal view built at %.1f ms (page clock %.1f ms, %.1f ms "
+                       "extracting): %s\n", ui_ms, ms, tab->extract_ms, tab->uri.c_str());
+        emit_page_event(*tab, PageEvent::TerminalView);
+    } else if (event == "extract-check") {
+        JSCValue* equal = jsc_value_object_get_property(value, "equal");
+        bool agree = equal && jsc_value_is_boolean(equal) && jsc_value_to_boolean(equal);
+        if (equal) g_object_unref(equal);
+        if (!agree) {
+            g_printerr("COLOSSUS-NAN: Extractors differ on %s: %s\n", tab->uri.c_str(),
+                       string_prop("detail").c_str());
+        }
+        emit_page_event(*tab, agree ? PageEvent::ExtractorsAgree : PageEvent::ExtractorsDiffer);
+    } else if (event == "render-quality") {
+        std::string tier = string_prop("tier");
+        if (tier != tab->render_tier) {
+            COLOSSUS_TRACE("CRT tier %s (%.1f ms frames): %s\n", tier.c_str(),
+                           number_prop("frameMs"), tab->uri.c_str());
+        }
+        tab->render_tier = tier;
+        tab->frame_ms = number_prop("frameMs");
+        if (tab->id == current_tab_id_) update_tab_status();
+    }
+}
+
 // ───────────────────────────────────────────────
 //  Static trampolines
 // ───────────────────────────────────────────────
@@ -639,14 +2615,74 @@ void Browser::s_title_changed(WebKitWebView* webview,
     self->on_title_changed(webview);
 }
 
+gboolean Browser::s_load_failed(WebKitWebView* webview,
+                                WebKitLoadEvent,
+                                gchar* failing_uri,
+                                GError* error,
+                                gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return FALSE;
+    return self->on_load_failed(webview, failing_uri, error);
+}
+
+gboolean Browser::s_decide_policy(WebKitWebView* webview,
+                                  WebKitPolicyDecision* decision,
+                                  WebKitPolicyDecisionType type,
+                                  gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return FALSE;
+    return self->on_decide_policy(webview, decision, type);
+}
+
+void Browser::s_resource_load_started(WebKitWebView* webview,
+                                      WebKitWebResource* resource,
+                                      WebKitURIRequest*,
+                                      gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_resource_load_started(webview, resource);
+}
+
+void Browser::s_resource_finished(WebKitWebResource* resource,
+                                  gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_resource_finished(resource);
+}
+
+void Browser::s_resource_failed(WebKitWebResource* resource,
+                                GError* error,
+                                gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_resource_failed(resource, error);
+}
+
 void Browser::s_tab_switched(GtkNotebook*,
-                             GtkWidget*,
-                             guint page_num,
+                             GtkWidget* page,
+                             guint,
                              gpointer user_data)
 {
     auto* self = static_cast<Browser*>(user_data);
     if (!self) return;
-    self->on_tab_switched(page_num);
+    self->on_tab_switched(page);
+}
+
+gboolean Browser::s_tab_label_pressed(GtkWidget* widget,
+                                      GdkEventButton* event,
+                                      gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self || !event || event->type != GDK_BUTTON_PRESS || event->button != 2)
+        return FALSE;
+
+    self->close_tab(GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(widget), TAB_ID_KEY)));
+    return TRUE;
 }
 
 gboolean Browser::s_key_press(GtkWidget*,
@@ -666,6 +2702,34 @@ void Browser::s_url_entry_activate(GtkEntry*,
     self->on_url_entry_activate();
 }
 
+void Browser::s_url_entry_changed(GtkEditable*,
+                                  gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_url_entry_changed();
+}
+
+// Rows are already filtered and ranked by HistoryIndex
+gboolean Browser::s_completion_match(GtkEntryCompletion*,
+                                     const gchar*,
+                                     GtkTreeIter*,
+                                     gpointer)
+{
+    return TRUE;
+}
+
+gboolean Browser::s_completion_selected(GtkEntryCompletion*,
+                                        GtkTreeModel* model,
+                                        GtkTreeIter* iter,
+                                        gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return FALSE;
+    self->on_completion_selected(model, iter);
+    return TRUE;
+}
+
 void Browser::s_mpv_message(WebKitUserContentManager*,
                             WebKitJavascriptResult* result,
                             gpointer user_data)
@@ -684,3 +2748,176 @@ void Browser::s_xterm_message(WebKitUserContentManager*,
     self->on_xterm_message(result);
 }
 
+void Browser::s_metrics_message(WebKitUserContentManager*,
+                                WebKitJavascriptResult* result,
+                                gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_metrics_message(result);
+}
+
+void Browser::s_resolver_message(WebKitUserContentManager*,
+                                 WebKitJavascriptResult* result,
+                                 gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_resolver_message(result);
+}
+
+void Browser::s_view_cache_message(WebKitUserContentManager*,
+                                   WebKitJavascriptResult* result,
+                                   gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_view_cache_message(result);
+}
+
+void Browser::s_speculation_message(WebKitUserContentManager*,
+                                    WebKitJavascriptResult* result,
+                                    gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_speculation_message(result);
+}
+
+gboolean Browser::s_load_icon(gpointer)
+{
+    static const char* ICON = "colossus-nan.png";
+
+    GError* error = nullptr;
+    GdkPixbuf* icon = nullptr;
+    std::string override_path = colossus_resource_override(ICON);
+    if (!override_path.empty()) {
+        icon = gdk_pixbuf_new_from_file_at_scale(override_path.c_str(), 256, 256, TRUE, &error);
+    } else {
+        icon = gdk_pixbuf_new_from_resource_at_scale(colossus_resource_path(ICON).c_str(),
+                                                     256, 256, TRUE, &error);
+    }
+
+    if (icon) {
+        gtk_window_set_default_icon(icon);
+        g_object_unref(icon);
+    } else {
+        g_printerr("COLOSSUS-NAN: Failed to load icon: %s\n",
+                   error ? error->message : "unknown error");
+        g_clear_error(&error);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean Browser::s_window_delete(GtkWidget*, GdkEvent*, gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (self) self->save_session_now();
+    return FALSE;   // close as usual
+}
+
+// Destroying the window takes the notebook and every tab's view with it
+void Browser::s_window_destroy(GtkWidget*, gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    if (self->session_save_source_) {
+        g_source_remove(self->session_save_source_);
+        self->session_save_source_ = 0;
+    }
+    self->window_ = nullptr;
+    self->tab_status_label_ = nullptr;
+}
+
+gboolean Browser::s_preload_swap(gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    self->preload_swap_source_ = 0;
+
+    // The tab may have been closed or discarded meanwhile
+    Tab* tab = self->get_tab(self->preload_swap_tab_);
+    if (tab && tab->webview) {
+        Speculator::Entry entry = self->preload_swap_;
+        self->preload_swap_ = Speculator::Entry();
+        self->swap_in_preload(*tab, entry);
+    } else {
+        self->drop_pending_preload_swap();
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean Browser::s_session_save(gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return G_SOURCE_REMOVE;
+    self->session_save_source_ = 0;
+    if (self->session_store_) {
+        self->session_store_->save(self->collect_session());
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gboolean Browser::s_dashboard_tick(gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    WebKitWebView* view = self->current_webview();
+    if (!view || !Dashboard::is_dashboard(webkit_web_view_get_uri(view))) {
+        self->dashboard_timer_ = 0;
+        return G_SOURCE_REMOVE;
+    }
+    self->refresh_dashboard();
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean Browser::s_lifecycle_tick(gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return G_SOURCE_REMOVE;
+    self->lifecycle_tick();
+    return G_SOURCE_CONTINUE;
+}
+
+void Browser::s_scroll_captured(GObject* source,
+                                GAsyncResult* result,
+                                gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_scroll_captured(WEBKIT_WEB_VIEW(source), result);
+}
+
+void Browser::s_save_page_finished(GObject* source,
+                                   GAsyncResult* result,
+                                   gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_save_page_finished(WEBKIT_WEB_VIEW(source), result);
+}
+
+void Browser::s_page_links_finished(GObject* source,
+                                    GAsyncResult* result,
+                                    gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_page_links_finished(WEBKIT_WEB_VIEW(source), result);
+}
+
+void Browser::s_low_memory_warning(GMemoryMonitor*,
+                                   GMemoryMonitorWarningLevel level,
+                                   gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_low_memory_warning(level);
+}
+
+void Browser::s_download_started(WebKitWebContext*,
+                                 WebKitDownload* download,
+                                 gpointer user_data)
+{
+    auto* self = static_cast<Browser*>(user_data);
+    if (!self) return;
+    self->on_download_started(download);
+}
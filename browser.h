@@ -3,7 +3,10 @@
 #ifndef COLOSSUS_BROWSER_H
 #define COLOSSUS_BROWSER_H
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 extern "C" {
@@ -12,22 +15,135 @@ extern "C" {
 #include <jsc/jsc.h>
 }
 
+#include "archiver.h"
+#include "content_filters.h"
+#include "dashboard.h"
+#include "download_manager.h"
+#include "history_index.h"
+#include "history_store.h"
+#include "image_proxy.h"
+#include "media_controller.h"
+#include "page_archive.h"
+#include "process_model.h"
+#include "session_store.h"
+#include "speculator.h"
+#include "stream_resolver.h"
+#include "view_cache.h"
+#include "webview_pool.h"
+
 class Browser {
 public:
-    explicit Browser(GtkApplication* app);
+    // Load milestones of a page, in ms since its LOAD_STARTED. TerminalView
+    // is browser.js having finished the terminal view; web_pid is 0 until the
+    // page reports it (needs the web-process extension). With
+    // COLOSSUS_EXTRACT_CHECK set, ExtractorsAgree / ExtractorsDiffer follow
+    // TerminalView: browser.js's walker against the native extractor.
+    enum class PageEvent {
+        Committed,
+        Finished,
+        TerminalView,
+        ExtractorsAgree,
+        ExtractorsDiffer
+    };
+    using PageEventCallback = std::function<void(PageEvent event, const std::string& uri,
+                                                 double ms, int web_pid)>;
+
+    // An empty homepage means the built-in one. `open_first` (command-line
+    // arguments on a cold start) replaces the homepage and the session's
+    // active page: saved tabs come back as placeholders behind them.
+    explicit Browser(GtkApplication* app, const std::string& homepage = {},
+                     const std::vector<std::string>& open_first = {});
     ~Browser();
 
     void show();
     void open_uri(const std::string& uri);
 
+    // Write the session while the tabs' views still exist: on window close,
+    // and from the application's "shutdown" for any other way out
+    void save_session_now();
+
+    // Open each URL (or command-bar input) in a new tab. The first becomes
+    // the current tab; the rest wait as placeholders and load when first
+    // selected, so batches of hundreds open in about the time of one.
+    void open_uris(const std::vector<std::string>& inputs);
+
+    // What the command bar makes of `input`: URLs pass through, bare host
+    // names get https://, anything else becomes a search
+    static std::string uri_for_input(const std::string& input);
+
+    // Whether uri_for_input() takes `input` as an address rather than
+    // search words
+    static bool looks_like_uri(const std::string& input);
+
+    // Close a tab and release its view and web process; the last tab is
+    // replaced with the homepage
+    void close_tab(guint id);
+    void close_current_tab();
+
+    void set_page_event_callback(PageEventCallback callback) { page_event_callback_ = std::move(callback); }
+
 private:
+    // Background tab tiers. Throttled is the plain background state: page
+    // timers are batched by browser.js (colossus:throttle) on top of what
+    // WebKit does for unmapped views; Frozen additionally mutes and pauses
+    // media; Discarded drops the webview and keeps only uri/title/scroll.
+    enum class TabState {
+        Active,
+        Throttled,
+        Frozen,
+        Discarded
+    };
+
     struct Tab {
+        guint id = 0;                   // stable for the tab's lifetime, never reused
         GtkWidget* scrolled = nullptr;
         WebKitWebView* webview = nullptr;
         GtkWidget* label = nullptr;
+        GtkWidget* tab_widget = nullptr;    // event box around label (middle-click)
+
+        TabState state = TabState::Active;
+        gint64 background_since = 0;    // monotonic µs, set when backgrounded
+        std::string uri;
+        std::string title;
+        double scroll_y = 0.0;
+        bool restore_scroll = false;
+
+        gint64 opened_at = 0;           // monotonic µs, for time-to-first-paint
+        bool first_paint_pending = false;
+        bool warm = false;              // view came from the pre-warmed pool
+
+        LoadProfile profile = LoadProfile::Full;   // matches the view's settings
+
+        // Serialized back/forward list (base64). Authoritative while the tab
+        // is discarded; for live tabs a cache refreshed when dirty.
+        std::string history;
+        bool history_dirty = true;
+
+        // Back/forward list from before a preloaded view was swapped in
+        // (which starts its own); going back past its start restores it
+        std::string history_before_swap;
+
+        gint web_pid = 0;               // reported by the web extension, 0 if unknown
+        std::string view_token;         // view-cache handshake of the committed page
+        gint64 load_started_at = 0;     // monotonic µs of the last LOAD_STARTED
+        double committed_ms = -1.0;     // LOAD_COMMITTED, ms since LOAD_STARTED
+        double finished_ms = -1.0;      // LOAD_FINISHED, ms since LOAD_STARTED
+        double first_row_ms = -1.0;     // browser.js: first terminal row, ms since LOAD_STARTED
+        double terminal_ms = -1.0;      // browser.js: terminal view done, ms since LOAD_STARTED
+        double extract_ms = -1.0;       // browser.js: time spent extracting the page model
+        std::string render_tier;        // browser.js: CRT effect tier, empty until reported
+        double frame_ms = -1.0;         // browser.js: mean frame interval of the last scroll
+
+        // Per page load, reset on LOAD_STARTED
+        guint requests_blocked = 0;     // stopped by content filters
+        guint requests_loaded = 0;
+        guint64 bytes_loaded = 0;       // Content-Length of finished responses
+        guint64 bytes_saved = 0;        // blocked requests at the mean response size
     };
 
     GtkApplication* app_ = nullptr;
+    std::string homepage_;
+    PageEventCallback page_event_callback_;
     GtkWidget* window_ = nullptr;
     GtkWidget* notebook_ = nullptr;
     GtkWidget* bottom_bar_ = nullptr;
@@ -36,26 +152,154 @@ private:
     GtkWidget* back_button_ = nullptr;
     GtkWidget* forward_button_ = nullptr;
     GtkWidget* home_button_ = nullptr;
+    GtkWidget* tab_status_label_ = nullptr;
+
+    // Command-bar completion over visited pages
+    HistoryIndex history_index_;
+    std::unique_ptr<HistoryStore> history_store_;
+    GtkListStore* completion_store_ = nullptr;
+    std::string typed_uri_;     // last URI entered in the command bar
+    bool updating_url_entry_ = false;
+
+    // Tabs by ID; notebook order is the display order (tabs_in_order).
+    // Tabs are heap-allocated so Tab* stays valid while others come and go.
+    std::unordered_map<guint, std::unique_ptr<Tab>> tabs_;
+    std::unordered_map<WebKitWebView*, Tab*> tab_by_view_;
+    std::unordered_map<guint64, Tab*> tab_by_page_id_;     // webkit_web_view_get_page_id
+    guint next_tab_id_ = 1;
+    guint current_tab_id_ = 0;     // 0 while no tab is current
 
-    std::vector<Tab> tabs_;
-    int current_tab_ = -1;
+    // Tab lifecycle (0 disables the corresponding tier)
+    guint freeze_after_s_ = 30;
+    guint discard_after_s_ = 600;
+    guint lifecycle_timer_ = 0;
+    GMemoryMonitor* memory_monitor_ = nullptr;
 
     std::string script_source_;
+    bool startup_painted_ = false;
+
+    // CRT effect tier pinned for every page (COLOSSUS_CRT_TIER, Alt+G);
+    // empty lets each page adapt to its own paint cost
+    std::string render_tier_pin_;
+
+    // Tab session, restored lazily (COLOSSUS_SESSION=0 disables it)
+    std::unique_ptr<SessionStore> session_store_;
+    guint session_save_source_ = 0;
+
+    // Terminal-view diet profile (COLOSSUS_DIET=0 disables it)
+    bool diet_enabled_ = true;
+
+    // Shared web context / content manager / process cap
+    std::unique_ptr<ProcessModel> process_model_;
+
+    // about:colossus, refreshed only while it is the current tab
+    std::unique_ptr<Dashboard> dashboard_;
+    guint dashboard_timer_ = 0;
+
+    // The one long-lived mpv behind ▶ mpv badges and Alt+V
+    std::unique_ptr<MediaController> media_;
+
+    // yt-dlp pre-resolution for playable links (destroyed before media_)
+    std::unique_ptr<StreamResolver> stream_resolver_;
+
+    // Compiled content-blocking lists on the shared content manager
+    std::unique_ptr<ContentFilters> content_filters_;
+
+    // Sized responses this session: a blocked request was never answered,
+    // so what it saved is estimated at their mean size
+    guint64 sized_responses_ = 0;
+    guint64 sized_response_bytes_ = 0;
+
+    // colossus-img:// thumbnails (destroyed before process_model_)
+    std::unique_ptr<ImageProxy> image_proxy_;
+
+    // Extracted terminal views by URL (COLOSSUS_VIEW_CACHE_MB=0 disables it)
+    std::unique_ptr<ViewCache> view_cache_;
+
+    // Pages saved for offline reading, and the background loads that save
+    // them (destroyed before image_proxy_)
+    std::unique_ptr<PageArchive> page_archive_;
+    std::unique_ptr<Archiver> archiver_;
+
+    // Pre-warmed views for new tabs (destroyed before process_model_)
+    std::unique_ptr<WebviewPool> webview_pool_;
+
+    // Hover / viewport link speculation (destroyed before process_model_)
+    std::unique_ptr<Speculator> speculator_;
+
+    // A preload taken in decide-policy, swapped in from idle: swapping
+    // destroys the view that is still emitting the signal
+    guint preload_swap_source_ = 0;
+    guint preload_swap_tab_ = 0;
+    Speculator::Entry preload_swap_;
+
+    // Download queue (destroyed before process_model_)
+    std::unique_ptr<DownloadManager> downloads_;
 
     // UI setup
     void setup_ui();
     void apply_shell_theme();
     Tab& create_tab(const std::string& uri);
-    WebKitUserContentManager* create_content_manager();
+    Tab& add_tab();
+    Tab& add_placeholder_tab(const std::string& uri, const std::string& title);
+    void make_tab_label(Tab& tab, const char* text);
+    void attach_webview(Tab& tab);
+    void connect_webview(Tab& tab);
+    void release_webview(Tab& tab);
+    void swap_in_preload(Tab& tab, Speculator::Entry& entry);
+    void drop_pending_preload_swap();
+    void note_first_paint(Tab& tab, const char* phase);
+    void emit_page_event(Tab& tab, PageEvent event);
+    void apply_load_profile(Tab& tab, const std::string& uri);
+    void setup_content_manager();
     void inject_user_script(WebKitUserContentManager* manager);
+    void cycle_render_tier_pin();
     WebKitWebView* current_webview();
+    Tab* current_tab();
+    Tab* get_tab(guint id);
     Tab* get_tab_for_webview(WebKitWebView* view);
+    Tab* get_tab_for_notebook_page(GtkWidget* page);
+    std::vector<Tab*> tabs_in_order();
+    Tab* get_tab_for_page_id(guint64 page_id);
+    Tab* get_tab_for_page(const std::string& uri);
+
+    // Session
+    bool restore_session(const SessionStore::Session& session, bool select = true);
+    void schedule_session_save();
+    SessionStore::Session collect_session();
+    static std::string serialize_history(WebKitWebView* view);
+    bool restore_history(Tab& tab);
 
     // Navigation / loading
     void load_homepage();
     void load_uri(const std::string& uri);
     void update_url_entry_for(WebKitWebView* view);
     void update_tab_title_for(WebKitWebView* view);
+    void update_tab_label(Tab& tab);
+    void record_visit(WebKitWebView* view);
+    void begin_cached_view(Tab& tab);
+
+    // Offline archive
+    void save_current_page();
+    void archive_page_links();
+    void toggle_offline_copy();
+
+    // about:colossus
+    void update_dashboard_timer();
+    void refresh_dashboard();
+    Dashboard::Snapshot collect_dashboard();
+
+    // Tab lifecycle
+    void setup_lifecycle();
+    void background_tab(Tab& tab);
+    void throttle_page(Tab& tab);
+    void activate_tab(Tab& tab);
+    void freeze_tab(Tab& tab);
+    void discard_tab(Tab& tab);
+    void lifecycle_tick();
+    void update_tab_status();
+    guint web_process_count() const;
+    static const char* tab_state_name(TabState state);
 
     // Actions
     void new_tab(const std::string& uri);
@@ -66,19 +310,39 @@ private:
 
     // Event handlers (instance)
     void on_url_entry_activate();
+    void on_url_entry_changed();
+    void on_completion_selected(GtkTreeModel* model, GtkTreeIter* iter);
     void on_load_changed(WebKitWebView* view, WebKitLoadEvent event);
     void on_uri_changed(WebKitWebView* view);
     void on_title_changed(WebKitWebView* view);
-    void on_tab_switched(guint page_num);
+    gboolean on_load_failed(WebKitWebView* view, const gchar* failing_uri, GError* error);
+    gboolean on_decide_policy(WebKitWebView* view, WebKitPolicyDecision* decision,
+                              WebKitPolicyDecisionType type);
+    gboolean on_decide_response(WebKitWebView* view, WebKitResponsePolicyDecision* decision);
+    void on_resource_load_started(WebKitWebView* view, WebKitWebResource* resource);
+    void on_resource_finished(WebKitWebResource* resource);
+    void on_resource_failed(WebKitWebResource* resource, GError* error);
+    void on_tab_switched(GtkWidget* page);
     gboolean on_key_press(GdkEventKey* event);
 
     void on_mpv_message(WebKitJavascriptResult* js_result);
     void on_xterm_message(WebKitJavascriptResult* js_result);
+    void on_metrics_message(WebKitJavascriptResult* js_result);
+    void on_resolver_message(WebKitJavascriptResult* js_result);
+    void on_view_cache_message(WebKitJavascriptResult* js_result);
+    void on_speculation_message(WebKitJavascriptResult* js_result);
+    void on_scroll_captured(WebKitWebView* view, GAsyncResult* result);
+    void on_save_page_finished(WebKitWebView* view, GAsyncResult* result);
+    void on_page_links_finished(WebKitWebView* view, GAsyncResult* result);
+    void on_low_memory_warning(GMemoryMonitorWarningLevel level);
+    void on_download_started(WebKitDownload* download);
 
     // Helpers
-    void launch_mpv(const std::string& url);
     void launch_xterm(const std::string& target);
-    static std::string load_text_file(const std::string& path);
+    void play_media(const std::string& url, bool replace);
+    void prefetch_dns(const std::string& uri);
+    void check_startup_budget();
+    static std::string find_web_extensions_dir();
 
     // Static trampolines
     static void s_load_changed(WebKitWebView* webview,
@@ -90,15 +354,51 @@ private:
     static void s_title_changed(WebKitWebView* webview,
                                 GParamSpec*,
                                 gpointer user_data);
+    static gboolean s_load_failed(WebKitWebView* webview,
+                                  WebKitLoadEvent load_event,
+                                  gchar* failing_uri,
+                                  GError* error,
+                                  gpointer user_data);
+    static gboolean s_decide_policy(WebKitWebView* webview,
+                                    WebKitPolicyDecision* decision,
+                                    WebKitPolicyDecisionType type,
+                                    gpointer user_data);
+    static void s_resource_load_started(WebKitWebView* webview,
+                                        WebKitWebResource* resource,
+                                        WebKitURIRequest* request,
+                                        gpointer user_data);
+    static void s_resource_finished(WebKitWebResource* resource,
+                                    gpointer user_data);
+    static void s_resource_failed(WebKitWebResource* resource,
+                                  GError* error,
+                                  gpointer user_data);
     static void s_tab_switched(GtkNotebook* notebook,
                                GtkWidget* page,
                                guint page_num,
                                gpointer user_data);
+    static gboolean s_tab_label_pressed(GtkWidget* widget,
+                                        GdkEventButton* event,
+                                        gpointer user_data);
+    static gboolean s_window_delete(GtkWidget* widget,
+                                    GdkEvent* event,
+                                    gpointer user_data);
+    static void s_window_destroy(GtkWidget* widget,
+                                 gpointer user_data);
     static gboolean s_key_press(GtkWidget* widget,
                                 GdkEventKey* event,
                                 gpointer user_data);
     static void s_url_entry_activate(GtkEntry* entry,
                                      gpointer user_data);
+    static void s_url_entry_changed(GtkEditable* editable,
+                                    gpointer user_data);
+    static gboolean s_completion_match(GtkEntryCompletion* completion,
+                                       const gchar* key,
+                                       GtkTreeIter* iter,
+                                       gpointer user_data);
+    static gboolean s_completion_selected(GtkEntryCompletion* completion,
+                                          GtkTreeModel* model,
+                                          GtkTreeIter* iter,
+                                          gpointer user_data);
 
     static void s_mpv_message(WebKitUserContentManager* manager,
                               WebKitJavascriptResult* result,
@@ -106,6 +406,39 @@ private:
     static void s_xterm_message(WebKitUserContentManager* manager,
                                 WebKitJavascriptResult* result,
                                 gpointer user_data);
+    static void s_metrics_message(WebKitUserContentManager* manager,
+                                  WebKitJavascriptResult* result,
+                                  gpointer user_data);
+    static void s_resolver_message(WebKitUserContentManager* manager,
+                                   WebKitJavascriptResult* result,
+                                   gpointer user_data);
+    static void s_view_cache_message(WebKitUserContentManager* manager,
+                                     WebKitJavascriptResult* result,
+                                     gpointer user_data);
+    static void s_speculation_message(WebKitUserContentManager* manager,
+                                      WebKitJavascriptResult* result,
+                                      gpointer user_data);
+
+    static gboolean s_lifecycle_tick(gpointer user_data);
+    static gboolean s_dashboard_tick(gpointer user_data);
+    static gboolean s_session_save(gpointer user_data);
+    static gboolean s_preload_swap(gpointer user_data);
+    static gboolean s_load_icon(gpointer user_data);
+    static void s_scroll_captured(GObject* source,
+                                  GAsyncResult* result,
+                                  gpointer user_data);
+    static void s_save_page_finished(GObject* source,
+                                     GAsyncResult* result,
+                                     gpointer user_data);
+    static void s_page_links_finished(GObject* source,
+                                      GAsyncResult* result,
+                                      gpointer user_data);
+    static void s_low_memory_warning(GMemoryMonitor* monitor,
+                                     GMemoryMonitorWarningLevel level,
+                                     gpointer user_data);
+    static void s_download_started(WebKitWebContext* context,
+                                   WebKitDownload* download,
+                                   gpointer user_data);
 };
 
 #endif // COLOSSUS_BROWSER_H
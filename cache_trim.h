@@ -0,0 +1,111 @@
+// cache_trim.h — COLOSSUS size-bounded on-disk cache directories
+
+#ifndef COLOSSUS_CACHE_TRIM_H
+#define COLOSSUS_CACHE_TRIM_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+}
+
+// Delete the oldest files (by mtime) in `dir` until it holds no more than
+// `limit_bytes`. *.part files are partial writes from an interrupted
+// session and always go. Blocking; see colossus_trim_cache_dir_async().
+inline void colossus_trim_cache_dir(const std::string& dir, guint64 limit_bytes)
+{
+    struct CacheFile {
+        std::string path;
+        guint64 size;
+        gint64 mtime;
+    };
+
+    GDir* handle = g_dir_open(dir.c_str(), 0, nullptr);
+    if (!handle) return;
+
+    std::vector<CacheFile> files;
+    guint64 total = 0;
+
+    while (const gchar* name = g_dir_read_name(handle)) {
+        gchar* path = g_build_filename(dir.c_str(), name, nullptr);
+        GStatBuf st;
+        if (g_stat(path, &st) == 0) {
+            if (g_str_has_suffix(name, ".part")) {
+                g_unlink(path);
+            } else {
+                files.push_back({ path, static_cast<guint64>(st.st_size),
+                                  static_cast<gint64>(st.st_mtime) });
+                total += static_cast<guint64>(st.st_size);
+            }
+        }
+        g_free(path);
+    }
+    g_dir_close(handle);
+
+    if (total <= limit_bytes) return;
+
+    std::sort(files.begin(), files.end(),
+              [](const CacheFile& a, const CacheFile& b) { return a.mtime < b.mtime; });
+
+    for (const CacheFile& file : files) {
+        if (total <= limit_bytes) break;
+        if (g_unlink(file.path.c_str()) == 0) total -= file.size;
+    }
+}
+
+// The same on a low-priority worker thread
+inline void colossus_trim_cache_dir_async(const std::string& dir, guint64 limit_bytes,
+                                          GCancellable* cancellable)
+{
+    struct TrimData {
+        std::string dir;
+        guint64 limit_bytes;
+    };
+
+    GTask* task = g_task_new(nullptr, cancellable, nullptr, nullptr);
+    g_task_set_task_data(task, new TrimData{ dir, limit_bytes },
+                         [](gpointer p) { delete static_cast<TrimData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, [](GTask* t, gpointer, gpointer task_data, GCancellable*) {
+        auto* data = static_cast<TrimData*>(task_data);
+        colossus_trim_cache_dir(data->dir, data->limit_bytes);
+        g_task_return_boolean(t, TRUE);
+    });
+    g_object_unref(task);
+}
+
+// Keeps a cache directory within its limit for a whole session, not just
+// at start: start() trims once, then wrote() trims again whenever the bytes
+// written since add up to a tenth of the limit. Main loop only; the owner
+// cancels `cancellable` before it goes away.
+class ColossusCacheTrimmer {
+public:
+    void start(const std::string& dir, guint64 limit_bytes, GCancellable* cancellable)
+    {
+        dir_ = dir;
+        limit_bytes_ = limit_bytes;
+        cancellable_ = cancellable;
+        if (limit_bytes_) colossus_trim_cache_dir_async(dir_, limit_bytes_, cancellable_);
+    }
+
+    void wrote(guint64 bytes)
+    {
+        if (!limit_bytes_) return;
+        written_ += bytes;
+        if (written_ < limit_bytes_ / 10) return;
+
+        written_ = 0;
+        colossus_trim_cache_dir_async(dir_, limit_bytes_, cancellable_);
+    }
+
+private:
+    std::string dir_;
+    guint64 limit_bytes_ = 0;
+    GCancellable* cancellable_ = nullptr;
+    guint64 written_ = 0;
+};
+
+#endif // COLOSSUS_CACHE_TRIM_H
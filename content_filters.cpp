@@ -0,0 +1,729 @@
+// content_filters.cpp — COLOSSUS content-blocking filter lists
+
+#include "content_filters.h"
+#include "trace.h"
+
+#include <algorithm>
+
+namespace {
+
+// WebKit refuses to compile lists beyond this many rules
+const guint MAX_RULES = 150000;
+
+// Generic element-hiding selectors are merged into rules of this size
+const size_t SELECTORS_PER_RULE = 250;
+
+// Part of every store identifier: bump it whenever convert_easylist()
+// output changes, so lists compiled by an older conversion are rebuilt
+const guint CONVERTER_VERSION = 2;
+
+// ───────────────────────────────────────────────
+//  EasyList conversion helpers
+// ───────────────────────────────────────────────
+
+void append_json_string(std::string& out, const std::string& s)
+{
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                g_snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    out += '"';
+}
+
+void append_json_array(std::string& out, const std::vector<std::string>& items)
+{
+    out += '[';
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i) out += ',';
+        append_json_string(out, items[i]);
+    }
+    out += ']';
+}
+
+bool is_ascii(const std::string& s)
+{
+    return std::all_of(s.begin(), s.end(),
+                       [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+std::vector<std::string> split(const std::string& s, char sep)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = s.find(sep, start);
+        parts.push_back(s.substr(start, end - start));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return parts;
+}
+
+// "a.com,~b.com" (or '|'-separated for $domain=) into if/unless lists.
+// WebKit matches "*domain" as the domain and its subdomains.
+void parse_domains(const std::string& list, char sep,
+                   std::vector<std::string>& if_domains,
+                   std::vector<std::string>& unless_domains)
+{
+    for (std::string d : split(list, sep)) {
+        if (d.empty()) continue;
+        bool negated = d[0] == '~';
+        if (negated) d.erase(0, 1);
+        if (d.empty() || !is_ascii(d)) continue;
+        for (auto& c : d) c = g_ascii_tolower(c);
+        (negated ? unless_domains : if_domains).push_back("*" + d);
+    }
+}
+
+// Adblock Plus pattern → WebKit url-filter regexes. WebKit supports a small
+// regex subset without alternation, so a trailing separator ("^", which
+// also matches the end of the URL) becomes two regexes: one ending in a
+// separator character, one anchored at the end.
+std::vector<std::string> pattern_to_regexes(const std::string& pattern)
+{
+    std::string out;
+    size_t i = 0;
+    size_t end = pattern.size();
+
+    if (pattern.compare(0, 2, "||") == 0) {
+        out = "^[^:]+://+([^/]+\\.)?";
+        i = 2;
+    } else if (!pattern.empty() && pattern[0] == '|') {
+        out = "^";
+        i = 1;
+    }
+
+    bool anchored_end = end > i && pattern[end - 1] == '|';
+    if (anchored_end) --end;
+
+    bool trailing_separator = end > i && pattern[end - 1] == '^';
+    if (trailing_separator) --end;
+
+    for (; i < end; ++i) {
+        char c = pattern[i];
+        switch (c) {
+        case '*':
+            out += ".*";
+            break;
+        case '^':
+            out += "[/:?=&]";
+            break;
+        case '.': case '+': case '?': case '$': case '{': case '}':
+        case '(': case ')': case '[': case ']': case '\\': case '|':
+            out += '\\';
+            out += c;
+            break;
+        default:
+            out += c;
+        }
+    }
+
+    std::vector<std::string> regexes;
+    if (trailing_separator) {
+        regexes.push_back(out + (anchored_end ? "[/:?=&]$" : "[/:?=&]"));
+        regexes.push_back(out + "$");
+    } else {
+        regexes.push_back(anchored_end ? out + "$" : out);
+    }
+
+    for (auto& regex : regexes) {
+        // Redundant leading wildcards slow the matcher down for nothing
+        while (regex.compare(0, 2, ".*") == 0 && regex.size() > 2) regex.erase(0, 2);
+        if (regex.empty()) regex = ".*";
+    }
+    return regexes;
+}
+
+// Subresource types. "document" is left out on purpose: WebKit would also
+// block top-level navigations, which Adblock Plus rules never do, and it
+// cannot be limited to child frames on every WebKitGTK we support.
+const char* const SUBRESOURCE_TYPES[] = {
+    "image", "style-sheet", "script", "font", "raw", "svg-document", "media", "popup"
+};
+
+// Adblock Plus $type → WebKit resource-type; nullptr when unsupported
+const char* resource_type_for(const std::string& option)
+{
+    if (option == "script") return "script";
+    if (option == "image") return "image";
+    if (option == "stylesheet") return "style-sheet";
+    if (option == "font") return "font";
+    if (option == "media") return "media";
+    if (option == "popup") return "popup";
+    if (option == "xmlhttprequest" || option == "websocket" ||
+        option == "ping" || option == "other") return "raw";
+    return nullptr;
+}
+
+// Extended element-hiding syntax WebKit cannot parse as CSS
+bool is_extended_selector(const std::string& selector)
+{
+    static const char* const markers[] = {
+        ":-abp-", ":has-text(", ":contains(", ":xpath(", ":matches-css",
+        ":upward(", ":remove(", ":style(", "[-ext-", ":matches-path("
+    };
+    for (const char* marker : markers) {
+        if (selector.find(marker) != std::string::npos) return true;
+    }
+    return false;
+}
+
+struct Trigger {
+    std::string url_filter = ".*";
+    bool case_sensitive = false;
+    std::vector<std::string> resource_types;
+    std::string load_type;
+    std::vector<std::string> if_domains;
+    std::vector<std::string> unless_domains;
+};
+
+std::string rule_json(const Trigger& trigger, const char* action,
+                      const std::string* selector = nullptr)
+{
+    std::string json = "{\"trigger\":{\"url-filter\":";
+    append_json_string(json, trigger.url_filter);
+    if (trigger.case_sensitive) json += ",\"url-filter-is-case-sensitive\":true";
+    if (!trigger.resource_types.empty()) {
+        json += ",\"resource-type\":";
+        append_json_array(json, trigger.resource_types);
+    }
+    if (!trigger.load_type.empty()) {
+        json += ",\"load-type\":[";
+        append_json_string(json, trigger.load_type);
+        json += ']';
+    }
+    // WebKit allows only one of if-domain / unless-domain per trigger
+    if (!trigger.if_domains.empty()) {
+        json += ",\"if-domain\":";
+        append_json_array(json, trigger.if_domains);
+    } else if (!trigger.unless_domains.empty()) {
+        json += ",\"unless-domain\":";
+        append_json_array(json, trigger.unless_domains);
+    }
+    json += "},\"action\":{\"type\":\"";
+    json += action;
+    json += '"';
+    if (selector) {
+        json += ",\"selector\":";
+        append_json_string(json, *selector);
+    }
+    json += "}}";
+    return json;
+}
+
+// Parse "$opt1,opt2" into the trigger; false if the rule cannot be expressed
+bool apply_options(const std::string& options, Trigger& trigger)
+{
+    std::vector<std::string> included;
+    std::vector<std::string> excluded;
+    bool typed = false;
+
+    for (std::string opt : split(options, ',')) {
+        for (auto& c : opt) c = g_ascii_tolower(c);
+        if (opt.empty() || opt == "important" || opt == "all") continue;
+
+        bool negated = opt[0] == '~';
+        std::string type = negated ? opt.substr(1) : opt;
+
+        if (opt == "third-party" || opt == "3p") {
+            trigger.load_type = "third-party";
+        } else if (opt == "~third-party" || opt == "1p" || opt == "first-party") {
+            trigger.load_type = "first-party";
+        } else if (opt == "match-case") {
+            trigger.case_sensitive = true;
+        } else if (opt.compare(0, 7, "domain=") == 0) {
+            parse_domains(opt.substr(7), '|', trigger.if_domains, trigger.unless_domains);
+        } else if (type == "subdocument") {
+            // Frames: see SUBRESOURCE_TYPES
+            if (!negated) typed = true;
+        } else if (const char* webkit_type = resource_type_for(type)) {
+            if (negated) {
+                excluded.push_back(webkit_type);
+            } else {
+                included.push_back(webkit_type);
+                typed = true;
+            }
+        } else {
+            // $redirect, $csp, $removeparam, $document, $elemhide, ...
+            return false;
+        }
+    }
+
+    if (!typed) {
+        for (const char* type : SUBRESOURCE_TYPES) included.push_back(type);
+    }
+    for (const auto& type : included) {
+        if (std::find(excluded.begin(), excluded.end(), type) == excluded.end() &&
+            std::find(trigger.resource_types.begin(), trigger.resource_types.end(), type) ==
+                trigger.resource_types.end()) {
+            trigger.resource_types.push_back(type);
+        }
+    }
+    return !trigger.resource_types.empty();
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  EasyList → WebKit JSON
+// ───────────────────────────────────────────────
+
+std::string ContentFilters::convert_easylist(const std::string& text, guint* rule_count)
+{
+    // WebKit applies rules in order: blocks and hiding first, exceptions last
+    std::vector<std::string> blocks;
+    std::vector<std::string> hides;
+    std::vector<std::string> exceptions;
+    std::vector<std::string> generic_selectors;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) eol = text.size();
+        std::string line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        while (!line.empty() && g_ascii_isspace(line.back())) line.pop_back();
+        size_t lead = 0;
+        while (lead < line.size() && g_ascii_isspace(line[lead])) ++lead;
+        line.erase(0, lead);
+
+        if (line.empty() || line[0] == '!' || line[0] == '[') continue;
+        if (!is_ascii(line)) continue;
+
+        // Element hiding; exceptions and scriptlets are not expressible
+        if (line.find("#@#") != std::string::npos || line.find("#?#") != std::string::npos ||
+            line.find("#$#") != std::string::npos || line.find("#%#") != std::string::npos)
+            continue;
+
+        size_t hide = line.find("##");
+        if (hide != std::string::npos) {
+            std::string selector = line.substr(hide + 2);
+            if (selector.empty() || is_extended_selector(selector)) continue;
+
+            if (hide == 0) {
+                generic_selectors.push_back(selector);
+            } else {
+                Trigger trigger;
+                parse_domains(line.substr(0, hide), ',', trigger.if_domains,
+                              trigger.unless_domains);
+                hides.push_back(rule_json(trigger, "css-display-none", &selector));
+            }
+            continue;
+        }
+
+        bool exception = line.compare(0, 2, "@@") == 0;
+        if (exception) line.erase(0, 2);
+
+        Trigger trigger;
+        std::string pattern = line;
+        std::string options;
+        size_t dollar = line.rfind('$');
+        if (dollar != std::string::npos) {
+            pattern = line.substr(0, dollar);
+            options = line.substr(dollar + 1);
+        }
+        // Exceptions keep the resource types of their options (subresources
+        // when untyped): an exception that also matched the document load
+        // would cancel every element-hiding rule on the page
+        if (!apply_options(options, trigger)) continue;
+
+        // /regex/ rules use syntax WebKit's matcher does not support
+        if (pattern.size() > 1 && pattern.front() == '/' && pattern.back() == '/') continue;
+
+        for (const auto& regex : pattern_to_regexes(pattern)) {
+            trigger.url_filter = regex;
+            (exception ? exceptions : blocks).push_back(
+                rule_json(trigger, exception ? "ignore-previous-rules" : "block"));
+        }
+    }
+
+    for (size_t i = 0; i < generic_selectors.size(); i += SELECTORS_PER_RULE) {
+        std::string selector;
+        size_t end = std::min(generic_selectors.size(), i + SELECTORS_PER_RULE);
+        for (size_t j = i; j < end; ++j) {
+            if (j > i) selector += ", ";
+            selector += generic_selectors[j];
+        }
+        hides.push_back(rule_json(Trigger(), "css-display-none", &selector));
+    }
+
+    std::string json = "[";
+    guint count = 0;
+    for (const auto* group : { &blocks, &hides, &exceptions }) {
+        for (const auto& rule : *group) {
+            if (count == MAX_RULES) break;
+            if (count++) json += ',';
+            json += rule;
+        }
+    }
+    json += ']';
+
+    if (count == MAX_RULES) {
+        g_printerr("COLOSSUS-NAN: Filter list truncated to %u rules\n", MAX_RULES);
+    }
+    if (rule_count) *rule_count = count;
+    return json;
+}
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+struct ContentFilters::ListJob {
+    ContentFilters* owner = nullptr;
+    GCancellable* cancellable = nullptr;    // owner is gone once cancelled
+    std::string path;                       // or the name of a built-in list
+    std::string identifier;
+    bool easylist = false;
+    GBytes* contents = nullptr;
+
+    ~ListJob()
+    {
+        if (contents) g_bytes_unref(contents);
+        g_clear_object(&cancellable);
+    }
+};
+
+ContentFilters::ContentFilters(WebKitUserContentManager* manager)
+    : manager_(manager)
+{
+    gchar* dir = g_build_filename(g_get_user_cache_dir(), "colossus-nan",
+                                  "content-filters", nullptr);
+    store_ = webkit_user_content_filter_store_new(dir);
+    g_free(dir);
+
+    cancellable_ = g_cancellable_new();
+}
+
+ContentFilters::~ContentFilters()
+{
+    g_cancellable_cancel(cancellable_);
+    g_clear_object(&cancellable_);
+    g_clear_object(&store_);
+}
+
+std::vector<std::string> ContentFilters::list_dirs()
+{
+    std::vector<std::string> dirs;
+
+    const gchar* env = g_getenv("COLOSSUS_FILTERS_DIR");
+    if (env && *env) dirs.push_back(env);
+
+    gchar* user = g_build_filename(g_get_user_config_dir(), "colossus-nan", "filters", nullptr);
+    dirs.push_back(user);
+    g_free(user);
+
+    dirs.push_back("/usr/local/share/colossus-nan/filters");
+    return dirs;
+}
+
+// ───────────────────────────────────────────────
+//  Loading
+// ───────────────────────────────────────────────
+
+void ContentFilters::add_builtin(const std::string& name, const std::string& json)
+{
+    builtins_.emplace_back(name, json);
+}
+
+void ContentFilters::load()
+{
+    for (const auto& builtin : builtins_) {
+        auto* job = new ListJob;
+        job->owner = this;
+        job->cancellable = G_CANCELLABLE(g_object_ref(cancellable_));
+        job->path = builtin.first;
+        job->contents = g_bytes_new(builtin.second.data(), builtin.second.size());
+
+        ++lists_pending_;
+        prepare(job);
+    }
+
+    // First list of a given file name wins (user lists shadow system ones)
+    std::set<std::string> seen;
+
+    for (const auto& dir : list_dirs()) {
+        GDir* handle = g_dir_open(dir.c_str(), 0, nullptr);
+        if (!handle) continue;
+
+        std::vector<std::string> names;
+        while (const gchar* name = g_dir_read_name(handle)) {
+            if (g_str_has_suffix(name, ".json") || g_str_has_suffix(name, ".txt"))
+                names.push_back(name);
+        }
+        g_dir_close(handle);
+        std::sort(names.begin(), names.end());
+
+        for (const auto& name : names) {
+            if (!seen.insert(name).second) continue;
+
+            gchar* path = g_build_filename(dir.c_str(), name.c_str(), nullptr);
+            auto* job = new ListJob;
+            job->owner = this;
+            job->cancellable = G_CANCELLABLE(g_object_ref(cancellable_));
+            job->path = path;
+            job->easylist = g_str_has_suffix(name.c_str(), ".txt");
+            g_free(path);
+
+            ++lists_pending_;
+            prepare(job);
+        }
+    }
+
+    if (lists_pending_ == 0) {
+        remove_stale_identifiers();
+    }
+}
+
+void ContentFilters::prepare(ListJob* job)
+{
+    GTask* task = g_task_new(nullptr, job->cancellable, s_prepared, job);
+    g_task_set_task_data(task, job, nullptr);
+    g_task_run_in_thread(task, s_prepare_thread);
+    g_object_unref(task);
+}
+
+// Worker: read the list (built-ins are already in memory) and derive its
+// store identifier from name, converter version and hash
+void ContentFilters::s_prepare_thread(GTask* task, gpointer, gpointer task_data,
+                                      GCancellable*)
+{
+    auto* job = static_cast<ListJob*>(task_data);
+
+    if (!job->contents) {
+        gchar* contents = nullptr;
+        gsize length = 0;
+        GError* error = nullptr;
+        if (!g_file_get_contents(job->path.c_str(), &contents, &length, &error)) {
+            g_task_return_error(task, error);
+            return;
+        }
+        job->contents = g_bytes_new_take(contents, length);
+    }
+
+    gchar* base = g_path_get_basename(job->path.c_str());
+    std::string name;
+    for (const char* p = base; *p; ++p) {
+        name += g_ascii_isalnum(*p) ? *p : '_';
+    }
+    g_free(base);
+
+    gchar* hash = g_compute_checksum_for_bytes(G_CHECKSUM_SHA256, job->contents);
+    job->identifier = name + "-v" + std::to_string(CONVERTER_VERSION) + "-" +
+                      std::string(hash).substr(0, 16);
+    g_free(hash);
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void ContentFilters::on_prepared(ListJob* job, GError* error)
+{
+    if (error) {
+        g_printerr("COLOSSUS-NAN: Cannot read filter list %s: %s\n",
+                   job->path.c_str(), error->message);
+        list_done(job);
+        return;
+    }
+
+    identifiers_.insert(job->identifier);
+
+    // Already compiled on an earlier start?
+    webkit_user_content_filter_store_load(store_, job->identifier.c_str(),
+                                          job->cancellable, s_loaded, job);
+}
+
+void ContentFilters::on_loaded(ListJob* job, WebKitUserContentFilter* filter)
+{
+    if (filter) {
+        COLOSSUS_TRACE("filter list %s loaded from store\n", job->identifier.c_str());
+        attach(job, filter);
+        list_done(job);
+        return;
+    }
+
+    if (!job->easylist) {
+        on_converted(job, g_bytes_ref(job->contents), nullptr);
+        return;
+    }
+
+    GTask* task = g_task_new(nullptr, job->cancellable, s_converted, job);
+    g_task_set_task_data(task, job, nullptr);
+    g_task_run_in_thread(task, s_convert_thread);
+    g_object_unref(task);
+}
+
+// Worker: EasyList text → WebKit JSON
+void ContentFilters::s_convert_thread(GTask* task, gpointer, gpointer task_data,
+                                      GCancellable*)
+{
+    auto* job = static_cast<ListJob*>(task_data);
+
+    gsize size = 0;
+    const auto* data = static_cast<const char*>(g_bytes_get_data(job->contents, &size));
+    guint rules = 0;
+    std::string json = convert_easylist(std::string(data, size), &rules);
+
+    COLOSSUS_TRACE("filter list %s: %u WebKit rules\n", job->path.c_str(), rules);
+
+    g_task_return_pointer(task, g_bytes_new(json.data(), json.size()),
+                          reinterpret_cast<GDestroyNotify>(g_bytes_unref));
+}
+
+void ContentFilters::on_converted(ListJob* job, GBytes* json, GError* error)
+{
+    if (!json) {
+        g_printerr("COLOSSUS-NAN: Cannot convert filter list %s: %s\n",
+                   job->path.c_str(), error ? error->message : "unknown error");
+        list_done(job);
+        return;
+    }
+
+    // Compiles in WebKit's own thread and persists the result
+    webkit_user_content_filter_store_save(store_, job->identifier.c_str(), json,
+                                          job->cancellable, s_saved, job);
+    g_bytes_unref(json);
+}
+
+void ContentFilters::on_saved(ListJob* job, WebKitUserContentFilter* filter, GError* error)
+{
+    if (!filter) {
+        g_printerr("COLOSSUS-NAN: Cannot compile filter list %s: %s\n",
+                   job->path.c_str(), error ? error->message : "unknown error");
+    } else {
+        COLOSSUS_TRACE("filter list %s compiled\n", job->identifier.c_str());
+        attach(job, filter);
+    }
+    list_done(job);
+}
+
+void ContentFilters::attach(ListJob*, WebKitUserContentFilter* filter)
+{
+    webkit_user_content_manager_add_filter(manager_, filter);
+    webkit_user_content_filter_unref(filter);
+    ++lists_active_;
+}
+
+void ContentFilters::list_done(ListJob* job)
+{
+    delete job;
+
+    if (lists_pending_ && --lists_pending_ == 0) {
+        remove_stale_identifiers();
+    }
+}
+
+// Drop compiled lists whose source changed or was removed
+void ContentFilters::remove_stale_identifiers()
+{
+    auto* job = new ListJob;
+    job->owner = this;
+    job->cancellable = G_CANCELLABLE(g_object_ref(cancellable_));
+
+    webkit_user_content_filter_store_fetch_identifiers(store_, job->cancellable,
+                                                       s_identifiers_fetched, job);
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+void ContentFilters::s_prepared(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    auto* job = static_cast<ListJob*>(user_data);
+    if (g_cancellable_is_cancelled(job->cancellable)) {
+        delete job;
+        return;
+    }
+
+    GError* error = nullptr;
+    g_task_propagate_boolean(G_TASK(result), &error);
+    job->owner->on_prepared(job, error);
+    if (error) g_error_free(error);
+}
+
+void ContentFilters::s_loaded(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    auto* job = static_cast<ListJob*>(user_data);
+    if (g_cancellable_is_cancelled(job->cancellable)) {
+        delete job;
+        return;
+    }
+
+    // A miss is reported as an error; it just means "compile it"
+    GError* error = nullptr;
+    WebKitUserContentFilter* filter = webkit_user_content_filter_store_load_finish(
+        WEBKIT_USER_CONTENT_FILTER_STORE(source), result, &error);
+    if (error) g_error_free(error);
+
+    job->owner->on_loaded(job, filter);
+}
+
+void ContentFilters::s_converted(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    auto* job = static_cast<ListJob*>(user_data);
+    if (g_cancellable_is_cancelled(job->cancellable)) {
+        delete job;
+        return;
+    }
+
+    GError* error = nullptr;
+    auto* json = static_cast<GBytes*>(g_task_propagate_pointer(G_TASK(result), &error));
+    job->owner->on_converted(job, json, error);
+    if (error) g_error_free(error);
+}
+
+void ContentFilters::s_saved(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    auto* job = static_cast<ListJob*>(user_data);
+    if (g_cancellable_is_cancelled(job->cancellable)) {
+        delete job;
+        return;
+    }
+
+    GError* error = nullptr;
+    WebKitUserContentFilter* filter = webkit_user_content_filter_store_save_finish(
+        WEBKIT_USER_CONTENT_FILTER_STORE(source), result, &error);
+    job->owner->on_saved(job, filter, error);
+    if (error) g_error_free(error);
+}
+
+void ContentFilters::s_identifiers_fetched(GObject* source, GAsyncResult* result,
+                                           gpointer user_data)
+{
+    auto* job = static_cast<ListJob*>(user_data);
+    if (g_cancellable_is_cancelled(job->cancellable)) {
+        delete job;
+        return;
+    }
+
+    auto* store = WEBKIT_USER_CONTENT_FILTER_STORE(source);
+    gchar** ids = webkit_user_content_filter_store_fetch_identifiers_finish(store, result);
+    for (gchar** id = ids; id && *id; ++id) {
+        if (job->owner->identifiers_.count(*id)) continue;
+
+        COLOSSUS_TRACE("removing stale filter list %s\n", *id);
+        webkit_user_content_filter_store_remove(store, *id, nullptr, s_removed, nullptr);
+    }
+    g_strfreev(ids);
+    delete job;
+}
+
+void ContentFilters::s_removed(GObject* source, GAsyncResult* result, gpointer)
+{
+    GError* error = nullptr;
+    webkit_user_content_filter_store_remove_finish(
+        WEBKIT_USER_CONTENT_FILTER_STORE(source), result, &error);
+    if (error) g_error_free(error);
+}
@@ -0,0 +1,82 @@
+// content_filters.h — COLOSSUS content-blocking filter lists
+
+#ifndef COLOSSUS_CONTENT_FILTERS_H
+#define COLOSSUS_CONTENT_FILTERS_H
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+// Compiles filter lists with WebKitUserContentFilterStore and attaches them
+// to the shared user-content manager. Accepts WebKit content-blocker JSON
+// (*.json) and EasyList/Adblock Plus syntax (*.txt, converted here).
+//
+// Compiled lists are stored under an identifier derived from the list's
+// name, the converter version and the content hash, so unchanged lists
+// load straight from the store on later starts; entries for lists that changed or disappeared are
+// removed once every list has been handled.
+class ContentFilters {
+public:
+    explicit ContentFilters(WebKitUserContentManager* manager);
+    ~ContentFilters();
+
+    ContentFilters(const ContentFilters&) = delete;
+    ContentFilters& operator=(const ContentFilters&) = delete;
+
+    // Register a list that ships with the browser (WebKit JSON); call
+    // before load()
+    void add_builtin(const std::string& name, const std::string& json);
+
+    // Scan the list directories and load/compile everything asynchronously
+    void load();
+
+    guint lists_active() const { return lists_active_; }
+
+    // Convert Adblock Plus syntax to WebKit content-blocker JSON.
+    // Unsupported rules (regex patterns, snippets, $redirect, ...) are skipped.
+    static std::string convert_easylist(const std::string& text, guint* rule_count);
+
+    // Directories searched for lists, in order
+    static std::vector<std::string> list_dirs();
+
+private:
+    WebKitUserContentManager* manager_ = nullptr;
+    WebKitUserContentFilterStore* store_ = nullptr;
+    GCancellable* cancellable_ = nullptr;
+
+    std::vector<std::pair<std::string, std::string>> builtins_;    // name, JSON
+    std::set<std::string> identifiers_;     // current lists, kept in the store
+    guint lists_pending_ = 0;
+    guint lists_active_ = 0;
+
+    struct ListJob;
+
+    void prepare(ListJob* job);
+    void on_prepared(ListJob* job, GError* error);
+    void on_loaded(ListJob* job, WebKitUserContentFilter* filter);
+    void on_converted(ListJob* job, GBytes* json, GError* error);
+    void on_saved(ListJob* job, WebKitUserContentFilter* filter, GError* error);
+    void attach(ListJob* job, WebKitUserContentFilter* filter);
+    void list_done(ListJob* job);
+    void remove_stale_identifiers();
+
+    static void s_prepare_thread(GTask* task, gpointer source, gpointer task_data,
+                                 GCancellable* cancellable);
+    static void s_prepared(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_loaded(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_convert_thread(GTask* task, gpointer source, gpointer task_data,
+                                 GCancellable* cancellable);
+    static void s_converted(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_saved(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_identifiers_fetched(GObject* source, GAsyncResult* result,
+                                      gpointer user_data);
+    static void s_removed(GObject* source, GAsyncResult* result, gpointer user_data);
+};
+
+#endif // COLOSSUS_CONTENT_FILTERS_H
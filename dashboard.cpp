@@ -0,0 +1,180 @@
+// dashboard.cpp — COLOSSUS about:colossus performance page (colossus:// scheme)
+
+#include "dashboard.h"
+#include "app_resources.h"
+#include "proc_stats.h"
+#include "trace.h"
+
+#include <map>
+
+#include <unistd.h>
+
+namespace {
+
+// Handed to WebKit with the scheme; outlives the dashboard, which clears it
+struct Registration {
+    Dashboard* dashboard = nullptr;
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+Dashboard::Dashboard(WebKitWebContext* context)
+    : context_(context)
+{
+    json_ = jsc_context_new();
+    page_ = colossus_resource_text("dashboard.html");
+
+    auto* registration = new Registration{ this };
+    g_object_set_data_full(G_OBJECT(context_), "colossus-dashboard", registration,
+                           [](gpointer p) { delete static_cast<Registration*>(p); });
+    webkit_web_context_register_uri_scheme(context_, SCHEME, s_request,
+                                           registration, nullptr);
+
+    WebKitSecurityManager* security = webkit_web_context_get_security_manager(context_);
+    webkit_security_manager_register_uri_scheme_as_local(security, SCHEME);
+}
+
+Dashboard::~Dashboard()
+{
+    auto* registration = static_cast<Registration*>(
+        g_object_get_data(G_OBJECT(context_), "colossus-dashboard"));
+    if (registration) registration->dashboard = nullptr;
+
+    g_clear_object(&json_);
+}
+
+bool Dashboard::is_dashboard(const char* uri)
+{
+    return uri && g_str_has_prefix(uri, URI);
+}
+
+// ───────────────────────────────────────────────
+//  Page
+// ───────────────────────────────────────────────
+
+void Dashboard::on_request(WebKitURISchemeRequest* request)
+{
+    if (!is_dashboard(webkit_uri_scheme_request_get_uri(request)) || page_.empty()) {
+        GError* error = g_error_new(G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                                    "No such %s page", SCHEME);
+        webkit_uri_scheme_request_finish_error(request, error);
+        g_error_free(error);
+        return;
+    }
+
+    GBytes* bytes = g_bytes_new_static(page_.data(), page_.size());
+    GInputStream* stream = g_memory_input_stream_new_from_bytes(bytes);
+    webkit_uri_scheme_request_finish(request, stream, static_cast<gint64>(page_.size()),
+                                     "text/html");
+    g_object_unref(stream);
+    g_bytes_unref(bytes);
+}
+
+// ───────────────────────────────────────────────
+//  Snapshots
+// ───────────────────────────────────────────────
+
+std::string Dashboard::json_string(const std::string& s)
+{
+    JSCValue* value = jsc_value_new_string(json_, s.c_str());
+    gchar* encoded = jsc_value_to_json(value, 0);
+    std::string out = encoded ? encoded : "\"\"";
+    g_free(encoded);
+    g_object_unref(value);
+    return out;
+}
+
+// Web-process RSS is read here, once per process, rather than collected by
+// the browser: it is only ever wanted while the page is on screen
+std::string Dashboard::to_json(const Snapshot& snapshot)
+{
+    std::map<int, double> rss;
+    for (const auto& tab : snapshot.tabs) {
+        if (tab.web_pid > 0 && !rss.count(tab.web_pid)) {
+            rss[tab.web_pid] = colossus_process_rss_kb(tab.web_pid);
+        }
+    }
+
+    double web_rss_kb = 0.0;
+    for (const auto& entry : rss) {
+        if (entry.second > 0) web_rss_kb += entry.second;
+    }
+
+    std::string json = "{\"tabs\":[";
+    for (size_t i = 0; i < snapshot.tabs.size(); ++i) {
+        const TabRow& tab = snapshot.tabs[i];
+        if (i) json += ',';
+        json += "{\"state\":" + json_string(tab.state) +
+                ",\"uri\":" + json_string(tab.uri) +
+                ",\"title\":" + json_string(tab.title) +
+                ",\"current\":" + (tab.current ? "true" : "false") +
+                ",\"committed\":" + colossus_format_metric(tab.committed_ms) +
+                ",\"finished\":" + colossus_format_metric(tab.finished_ms) +
+                ",\"firstRow\":" + colossus_format_metric(tab.first_row_ms) +
+                ",\"terminal\":" + colossus_format_metric(tab.terminal_ms) +
+                ",\"extract\":" + colossus_format_metric(tab.extract_ms) +
+                ",\"fx\":" + json_string(tab.render_tier) +
+                ",\"frame\":" + colossus_format_metric(tab.frame_ms) +
+                ",\"pid\":" + std::to_string(tab.web_pid) +
+                ",\"rssKb\":" + colossus_format_metric(tab.web_pid > 0 ? rss[tab.web_pid] : -1.0) +
+                ",\"requests\":" + std::to_string(tab.requests) +
+                ",\"blocked\":" + std::to_string(tab.blocked) +
+                ",\"bytes\":" + std::to_string(tab.bytes) +
+                ",\"savedBytes\":" + std::to_string(tab.bytes_saved) + "}";
+    }
+
+    json += "],\"global\":{\"processes\":" + std::to_string(snapshot.processes) +
+            ",\"processHint\":" + std::to_string(snapshot.process_hint) +
+            ",\"webRssKb\":" + colossus_format_metric(web_rss_kb) +
+            ",\"uiRssKb\":" + colossus_format_metric(colossus_process_rss_kb(getpid())) +
+            ",\"poolSize\":" + std::to_string(snapshot.pool_size) +
+            ",\"poolTarget\":" + std::to_string(snapshot.pool_target) +
+            ",\"imgHits\":" + std::to_string(snapshot.img_hits) +
+            ",\"imgTranscoded\":" + std::to_string(snapshot.img_transcoded) +
+            ",\"imgFailures\":" + std::to_string(snapshot.img_failures) +
+            ",\"streamHits\":" + std::to_string(snapshot.stream_hits) +
+            ",\"streamMisses\":" + std::to_string(snapshot.stream_misses) +
+            ",\"streamsCached\":" + std::to_string(snapshot.streams_cached) +
+            ",\"viewHits\":" + std::to_string(snapshot.view_hits) +
+            ",\"viewMisses\":" + std::to_string(snapshot.view_misses) +
+            ",\"viewsCached\":" + std::to_string(snapshot.views_cached) +
+            ",\"specHits\":" + std::to_string(snapshot.speculation_hits) +
+            ",\"specMisses\":" + std::to_string(snapshot.speculation_misses) +
+            ",\"preloads\":" + std::to_string(snapshot.preloads) +
+            ",\"preloadsWasted\":" + std::to_string(snapshot.preloads_wasted) +
+            ",\"specSavedMs\":" + colossus_format_metric(snapshot.speculation_saved_ms) +
+            ",\"historyEntries\":" + std::to_string(snapshot.history_entries) + "}}";
+    return json;
+}
+
+void Dashboard::refresh(WebKitWebView* view, const Snapshot& snapshot)
+{
+    if (!view || !is_dashboard(webkit_web_view_get_uri(view))) return;
+
+    std::string js = "window.colossusDashboard && window.colossusDashboard.update(" +
+                     to_json(snapshot) + ");";
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_view_run_javascript(view, js.c_str(), nullptr, nullptr, nullptr);
+#pragma GCC diagnostic pop
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+void Dashboard::s_request(WebKitURISchemeRequest* request, gpointer user_data)
+{
+    auto* registration = static_cast<Registration*>(user_data);
+    if (!registration || !registration->dashboard) {
+        GError* error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CANCELLED, "Shutting down");
+        webkit_uri_scheme_request_finish_error(request, error);
+        g_error_free(error);
+        return;
+    }
+    registration->dashboard->on_request(request);
+}
@@ -0,0 +1,92 @@
+// dashboard.h — COLOSSUS about:colossus performance page (colossus:// scheme)
+
+#ifndef COLOSSUS_DASHBOARD_H
+#define COLOSSUS_DASHBOARD_H
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+#include <jsc/jsc.h>
+}
+
+// Serves colossus://dashboard (typed as about:colossus): a static page from
+// the embedded resources that renders whatever snapshot it is handed. The
+// browser pushes snapshots into it with refresh() while it is the current
+// tab and not otherwise, so a closed or backgrounded dashboard costs
+// nothing. The scheme is local: web pages can neither link to nor embed it.
+class Dashboard {
+public:
+    static constexpr const char* SCHEME = "colossus";
+    static constexpr const char* URI = "colossus://dashboard";
+    static constexpr const char* ALIAS = "about:colossus";
+
+    // Milestones in ms since the load started, -1 when not reached
+    struct TabRow {
+        std::string state;
+        std::string uri;
+        std::string title;
+        bool current = false;
+        double committed_ms = -1.0;
+        double finished_ms = -1.0;
+        double first_row_ms = -1.0;
+        double terminal_ms = -1.0;
+        double extract_ms = -1.0;   // browser.js page-model extraction
+        std::string render_tier;    // CRT effect tier, empty until reported
+        double frame_ms = -1.0;     // mean frame interval of the last scroll
+        int web_pid = 0;
+        guint requests = 0;
+        guint blocked = 0;
+        guint64 bytes = 0;
+        guint64 bytes_saved = 0;    // estimated, see Browser::on_resource_failed
+    };
+
+    struct Snapshot {
+        std::vector<TabRow> tabs;
+        guint processes = 0;        // distinct web-process PIDs reported
+        guint process_hint = 0;
+        guint pool_size = 0;
+        guint pool_target = 0;
+        guint64 img_hits = 0;       // colossus-img:// served from disk
+        guint64 img_transcoded = 0;
+        guint64 img_failures = 0;
+        guint64 stream_hits = 0;    // plays with streams already resolved
+        guint64 stream_misses = 0;
+        guint streams_cached = 0;
+        guint64 view_hits = 0;      // committed pages with a cached terminal view
+        guint64 view_misses = 0;
+        guint views_cached = 0;
+        guint64 speculation_hits = 0;       // followed links that were preloaded
+        guint64 speculation_misses = 0;
+        guint64 preloads = 0;
+        guint64 preloads_wasted = 0;        // dropped unused
+        double speculation_saved_ms = 0.0;  // load time already done at the click
+        size_t history_entries = 0;
+    };
+
+    explicit Dashboard(WebKitWebContext* context);
+    ~Dashboard();
+
+    Dashboard(const Dashboard&) = delete;
+    Dashboard& operator=(const Dashboard&) = delete;
+
+    static bool is_dashboard(const char* uri);
+
+    // Render `snapshot` in a view showing the dashboard
+    void refresh(WebKitWebView* view, const Snapshot& snapshot);
+
+private:
+    WebKitWebContext* context_ = nullptr;
+    JSCContext* json_ = nullptr;        // string encoding only
+    std::string page_;
+
+    std::string to_json(const Snapshot& snapshot);
+    std::string json_string(const std::string& s);
+    void on_request(WebKitURISchemeRequest* request);
+
+    static void s_request(WebKitURISchemeRequest* request, gpointer user_data);
+};
+
+#endif // COLOSSUS_DASHBOARD_H
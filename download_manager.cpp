@@ -0,0 +1,969 @@
+// download_manager.cpp — COLOSSUS download queue with segmented range fetches
+
+#include "download_manager.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+extern "C" {
+#include <libsoup/soup.h>
+}
+
+namespace {
+
+// Smaller files are not worth splitting; each segment gets at least this
+const guint64 SEGMENT_MIN_BYTES = 4 * 1024 * 1024;
+
+// Read and pwrite() size
+const gsize IO_BLOCK_BYTES = 1024 * 1024;
+
+// A worker syncs its data and saves the segment table after this many bytes
+const guint64 CHECKPOINT_BYTES = 8 * 1024 * 1024;
+
+const guint REQUEST_TIMEOUT_S = 30;
+const guint MAX_REDIRECTS = 10;
+const char* PART_SUFFIX = ".part";
+const char* STATE_GROUP = "download";
+
+// [start, end) of the file; end 0 is "until the server stops" (size unknown).
+// `done` bytes are synced to disk and saved; `written` counts the rest too.
+struct Segment {
+    guint64 start = 0;
+    guint64 end = 0;
+    guint64 done = 0;
+    guint64 written = 0;
+};
+
+struct SegmentData {
+    std::shared_ptr<DownloadFile> file;
+    guint id = 0;
+    size_t index = 0;
+};
+
+struct CookieRequest {
+    DownloadManager* manager = nullptr;
+    std::weak_ptr<bool> alive;
+    guint id = 0;
+};
+
+bool is_http(const std::string& url)
+{
+    return g_str_has_prefix(url.c_str(), "http://") || g_str_has_prefix(url.c_str(), "https://");
+}
+
+bool write_all(int fd, const char* data, size_t size, off_t offset)
+{
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+// Scheme, host and port; a Cookie header is only sent within one origin
+bool same_origin(const std::string& a, const std::string& b)
+{
+    GUri* ua = g_uri_parse(a.c_str(), G_URI_FLAGS_NONE, nullptr);
+    GUri* ub = g_uri_parse(b.c_str(), G_URI_FLAGS_NONE, nullptr);
+    bool same = ua && ub &&
+                g_ascii_strcasecmp(g_uri_get_scheme(ua), g_uri_get_scheme(ub)) == 0 &&
+                g_ascii_strcasecmp(g_uri_get_host(ua) ? g_uri_get_host(ua) : "",
+                                   g_uri_get_host(ub) ? g_uri_get_host(ub) : "") == 0 &&
+                g_uri_get_port(ua) == g_uri_get_port(ub);
+    if (ua) g_uri_unref(ua);
+    if (ub) g_uri_unref(ub);
+    return same;
+}
+
+SoupMessageHeaders* request_headers(SoupMessage* message)
+{
+#if SOUP_CHECK_VERSION(3, 0, 0)
+    return soup_message_get_request_headers(message);
+#else
+    return message->request_headers;
+#endif
+}
+
+SoupMessageHeaders* response_headers(SoupMessage* message)
+{
+#if SOUP_CHECK_VERSION(3, 0, 0)
+    return soup_message_get_response_headers(message);
+#else
+    return message->response_headers;
+#endif
+}
+
+guint status_of(SoupMessage* message)
+{
+#if SOUP_CHECK_VERSION(3, 0, 0)
+    return soup_message_get_status(message);
+#else
+    return message->status_code;
+#endif
+}
+
+std::string format_segments(const std::vector<Segment>& segments)
+{
+    std::string out;
+    for (const Segment& s : segments) {
+        if (!out.empty()) out += ';';
+        out += std::to_string(s.start) + ':' + std::to_string(s.end) + ':' + std::to_string(s.done);
+    }
+    return out;
+}
+
+bool parse_segments(const gchar* text, std::vector<Segment>& out)
+{
+    if (!text || !*text) return false;
+
+    gchar** parts = g_strsplit(text, ";", -1);
+    bool ok = true;
+    for (gchar** part = parts; *part && ok; ++part) {
+        Segment s;
+        guint64 start = 0, end = 0, done = 0;
+        ok = sscanf(*part, "%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT,
+                    &start, &end, &done) == 3 &&
+             (end == 0 || start + done <= end);
+        s.start = start;
+        s.end = end;
+        s.done = done;
+        s.written = done;
+        if (ok) out.push_back(s);
+    }
+    g_strfreev(parts);
+    return ok && !out.empty();
+}
+
+// Content-Length of a response, 0 when it has none
+guint64 content_length(SoupMessageHeaders* headers)
+{
+    if (soup_message_headers_get_encoding(headers) != SOUP_ENCODING_CONTENT_LENGTH) return 0;
+    return static_cast<guint64>(soup_message_headers_get_content_length(headers));
+}
+
+} // namespace
+
+// Shared between a running download and its segment workers. The segment
+// table is behind `lock`; everything else is fixed once workers start.
+struct DownloadFile {
+    std::string url;
+    std::string dest;
+    std::string part_path;
+    std::string state_path;
+    std::string referer;
+    std::string user_agent;
+    std::string cookies;
+    std::string validator;
+    guint64 total = 0;
+    bool ranges = false;
+    int fd = -1;
+
+    GMutex lock;
+    std::vector<Segment> segments;
+
+    DownloadFile() { g_mutex_init(&lock); }
+    ~DownloadFile()
+    {
+        if (fd >= 0) close(fd);
+        g_mutex_clear(&lock);
+    }
+
+    guint64 received()
+    {
+        g_mutex_lock(&lock);
+        guint64 sum = 0;
+        for (const Segment& s : segments) sum += s.written;
+        g_mutex_unlock(&lock);
+        return sum;
+    }
+
+    // Only what has been synced may be recorded as done, so callers
+    // fdatasync() first. Best effort: a lost save costs a refetch.
+    void save_state()
+    {
+        g_mutex_lock(&lock);
+        std::string table = format_segments(segments);
+        g_mutex_unlock(&lock);
+
+        GKeyFile* key_file = g_key_file_new();
+        g_key_file_set_string(key_file, STATE_GROUP, "url", url.c_str());
+        g_key_file_set_string(key_file, STATE_GROUP, "dest", dest.c_str());
+        g_key_file_set_string(key_file, STATE_GROUP, "referer", referer.c_str());
+        g_key_file_set_string(key_file, STATE_GROUP, "user_agent", user_agent.c_str());
+        g_key_file_set_uint64(key_file, STATE_GROUP, "total", total);
+        g_key_file_set_boolean(key_file, STATE_GROUP, "ranges", ranges);
+        g_key_file_set_string(key_file, STATE_GROUP, "validator", validator.c_str());
+        g_key_file_set_string(key_file, STATE_GROUP, "segments", table.c_str());
+
+        gsize length = 0;
+        gchar* data = g_key_file_to_data(key_file, &length, nullptr);
+        g_file_set_contents(state_path.c_str(), data, static_cast<gssize>(length), nullptr);
+        g_free(data);
+        g_key_file_free(key_file);
+    }
+};
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+DownloadManager::DownloadManager(WebKitWebContext* context,
+                                 const std::string& state_dir,
+                                 guint max_active,
+                                 guint max_segments)
+    : context_(context),
+      state_dir_(state_dir),
+      max_active_(max_active ? max_active : 1),
+      max_segments_(max_segments ? max_segments : 1),
+      cancellable_(g_cancellable_new())
+{
+    const gchar* downloads = g_get_user_special_dir(G_USER_DIRECTORY_DOWNLOAD);
+    if (downloads) {
+        download_dir_ = downloads;
+    } else {
+        gchar* fallback = g_build_filename(g_get_home_dir(), "Downloads", nullptr);
+        download_dir_ = fallback;
+        g_free(fallback);
+    }
+    g_mkdir_with_parents(download_dir_.c_str(), 0755);
+    g_mkdir_with_parents(state_dir_.c_str(), 0700);
+
+    resume_saved();
+}
+
+// Workers see the cancellable, save their segment table and stop; the
+// .part files are picked up again on the next run
+DownloadManager::~DownloadManager()
+{
+    alive_.reset();
+    g_cancellable_cancel(cancellable_);
+    g_object_unref(cancellable_);
+
+    if (tick_source_) g_source_remove(tick_source_);
+
+    for (auto& item : items_) {
+        if (!item->native) continue;
+        g_signal_handlers_disconnect_by_data(item->native, this);
+        g_object_unref(item->native);
+    }
+    items_.clear();
+}
+
+// ───────────────────────────────────────────────
+//  Items
+// ───────────────────────────────────────────────
+
+DownloadManager::Item* DownloadManager::get_item(guint id)
+{
+    for (auto& item : items_) {
+        if (item->id == id) return item.get();
+    }
+    return nullptr;
+}
+
+DownloadManager::Item& DownloadManager::add_item(const std::string& url, const std::string& dest)
+{
+    auto item = std::make_unique<Item>();
+    item->id = next_id_++;
+    item->url = url;
+    item->dest = dest;
+    items_.push_back(std::move(item));
+    return *items_.back();
+}
+
+// "name.ext", then "name (1).ext" and so on: neither the file nor its
+// .part may exist, nor belong to another download
+std::string DownloadManager::unique_destination(const std::string& filename) const
+{
+    gchar* base = g_path_get_basename(filename.empty() ? "download" : filename.c_str());
+    std::string name = base;
+    g_free(base);
+    if (name.empty() || name == "." || name == ".." || name == G_DIR_SEPARATOR_S) name = "download";
+
+    size_t dot = name.rfind('.');
+    if (dot == 0 || dot == std::string::npos) dot = name.size();
+    std::string stem = name.substr(0, dot);
+    std::string ext = name.substr(dot);
+
+    for (guint n = 0;; ++n) {
+        std::string candidate = n ? stem + " (" + std::to_string(n) + ")" + ext : name;
+        gchar* path = g_build_filename(download_dir_.c_str(), candidate.c_str(), nullptr);
+        std::string dest = path;
+        g_free(path);
+
+        bool taken = g_file_test(dest.c_str(), G_FILE_TEST_EXISTS) ||
+                     g_file_test((dest + PART_SUFFIX).c_str(), G_FILE_TEST_EXISTS) ||
+                     std::any_of(items_.begin(), items_.end(),
+                                 [&dest](const std::unique_ptr<Item>& i) { return i->dest == dest; });
+        if (!taken) return dest;
+    }
+}
+
+std::string DownloadManager::state_path(const Item& item) const
+{
+    gchar* digest = g_compute_checksum_for_string(G_CHECKSUM_SHA1, item.dest.c_str(), -1);
+    std::string name = std::string(digest) + ".state";
+    g_free(digest);
+
+    gchar* path = g_build_filename(state_dir_.c_str(), name.c_str(), nullptr);
+    std::string out = path;
+    g_free(path);
+    return out;
+}
+
+void DownloadManager::resume_saved()
+{
+    GDir* dir = g_dir_open(state_dir_.c_str(), 0, nullptr);
+    if (!dir) return;
+
+    while (const gchar* name = g_dir_read_name(dir)) {
+        if (!g_str_has_suffix(name, ".state")) continue;
+
+        gchar* path = g_build_filename(state_dir_.c_str(), name, nullptr);
+        GKeyFile* key_file = g_key_file_new();
+        if (g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, nullptr)) {
+            gchar* url = g_key_file_get_string(key_file, STATE_GROUP, "url", nullptr);
+            gchar* dest = g_key_file_get_string(key_file, STATE_GROUP, "dest", nullptr);
+            gchar* referer = g_key_file_get_string(key_file, STATE_GROUP, "referer", nullptr);
+            gchar* user_agent = g_key_file_get_string(key_file, STATE_GROUP, "user_agent", nullptr);
+
+            if (url && dest && is_http(url)) {
+                Item& item = add_item(url, dest);
+                item.referer = referer ? referer : "";
+                item.user_agent = user_agent ? user_agent : "";
+                item.total = g_key_file_get_uint64(key_file, STATE_GROUP, "total", nullptr);
+                item.ranges = g_key_file_get_boolean(key_file, STATE_GROUP, "ranges", nullptr);
+                gchar* validator = g_key_file_get_string(key_file, STATE_GROUP, "validator", nullptr);
+                item.validator = validator ? validator : "";
+                g_free(validator);
+                COLOSSUS_TRACE("resuming download %s\n", item.dest.c_str());
+                enqueue(item);
+            } else {
+                g_unlink(path);
+            }
+
+            g_free(url);
+            g_free(dest);
+            g_free(referer);
+            g_free(user_agent);
+        }
+        g_key_file_free(key_file);
+        g_free(path);
+    }
+    g_dir_close(dir);
+}
+
+void DownloadManager::enqueue(Item& item)
+{
+    item.state = State::Queued;
+    item.error.clear();
+    queued_.push_back(item.id);
+    start_queued();
+    notify_changed();
+}
+
+void DownloadManager::retry_failed()
+{
+    for (auto& item : items_) {
+        if (item->state == State::Failed && !item->native) enqueue(*item);
+    }
+}
+
+DownloadManager::Summary DownloadManager::summary() const
+{
+    Summary out;
+    for (const auto& item : items_) {
+        switch (item->state) {
+        case State::Queued:
+            ++out.queued;
+            break;
+        case State::Running:
+            ++out.running;
+            if (item->total) {
+                out.received += item->sampled;
+                out.total += item->total;
+            }
+            out.bytes_per_s += item->bytes_per_s;
+            break;
+        case State::Failed:
+            ++out.failed;
+            break;
+        case State::Done:
+            break;
+        }
+    }
+    return out;
+}
+
+// ───────────────────────────────────────────────
+//  Taking over WebKit downloads
+// ───────────────────────────────────────────────
+
+void DownloadManager::adopt(WebKitDownload* download, const std::string& user_agent)
+{
+    g_object_set_data_full(G_OBJECT(download), "colossus-user-agent",
+                           g_strdup(user_agent.c_str()), g_free);
+    g_signal_connect(download, "decide-destination", G_CALLBACK(s_decide_destination), this);
+}
+
+// The first point at which the response is known
+void DownloadManager::on_decide_destination(WebKitDownload* download, const gchar* suggested_filename)
+{
+    g_signal_handlers_disconnect_by_data(download, this);
+
+    WebKitURIRequest* request = webkit_download_get_request(download);
+    WebKitURIResponse* response = webkit_download_get_response(download);
+    const gchar* method = request ? webkit_uri_request_get_http_method(request) : nullptr;
+    const gchar* uri = response ? webkit_uri_response_get_uri(response)
+                                : request ? webkit_uri_request_get_uri(request) : nullptr;
+    std::string url = uri ? uri : "";
+
+    std::string dest = unique_destination(suggested_filename ? suggested_filename : "");
+    Item& item = add_item(url, dest);
+    if (response) item.total = webkit_uri_response_get_content_length(response);
+
+    auto* user_agent = static_cast<const gchar*>(
+        g_object_get_data(G_OBJECT(download), "colossus-user-agent"));
+    item.user_agent = user_agent ? user_agent : "";
+
+    // Only a plain GET can be fetched again without WebKit
+    if (!is_http(url) || (method && g_strcmp0(method, "GET") != 0)) {
+        gchar* dest_uri = g_filename_to_uri(dest.c_str(), nullptr, nullptr);
+        webkit_download_set_destination(download, dest_uri);
+        g_free(dest_uri);
+
+        item.state = State::Running;
+        item.native = WEBKIT_DOWNLOAD(g_object_ref(download));
+        g_signal_connect(download, "failed", G_CALLBACK(s_native_failed), this);
+        g_signal_connect(download, "finished", G_CALLBACK(s_native_finished), this);
+        COLOSSUS_TRACE("download (WebKit) %s -> %s\n", url.c_str(), dest.c_str());
+        schedule_tick();
+        notify_changed();
+        return;
+    }
+
+    SoupMessageHeaders* sent = request ? webkit_uri_request_get_http_headers(request) : nullptr;
+    const char* referer = sent ? soup_message_headers_get_one(sent, "Referer") : nullptr;
+    if (referer) item.referer = referer;
+
+    SoupMessageHeaders* received = response ? webkit_uri_response_get_http_headers(response) : nullptr;
+    const char* accept = received ? soup_message_headers_get_one(received, "Accept-Ranges") : nullptr;
+    item.ranges = item.total > 0 && accept && g_ascii_strcasecmp(accept, "bytes") == 0;
+
+    // Weak ETags cannot be used with If-Range
+    const char* etag = received ? soup_message_headers_get_one(received, "ETag") : nullptr;
+    const char* modified = received ? soup_message_headers_get_one(received, "Last-Modified") : nullptr;
+    if (etag && !g_str_has_prefix(etag, "W/")) {
+        item.validator = etag;
+    } else if (modified) {
+        item.validator = modified;
+    }
+
+    webkit_download_cancel(download);
+
+    COLOSSUS_TRACE("download %s -> %s (%" G_GUINT64_FORMAT " bytes%s)\n", url.c_str(),
+                   dest.c_str(), item.total, item.ranges ? ", ranges" : "");
+    enqueue(item);
+}
+
+void DownloadManager::on_native_finished(WebKitDownload* download, GError* error)
+{
+    for (auto& item : items_) {
+        if (item->native != download) continue;
+
+        if (error) {
+            // "finished" follows "failed"; the first word stands
+            item->state = State::Failed;
+            item->error = error->message;
+            return;
+        }
+
+        g_signal_handlers_disconnect_by_data(download, this);
+        if (item->state == State::Running) {
+            guint64 received = webkit_download_get_received_data_length(download);
+            bytes_total_ += received - std::min(received, item->sampled);
+            item->state = State::Done;
+        }
+        COLOSSUS_TRACE("download (WebKit) %s: %s\n", item->state == State::Done ? "done" : "failed",
+                       item->dest.c_str());
+        item->bytes_per_s = 0.0;
+        notify_changed();
+        return;
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Queue
+// ───────────────────────────────────────────────
+
+void DownloadManager::start_queued()
+{
+    while (active_ < max_active_ && !queued_.empty()) {
+        guint id = queued_.front();
+        queued_.pop_front();
+        if (Item* item = get_item(id)) start_item(*item);
+    }
+}
+
+// The cookies are looked up on every start; a resumed download may have
+// been queued since the last run
+void DownloadManager::start_item(Item& item)
+{
+    item.state = State::Running;
+    item.restart_single = false;
+    item.sampled = 0;
+    item.bytes_per_s = 0.0;
+    ++active_;
+
+    auto* request = new CookieRequest;
+    request->manager = this;
+    request->alive = alive_;
+    request->id = item.id;
+
+    WebKitCookieManager* cookies = webkit_web_context_get_cookie_manager(context_);
+    webkit_cookie_manager_get_cookies(cookies, item.url.c_str(), cancellable_,
+                                      s_cookies_ready, request);
+}
+
+// Picks up a saved segment table if the .part file it describes is still
+// there; otherwise splits the file afresh
+void DownloadManager::start_workers(Item& item)
+{
+    auto file = std::make_shared<DownloadFile>();
+    file->url = item.url;
+    file->dest = item.dest;
+    file->part_path = item.dest + PART_SUFFIX;
+    file->state_path = state_path(item);
+    file->referer = item.referer;
+    file->user_agent = item.user_agent;
+    file->cookies = item.cookies;
+    file->validator = item.validator;
+    file->total = item.total;
+    file->ranges = item.ranges && item.total > 0;
+
+    // Without a validator there is no telling whether the bytes on disk
+    // still belong to the file on the server
+    if (file->ranges && !file->validator.empty() &&
+        g_file_test(file->part_path.c_str(), G_FILE_TEST_EXISTS)) {
+        GKeyFile* key_file = g_key_file_new();
+        gchar* saved = nullptr;
+        if (g_key_file_load_from_file(key_file, file->state_path.c_str(), G_KEY_FILE_NONE, nullptr) &&
+            g_key_file_get_uint64(key_file, STATE_GROUP, "total", nullptr) == file->total &&
+            (saved = g_key_file_get_string(key_file, STATE_GROUP, "validator", nullptr)) &&
+            file->validator == saved) {
+            gchar* table = g_key_file_get_string(key_file, STATE_GROUP, "segments", nullptr);
+            if (!parse_segments(table, file->segments)) file->segments.clear();
+            g_free(table);
+        }
+        g_free(saved);
+        g_key_file_free(key_file);
+    }
+
+    if (file->segments.empty()) {
+        guint64 count = 1;
+        if (file->ranges && file->total >= 2 * SEGMENT_MIN_BYTES) {
+            count = std::min<guint64>(max_segments_, file->total / SEGMENT_MIN_BYTES);
+        }
+        for (guint64 i = 0; i < count; ++i) {
+            Segment s;
+            // A single stream reads to the end of whatever the server sends
+            s.start = file->total * i / count;
+            s.end = file->ranges ? file->total * (i + 1) / count : 0;
+            file->segments.push_back(s);
+        }
+    }
+
+    // A single stream cannot resume: start over
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC | (file->ranges ? 0 : O_TRUNC);
+    file->fd = open(file->part_path.c_str(), flags, 0644);
+    if (file->fd < 0 || (file->ranges && ftruncate(file->fd, static_cast<off_t>(file->total)) != 0)) {
+        item.error = g_strerror(errno);
+        finish_item(item);
+        return;
+    }
+
+    file->save_state();
+    item.file = file;
+    item.sampled = file->received();
+    item.workers = 0;
+
+    for (size_t i = 0; i < file->segments.size(); ++i) {
+        const Segment& s = file->segments[i];
+        if (s.end && s.start + s.done >= s.end) continue;
+
+        auto* data = new SegmentData;
+        data->file = file;
+        data->id = item.id;
+        data->index = i;
+
+        GTask* task = g_task_new(nullptr, cancellable_, s_segment_done, this);
+        g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<SegmentData*>(p); });
+        g_task_run_in_thread(task, s_segment_thread);
+        g_object_unref(task);
+        ++item.workers;
+    }
+
+    if (item.workers == 0) {
+        finish_item(item);
+        return;
+    }
+    schedule_tick();
+    notify_changed();
+}
+
+void DownloadManager::on_segment_done(guint id, GError* error)
+{
+    Item* item = get_item(id);
+    if (!item || item->workers == 0) return;
+    --item->workers;
+
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED)) {
+        item->restart_single = true;
+    } else if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_WRONG_ETAG)) {
+        // The size WebKit saw no longer holds (or was of an encoded body)
+        item->restart_single = true;
+        item->total = 0;
+    } else if (error && item->error.empty()) {
+        item->error = error->message;
+    }
+    if (item->workers > 0) return;
+
+    if (item->restart_single && item->error.empty()) {
+        COLOSSUS_TRACE("download %s: no ranges after all, one stream\n", item->dest.c_str());
+        item->file.reset();
+        item->ranges = false;
+        item->restart_single = false;
+        g_unlink(state_path(*item).c_str());
+        start_workers(*item);
+        return;
+    }
+    finish_item(*item);
+}
+
+// A failed download keeps its .part file and state for retry_failed() or
+// the next run
+void DownloadManager::finish_item(Item& item)
+{
+    std::string part_path = item.dest + PART_SUFFIX;
+    if (item.file) {
+        guint64 received = item.file->received();
+        bytes_total_ += received - std::min(received, item.sampled);
+        item.sampled = received;
+    }
+    item.file.reset();
+    item.bytes_per_s = 0.0;
+
+    if (item.error.empty() && g_rename(part_path.c_str(), item.dest.c_str()) != 0) {
+        item.error = g_strerror(errno);
+    }
+
+    if (item.error.empty()) {
+        item.state = State::Done;
+        g_unlink(state_path(item).c_str());
+        COLOSSUS_TRACE("download done: %s\n", item.dest.c_str());
+    } else {
+        item.state = State::Failed;
+        g_printerr("COLOSSUS-NAN: download failed: %s: %s\n", item.url.c_str(), item.error.c_str());
+    }
+
+    --active_;
+    start_queued();
+    notify_changed();
+}
+
+// ───────────────────────────────────────────────
+//  Segment workers (worker threads)
+// ───────────────────────────────────────────────
+
+// One request for whatever of the segment is still missing. Fails with
+// G_IO_ERROR_NOT_SUPPORTED when the server ignores the range and sends the
+// whole file, so the download can fall back to a single stream.
+void DownloadManager::s_segment_thread(GTask* task, gpointer, gpointer task_data,
+                                       GCancellable* cancellable)
+{
+    auto* data = static_cast<SegmentData*>(task_data);
+    DownloadFile& file = *data->file;
+
+    g_mutex_lock(&file.lock);
+    Segment segment = file.segments[data->index];
+    g_mutex_unlock(&file.lock);
+    guint64 offset = segment.start + segment.done;
+
+    SoupSession* session = soup_session_new_with_options(
+        "timeout", REQUEST_TIMEOUT_S,
+        "user-agent", file.user_agent.empty() ? nullptr : file.user_agent.c_str(),
+        nullptr);
+
+    // Redirects are followed here rather than by libsoup, so the Cookie
+    // header taken for the download's origin never goes to another one
+    std::string url = file.url;
+    bool send_cookies = !file.cookies.empty();
+    SoupMessage* message = nullptr;
+    GInputStream* in = nullptr;
+    GError* error = nullptr;
+    for (guint hops = 0;; ++hops) {
+        message = soup_message_new("GET", url.c_str());
+        if (!message) {
+            error = g_error_new(G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Invalid URL");
+            break;
+        }
+        soup_message_set_flags(message, SOUP_MESSAGE_NO_REDIRECT);
+
+        // Encoded bodies would not line up with the byte ranges
+        SoupMessageHeaders* headers = request_headers(message);
+        soup_message_headers_replace(headers, "Accept-Encoding", "identity");
+        if (send_cookies) soup_message_headers_replace(headers, "Cookie", file.cookies.c_str());
+        if (!file.referer.empty()) soup_message_headers_replace(headers, "Referer", file.referer.c_str());
+        if (file.ranges) {
+            soup_message_headers_set_range(headers, static_cast<goffset>(offset),
+                                           segment.end ? static_cast<goffset>(segment.end) - 1 : -1);
+            if (!file.validator.empty()) {
+                soup_message_headers_replace(headers, "If-Range", file.validator.c_str());
+            }
+        }
+
+        in = soup_session_send(session, message, cancellable, &error);
+        if (!in) break;
+
+        const char* location = soup_message_headers_get_one(response_headers(message), "Location");
+        if (!SOUP_STATUS_IS_REDIRECTION(status_of(message)) || !location) break;
+
+        gchar* next = hops < MAX_REDIRECTS
+                          ? g_uri_resolve_relative(url.c_str(), location, G_URI_FLAGS_NONE, nullptr)
+                          : nullptr;
+        g_input_stream_close(in, nullptr, nullptr);
+        g_clear_object(&in);
+        g_clear_object(&message);
+        if (!next || !is_http(next)) {
+            g_free(next);
+            error = g_error_new(G_IO_ERROR, G_IO_ERROR_FAILED, "Bad or too many redirects");
+            break;
+        }
+        if (send_cookies && !same_origin(url, next)) send_cookies = false;
+        url = next;
+        g_free(next);
+    }
+
+    // A single stream checks its length against Content-Length when done
+    guint64 expected = 0;
+    if (in) {
+        guint status = status_of(message);
+        SoupMessageHeaders* received = response_headers(message);
+        goffset first = 0, last = 0, length = 0;
+        if (file.ranges && status == SOUP_STATUS_PARTIAL_CONTENT) {
+            if (!soup_message_headers_get_content_range(received, &first, &last, &length) ||
+                static_cast<guint64>(first) != offset) {
+                error = g_error_new(G_IO_ERROR, G_IO_ERROR_FAILED, "Bad range response");
+            } else if (length < 0 || static_cast<guint64>(length) != file.total) {
+                error = g_error_new(G_IO_ERROR, G_IO_ERROR_WRONG_ETAG, "File changed on the server");
+            }
+        } else if (file.ranges && status == SOUP_STATUS_OK) {
+            // The range was ignored, or If-Range found the file changed.
+            // Only a first segment covering the whole, unchanged file can
+            // use the response.
+            bool whole = offset == 0 && segment.end == file.total &&
+                         content_length(received) == file.total;
+            if (!whole) {
+                error = g_error_new(G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Range not honoured");
+            }
+        } else if (!SOUP_STATUS_IS_SUCCESSFUL(status)) {
+            error = g_error_new(G_IO_ERROR, G_IO_ERROR_FAILED, "HTTP %u", status);
+        } else if (!file.ranges) {
+            expected = content_length(received);
+        }
+    }
+
+    guint64 unsynced = 0;
+    if (!error) {
+        auto* buffer = static_cast<char*>(g_malloc(IO_BLOCK_BYTES));
+        for (;;) {
+            gsize want = IO_BLOCK_BYTES;
+            if (segment.end) want = static_cast<gsize>(std::min<guint64>(want, segment.end - offset));
+            if (want == 0) break;
+
+            gsize got = 0;
+            if (!g_input_stream_read_all(in, buffer, want, &got, cancellable, &error) || got == 0) break;
+
+            if (!write_all(file.fd, buffer, got, static_cast<off_t>(offset))) {
+                int saved_errno = errno;
+                error = g_error_new(G_IO_ERROR, g_io_error_from_errno(saved_errno),
+                                    "%s", g_strerror(saved_errno));
+                break;
+            }
+            offset += got;
+            unsynced += got;
+
+            g_mutex_lock(&file.lock);
+            file.segments[data->index].written = offset - segment.start;
+            g_mutex_unlock(&file.lock);
+
+            if (unsynced >= CHECKPOINT_BYTES && fdatasync(file.fd) == 0) {
+                g_mutex_lock(&file.lock);
+                file.segments[data->index].done = offset - segment.start;
+                g_mutex_unlock(&file.lock);
+                file.save_state();
+                unsynced = 0;
+            }
+        }
+        g_free(buffer);
+
+        if (!error && ((segment.end && offset < segment.end) || (expected && offset != expected))) {
+            error = g_error_new(G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT, "Connection closed early");
+        }
+    }
+
+    // What was written so far is kept, cancelled (quit) or not
+    if (unsynced && fdatasync(file.fd) == 0) {
+        g_mutex_lock(&file.lock);
+        file.segments[data->index].done = offset - segment.start;
+        g_mutex_unlock(&file.lock);
+        file.save_state();
+    }
+
+    if (in) {
+        g_input_stream_close(in, nullptr, nullptr);
+        g_object_unref(in);
+    }
+    g_clear_object(&message);
+    g_object_unref(session);
+
+    if (error) {
+        g_task_return_error(task, error);
+    } else {
+        g_task_return_boolean(task, TRUE);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Rates
+// ───────────────────────────────────────────────
+
+void DownloadManager::schedule_tick()
+{
+    if (tick_source_) return;
+    sampled_at_ = g_get_monotonic_time();
+    tick_source_ = g_timeout_add_seconds(1, s_tick, this);
+}
+
+bool DownloadManager::tick()
+{
+    gint64 now = g_get_monotonic_time();
+    double seconds = std::max(0.001, (now - sampled_at_) / 1e6);
+    sampled_at_ = now;
+
+    bool running = false;
+    for (auto& item : items_) {
+        if (item->state != State::Running) continue;
+
+        guint64 received = 0;
+        if (item->file) {
+            received = item->file->received();
+        } else if (item->native) {
+            received = webkit_download_get_received_data_length(item->native);
+        } else {
+            continue;   // waiting for cookies
+        }
+
+        guint64 delta = received - std::min(received, item->sampled);
+        item->bytes_per_s = delta / seconds;
+        item->sampled = received;
+        bytes_total_ += delta;
+        running = true;
+    }
+
+    notify_changed();
+    if (!running && active_ == 0) {
+        tick_source_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void DownloadManager::notify_changed()
+{
+    if (changed_callback_) changed_callback_();
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+void DownloadManager::s_cookies_ready(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    auto* request = static_cast<CookieRequest*>(user_data);
+    GError* error = nullptr;
+    GList* cookies = webkit_cookie_manager_get_cookies_finish(WEBKIT_COOKIE_MANAGER(source),
+                                                              result, &error);
+
+    if (!request->alive.expired()) {
+        if (Item* item = request->manager->get_item(request->id)) {
+            // No cookies is not a reason to give up
+            GSList* list = nullptr;
+            for (GList* l = cookies; l; l = l->next) list = g_slist_prepend(list, l->data);
+            gchar* header = list ? soup_cookies_to_cookie_header(g_slist_reverse(list)) : nullptr;
+            item->cookies = header ? header : "";
+            g_free(header);
+            g_slist_free(list);
+
+            request->manager->start_workers(*item);
+        }
+    }
+
+    g_list_free_full(cookies, reinterpret_cast<GDestroyNotify>(soup_cookie_free));
+    if (error) g_error_free(error);
+    delete request;
+}
+
+void DownloadManager::s_segment_done(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+
+    // The manager is gone once its cancellable fires
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<SegmentData*>(g_task_get_task_data(task));
+    GError* error = nullptr;
+    g_task_propagate_boolean(task, &error);
+
+    static_cast<DownloadManager*>(user_data)->on_segment_done(data->id, error);
+
+    if (error) g_error_free(error);
+}
+
+gboolean DownloadManager::s_decide_destination(WebKitDownload* download,
+                                               gchar* suggested_filename,
+                                               gpointer user_data)
+{
+    static_cast<DownloadManager*>(user_data)->on_decide_destination(download, suggested_filename);
+    return TRUE;
+}
+
+void DownloadManager::s_native_finished(WebKitDownload* download, gpointer user_data)
+{
+    static_cast<DownloadManager*>(user_data)->on_native_finished(download, nullptr);
+}
+
+void DownloadManager::s_native_failed(WebKitDownload* download, GError* error, gpointer user_data)
+{
+    static_cast<DownloadManager*>(user_data)->on_native_finished(download, error);
+}
+
+gboolean DownloadManager::s_tick(gpointer user_data)
+{
+    return static_cast<DownloadManager*>(user_data)->tick() ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
@@ -0,0 +1,160 @@
+// download_manager.h — COLOSSUS download queue with segmented range fetches
+
+#ifndef COLOSSUS_DOWNLOAD_MANAGER_H
+#define COLOSSUS_DOWNLOAD_MANAGER_H
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+struct DownloadFile;
+
+// Takes over the downloads pages start. WebKit only gets as far as the
+// response: the URL, size, file name and whether the server takes range
+// requests are noted, WebKit's download is cancelled, and the file is
+// fetched here with libsoup on worker threads.
+//
+//  * At most `max_active` downloads run at once; the rest wait in a queue.
+//  * A file of twice SEGMENT_MIN_BYTES or more from a server that advertises
+//    Accept-Ranges: bytes is fetched as up to `max_segments` parallel range
+//    requests into one .part file, sized up front. A server that answers a
+//    range with the whole file gets a single stream instead.
+//  * Each worker reads in large blocks and writes them at its offset with
+//    pwrite(); every few MB it syncs the data and saves the segment table
+//    (a key file under `state_dir`). Downloads left unfinished at exit, or
+//    failed, resume from there on the next run, provided the server gave a
+//    validator (strong ETag or Last-Modified). Range requests carry it in
+//    If-Range, and a 206 whose total differs from the known size counts as
+//    a changed file: either way the download starts over as one stream.
+//  * Workers follow redirects themselves and drop the Cookie header when
+//    one leaves the download's origin.
+//  * Bytes are accounted per download and in total; rates are sampled
+//    once a second while anything runs, which is also when the changed
+//    callback fires for the status bar.
+//
+// Downloads WebKit cannot hand over (POST responses, blob: and data: URLs)
+// are saved by WebKit itself, outside the queue, and only tracked.
+class DownloadManager {
+public:
+    enum class State {
+        Queued,
+        Running,
+        Done,
+        Failed
+    };
+
+    // Totals for the status bar
+    struct Summary {
+        guint running = 0;
+        guint queued = 0;
+        guint failed = 0;
+        guint64 received = 0;       // of running downloads of known size
+        guint64 total = 0;
+        double bytes_per_s = 0.0;   // all running downloads
+    };
+
+    DownloadManager(WebKitWebContext* context,
+                    const std::string& state_dir,
+                    guint max_active,
+                    guint max_segments);
+    ~DownloadManager();
+
+    DownloadManager(const DownloadManager&) = delete;
+    DownloadManager& operator=(const DownloadManager&) = delete;
+
+    // A download a tab started; `user_agent` is the tab's
+    void adopt(WebKitDownload* download, const std::string& user_agent);
+
+    // Queue failed downloads again
+    void retry_failed();
+
+    Summary summary() const;
+    guint64 bytes_total() const { return bytes_total_; }     // this session
+
+    // Runs when a download starts, finishes or fails, and on every rate sample
+    void set_changed_callback(std::function<void()> callback) { changed_callback_ = std::move(callback); }
+
+private:
+    struct Item {
+        guint id = 0;
+        State state = State::Queued;
+        std::string url;
+        std::string dest;               // final path
+        std::string referer;
+        std::string user_agent;
+        guint64 total = 0;              // 0 when unknown
+        bool ranges = false;
+        std::string validator;          // strong ETag or Last-Modified, for If-Range
+        std::string cookies;            // Cookie header, fetched on each start
+        std::shared_ptr<DownloadFile> file;     // while running
+        guint workers = 0;              // segment tasks still running
+        bool restart_single = false;    // range ignored, or the file changed
+        std::string error;              // first segment failure
+
+        guint64 sampled = 0;            // received at the last rate sample
+        double bytes_per_s = 0.0;
+
+        WebKitDownload* native = nullptr;   // saved by WebKit (ref held)
+    };
+
+    WebKitWebContext* context_ = nullptr;
+    std::string state_dir_;
+    std::string download_dir_;
+    guint max_active_ = 0;
+    guint max_segments_ = 0;
+    GCancellable* cancellable_ = nullptr;
+
+    std::list<std::unique_ptr<Item>> items_;
+    std::deque<guint> queued_;
+    guint next_id_ = 1;
+    guint active_ = 0;
+
+    guint tick_source_ = 0;
+    gint64 sampled_at_ = 0;
+    guint64 bytes_total_ = 0;
+    std::function<void()> changed_callback_;
+
+    // Cookie lookups can outlive us
+    std::shared_ptr<bool> alive_ = std::make_shared<bool>(true);
+
+    Item* get_item(guint id);
+    Item& add_item(const std::string& url, const std::string& dest);
+    std::string unique_destination(const std::string& filename) const;
+    std::string state_path(const Item& item) const;
+    void resume_saved();
+    void enqueue(Item& item);
+
+    void start_queued();
+    void start_item(Item& item);
+    void start_workers(Item& item);
+    void on_segment_done(guint id, GError* error);
+    void finish_item(Item& item);
+
+    void on_decide_destination(WebKitDownload* download, const gchar* suggested_filename);
+    void on_native_finished(WebKitDownload* download, GError* error);
+
+    void schedule_tick();
+    bool tick();
+    void notify_changed();
+
+    static void s_cookies_ready(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_segment_thread(GTask* task, gpointer source, gpointer task_data,
+                                 GCancellable* cancellable);
+    static void s_segment_done(GObject* source, GAsyncResult* result, gpointer user_data);
+    static gboolean s_decide_destination(WebKitDownload* download,
+                                         gchar* suggested_filename,
+                                         gpointer user_data);
+    static void s_native_finished(WebKitDownload* download, gpointer user_data);
+    static void s_native_failed(WebKitDownload* download, GError* error, gpointer user_data);
+    static gboolean s_tick(gpointer user_data);
+};
+
+#endif // COLOSSUS_DOWNLOAD_MANAGER_H
@@ -0,0 +1,250 @@
+// history_index.cpp — COLOSSUS frecency-ranked omnibox index
+
+#include "history_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// τ for the exponential decay: frecency halves every half-life
+const double TAU_S = HistoryIndex::FRECENCY_HALF_LIFE_DAYS * 86400.0 / std::log(2.0);
+
+const double TYPED_WEIGHT = 2.0;
+const double VISIT_WEIGHT = 1.0;
+
+// Match bonuses, added to the log-domain rank
+const double HOST_PREFIX_BONUS = std::log(4.0);
+const double WORD_START_BONUS = std::log(2.0);
+
+const double NO_MATCH = -std::numeric_limits<double>::infinity();
+
+bool word_boundary(char c)
+{
+    return c == '/' || c == '.' || c == '-' || c == '_' || c == ' ' ||
+           c == '?' || c == '=' || c == '&' || c == ':';
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Keys / trigrams
+// ───────────────────────────────────────────────
+
+bool HistoryIndex::indexable(const std::string& url)
+{
+    return url.compare(0, 7, "http://") == 0 ||
+           url.compare(0, 8, "https://") == 0 ||
+           url.compare(0, 7, "file://") == 0;
+}
+
+std::string HistoryIndex::lower(const std::string& text)
+{
+    gchar* down = g_utf8_strdown(text.c_str(), static_cast<gssize>(text.size()));
+    std::string out(down ? down : "");
+    g_free(down);
+    return out;
+}
+
+std::string HistoryIndex::url_key_for(const std::string& url)
+{
+    std::string key = lower(url);
+
+    size_t scheme = key.find("://");
+    if (scheme != std::string::npos) key.erase(0, scheme + 3);
+    if (key.compare(0, 4, "www.") == 0) key.erase(0, 4);
+    if (!key.empty() && key.back() == '/') key.pop_back();
+    return key;
+}
+
+void HistoryIndex::collect_grams(const std::string& key, size_t max_bytes,
+                                 std::vector<uint32_t>& out)
+{
+    size_t len = std::min(key.size(), max_bytes);
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        out.push_back((static_cast<uint32_t>(static_cast<unsigned char>(key[i])) << 16) |
+                      (static_cast<uint32_t>(static_cast<unsigned char>(key[i + 1])) << 8) |
+                      static_cast<uint32_t>(static_cast<unsigned char>(key[i + 2])));
+    }
+}
+
+void HistoryIndex::index_grams(uint32_t id, const std::string& key, size_t max_bytes)
+{
+    std::vector<uint32_t> grams;
+    collect_grams(key, max_bytes, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    for (uint32_t gram : grams) {
+        std::vector<uint32_t>& ids = postings_[gram];
+        if (ids.empty() || ids.back() != id) ids.push_back(id);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Updates
+// ───────────────────────────────────────────────
+
+void HistoryIndex::add_visit(const std::string& url, gint64 when, bool typed)
+{
+    if (!indexable(url)) return;
+
+    double now_s = static_cast<double>(when) / G_USEC_PER_SEC;
+    double weight = typed ? TYPED_WEIGHT : VISIT_WEIGHT;
+
+    auto it = by_url_.find(url);
+    if (it != by_url_.end()) {
+        // Decay the old score to `when`, then add this visit
+        Entry& entry = entries_[it->second];
+        double old_rank = entry.rank;
+        double score = std::exp(old_rank - now_s / TAU_S) + weight;
+        entry.rank = std::log(score) + now_s / TAU_S;
+        update_hot(it->second, old_rank);
+        return;
+    }
+
+    uint32_t id = static_cast<uint32_t>(entries_.size());
+    Entry entry;
+    entry.url = url;
+    entry.url_key = url_key_for(url);
+    entry.rank = std::log(weight) + now_s / TAU_S;
+    entries_.push_back(std::move(entry));
+    by_url_.emplace(url, id);
+
+    index_grams(id, entries_[id].url_key, URL_GRAM_BYTES);
+    update_hot(id, NO_MATCH);
+}
+
+void HistoryIndex::set_title(const std::string& url, const std::string& title)
+{
+    auto it = by_url_.find(url);
+    if (it == by_url_.end()) return;
+
+    Entry& entry = entries_[it->second];
+    if (entry.title == title) return;
+
+    // Pages retitle themselves while loading; only grams the old title
+    // lacked are new postings
+    std::string key = lower(title);
+    std::vector<uint32_t> old_grams;
+    collect_grams(entry.title_key, TITLE_GRAM_BYTES, old_grams);
+    std::sort(old_grams.begin(), old_grams.end());
+
+    std::vector<uint32_t> grams;
+    collect_grams(key, TITLE_GRAM_BYTES, grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    for (uint32_t gram : grams) {
+        if (std::binary_search(old_grams.begin(), old_grams.end(), gram)) continue;
+        std::vector<uint32_t>& ids = postings_[gram];
+        if (ids.empty() || ids.back() != it->second) ids.push_back(it->second);
+    }
+
+    entry.title = title;
+    entry.title_key = std::move(key);
+}
+
+void HistoryIndex::update_hot(uint32_t id, double old_rank)
+{
+    if (old_rank != NO_MATCH) hot_.erase({ old_rank, id });
+
+    double rank = entries_[id].rank;
+    if (hot_.size() >= HOT_SIZE && rank <= hot_.begin()->first) return;
+
+    hot_.insert({ rank, id });
+    if (hot_.size() > HOT_SIZE) hot_.erase(hot_.begin());
+}
+
+// ───────────────────────────────────────────────
+//  Queries
+// ───────────────────────────────────────────────
+
+double HistoryIndex::match_rank(const Entry& entry, const std::vector<std::string>& terms) const
+{
+    double bonus = 0.0;
+
+    for (const auto& term : terms) {
+        size_t in_url = entry.url_key.find(term);
+        size_t in_title = entry.title_key.find(term);
+        if (in_url == std::string::npos && in_title == std::string::npos) return NO_MATCH;
+
+        if (in_url == 0) {
+            bonus += HOST_PREFIX_BONUS;
+        } else if ((in_url != std::string::npos && word_boundary(entry.url_key[in_url - 1])) ||
+                   in_title == 0 ||
+                   (in_title != std::string::npos && word_boundary(entry.title_key[in_title - 1]))) {
+            bonus += WORD_START_BONUS;
+        }
+    }
+    return entry.rank + bonus;
+}
+
+std::vector<HistoryIndex::Match> HistoryIndex::query(const std::string& text, size_t limit) const
+{
+    std::vector<Match> out;
+    if (limit == 0 || entries_.empty()) return out;
+
+    std::vector<std::string> terms;
+    gchar** words = g_strsplit_set(lower(text).c_str(), " \t", -1);
+    for (gchar** word = words; *word; ++word) {
+        if (**word) terms.push_back(*word);
+    }
+    g_strfreev(words);
+    if (terms.empty()) return out;
+
+    // Rarest trigram across all terms; a trigram nobody has leaves only
+    // entries whose text was cut off before indexing (checked via hot_)
+    const std::vector<uint32_t>* rarest = nullptr;
+    bool has_gram = false;
+    bool gram_missing = false;
+    for (const auto& term : terms) {
+        std::vector<uint32_t> grams;
+        collect_grams(term, term.size(), grams);
+        for (uint32_t gram : grams) {
+            has_gram = true;
+            auto it = postings_.find(gram);
+            if (it == postings_.end()) {
+                gram_missing = true;
+                break;
+            }
+            if (!rarest || it->second.size() < rarest->size()) rarest = &it->second;
+        }
+        if (gram_missing) break;
+    }
+
+    std::vector<uint32_t> candidates;
+    candidates.reserve(hot_.size() + SCAN_BUDGET);
+    for (const auto& hot : hot_) candidates.push_back(hot.second);
+
+    // Newest first, within budget
+    if (!has_gram) {
+        size_t n = std::min(entries_.size(), SCAN_BUDGET);
+        for (size_t i = 0; i < n; ++i) {
+            candidates.push_back(static_cast<uint32_t>(entries_.size() - 1 - i));
+        }
+    } else if (!gram_missing && rarest) {
+        size_t n = std::min(rarest->size(), SCAN_BUDGET);
+        candidates.insert(candidates.end(), rarest->end() - static_cast<std::ptrdiff_t>(n), rarest->end());
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<std::pair<double, uint32_t>> scored;
+    for (uint32_t id : candidates) {
+        double rank = match_rank(entries_[id], terms);
+        if (rank != NO_MATCH) scored.push_back({ rank, id });
+    }
+
+    size_t n = std::min(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(n), scored.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (size_t i = 0; i < n; ++i) {
+        const Entry& entry = entries_[scored[i].second];
+        out.push_back({ entry.url, entry.title, scored[i].first });
+    }
+    return out;
+}
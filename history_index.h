@@ -0,0 +1,89 @@
+// history_index.h — COLOSSUS frecency-ranked omnibox index
+
+#ifndef COLOSSUS_HISTORY_INDEX_H
+#define COLOSSUS_HISTORY_INDEX_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <glib.h>
+}
+
+// In-memory index of visited URLs and titles behind the command-bar
+// completion. Each entry is indexed by the byte trigrams of its URL (scheme
+// and "www." stripped) and title; a query intersects on its rarest trigram
+// and verifies candidates by substring. Posting lists are walked newest
+// first under a fixed budget, and the HOT_SIZE highest-ranked entries are
+// always checked, so a keystroke costs the same at 1k or 1M entries.
+//
+// Frecency decays exponentially (half-life FRECENCY_HALF_LIFE_DAYS), stored
+// as ln(score) + t/τ so that ranks stay comparable without re-scoring.
+//
+// Plain data, no GTK: an index can be built off the main thread and moved
+// in. Not thread-safe by itself.
+class HistoryIndex {
+public:
+    struct Match {
+        std::string url;
+        std::string title;
+        double rank = 0.0;
+    };
+
+    static constexpr double FRECENCY_HALF_LIFE_DAYS = 30.0;
+
+    HistoryIndex() = default;
+
+    HistoryIndex(HistoryIndex&&) = default;
+    HistoryIndex& operator=(HistoryIndex&&) = default;
+    HistoryIndex(const HistoryIndex&) = delete;
+    HistoryIndex& operator=(const HistoryIndex&) = delete;
+
+    // `when` is real time in µs; typed visits (command bar) weigh double
+    void add_visit(const std::string& url, gint64 when, bool typed = false);
+    void set_title(const std::string& url, const std::string& title);
+
+    // Best `limit` entries containing every whitespace-separated term
+    std::vector<Match> query(const std::string& text, size_t limit) const;
+
+    size_t size() const { return entries_.size(); }
+
+    // Only web pages are worth completing
+    static bool indexable(const std::string& url);
+
+private:
+    struct Entry {
+        std::string url;
+        std::string title;
+        std::string url_key;    // lowercase, no scheme / "www."
+        std::string title_key;  // lowercase
+        double rank = 0.0;      // ln(frecency) + t/τ
+    };
+
+    static constexpr size_t HOT_SIZE = 1024;
+    static constexpr size_t SCAN_BUDGET = 3000;
+    static constexpr size_t URL_GRAM_BYTES = 80;
+    static constexpr size_t TITLE_GRAM_BYTES = 64;
+
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, uint32_t> by_url_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_;  // trigram → ids, oldest first
+
+    // Highest-ranked entries, lowest first
+    std::set<std::pair<double, uint32_t>> hot_;
+
+    static std::string url_key_for(const std::string& url);
+    static std::string lower(const std::string& text);
+    static void collect_grams(const std::string& key, size_t max_bytes,
+                              std::vector<uint32_t>& out);
+
+    void index_grams(uint32_t id, const std::string& key, size_t max_bytes);
+    void update_hot(uint32_t id, double old_rank);
+    double match_rank(const Entry& entry, const std::vector<std::string>& terms) const;
+};
+
+#endif // COLOSSUS_HISTORY_INDEX_H
@@ -0,0 +1,656 @@
+// history_store.cpp — COLOSSUS append-only, memory-mapped visit log
+
+#include "history_store.h"
+#include "append_log.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include <errno.h>
+#include <sys/mman.h>
+
+namespace {
+
+// ───────────────────────────────────────────────
+//  Records (native endianness, 8-byte aligned; see append_log.h)
+// ───────────────────────────────────────────────
+
+const char MAGIC[8] = { 'C', 'N', 'H', 'I', 'S', 'T', '0', '1' };
+
+enum RecordType : guint32 {
+    RECORD_URL = 1,             // TextRecord: id → URL (interning)
+    RECORD_TITLE = 2,           // TextRecord: latest title for id
+    RECORD_VISIT = 3            // VisitRecord
+};
+
+struct RecordHeader {
+    guint32 size;               // whole record, padded to 8
+    guint32 type;
+};
+
+struct TextRecord {
+    RecordHeader header;
+    guint32 id;
+    guint32 length;             // followed by `length` bytes of UTF-8
+};
+
+struct VisitRecord {
+    RecordHeader header;
+    guint32 id;
+    guint32 flags;
+    gint64 when;                // real time, µs
+    float load_ms;
+    float first_row_ms;
+    guint32 requests;
+    guint32 blocked;
+    guint64 bytes;
+};
+
+const guint32 VISIT_TYPED = 1u << 0;
+
+const size_t MAX_URL_BYTES = 8192;      // data: URLs and the like are skipped
+const size_t MAX_TITLE_BYTES = 1024;
+const guint32 MAX_ID = 1u << 28;
+
+const guint FLUSH_DELAY_S = 2;
+const size_t FLUSH_BATCH_BYTES = 64 * 1024;
+const guint64 COMPACT_MIN_BYTES = 4 * 1024 * 1024;
+
+// Calls fn(type, record, size) for each well-formed record; stops at the
+// first one that is not (only possible past a torn, uncommitted tail)
+template <typename Fn>
+void for_each_record(const char* data, size_t size, Fn&& fn)
+{
+    size_t pos = AppendLog::HEADER_SIZE;
+    while (pos + sizeof(RecordHeader) <= size) {
+        RecordHeader header;
+        memcpy(&header, data + pos, sizeof(header));
+        if (header.size < sizeof(RecordHeader) || header.size % 8 != 0 ||
+            header.size > size - pos) {
+            break;
+        }
+        fn(header.type, data + pos, static_cast<size_t>(header.size));
+        pos += header.size;
+    }
+}
+
+bool read_text(const char* record, size_t size, guint32& id, std::string_view& text)
+{
+    if (size < sizeof(TextRecord)) return false;
+    TextRecord head;
+    memcpy(&head, record, sizeof(head));
+    if (head.length > size - sizeof(TextRecord)) return false;
+    id = head.id;
+    text = std::string_view(record + sizeof(TextRecord), head.length);
+    return id < MAX_ID;
+}
+
+bool read_visit(const char* record, size_t size, VisitRecord& visit)
+{
+    if (size < sizeof(VisitRecord)) return false;
+    memcpy(&visit, record, sizeof(visit));
+    return visit.id < MAX_ID;
+}
+
+// Cut a title at a UTF-8 character boundary
+std::string clamp_utf8(const std::string& text, size_t max_bytes)
+{
+    if (text.size() <= max_bytes) return text;
+    size_t end = max_bytes;
+    while (end > 0 && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) --end;
+    return text.substr(0, end);
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  HistoryFile: the log itself, shared with worker threads
+// ───────────────────────────────────────────────
+//
+// Workers take turns in ticket order (tickets are handed out on the main
+// loop), so batches land in the order they were encoded even when the
+// destructor writes the last one itself.
+
+struct HistoryFile {
+    AppendLog log;
+
+    // Committed region as mapped at open, read by load()
+    const char* map = nullptr;
+    size_t map_size = 0;
+
+    GMutex lock;
+    GCond turn;
+    guint64 serving = 0;        // under lock
+    guint64 tickets = 0;        // main loop only
+
+    explicit HistoryFile(const std::string& path) : log(path, MAGIC, "history log")
+    {
+        g_mutex_init(&lock);
+        g_cond_init(&turn);
+    }
+
+    ~HistoryFile()
+    {
+        if (map) munmap(const_cast<char*>(map), map_size);
+        g_cond_clear(&turn);
+        g_mutex_clear(&lock);
+    }
+
+    guint64 take_ticket() { return tickets++; }
+
+    void wait_turn(guint64 ticket)
+    {
+        g_mutex_lock(&lock);
+        while (serving != ticket) g_cond_wait(&turn, &lock);
+    }
+
+    void end_turn()
+    {
+        ++serving;
+        g_cond_broadcast(&turn);
+        g_mutex_unlock(&lock);
+    }
+
+    bool open();
+    bool compact(gint64 cutoff);
+};
+
+// Constant time: header read, optional tail truncation, one mmap
+bool HistoryFile::open()
+{
+    if (!log.open()) return false;
+
+    guint64 committed = log.committed;
+    if (committed > AppendLog::HEADER_SIZE) {
+        void* mapped = mmap(nullptr, committed, PROT_READ, MAP_PRIVATE, log.fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, committed, MADV_SEQUENTIAL);
+            map = static_cast<const char*>(mapped);
+            map_size = committed;
+        }
+    }
+    return true;
+}
+
+// Rewrite without superseded titles and visits older than `cutoff`. URL
+// records are all kept: the main loop's interned ids stay valid.
+bool HistoryFile::compact(gint64 cutoff)
+{
+    guint64 committed = log.committed;
+    if (log.fd < 0 || committed <= AppendLog::HEADER_SIZE) return false;
+
+    void* mapped = mmap(nullptr, committed, PROT_READ, MAP_PRIVATE, log.fd, 0);
+    if (mapped == MAP_FAILED) return false;
+    const char* data = static_cast<const char*>(mapped);
+
+    // Offset of the last title record for each id
+    std::vector<size_t> last_title;
+    for_each_record(data, committed, [&](guint32 type, const char* record, size_t size) {
+        guint32 id;
+        std::string_view text;
+        if (type != RECORD_TITLE || !read_text(record, size, id, text)) return;
+        if (last_title.size() <= id) last_title.resize(id + 1, 0);
+        last_title[id] = static_cast<size_t>(record - data);
+    });
+
+    std::string out(AppendLog::HEADER_SIZE, '\0');
+    for_each_record(data, committed, [&](guint32 type, const char* record, size_t size) {
+        bool keep = false;
+        if (type == RECORD_URL) {
+            keep = true;
+        } else if (type == RECORD_TITLE) {
+            guint32 id;
+            std::string_view text;
+            keep = read_text(record, size, id, text) && id < last_title.size() &&
+                   last_title[id] == static_cast<size_t>(record - data);
+        } else if (type == RECORD_VISIT) {
+            VisitRecord visit;
+            keep = read_visit(record, size, visit) && visit.when >= cutoff;
+        }
+        if (keep) out.append(record, size);
+    });
+    munmap(mapped, committed);
+
+    int replacement = log.write_replacement(out);
+    if (replacement < 0) return false;
+
+    COLOSSUS_TRACE("history compacted: %" G_GUINT64_FORMAT " → %zu KB\n",
+                   committed / 1024, out.size() / 1024);
+
+    // The load mapping (if any) still refers to the old inode, which stays
+    // readable until unmapped
+    log.adopt(replacement, out.size());
+    return true;
+}
+
+// ───────────────────────────────────────────────
+//  Worker payloads
+// ───────────────────────────────────────────────
+
+struct HistoryLoadResult {
+    HistoryIndex index;
+    std::unordered_map<std::string, guint32> url_ids;
+    std::vector<size_t> title_hashes;
+    guint32 next_id = 0;
+    guint64 total_bytes = 0;
+    guint64 dead_bytes = 0;
+};
+
+namespace {
+
+struct LoadData {
+    std::shared_ptr<HistoryFile> file;
+    gint64 cutoff = 0;
+    HistoryLoadResult result;
+};
+
+struct WriteData {
+    std::shared_ptr<HistoryFile> file;
+    guint64 ticket = 0;
+    std::string batch;          // empty for compaction
+    gint64 cutoff = 0;
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+HistoryStore::HistoryStore(const std::string& path, guint retention_days)
+    : retention_days_(retention_days)
+{
+    cancellable_ = g_cancellable_new();
+
+    gint64 started = g_get_monotonic_time();
+    file_ = std::make_shared<HistoryFile>(path);
+    if (!file_->open()) {
+        g_printerr("COLOSSUS-NAN: History disabled, cannot open %s: %s\n",
+                   path.c_str(), g_strerror(errno));
+        file_.reset();
+        return;
+    }
+
+    COLOSSUS_TRACE("history opened in %.2f ms (%" G_GUINT64_FORMAT " KB)\n",
+                   colossus_ms_between(started, g_get_monotonic_time()),
+                   file_->log.committed / 1024);
+}
+
+HistoryStore::~HistoryStore()
+{
+    if (flush_source_) {
+        g_source_remove(flush_source_);
+        flush_source_ = 0;
+    }
+    g_cancellable_cancel(cancellable_);
+
+    // Synchronous, after any batch still in flight
+    if (file_ && !batch_.empty()) {
+        guint64 ticket = file_->take_ticket();
+        file_->wait_turn(ticket);
+        if (!file_->log.append(batch_)) {
+            g_printerr("COLOSSUS-NAN: Failed to write history: %s\n", g_strerror(errno));
+        }
+        file_->end_turn();
+    }
+
+    g_clear_object(&cancellable_);
+}
+
+// ───────────────────────────────────────────────
+//  Loading
+// ───────────────────────────────────────────────
+
+void HistoryStore::load(LoadedCallback callback)
+{
+    loaded_callback_ = std::move(callback);
+
+    if (!file_) {
+        HistoryLoadResult empty;
+        finish_load(empty);
+        return;
+    }
+
+    auto* data = new LoadData;
+    data->file = file_;
+    data->cutoff = g_get_real_time() -
+                   static_cast<gint64>(retention_days_) * 86400 * G_USEC_PER_SEC;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_loaded, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<LoadData*>(p); });
+    g_task_run_in_thread(task, s_load_thread);
+    g_object_unref(task);
+}
+
+void HistoryStore::finish_load(HistoryLoadResult& result)
+{
+    url_ids_ = std::move(result.url_ids);
+    title_hashes_ = std::move(result.title_hashes);
+    next_id_ = result.next_id;
+    loaded_ = true;
+
+    HistoryIndex index = std::move(result.index);
+
+    // Recorded while the log was being read
+    for (const auto& pending : before_load_) {
+        const Visit& visit = pending.visit;
+        if (pending.is_visit) {
+            index.add_visit(visit.url, visit.when, visit.typed);
+            add_visit(visit);
+        } else {
+            set_title(visit.url, visit.title);
+        }
+        if (!visit.title.empty()) index.set_title(visit.url, visit.title);
+    }
+    before_load_.clear();
+
+    compact_wanted_ = file_ && result.total_bytes >= COMPACT_MIN_BYTES &&
+                      result.dead_bytes * 2 > result.total_bytes;
+    if (compact_wanted_ && !write_in_flight_) {
+        start_compaction();
+    }
+
+    if (loaded_callback_) {
+        LoadedCallback callback = std::move(loaded_callback_);
+        loaded_callback_ = nullptr;
+        callback(std::move(index));
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Recording
+// ───────────────────────────────────────────────
+
+guint32 HistoryStore::intern(const std::string& url)
+{
+    auto it = url_ids_.find(url);
+    if (it != url_ids_.end()) return it->second;
+
+    guint32 id = next_id_++;
+    url_ids_.emplace(url, id);
+    if (title_hashes_.size() <= id) title_hashes_.resize(id + 1, 0);
+
+    TextRecord record = {};
+    record.header.size = static_cast<guint32>(AppendLog::padded(sizeof(TextRecord) + url.size()));
+    record.header.type = RECORD_URL;
+    record.id = id;
+    record.length = static_cast<guint32>(url.size());
+
+    batch_.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    batch_.append(url);
+    batch_.append(record.header.size - sizeof(TextRecord) - url.size(), '\0');
+    return id;
+}
+
+void HistoryStore::write_title(guint32 id, const std::string& title)
+{
+    std::string text = clamp_utf8(title, MAX_TITLE_BYTES);
+    size_t hash = std::hash<std::string>{}(text);
+    if (title_hashes_[id] == hash) return;
+    title_hashes_[id] = hash;
+
+    TextRecord record = {};
+    record.header.size = static_cast<guint32>(AppendLog::padded(sizeof(TextRecord) + text.size()));
+    record.header.type = RECORD_TITLE;
+    record.id = id;
+    record.length = static_cast<guint32>(text.size());
+
+    batch_.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    batch_.append(text);
+    batch_.append(record.header.size - sizeof(TextRecord) - text.size(), '\0');
+}
+
+void HistoryStore::write_visit(guint32 id, const Visit& visit)
+{
+    VisitRecord record = {};
+    record.header.size = sizeof(VisitRecord);
+    record.header.type = RECORD_VISIT;
+    record.id = id;
+    record.flags = visit.typed ? VISIT_TYPED : 0;
+    record.when = visit.when;
+    record.load_ms = visit.load_ms;
+    record.first_row_ms = visit.first_row_ms;
+    record.requests = visit.requests;
+    record.blocked = visit.blocked;
+    record.bytes = visit.bytes;
+
+    batch_.append(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+void HistoryStore::add_visit(const Visit& visit)
+{
+    if (!file_ || visit.url.size() > MAX_URL_BYTES || !HistoryIndex::indexable(visit.url)) return;
+
+    if (!loaded_) {
+        before_load_.push_back({ true, visit });
+        return;
+    }
+
+    guint32 id = intern(visit.url);
+    write_visit(id, visit);
+    if (!visit.title.empty()) write_title(id, visit.title);
+    schedule_flush();
+}
+
+// Titles of pages never visited (still loading) arrive with their visit
+void HistoryStore::set_title(const std::string& url, const std::string& title)
+{
+    if (!file_ || title.empty()) return;
+
+    if (!loaded_) {
+        Pending pending;
+        pending.is_visit = false;
+        pending.visit.url = url;
+        pending.visit.title = title;
+        before_load_.push_back(std::move(pending));
+        return;
+    }
+
+    auto it = url_ids_.find(url);
+    if (it == url_ids_.end()) return;
+
+    write_title(it->second, title);
+    schedule_flush();
+}
+
+// ───────────────────────────────────────────────
+//  Writing
+// ───────────────────────────────────────────────
+
+void HistoryStore::schedule_flush()
+{
+    if (batch_.size() >= FLUSH_BATCH_BYTES) {
+        flush();
+    } else if (!flush_source_ && !batch_.empty()) {
+        flush_source_ = g_timeout_add_seconds(FLUSH_DELAY_S, s_flush, this);
+    }
+}
+
+// One worker at a time; anything recorded meanwhile goes in the next batch
+void HistoryStore::flush()
+{
+    if (flush_source_) {
+        g_source_remove(flush_source_);
+        flush_source_ = 0;
+    }
+    if (write_in_flight_ || batch_.empty()) return;
+
+    auto* data = new WriteData;
+    data->file = file_;
+    data->ticket = file_->take_ticket();
+    data->batch.swap(batch_);
+    write_in_flight_ = true;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_write_done, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<WriteData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_write_thread);
+    g_object_unref(task);
+}
+
+void HistoryStore::start_compaction()
+{
+    compact_wanted_ = false;
+
+    auto* data = new WriteData;
+    data->file = file_;
+    data->ticket = file_->take_ticket();
+    data->cutoff = g_get_real_time() -
+                   static_cast<gint64>(retention_days_) * 86400 * G_USEC_PER_SEC;
+    write_in_flight_ = true;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_write_done, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<WriteData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_compact_thread);
+    g_object_unref(task);
+}
+
+void HistoryStore::on_write_done()
+{
+    write_in_flight_ = false;
+    if (compact_wanted_) {
+        start_compaction();
+    } else {
+        schedule_flush();
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+gboolean HistoryStore::s_flush(gpointer user_data)
+{
+    auto* self = static_cast<HistoryStore*>(user_data);
+    self->flush_source_ = 0;
+    self->flush();
+    return G_SOURCE_REMOVE;
+}
+
+// Reads URLs and titles straight out of the mapping
+void HistoryStore::s_load_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<LoadData*>(task_data);
+    HistoryFile& file = *data->file;
+    HistoryLoadResult& result = data->result;
+    gint64 started = g_get_monotonic_time();
+
+    std::vector<std::string_view> urls;
+    std::vector<std::string_view> titles;
+    std::vector<guint32> title_sizes;
+    std::string url;
+    guint64 visits = 0;
+
+    if (file.map) {
+        result.total_bytes = file.map_size;
+        for_each_record(file.map, file.map_size, [&](guint32 type, const char* record, size_t size) {
+            guint32 id;
+            std::string_view text;
+            VisitRecord visit;
+
+            switch (type) {
+            case RECORD_URL:
+                if (!read_text(record, size, id, text)) break;
+                if (urls.size() <= id) urls.resize(id + 1);
+                urls[id] = text;
+                result.next_id = std::max(result.next_id, id + 1);
+                break;
+
+            case RECORD_TITLE:
+                if (!read_text(record, size, id, text)) break;
+                if (titles.size() <= id) {
+                    titles.resize(id + 1);
+                    title_sizes.resize(id + 1, 0);
+                }
+                result.dead_bytes += title_sizes[id];
+                titles[id] = text;
+                title_sizes[id] = static_cast<guint32>(size);
+                break;
+
+            case RECORD_VISIT:
+                if (!read_visit(record, size, visit) || visit.id >= urls.size() ||
+                    urls[visit.id].empty()) {
+                    break;
+                }
+                // Expired: gone from the file at the next compaction
+                if (visit.when < data->cutoff) {
+                    result.dead_bytes += size;
+                    break;
+                }
+                url.assign(urls[visit.id]);
+                result.index.add_visit(url, visit.when, (visit.flags & VISIT_TYPED) != 0);
+                ++visits;
+                break;
+
+            default:
+                break;
+            }
+        });
+    }
+
+    result.title_hashes.assign(result.next_id, 0);
+    result.url_ids.reserve(urls.size());
+    for (guint32 id = 0; id < urls.size(); ++id) {
+        if (urls[id].empty()) continue;
+        url.assign(urls[id]);
+        result.url_ids.emplace(url, id);
+
+        if (id < titles.size() && !titles[id].empty()) {
+            std::string title(titles[id]);
+            result.index.set_title(url, title);
+            result.title_hashes[id] = std::hash<std::string>{}(title);
+        }
+    }
+
+    COLOSSUS_TRACE("history loaded: %zu URLs, %" G_GUINT64_FORMAT " visits in %.1f ms\n",
+                   result.url_ids.size(), visits,
+                   colossus_ms_between(started, g_get_monotonic_time()));
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void HistoryStore::s_loaded(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<LoadData*>(g_task_get_task_data(task));
+    static_cast<HistoryStore*>(user_data)->finish_load(data->result);
+}
+
+void HistoryStore::s_write_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<WriteData*>(task_data);
+
+    data->file->wait_turn(data->ticket);
+    bool ok = data->file->log.append(data->batch);
+    int saved_errno = errno;
+    data->file->end_turn();
+
+    if (!ok) {
+        g_printerr("COLOSSUS-NAN: Failed to write history: %s\n", g_strerror(saved_errno));
+    }
+    g_task_return_boolean(task, ok);
+}
+
+void HistoryStore::s_compact_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<WriteData*>(task_data);
+
+    data->file->wait_turn(data->ticket);
+    bool ok = data->file->compact(data->cutoff);
+    data->file->end_turn();
+
+    g_task_return_boolean(task, ok);
+}
+
+void HistoryStore::s_write_done(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    static_cast<HistoryStore*>(user_data)->on_write_done();
+}
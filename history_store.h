@@ -0,0 +1,107 @@
+// history_store.h — COLOSSUS append-only, memory-mapped visit log
+
+#ifndef COLOSSUS_HISTORY_STORE_H
+#define COLOSSUS_HISTORY_STORE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+#include "history_index.h"
+
+struct HistoryFile;
+struct HistoryLoadResult;
+
+// Persistent browsing history: one binary log of fixed-layout records
+// (interned URL, title, visit with load timings) behind a small header
+// holding the committed length.
+//
+//  * Opening reads the header and maps the committed region; nothing is
+//    scanned, so startup cost does not depend on history size.
+//  * load() walks the mapping on a worker thread (URLs and titles are read
+//    in place) and hands back a ready HistoryIndex.
+//  * Records are encoded on the main loop and written in batches on a
+//    worker: data first, fdatasync, then the header's committed length. A
+//    crash leaves at most an uncommitted tail, which the next open drops.
+//  * When over half the log is dead (superseded titles, visits older than
+//    the retention window) it is rewritten on a worker and renamed over.
+class HistoryStore {
+public:
+    struct Visit {
+        std::string url;
+        std::string title;
+        gint64 when = 0;            // real time, µs
+        bool typed = false;         // entered in the command bar
+        float load_ms = -1.0f;      // LOAD_STARTED → LOAD_FINISHED
+        float first_row_ms = -1.0f; // browser.js first terminal row
+        guint requests = 0;
+        guint blocked = 0;
+        guint64 bytes = 0;
+    };
+
+    using LoadedCallback = std::function<void(HistoryIndex&& index)>;
+
+    HistoryStore(const std::string& path, guint retention_days);
+    ~HistoryStore();    // writes the pending batch before returning
+
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // Build the index from disk; visits recorded meanwhile are replayed
+    // into it before `callback` runs
+    void load(LoadedCallback callback);
+
+    void add_visit(const Visit& visit);
+    void set_title(const std::string& url, const std::string& title);
+
+    bool loaded() const { return loaded_; }
+
+private:
+    struct Pending {
+        bool is_visit = true;
+        Visit visit;                // title-only updates use url + title
+    };
+
+    std::shared_ptr<HistoryFile> file_;
+    guint retention_days_ = 0;
+    GCancellable* cancellable_ = nullptr;
+
+    bool loaded_ = false;
+    LoadedCallback loaded_callback_;
+    std::vector<Pending> before_load_;
+
+    // Interned URLs, plus a hash of each URL's last written title so
+    // unchanged titles are not logged again
+    std::unordered_map<std::string, guint32> url_ids_;
+    std::vector<size_t> title_hashes_;
+    guint32 next_id_ = 0;
+
+    std::string batch_;             // encoded, not yet handed to a worker
+    guint flush_source_ = 0;
+    bool write_in_flight_ = false;
+    bool compact_wanted_ = false;
+
+    guint32 intern(const std::string& url);
+    void write_title(guint32 id, const std::string& title);
+    void write_visit(guint32 id, const Visit& visit);
+    void schedule_flush();
+    void flush();
+    void start_compaction();
+    void on_write_done();
+    void finish_load(HistoryLoadResult& result);
+
+    static gboolean s_flush(gpointer user_data);
+    static void s_load_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_loaded(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_write_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_compact_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_write_done(GObject* source, GAsyncResult* result, gpointer user_data);
+};
+
+#endif // COLOSSUS_HISTORY_STORE_H
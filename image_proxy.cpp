@@ -0,0 +1,510 @@
+// image_proxy.cpp — COLOSSUS colossus-img:// thumbnail transcoder + disk cache
+
+#include "image_proxy.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glib/gstdio.h>
+
+namespace {
+
+const int MAX_DIMENSION = 1024;
+
+// Larger originals are not fetched, or are cut off once they get there:
+// any page can point the proxy at any URL
+const guint64 MAX_SOURCE_BYTES = 8 * 1024 * 1024;
+const char* INTERNAL_DOWNLOAD_KEY = "colossus-internal";
+
+// Handed to WebKit with the scheme; outlives the proxy, which clears it
+struct Registration {
+    ImageProxy* proxy = nullptr;
+};
+
+struct TranscodeData {
+    std::string key;
+    std::string part_path;
+    std::string out_path;
+    Tone tone = Tone::Mono;
+    int width = 0;
+    int height = 0;
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+ImageProxy::ImageProxy(WebKitWebContext* context,
+                       guint max_fetches,
+                       guint64 cache_limit_bytes)
+    : context_(context)
+    , max_fetches_(max_fetches ? max_fetches : 1)
+{
+    gchar* dir = g_build_filename(g_get_user_cache_dir(), "colossus-nan", "img", nullptr);
+    cache_dir_ = dir;
+    g_free(dir);
+
+    if (g_mkdir_with_parents(cache_dir_.c_str(), 0700) != 0) {
+        g_printerr("COLOSSUS-NAN: Cannot create image cache %s\n", cache_dir_.c_str());
+    }
+
+    cancellable_ = g_cancellable_new();
+
+    gchar* token = g_uuid_string_random();
+    token_ = token;
+    g_free(token);
+
+    fetch_context_ = webkit_web_context_new_ephemeral();
+
+    auto* registration = new Registration{ this };
+    g_object_set_data_full(G_OBJECT(context_), "colossus-image-proxy", registration,
+                           [](gpointer p) { delete static_cast<Registration*>(p); });
+    webkit_web_context_register_uri_scheme(context_, SCHEME, s_request,
+                                           registration, nullptr);
+
+    // Thumbnails are embedded in http(s) pages: no mixed-content blocking.
+    // Not CORS-enabled, so a page cannot read the pixels back.
+    WebKitSecurityManager* security = webkit_web_context_get_security_manager(context_);
+    webkit_security_manager_register_uri_scheme_as_secure(security, SCHEME);
+
+    cache_trimmer_.start(cache_dir_, cache_limit_bytes, cancellable_);
+}
+
+ImageProxy::~ImageProxy()
+{
+    auto* registration = static_cast<Registration*>(
+        g_object_get_data(G_OBJECT(context_), "colossus-image-proxy"));
+    if (registration) registration->proxy = nullptr;
+
+    g_cancellable_cancel(cancellable_);
+
+    GError* error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CANCELLED, "Shutting down");
+    for (auto& entry : jobs_) {
+        Job& job = *entry.second;
+        if (job.download) {
+            g_signal_handlers_disconnect_by_data(job.download, this);
+            webkit_download_cancel(job.download);
+            g_object_unref(job.download);
+        }
+        for (WebKitURISchemeRequest* request : job.waiters) {
+            webkit_uri_scheme_request_finish_error(request, error);
+            g_object_unref(request);
+        }
+    }
+    g_error_free(error);
+    jobs_.clear();
+
+    g_clear_object(&fetch_context_);
+    g_clear_object(&cancellable_);
+}
+
+// ───────────────────────────────────────────────
+//  Requests
+// ───────────────────────────────────────────────
+
+std::string ImageProxy::prefix() const
+{
+    return std::string(SCHEME) + "://" + token_ + "/";
+}
+
+// colossus-img://<token>/<mono|amber>/<W>x<H>/<percent-encoded http(s) URL>
+bool ImageProxy::parse_uri(const char* uri, Spec& spec) const
+{
+    std::string expected = prefix();
+    if (!uri || g_ascii_strncasecmp(uri, expected.c_str(), expected.size()) != 0)
+        return false;
+
+    const char* tone = uri + expected.size();
+    const char* size = strchr(tone, '/');
+    if (!size) return false;
+    const char* encoded = strchr(size + 1, '/');
+    if (!encoded) return false;
+
+    std::string tone_name(tone, size - tone);
+    if (tone_name == "mono") spec.tone = Tone::Mono;
+    else if (tone_name == "amber") spec.tone = Tone::Amber;
+    else return false;
+
+    if (sscanf(size + 1, "%dx%d", &spec.width, &spec.height) != 2 ||
+        spec.width <= 0 || spec.height <= 0)
+        return false;
+    spec.width = std::min(spec.width, MAX_DIMENSION);
+    spec.height = std::min(spec.height, MAX_DIMENSION);
+
+    gchar* src = g_uri_unescape_string(encoded + 1, nullptr);
+    if (!src) return false;
+    spec.src = src;
+    g_free(src);
+
+    if (g_ascii_strncasecmp(spec.src.c_str(), "http://", 7) != 0 &&
+        g_ascii_strncasecmp(spec.src.c_str(), "https://", 8) != 0)
+        return false;
+
+    std::string id = tone_name + "|" + std::to_string(spec.width) + "x" +
+                     std::to_string(spec.height) + "|" + spec.src;
+    gchar* key = g_compute_checksum_for_string(G_CHECKSUM_SHA1, id.c_str(), -1);
+    spec.key = key;
+    g_free(key);
+    return true;
+}
+
+std::string ImageProxy::cache_path(const Spec& spec) const
+{
+    gchar* path = g_build_filename(cache_dir_.c_str(), (spec.key + ".png").c_str(), nullptr);
+    std::string out(path);
+    g_free(path);
+    return out;
+}
+
+void ImageProxy::serve(WebKitURISchemeRequest* request, GBytes* png)
+{
+    GInputStream* stream = g_memory_input_stream_new_from_bytes(png);
+    webkit_uri_scheme_request_finish(request, stream,
+                                     static_cast<gint64>(g_bytes_get_size(png)),
+                                     "image/png");
+    g_object_unref(stream);
+}
+
+// Cache hit: a few KB of PNG, read straight from disk
+GBytes* ImageProxy::read_cached(const Spec& spec)
+{
+    gchar* contents = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents(cache_path(spec).c_str(), &contents, &length, nullptr))
+        return nullptr;
+
+    ++cache_hits_;
+    return g_bytes_new_take(contents, length);
+}
+
+// The in-flight job for `spec`, queued if there was none
+ImageProxy::Job& ImageProxy::add_job(const Spec& spec)
+{
+    auto it = jobs_.find(spec.key);
+    if (it != jobs_.end()) return *it->second;
+
+    auto job = std::make_unique<Job>();
+    job->spec = spec;
+    Job& added = *job;
+    jobs_.emplace(spec.key, std::move(job));
+    queued_.push_back(spec.key);
+    return added;
+}
+
+void ImageProxy::on_request(WebKitURISchemeRequest* request)
+{
+    Spec spec;
+    if (!parse_uri(webkit_uri_scheme_request_get_uri(request), spec)) {
+        GError* error = g_error_new(G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                    "Bad %s URI", SCHEME);
+        webkit_uri_scheme_request_finish_error(request, error);
+        g_error_free(error);
+        return;
+    }
+
+    if (GBytes* png = read_cached(spec)) {
+        serve(request, png);
+        g_bytes_unref(png);
+        return;
+    }
+
+    add_job(spec).waiters.push_back(WEBKIT_URI_SCHEME_REQUEST(g_object_ref(request)));
+    start_fetches();
+}
+
+void ImageProxy::fetch(const std::string& uri, FetchCallback callback)
+{
+    Spec spec;
+    if (!parse_uri(uri.c_str(), spec)) {
+        callback(nullptr);
+        return;
+    }
+
+    if (GBytes* png = read_cached(spec)) {
+        callback(png);
+        g_bytes_unref(png);
+        return;
+    }
+
+    add_job(spec).callbacks.push_back(std::move(callback));
+    start_fetches();
+}
+
+// ───────────────────────────────────────────────
+//  Fetching
+// ───────────────────────────────────────────────
+
+void ImageProxy::start_fetches()
+{
+    while (active_fetches_ < max_fetches_ && !queued_.empty()) {
+        std::string key = queued_.front();
+        queued_.pop_front();
+
+        auto it = jobs_.find(key);
+        if (it != jobs_.end()) start_fetch(*it->second);
+    }
+}
+
+void ImageProxy::start_fetch(Job& job)
+{
+    job.part_path = cache_path(job.spec) + ".part";
+
+    // Without the user's cookies: what a page gets back must not depend on
+    // who is logged in where
+    job.download = webkit_web_context_download_uri(fetch_context_, job.spec.src.c_str());
+    g_object_set_data(G_OBJECT(job.download), INTERNAL_DOWNLOAD_KEY, GINT_TO_POINTER(1));
+    webkit_download_set_allow_overwrite(job.download, TRUE);
+
+    g_signal_connect(job.download, "decide-destination",
+                     G_CALLBACK(s_decide_destination), this);
+    g_signal_connect(job.download, "received-data",
+                     G_CALLBACK(s_received_data), this);
+    g_signal_connect(job.download, "finished",
+                     G_CALLBACK(s_download_finished), this);
+    g_signal_connect(job.download, "failed",
+                     G_CALLBACK(s_download_failed), this);
+
+    ++active_fetches_;
+}
+
+ImageProxy::Job* ImageProxy::job_for_download(WebKitDownload* download)
+{
+    for (auto& entry : jobs_) {
+        if (entry.second->download == download) return entry.second.get();
+    }
+    return nullptr;
+}
+
+void ImageProxy::on_download_finished(WebKitDownload* download)
+{
+    // "finished" also follows "failed", which already retired the job
+    Job* job = job_for_download(download);
+    if (!job) return;
+
+    g_signal_handlers_disconnect_by_data(download, this);
+    g_object_unref(download);
+    job->download = nullptr;
+    --active_fetches_;
+
+    auto* data = new TranscodeData;
+    data->key = job->spec.key;
+    data->part_path = job->part_path;
+    data->out_path = cache_path(job->spec);
+    data->tone = job->spec.tone;
+    data->width = job->spec.width;
+    data->height = job->spec.height;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_transcode_done, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<TranscodeData*>(p); });
+    g_task_run_in_thread(task, s_transcode_thread);
+    g_object_unref(task);
+
+    start_fetches();
+}
+
+void ImageProxy::on_download_failed(WebKitDownload* download, GError* error)
+{
+    Job* job = job_for_download(download);
+    if (!job) return;
+
+    g_signal_handlers_disconnect_by_data(download, this);
+    g_object_unref(download);
+    job->download = nullptr;
+    --active_fetches_;
+
+    g_unlink(job->part_path.c_str());
+    finish_job(job->spec.key, nullptr, error);
+
+    start_fetches();
+}
+
+// ───────────────────────────────────────────────
+//  Transcoding (worker thread)
+// ───────────────────────────────────────────────
+
+void ImageProxy::s_transcode_thread(GTask* task, gpointer, gpointer task_data,
+                                    GCancellable*)
+{
+    auto* data = static_cast<TranscodeData*>(task_data);
+    GError* error = nullptr;
+
+    // Decode straight to the target size (JPEG decodes scaled), never upscale
+    int width = 0, height = 0;
+    if (!gdk_pixbuf_get_file_info(data->part_path.c_str(), &width, &height) ||
+        width <= 0 || height <= 0) {
+        g_unlink(data->part_path.c_str());
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                "Unsupported image format");
+        return;
+    }
+
+    double scale = std::min({ 1.0,
+                              static_cast<double>(data->width) / width,
+                              static_cast<double>(data->height) / height });
+    int target_w = std::max(1, static_cast<int>(width * scale));
+    int target_h = std::max(1, static_cast<int>(height * scale));
+
+    GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file_at_scale(
+        data->part_path.c_str(), target_w, target_h, TRUE, &error);
+    g_unlink(data->part_path.c_str());
+    if (!pixbuf) {
+        g_task_return_error(task, error);
+        return;
+    }
+
+    if (!gdk_pixbuf_get_has_alpha(pixbuf)) {
+        GdkPixbuf* rgba = gdk_pixbuf_add_alpha(pixbuf, FALSE, 0, 0, 0);
+        g_object_unref(pixbuf);
+        pixbuf = rgba;
+    }
+
+    tone_map_rgba(gdk_pixbuf_get_pixels(pixbuf),
+                  gdk_pixbuf_get_width(pixbuf),
+                  gdk_pixbuf_get_height(pixbuf),
+                  gdk_pixbuf_get_rowstride(pixbuf),
+                  data->tone);
+
+    gchar* buffer = nullptr;
+    gsize size = 0;
+    gboolean saved = gdk_pixbuf_save_to_buffer(pixbuf, &buffer, &size, "png",
+                                               &error, nullptr);
+    g_object_unref(pixbuf);
+    if (!saved) {
+        g_task_return_error(task, error);
+        return;
+    }
+
+    // Best effort: a failed cache write only costs a refetch later
+    g_file_set_contents(data->out_path.c_str(), buffer, static_cast<gssize>(size), nullptr);
+
+    g_task_return_pointer(task, g_bytes_new_take(buffer, size),
+                          reinterpret_cast<GDestroyNotify>(g_bytes_unref));
+}
+
+void ImageProxy::on_transcoded(const std::string& key, GBytes* png, GError* error)
+{
+    if (png) {
+        ++transcoded_;
+        cache_trimmer_.wrote(g_bytes_get_size(png));
+    }
+    finish_job(key, png, error);
+}
+
+void ImageProxy::finish_job(const std::string& key, GBytes* png, GError* error)
+{
+    auto it = jobs_.find(key);
+    if (it == jobs_.end()) return;
+
+    std::unique_ptr<Job> job = std::move(it->second);
+    jobs_.erase(it);
+
+    if (!png) {
+        ++failures_;
+        COLOSSUS_TRACE("image proxy failed for %s: %s\n", job->spec.src.c_str(),
+                       error ? error->message : "unknown error");
+    }
+
+    for (WebKitURISchemeRequest* request : job->waiters) {
+        if (png) {
+            serve(request, png);
+        } else {
+            // browser.js falls back to the original URL on error
+            GError* failed = error ? g_error_copy(error)
+                                   : g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                                         "Image fetch failed");
+            webkit_uri_scheme_request_finish_error(request, failed);
+            g_error_free(failed);
+        }
+        g_object_unref(request);
+    }
+
+    for (const FetchCallback& callback : job->callbacks) {
+        callback(png);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+void ImageProxy::s_request(WebKitURISchemeRequest* request, gpointer user_data)
+{
+    auto* registration = static_cast<Registration*>(user_data);
+    if (!registration->proxy) {
+        GError* error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CANCELLED, "Shutting down");
+        webkit_uri_scheme_request_finish_error(request, error);
+        g_error_free(error);
+        return;
+    }
+    registration->proxy->on_request(request);
+}
+
+gboolean ImageProxy::s_decide_destination(WebKitDownload* download,
+                                          gchar*,
+                                          gpointer user_data)
+{
+    auto* self = static_cast<ImageProxy*>(user_data);
+    Job* job = self->job_for_download(download);
+    if (!job) return FALSE;
+
+    // Announced too large: cancelling fails the download, which retires
+    // the job
+    WebKitURIResponse* response = webkit_download_get_response(download);
+    guint64 length = response ? webkit_uri_response_get_content_length(response) : 0;
+    if (length > MAX_SOURCE_BYTES) {
+        COLOSSUS_TRACE("image too large (%" G_GUINT64_FORMAT " KB): %s\n",
+                       length / 1024, job->spec.src.c_str());
+        webkit_download_cancel(download);
+        return TRUE;
+    }
+
+    gchar* uri = g_filename_to_uri(job->part_path.c_str(), nullptr, nullptr);
+    webkit_download_set_destination(download, uri);
+    g_free(uri);
+    return TRUE;
+}
+
+// No or a false Content-Length: counted as it arrives
+void ImageProxy::s_received_data(WebKitDownload* download, guint64, gpointer user_data)
+{
+    if (webkit_download_get_received_data_length(download) <= MAX_SOURCE_BYTES) return;
+
+    auto* self = static_cast<ImageProxy*>(user_data);
+    Job* job = self->job_for_download(download);
+    if (!job) return;
+
+    COLOSSUS_TRACE("image too large (over %" G_GUINT64_FORMAT " KB): %s\n",
+                   MAX_SOURCE_BYTES / 1024, job->spec.src.c_str());
+    webkit_download_cancel(download);
+}
+
+void ImageProxy::s_download_finished(WebKitDownload* download, gpointer user_data)
+{
+    static_cast<ImageProxy*>(user_data)->on_download_finished(download);
+}
+
+void ImageProxy::s_download_failed(WebKitDownload* download, GError* error,
+                                   gpointer user_data)
+{
+    static_cast<ImageProxy*>(user_data)->on_download_failed(download, error);
+}
+
+void ImageProxy::s_transcode_done(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+
+    // The proxy is gone once its cancellable fires
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<TranscodeData*>(g_task_get_task_data(task));
+    GError* error = nullptr;
+    auto* png = static_cast<GBytes*>(g_task_propagate_pointer(task, &error));
+
+    static_cast<ImageProxy*>(user_data)->on_transcoded(data->key, png, error);
+
+    if (png) g_bytes_unref(png);
+    if (error) g_error_free(error);
+}
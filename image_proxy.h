@@ -0,0 +1,125 @@
+// image_proxy.h — COLOSSUS colossus-img:// thumbnail transcoder + disk cache
+
+#ifndef COLOSSUS_IMAGE_PROXY_H
+#define COLOSSUS_IMAGE_PROXY_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+#include "cache_trim.h"
+#include "tone_map.h"
+
+// Serves colossus-img://<token>/<tone>/<width>x<height>/<encoded source URL>.
+//
+// The source is fetched through a private ephemeral web context, so no
+// cookies or HTTP credentials go with it, decoded at no more than the
+// requested size, tone mapped to the terminal palette off the main loop,
+// and written to the on-disk cache as PNG so later requests for the same
+// URL, tone and size are a single file read. Identical in-flight requests
+// share one fetch. Originals over 8 MB are refused.
+//
+// `token` is random per session and handed to browser.js only (see
+// Browser::inject_user_script); requests without it are refused, so a page
+// cannot drive the proxy blind. The scheme is not CORS-enabled: pages can
+// show its images but not read them back.
+class ImageProxy {
+public:
+    static constexpr const char* SCHEME = "colossus-img";
+
+    // The PNG, or nullptr when the fetch or transcode failed
+    using FetchCallback = std::function<void(GBytes* png)>;
+
+    ImageProxy(WebKitWebContext* context,
+               guint max_fetches,
+               guint64 cache_limit_bytes);
+    ~ImageProxy();
+
+    ImageProxy(const ImageProxy&) = delete;
+    ImageProxy& operator=(const ImageProxy&) = delete;
+
+    // The same as a page loading `uri` (a colossus-img:// URI), for the UI
+    // process. Callbacks still pending when the proxy goes away are dropped.
+    void fetch(const std::string& uri, FetchCallback callback);
+
+    // colossus-img://<token>/ — every request starts with it
+    std::string prefix() const;
+    const std::string& token() const { return token_; }
+
+    guint64 cache_hits() const { return cache_hits_; }
+    guint64 transcoded() const { return transcoded_; }
+    guint64 failures() const { return failures_; }
+
+private:
+    struct Spec {
+        Tone tone = Tone::Mono;
+        int width = 0;
+        int height = 0;
+        std::string src;
+        std::string key;            // hash of tone, size and src
+    };
+
+    struct Job {
+        Spec spec;
+        std::vector<WebKitURISchemeRequest*> waiters;   // one ref each
+        std::vector<FetchCallback> callbacks;           // fetch() callers
+        WebKitDownload* download = nullptr;
+        std::string part_path;
+    };
+
+    WebKitWebContext* context_ = nullptr;
+    WebKitWebContext* fetch_context_ = nullptr;     // ephemeral: no cookies
+    std::string token_;
+    std::string cache_dir_;
+    guint max_fetches_ = 0;
+    GCancellable* cancellable_ = nullptr;
+    ColossusCacheTrimmer cache_trimmer_;    // at start and as PNGs are written
+
+    std::map<std::string, std::unique_ptr<Job>> jobs_;  // by Spec::key
+    std::deque<std::string> queued_;
+    guint active_fetches_ = 0;
+
+    guint64 cache_hits_ = 0;
+    guint64 transcoded_ = 0;
+    guint64 failures_ = 0;
+
+    bool parse_uri(const char* uri, Spec& spec) const;
+    std::string cache_path(const Spec& spec) const;
+
+    void on_request(WebKitURISchemeRequest* request);
+    GBytes* read_cached(const Spec& spec);
+    Job& add_job(const Spec& spec);
+    void start_fetches();
+    void start_fetch(Job& job);
+    void on_download_finished(WebKitDownload* download);
+    void on_download_failed(WebKitDownload* download, GError* error);
+    void on_transcoded(const std::string& key, GBytes* png, GError* error);
+    void finish_job(const std::string& key, GBytes* png, GError* error);
+    Job* job_for_download(WebKitDownload* download);
+
+    static void serve(WebKitURISchemeRequest* request, GBytes* png);
+
+    static void s_request(WebKitURISchemeRequest* request, gpointer user_data);
+    static gboolean s_decide_destination(WebKitDownload* download,
+                                         gchar* suggested_filename,
+                                         gpointer user_data);
+    static void s_received_data(WebKitDownload* download, guint64 data_length,
+                                gpointer user_data);
+    static void s_download_finished(WebKitDownload* download, gpointer user_data);
+    static void s_download_failed(WebKitDownload* download, GError* error,
+                                  gpointer user_data);
+    static void s_transcode_thread(GTask* task, gpointer source, gpointer task_data,
+                                   GCancellable* cancellable);
+    static void s_transcode_done(GObject* source, GAsyncResult* result,
+                                 gpointer user_data);
+};
+
+#endif // COLOSSUS_IMAGE_PROXY_H
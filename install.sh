@@ -89,6 +89,12 @@ echo "[CN-007] INSTALLING SYSTEM FILES..."
 sudo mkdir -p /usr/local/share/colossus-nan/resources
 sudo cp -r resources/* /usr/local/share/colossus-nan/resources/
 
+# Install native web-process extension (optional; browser.js falls back to JS)
+if [ -f web-extensions/libcolossus-nan-ext.so ]; then
+    sudo mkdir -p /usr/local/lib/colossus-nan/web-extensions
+    sudo cp web-extensions/libcolossus-nan-ext.so /usr/local/lib/colossus-nan/web-extensions/
+fi
+
 # Install executable (rename COLOSSUS-NAN -> nan)
 sudo cp "$BIN_BUILD" /usr/local/bin/"$BIN_INSTALL"
 sudo chmod +x /usr/local/bin/"$BIN_INSTALL"
@@ -0,0 +1,130 @@
+// load_profile.cpp — COLOSSUS per-tab load profiles
+
+#include "load_profile.h"
+
+namespace {
+
+// Hostname substrings shown natively. browser.js gets this list from
+// load_profile_full_hosts() when the script is injected.
+const char* const FULL_PROFILE_HOSTS[] = {
+    "telehack.com",
+    "levidia.ch"
+};
+
+// Regex-escape for a JSON string literal (backslashes already doubled)
+std::string escape_regex(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (std::string(".+?*^$()[]{}|\\").find(c) != std::string::npos) out += "\\\\";
+        out += c;
+    }
+    return out;
+}
+
+} // namespace
+
+std::string host_of(const std::string& uri)
+{
+    size_t scheme = uri.find("://");
+    if (scheme == std::string::npos) return {};
+
+    size_t start = scheme + 3;
+    size_t end = uri.find_first_of("/?#", start);
+    std::string host = uri.substr(start, end == std::string::npos ? std::string::npos
+                                                                  : end - start);
+
+    size_t at = host.rfind('@');
+    if (at != std::string::npos) host.erase(0, at + 1);
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos && host.find(']') == std::string::npos) host.erase(colon);
+
+    for (auto& c : host) c = g_ascii_tolower(c);
+    return host;
+}
+
+LoadProfile load_profile_for_uri(const std::string& uri)
+{
+    // Internal pages, files, about:blank: nothing to save
+    if (uri.compare(0, 7, "http://") != 0 && uri.compare(0, 8, "https://") != 0)
+        return LoadProfile::Full;
+
+    std::string host = host_of(uri);
+    for (const char* exempt : FULL_PROFILE_HOSTS) {
+        if (host.find(exempt) != std::string::npos) return LoadProfile::Full;
+    }
+    return LoadProfile::Diet;
+}
+
+std::string load_profile_full_hosts()
+{
+    std::string out;
+    for (const char* host : FULL_PROFILE_HOSTS) {
+        if (!out.empty()) out += ',';
+        out += host;
+    }
+    return out;
+}
+
+const char* load_profile_name(LoadProfile profile)
+{
+    return profile == LoadProfile::Diet ? "diet" : "full";
+}
+
+WebKitSettings* load_profile_diet_settings(WebKitSettings* base)
+{
+    WebKitSettings* settings = webkit_settings_new();
+
+    // Keep whatever the shared settings were configured with
+    webkit_settings_set_user_agent(settings, webkit_settings_get_user_agent(base));
+    webkit_settings_set_enable_javascript(settings,
+                                          webkit_settings_get_enable_javascript(base));
+
+    webkit_settings_set_enable_webgl(settings, FALSE);
+    webkit_settings_set_enable_webaudio(settings, FALSE);
+    webkit_settings_set_enable_mediasource(settings, FALSE);
+    webkit_settings_set_enable_media_stream(settings, FALSE);
+    webkit_settings_set_enable_encrypted_media(settings, FALSE);
+    webkit_settings_set_media_playback_requires_user_gesture(settings, TRUE);
+    return settings;
+}
+
+std::string load_profile_diet_rules(bool block_third_party_scripts)
+{
+    // Exempt top-level pages, matched like host.includes(...) in browser.js
+    std::string unless_top = "[";
+    bool first = true;
+    for (const char* exempt : FULL_PROFILE_HOSTS) {
+        if (!first) unless_top += ',';
+        first = false;
+        unless_top += "\"^[^:]+://+[^/]*" + escape_regex(exempt) + "\"";
+    }
+    unless_top += "]";
+
+    // Only http(s): colossus-img:// thumbnails must keep loading. Web fonts
+    // are covered by "font" (WebKitSettings has no switch for them).
+    // Page images are dropped because the terminal view shows proxied
+    // copies; the original browser.js falls back to when the proxy fails
+    // carries DIET_FALLBACK_MARK and is let through. Frames cannot be told
+    // apart from top-level documents on every supported WebKitGTK, so they
+    // are left alone.
+    std::string rules =
+        "["
+        "{\"trigger\":{\"url-filter\":\"^https?://\","
+        "\"resource-type\":[\"style-sheet\",\"font\",\"media\",\"svg-document\",\"image\"],"
+        "\"unless-top-url\":" + unless_top + "},"
+        "\"action\":{\"type\":\"block\"}},"
+        "{\"trigger\":{\"url-filter\":\"" + escape_regex(DIET_FALLBACK_MARK) + "$\","
+        "\"resource-type\":[\"image\"]},"
+        "\"action\":{\"type\":\"ignore-previous-rules\"}}";
+
+    // Opt-in: many sites render nothing useful without their CDN's scripts
+    if (block_third_party_scripts) {
+        rules +=
+            ",{\"trigger\":{\"url-filter\":\"^https?://\","
+            "\"resource-type\":[\"script\"],\"load-type\":[\"third-party\"],"
+            "\"unless-top-url\":" + unless_top + "},"
+            "\"action\":{\"type\":\"block\"}}";
+    }
+    return rules + "]";
+}
@@ -0,0 +1,46 @@
+// load_profile.h — COLOSSUS per-tab load profiles
+
+#ifndef COLOSSUS_LOAD_PROFILE_H
+#define COLOSSUS_LOAD_PROFILE_H
+
+#include <string>
+
+extern "C" {
+#include <webkit2/webkit2.h>
+}
+
+// Full:  the page is shown as-is (Telehack, native-amber hosts)
+// Diet:  browser.js rebuilds the page as the terminal view, so everything
+//        it never displays (stylesheets, web fonts, media, page images,
+//        WebGL, autoplay; third-party scripts on request) is not fetched
+//        or run
+enum class LoadProfile {
+    Full,
+    Diet
+};
+
+// Fragment browser.js appends to a page image it loads directly after the
+// image proxy failed on it; the Diet rules let such images through
+constexpr const char* DIET_FALLBACK_MARK = "#colossus-fallback";
+
+// Lowercase host of an absolute URI, "" if it has none
+std::string host_of(const std::string& uri);
+
+// Full for the hosts in load_profile_full_hosts(), Diet otherwise
+LoadProfile load_profile_for_uri(const std::string& uri);
+
+// The Full-profile hostname substrings, comma-separated; browser.js gets
+// them in place of "@COLOSSUS_FULL_PROFILE_HOSTS@"
+std::string load_profile_full_hosts();
+
+const char* load_profile_name(LoadProfile profile);
+
+// WebKitSettings for the Diet profile, derived from `base`
+WebKitSettings* load_profile_diet_settings(WebKitSettings* base);
+
+// Content-blocker JSON applying the Diet profile to every top-level page
+// outside the exempt hosts. Exempt pages are matched by top URL, so the
+// rules follow the same decision as load_profile_for_uri().
+std::string load_profile_diet_rules(bool block_third_party_scripts);
+
+#endif // COLOSSUS_LOAD_PROFILE_H
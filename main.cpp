@@ -1,7 +1,13 @@
 // main.cpp — entry point for COLOSSUS Browser
 
 #include <gtk/gtk.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "app_resources.h"
 #include "browser.h"
+#include "trace.h"
 
 // Global browser instance (same pattern you had before)
 static Browser* g_browser = nullptr;
@@ -14,13 +20,20 @@ static void load_colossus_gtk_theme()
     GtkCssProvider* provider = gtk_css_provider_new();
     GError* error = nullptr;
 
-    const char* css_path = "resources/gtk-colossus.css";
+    // Built in; COLOSSUS_RESOURCES_DIR overrides it for theme work
+    const char* css_name = "gtk-colossus.css";
+    std::string css_path = colossus_resource_override(css_name);
 
-    gtk_css_provider_load_from_path(provider, css_path, &error);
+    if (!css_path.empty()) {
+        gtk_css_provider_load_from_path(provider, css_path.c_str(), &error);
+    } else {
+        css_path = colossus_resource_path(css_name);
+        gtk_css_provider_load_from_resource(provider, css_path.c_str());
+    }
 
     if (error) {
         g_printerr("Failed to load Colossus GTK theme (%s): %s\n",
-                   css_path, error->message);
+                   css_path.c_str(), error->message);
         g_error_free(error);
     } else {
         GdkScreen* screen = gdk_screen_get_default();
@@ -40,6 +53,7 @@ static void on_app_startup(GtkApplication* app, gpointer user_data)
     (void)app;
     (void)user_data;
     load_colossus_gtk_theme();
+    colossus_startup_mark("theme");
 }
 
 // Called whenever the app is activated (first launch or re-activation)
@@ -54,15 +68,130 @@ static void on_app_activate(GtkApplication* app, gpointer user_data)
     g_browser->show();
 }
 
+// Before GtkApplication takes the windows down, while the tabs' views
+// still exist (closing the window saves too; this covers other exits)
+static void on_app_shutdown(GtkApplication* app, gpointer user_data)
+{
+    (void)app;
+    (void)user_data;
+
+    if (g_browser) g_browser->save_session_now();
+}
+
+// ───────────────────────────────────────────────
+//  Remote open
+// ───────────────────────────────────────────────
+//
+// Only the first COLOSSUS-NAN process builds a browser. Any later one
+// registers as a remote instance of the same application ID, hands its
+// arguments over D-Bus to that primary instance and exits. The primary
+// opens them as tabs (Browser::open_uris), without a cold start.
+
+// On a cold start the browser opens them itself, in place of the homepage
+// or the saved active tab
+static void open_in_browser(GtkApplication* app, const std::vector<std::string>& uris)
+{
+    if (!g_browser) {
+        g_browser = new Browser(app, {}, uris);
+    } else {
+        g_browser->open_uris(uris);
+    }
+    g_browser->show();
+}
+
+// `COLOSSUS-NAN [URL | FILE | search words]...`, run in the primary
+// instance with the invoking process's arguments and working directory.
+// Existing files open as file:// URIs and addresses go through the
+// command bar's rules (Browser::uri_for_input); the remaining words make
+// one search, in the tab where the first of them stood.
+static int on_app_command_line(GtkApplication* app,
+                               GApplicationCommandLine* command_line,
+                               gpointer user_data)
+{
+    (void)user_data;
+
+    gint argc = 0;
+    gchar** argv = g_application_command_line_get_arguments(command_line, &argc);
+
+    std::vector<std::string> uris;
+    std::string query;
+    size_t query_at = 0;
+    for (gint i = 1; i < argc; ++i) {
+        const gchar* arg = argv[i];
+        if (!arg || !*arg) continue;
+
+        if (!g_strstr_len(arg, -1, "://")) {
+            GFile* file = g_application_command_line_create_file_for_arg(command_line, arg);
+            if (g_file_query_exists(file, nullptr)) {
+                gchar* uri = g_file_get_uri(file);
+                uris.push_back(uri);
+                g_free(uri);
+                g_object_unref(file);
+                continue;
+            }
+            g_object_unref(file);
+
+            if (!Browser::looks_like_uri(arg)) {
+                if (query.empty()) query_at = uris.size();
+                else query += ' ';
+                query += arg;
+                continue;
+            }
+        }
+        uris.push_back(arg);
+    }
+    g_strfreev(argv);
+
+    if (!query.empty()) {
+        uris.insert(uris.begin() + static_cast<std::ptrdiff_t>(query_at), query);
+    }
+
+    if (uris.empty()) {
+        g_application_activate(G_APPLICATION(app));
+    } else {
+        open_in_browser(app, uris);
+    }
+    return 0;
+}
+
+// D-Bus activation and file managers ("Open With")
+static void on_app_open(GtkApplication* app,
+                        GFile** files,
+                        gint n_files,
+                        const gchar* hint,
+                        gpointer user_data)
+{
+    (void)hint;
+    (void)user_data;
+
+    std::vector<std::string> uris;
+    for (gint i = 0; i < n_files; ++i) {
+        gchar* uri = g_file_get_uri(files[i]);
+        if (uri) uris.push_back(uri);
+        g_free(uri);
+    }
+    open_in_browser(app, uris);
+}
+
 int main(int argc, char** argv)
 {
+    colossus_startup_mark("main");
+
     GtkApplication* app =
-        gtk_application_new("tech.will.colossus", G_APPLICATION_DEFAULT_FLAGS);
+        gtk_application_new("tech.will.colossus",
+                            static_cast<GApplicationFlags>(G_APPLICATION_HANDLES_COMMAND_LINE |
+                                                           G_APPLICATION_HANDLES_OPEN));
 
     g_signal_connect(app, "startup",
                      G_CALLBACK(on_app_startup), nullptr);
     g_signal_connect(app, "activate",
                      G_CALLBACK(on_app_activate), nullptr);
+    g_signal_connect(app, "shutdown",
+                     G_CALLBACK(on_app_shutdown), nullptr);
+    g_signal_connect(app, "command-line",
+                     G_CALLBACK(on_app_command_line), nullptr);
+    g_signal_connect(app, "open",
+                     G_CALLBACK(on_app_open), nullptr);
 
     int status = g_application_run(G_APPLICATION(app), argc, argv);
 
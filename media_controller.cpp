@@ -0,0 +1,496 @@
+// media_controller.cpp — COLOSSUS persistent mpv driven over JSON IPC
+
+#include "media_controller.h"
+#include "trace.h"
+
+#include <iostream>
+#include <memory>
+
+#include <unistd.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib/gstdio.h>
+
+namespace {
+
+// Give mpv this long to create its IPC socket after spawning
+const guint CONNECT_INTERVAL_MS = 100;
+const guint CONNECT_MAX_ATTEMPTS = 50;
+
+// Observed with ids 1..n, reported back as property-change events
+const char* const OBSERVED_PROPERTIES[] = {
+    "pause", "idle-active", "media-title", "playlist-pos"
+};
+
+bool is_cancelled(GError* error)
+{
+    return error && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+// One line being written; owns its bytes, so the queue can be dropped
+// while the write is in flight
+struct PendingWrite {
+    MediaController* self;
+    std::string line;
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+MediaController::MediaController()
+{
+    json_ = jsc_context_new();
+
+    gchar* name = g_strdup_printf("colossus-nan-mpv-%d.sock", static_cast<int>(getpid()));
+    gchar* path = g_build_filename(g_get_user_runtime_dir(), name, nullptr);
+    socket_path_ = path;
+    g_free(path);
+    g_free(name);
+}
+
+MediaController::~MediaController()
+{
+    changed_ = nullptr;
+
+    // The main loop is done with us: the one quit line is written in place,
+    // unless a write in flight would leave it after half a command
+    if (connection_ && !writing_) {
+        static const char quit[] = "{\"command\":[\"quit\"]}\n";
+        GOutputStream* out = g_io_stream_get_output_stream(G_IO_STREAM(connection_));
+        g_output_stream_write_all(out, quit, sizeof(quit) - 1, nullptr, nullptr, nullptr);
+    } else if (process_) {
+        g_subprocess_force_exit(process_);
+    }
+    shutdown_process();
+    g_clear_object(&json_);
+}
+
+MediaController::Item MediaController::item_for_url(const std::string& url)
+{
+    Item item;
+    item.url = url;
+
+    // Telehack Radio: audio-only stream
+    item.audio_only = url.find("telehack.com/radio") != std::string::npos ||
+                      url.find("telehack/radio") != std::string::npos;
+    return item;
+}
+
+const char* MediaController::state_name(State state)
+{
+    switch (state) {
+    case State::Stopped:  return "stopped";
+    case State::Starting: return "starting";
+    case State::Idle:     return "idle";
+    case State::Playing:  return "playing";
+    case State::Paused:   return "paused";
+    }
+    return "unknown";
+}
+
+// ───────────────────────────────────────────────
+//  Requests
+// ───────────────────────────────────────────────
+
+void MediaController::play_now(const Item& item)
+{
+    ensure_running();
+    load(item, true);
+}
+
+void MediaController::enqueue(const Item& item)
+{
+    ensure_running();
+    load(item, false);
+}
+
+void MediaController::toggle_pause()
+{
+    if (state_ == State::Stopped) return;
+    send("{\"command\":[\"cycle\",\"pause\"]}");
+}
+
+void MediaController::load(const Item& item, bool replace)
+{
+    // Per-file options; %len% quoting keeps commas in URLs intact
+    auto quoted = [](const std::string& value) {
+        return "%" + std::to_string(value.size()) + "%" + value;
+    };
+
+    std::vector<std::string> options;
+    if (item.audio_only) options.push_back("vid=no");
+
+    std::string url = item.url;
+    if (!item.streams.empty()) {
+        url = item.streams[0];
+        if (item.streams.size() > 1) options.push_back("audio-file=" + quoted(item.streams[1]));
+        if (!item.title.empty()) options.push_back("force-media-title=" + quoted(item.title));
+    }
+
+    // Named arguments: the positional form of loadfile changed in mpv 0.38
+    std::string command =
+        "{\"command\":{\"name\":\"loadfile\",\"url\":" + json_string(url) +
+        ",\"flags\":\"" + (replace ? "replace" : "append-play") + "\"";
+    if (!options.empty()) {
+        std::string joined;
+        for (const auto& option : options) {
+            if (!joined.empty()) joined += ',';
+            joined += option;
+        }
+        command += ",\"options\":" + json_string(joined);
+    }
+    command += "}}";
+
+    if (replace) {
+        playlist_.clear();
+        playlist_pos_ = -1;
+    }
+    playlist_.push_back(item);
+
+    send(command);
+    notify_changed();
+}
+
+std::string MediaController::json_string(const std::string& s)
+{
+    JSCValue* value = jsc_value_new_string(json_, s.c_str());
+    gchar* encoded = jsc_value_to_json(value, 0);
+    std::string out = encoded ? encoded : "\"\"";
+    g_free(encoded);
+    g_object_unref(value);
+    return out;
+}
+
+void MediaController::send(const std::string& command_json)
+{
+    if (!connection_) {
+        outbox_.push_back(command_json);
+        return;
+    }
+
+    write_queue_.push_back(command_json + "\n");
+    if (!writing_) write_next();
+}
+
+// A stream takes one write at a time; the rest wait in order. mpv reading
+// slowly (or hanging) then never blocks the main loop.
+void MediaController::write_next()
+{
+    if (write_queue_.empty() || !connection_) {
+        writing_ = false;
+        return;
+    }
+
+    auto* pending = new PendingWrite{ this, std::move(write_queue_.front()) };
+    write_queue_.pop_front();
+    writing_ = true;
+
+    GOutputStream* out = g_io_stream_get_output_stream(G_IO_STREAM(connection_));
+    g_output_stream_write_all_async(out, pending->line.data(), pending->line.size(),
+                                    G_PRIORITY_DEFAULT, cancellable_, s_written, pending);
+}
+
+void MediaController::flush_outbox()
+{
+    std::vector<std::string> pending;
+    pending.swap(outbox_);
+    for (const auto& command : pending) {
+        send(command);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Process
+// ───────────────────────────────────────────────
+
+void MediaController::ensure_running()
+{
+    if (process_) return;
+
+    // Items that never started before mpv went away go back in front
+    std::vector<Item> leftover;
+    for (size_t i = playlist_pos_ < 0 ? 0 : static_cast<size_t>(playlist_pos_) + 1;
+         i < playlist_.size(); ++i) {
+        // Resolved stream URLs may have expired by now
+        Item item = playlist_[i];
+        item.streams.clear();
+        item.title.clear();
+        leftover.push_back(item);
+    }
+    playlist_.clear();
+    playlist_pos_ = -1;
+    outbox_.clear();
+
+    if (!spawn()) return;
+
+    for (const auto& item : leftover) {
+        load(item, false);
+    }
+}
+
+bool MediaController::spawn()
+{
+    g_unlink(socket_path_.c_str());
+
+    std::string ipc = "--input-ipc-server=" + socket_path_;
+    std::string ytdl_format = std::string("--ytdl-format=") + YTDL_FORMAT;
+
+    // Player-wide defaults formerly passed per launch: software decode,
+    // amber/sepia filter for video
+    const gchar* argv[] = {
+        "mpv",
+        "--idle=yes",
+        "--quiet",
+        "--hwdec=no",
+        "--vo=gpu",
+        ytdl_format.c_str(),
+        "--cache=yes",
+        "--cache-secs=10",
+        "--vf=format=rgb24,hue=s=0,eq=brightness=-0.05:contrast=1.35:saturation=1.8",
+        ipc.c_str(),
+        nullptr
+    };
+
+    GError* error = nullptr;
+    process_ = g_subprocess_newv(argv, G_SUBPROCESS_FLAGS_NONE, &error);
+    if (!process_) {
+        std::cerr << "Failed to launch mpv: "
+                  << (error ? error->message : "unknown error") << std::endl;
+        if (error) g_error_free(error);
+        return false;
+    }
+
+    cancellable_ = g_cancellable_new();
+    g_subprocess_wait_async(process_, cancellable_, s_exited, this);
+
+    set_state(State::Starting);
+    connect_attempts_ = 0;
+    connect_source_ = g_timeout_add(CONNECT_INTERVAL_MS, s_connect_retry, this);
+    return true;
+}
+
+void MediaController::try_connect()
+{
+    GSocketClient* client = g_socket_client_new();
+    GSocketAddress* address = g_unix_socket_address_new(socket_path_.c_str());
+    g_socket_client_connect_async(client, G_SOCKET_CONNECTABLE(address),
+                                  cancellable_, s_connected, this);
+    g_object_unref(address);
+    g_object_unref(client);
+}
+
+void MediaController::on_connected(GSocketConnection* connection)
+{
+    connection_ = connection;
+
+    GInputStream* in = g_io_stream_get_input_stream(G_IO_STREAM(connection_));
+    reader_ = g_data_input_stream_new(in);
+
+    guint id = 1;
+    for (const char* property : OBSERVED_PROPERTIES) {
+        send("{\"command\":[\"observe_property\"," + std::to_string(id++) + ",\"" +
+             property + "\"]}");
+    }
+
+    set_state(State::Idle);
+    flush_outbox();
+    read_next_line();
+}
+
+void MediaController::on_exited()
+{
+    COLOSSUS_TRACE("mpv exited; restarting on next request\n");
+
+    // Keep playlist_/playlist_pos_: ensure_running() re-queues the rest
+    shutdown_process();
+    title_.clear();
+    set_state(State::Stopped);
+}
+
+void MediaController::shutdown_process()
+{
+    if (connect_source_) {
+        g_source_remove(connect_source_);
+        connect_source_ = 0;
+    }
+    if (cancellable_) {
+        g_cancellable_cancel(cancellable_);
+        g_clear_object(&cancellable_);
+    }
+    g_clear_object(&reader_);
+    if (connection_) {
+        g_io_stream_close(G_IO_STREAM(connection_), nullptr, nullptr);
+        g_clear_object(&connection_);
+    }
+    g_clear_object(&process_);
+    outbox_.clear();
+    write_queue_.clear();
+    writing_ = false;
+    g_unlink(socket_path_.c_str());
+}
+
+// ───────────────────────────────────────────────
+//  Events
+// ───────────────────────────────────────────────
+
+void MediaController::read_next_line()
+{
+    g_data_input_stream_read_line_async(reader_, G_PRIORITY_DEFAULT, cancellable_,
+                                        s_line_read, this);
+}
+
+void MediaController::on_line(const char* line)
+{
+    JSCValue* message = jsc_value_new_from_json(json_, line);
+    if (!message || !jsc_value_is_object(message)) {
+        if (message) g_object_unref(message);
+        return;
+    }
+
+    JSCValue* event = jsc_value_object_get_property(message, "event");
+    if (jsc_value_is_string(event)) {
+        gchar* name = jsc_value_to_string(event);
+
+        if (g_strcmp0(name, "property-change") == 0) {
+            JSCValue* property = jsc_value_object_get_property(message, "name");
+            JSCValue* data = jsc_value_object_get_property(message, "data");
+            gchar* property_name = jsc_value_to_string(property);
+            on_property(property_name ? property_name : "", data);
+            g_free(property_name);
+            g_object_unref(data);
+            g_object_unref(property);
+        }
+        g_free(name);
+    }
+
+    g_object_unref(event);
+    g_object_unref(message);
+}
+
+void MediaController::on_property(const std::string& name, JSCValue* data)
+{
+    if (name == "pause") {
+        if (state_ == State::Playing || state_ == State::Paused) {
+            set_state(jsc_value_to_boolean(data) ? State::Paused : State::Playing);
+        }
+    } else if (name == "idle-active") {
+        set_state(jsc_value_to_boolean(data) ? State::Idle : State::Playing);
+    } else if (name == "media-title") {
+        gchar* title = jsc_value_is_string(data) ? jsc_value_to_string(data) : nullptr;
+        title_ = title ? title : "";
+        g_free(title);
+        notify_changed();
+    } else if (name == "playlist-pos") {
+        playlist_pos_ = jsc_value_is_number(data) ? jsc_value_to_int32(data) : -1;
+        notify_changed();
+    }
+}
+
+void MediaController::set_state(State state)
+{
+    if (state_ == state) return;
+    state_ = state;
+    notify_changed();
+}
+
+void MediaController::notify_changed()
+{
+    if (changed_) changed_();
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+gboolean MediaController::s_connect_retry(gpointer user_data)
+{
+    auto* self = static_cast<MediaController*>(user_data);
+
+    if (!g_file_test(self->socket_path_.c_str(), G_FILE_TEST_EXISTS)) {
+        if (++self->connect_attempts_ < CONNECT_MAX_ATTEMPTS)
+            return G_SOURCE_CONTINUE;
+
+        std::cerr << "mpv did not open its IPC socket; giving up" << std::endl;
+        self->connect_source_ = 0;
+        if (self->process_) g_subprocess_force_exit(self->process_);
+        return G_SOURCE_REMOVE;
+    }
+
+    self->connect_source_ = 0;
+    self->try_connect();
+    return G_SOURCE_REMOVE;
+}
+
+void MediaController::s_connected(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    GError* error = nullptr;
+    GSocketConnection* connection =
+        g_socket_client_connect_finish(G_SOCKET_CLIENT(source), result, &error);
+
+    if (!connection) {
+        if (!is_cancelled(error)) {
+            std::cerr << "mpv IPC connect failed: "
+                      << (error ? error->message : "unknown error") << std::endl;
+            auto* self = static_cast<MediaController*>(user_data);
+            if (self->process_) g_subprocess_force_exit(self->process_);
+        }
+        if (error) g_error_free(error);
+        return;
+    }
+
+    static_cast<MediaController*>(user_data)->on_connected(connection);
+}
+
+void MediaController::s_line_read(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    GError* error = nullptr;
+    gchar* line = g_data_input_stream_read_line_finish(G_DATA_INPUT_STREAM(source),
+                                                       result, nullptr, &error);
+    if (is_cancelled(error)) {
+        g_error_free(error);
+        return;
+    }
+    if (error) g_error_free(error);
+
+    // EOF: mpv is exiting; s_exited does the cleanup
+    if (!line) return;
+
+    auto* self = static_cast<MediaController*>(user_data);
+    self->on_line(line);
+    g_free(line);
+    self->read_next_line();
+}
+
+void MediaController::s_written(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    std::unique_ptr<PendingWrite> pending(static_cast<PendingWrite*>(user_data));
+
+    GError* error = nullptr;
+    if (!g_output_stream_write_all_finish(G_OUTPUT_STREAM(source), result, nullptr, &error)) {
+        // Cancelled: the process generation this was written for is gone
+        if (is_cancelled(error)) {
+            g_error_free(error);
+            return;
+        }
+        std::cerr << "mpv IPC write failed: "
+                  << (error ? error->message : "unknown error") << std::endl;
+        if (error) g_error_free(error);
+    }
+
+    pending->self->write_next();
+}
+
+void MediaController::s_exited(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    GError* error = nullptr;
+    g_subprocess_wait_finish(G_SUBPROCESS(source), result, &error);
+    if (is_cancelled(error)) {
+        g_error_free(error);
+        return;
+    }
+    if (error) g_error_free(error);
+
+    static_cast<MediaController*>(user_data)->on_exited();
+}
@@ -0,0 +1,115 @@
+// media_controller.h — COLOSSUS persistent mpv driven over JSON IPC
+
+#ifndef COLOSSUS_MEDIA_CONTROLLER_H
+#define COLOSSUS_MEDIA_CONTROLLER_H
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gio/gio.h>
+#include <jsc/jsc.h>
+}
+
+// Keeps one idle mpv alive (--idle --input-ipc-server) and feeds it with
+// loadfile commands instead of spawning a player per click. ▶ mpv badges
+// append to mpv's playlist, Alt+V replaces it. Playback state is tracked
+// from observed properties. If mpv exits, the controller restarts it on the
+// next request and re-queues whatever had not started playing yet.
+class MediaController {
+public:
+    enum class State {
+        Stopped,    // no mpv process
+        Starting,   // spawned, IPC not connected yet
+        Idle,       // running, nothing loaded
+        Playing,
+        Paused
+    };
+
+    // Format selector mpv (and the stream pre-resolver) hand to yt-dlp:
+    // 480p-preferred
+    static constexpr const char* YTDL_FORMAT =
+        "bv*[height<=480]+ba/best[height<=480]/best";
+
+    struct Item {
+        std::string url;
+        bool audio_only = false;    // e.g. Telehack radio: no video output
+
+        // Pre-resolved by StreamResolver: direct video (+ audio) URLs that
+        // mpv plays without running yt-dlp itself
+        std::vector<std::string> streams;
+        std::string title;
+    };
+
+    MediaController();
+    ~MediaController();
+
+    MediaController(const MediaController&) = delete;
+    MediaController& operator=(const MediaController&) = delete;
+
+    // Per-URL playback profile
+    static Item item_for_url(const std::string& url);
+
+    void play_now(const Item& item);
+    void enqueue(const Item& item);
+    void toggle_pause();
+
+    State state() const { return state_; }
+    static const char* state_name(State state);
+    const std::string& title() const { return title_; }
+    int playlist_pos() const { return playlist_pos_; }
+    guint playlist_count() const { return static_cast<guint>(playlist_.size()); }
+
+    // Called on the main loop whenever state, title or playlist change
+    void set_changed_callback(std::function<void()> callback) { changed_ = std::move(callback); }
+
+private:
+    GSubprocess* process_ = nullptr;
+    GSocketConnection* connection_ = nullptr;
+    GDataInputStream* reader_ = nullptr;
+    GCancellable* cancellable_ = nullptr;     // current process generation
+    JSCContext* json_ = nullptr;              // JSON encode/decode
+
+    std::string socket_path_;
+    guint connect_source_ = 0;
+    guint connect_attempts_ = 0;
+
+    State state_ = State::Stopped;
+    std::string title_;
+    int playlist_pos_ = -1;
+    std::vector<Item> playlist_;              // mirrors mpv's playlist
+    std::vector<std::string> outbox_;         // commands awaiting the socket
+    std::deque<std::string> write_queue_;     // lines awaiting the write in flight
+    bool writing_ = false;
+
+    std::function<void()> changed_;
+
+    void ensure_running();
+    bool spawn();
+    void try_connect();
+    void on_connected(GSocketConnection* connection);
+    void on_exited();
+    void shutdown_process();
+
+    void load(const Item& item, bool replace);
+    void send(const std::string& command_json);
+    void write_next();
+    void flush_outbox();
+    std::string json_string(const std::string& s);
+
+    void read_next_line();
+    void on_line(const char* line);
+    void on_property(const std::string& name, JSCValue* data);
+    void set_state(State state);
+    void notify_changed();
+
+    static gboolean s_connect_retry(gpointer user_data);
+    static void s_connected(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_line_read(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_written(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_exited(GObject* source, GAsyncResult* result, gpointer user_data);
+};
+
+#endif // COLOSSUS_MEDIA_CONTROLLER_H
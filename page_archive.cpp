@@ -0,0 +1,764 @@
+// page_archive.cpp — COLOSSUS offline reading archive (colossus-archive:// scheme)
+
+#include "page_archive.h"
+#include "append_log.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// ───────────────────────────────────────────────
+//  Records (native endianness, 8-byte aligned; see append_log.h)
+// ───────────────────────────────────────────────
+
+const char MAGIC[8] = { 'C', 'N', 'A', 'R', 'C', 'H', '0', '1' };
+
+enum RecordType : guint32 {
+    RECORD_PAGE = 1,            // key: URL, data: page-model JSON
+    RECORD_IMAGE = 2            // key: image source URL, data: PNG
+};
+
+// Followed by `key_length` bytes of key, `stored` bytes of data, padding
+struct RecordHeader {
+    guint32 size;               // whole record, padded to 8
+    guint32 type;
+    guint32 key_length;
+    guint32 stored;
+    guint32 length;             // data once inflated
+    guint32 flags;
+};
+
+const guint32 RECORD_DEFLATED = 1u << 0;
+
+const size_t MAX_KEY_BYTES = 8192;
+const size_t MAX_DATA_BYTES = 64 * 1024 * 1024;
+
+const guint64 COMPACT_MIN_BYTES = 4 * 1024 * 1024;
+
+const char PAGE_PREFIX[] = "colossus-archive://page/";
+const char IMAGE_PREFIX[] = "colossus-archive://img/";
+
+// Handed to WebKit with the scheme; outlives the archive, which clears it
+struct Registration {
+    PageArchive* archive = nullptr;
+};
+
+size_t record_size(size_t key_length, size_t stored)
+{
+    return AppendLog::padded(sizeof(RecordHeader) + key_length + stored);
+}
+
+// Calls fn(header, pos) for each well-formed record; stops at the first one
+// that is not
+template <typename Fn>
+void for_each_record(const char* map, guint64 committed, Fn&& fn)
+{
+    size_t pos = AppendLog::HEADER_SIZE;
+    while (pos + sizeof(RecordHeader) <= committed) {
+        RecordHeader header;
+        memcpy(&header, map + pos, sizeof(header));
+        if (header.size % 8 != 0 || header.size > committed - pos ||
+            header.key_length > MAX_KEY_BYTES || header.stored > MAX_DATA_BYTES ||
+            header.size < sizeof(RecordHeader) + header.key_length + header.stored) {
+            break;
+        }
+        fn(header, pos);
+        pos += header.size;
+    }
+}
+
+// Pages and images are separate namespaces
+std::string index_key(guint32 type, const char* key, size_t length)
+{
+    std::string out(1, static_cast<char>(type));
+    out.append(key, length);
+    return out;
+}
+
+// Run `size` bytes through a zlib (de)compressor; nullptr on corrupt input
+GBytes* convert_all(GConverter* converter, const char* data, size_t size)
+{
+    GOutputStream* memory = g_memory_output_stream_new_resizable();
+    GOutputStream* out = g_converter_output_stream_new(memory, converter);
+
+    bool ok = g_output_stream_write_all(out, data, size, nullptr, nullptr, nullptr) &&
+              g_output_stream_close(out, nullptr, nullptr);
+
+    GBytes* bytes = ok ? g_memory_output_stream_steal_as_bytes(G_MEMORY_OUTPUT_STREAM(memory))
+                       : nullptr;
+    g_object_unref(out);
+    g_object_unref(memory);
+    return bytes;
+}
+
+GBytes* deflate_bytes(const std::string& data)
+{
+    GZlibCompressor* compressor = g_zlib_compressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW, 6);
+    GBytes* out = convert_all(G_CONVERTER(compressor), data.data(), data.size());
+    g_object_unref(compressor);
+    return out;
+}
+
+GBytes* inflate_bytes(const char* data, size_t size)
+{
+    GZlibDecompressor* decompressor = g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_RAW);
+    GBytes* out = convert_all(G_CONVERTER(decompressor), data, size);
+    g_object_unref(decompressor);
+    return out;
+}
+
+void append_record(std::string& out, guint32 type, const std::string& key,
+                   const void* data, size_t stored, size_t length, guint32 flags)
+{
+    RecordHeader header = {};
+    header.size = static_cast<guint32>(record_size(key.size(), stored));
+    header.type = type;
+    header.key_length = static_cast<guint32>(key.size());
+    header.stored = static_cast<guint32>(stored);
+    header.length = static_cast<guint32>(length);
+    header.flags = flags;
+
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(key);
+    out.append(static_cast<const char*>(data), stored);
+    out.append(header.size - sizeof(RecordHeader) - key.size() - stored, '\0');
+}
+
+void fail_request(WebKitURISchemeRequest* request, const char* message)
+{
+    GError* error = g_error_new(G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "%s", message);
+    webkit_uri_scheme_request_finish_error(request, error);
+    g_error_free(error);
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  ArchiveFile: the archive itself, shared with worker threads
+// ───────────────────────────────────────────────
+
+struct ArchiveCompactResult;
+
+struct ArchiveFile {
+    AppendLog log;              // under lock once workers run
+    GMutex lock;
+
+    explicit ArchiveFile(const std::string& path) : log(path, MAGIC, "page archive")
+    {
+        g_mutex_init(&lock);
+    }
+
+    ~ArchiveFile() { g_mutex_clear(&lock); }
+
+    bool append(const std::string& data, guint64& at);
+    bool compact(ArchiveCompactResult& result);
+};
+
+// `at` receives the offset the data was written at
+bool ArchiveFile::append(const std::string& data, guint64& at)
+{
+    g_mutex_lock(&lock);
+    at = log.committed;
+    bool ok = log.append(data);
+    g_mutex_unlock(&lock);
+    return ok;
+}
+
+// ───────────────────────────────────────────────
+//  Worker payloads
+// ───────────────────────────────────────────────
+
+struct ArchiveEntry {
+    guint32 type = 0;
+    std::string key;
+    guint64 offset = 0;
+    guint32 stored = 0;
+    guint32 length = 0;
+    guint32 flags = 0;
+};
+
+struct ArchiveLoadResult {
+    std::vector<ArchiveEntry> entries;      // in file order; later ones win
+    guint64 committed = 0;
+    guint64 dead_bytes = 0;                 // in superseded records
+};
+
+struct ArchiveWriteResult {
+    std::vector<ArchiveEntry> entries;
+    guint64 committed = 0;
+};
+
+// The replacement is renamed over the archive but not yet in use: the main
+// loop may still be reading through the old descriptor
+struct ArchiveCompactResult {
+    std::vector<ArchiveEntry> entries;
+    int fd = -1;
+    guint64 committed = 0;
+
+    ~ArchiveCompactResult()
+    {
+        if (fd >= 0) close(fd);
+    }
+};
+
+// Rewrite with only the latest record for each key. Runs with no appends
+// in flight (the main loop holds them back), so nothing is lost to the
+// rename.
+bool ArchiveFile::compact(ArchiveCompactResult& result)
+{
+    g_mutex_lock(&lock);
+    guint64 committed = log.committed;
+    void* mapped = committed > AppendLog::HEADER_SIZE
+                 ? mmap(nullptr, committed, PROT_READ, MAP_SHARED, log.fd, 0)
+                 : MAP_FAILED;
+    g_mutex_unlock(&lock);
+    if (mapped == MAP_FAILED) return false;
+    const char* map = static_cast<const char*>(mapped);
+
+    std::unordered_map<std::string, size_t> last;
+    for_each_record(map, committed, [&](const RecordHeader& header, size_t pos) {
+        last[index_key(header.type, map + pos + sizeof(RecordHeader), header.key_length)] = pos;
+    });
+
+    std::string out(AppendLog::HEADER_SIZE, '\0');
+    for_each_record(map, committed, [&](const RecordHeader& header, size_t pos) {
+        const char* key = map + pos + sizeof(RecordHeader);
+        if ((header.type != RECORD_PAGE && header.type != RECORD_IMAGE) ||
+            last[index_key(header.type, key, header.key_length)] != pos) {
+            return;
+        }
+
+        ArchiveEntry entry;
+        entry.type = header.type;
+        entry.key.assign(key, header.key_length);
+        entry.offset = out.size() + sizeof(RecordHeader) + header.key_length;
+        entry.stored = header.stored;
+        entry.length = header.length;
+        entry.flags = header.flags;
+        result.entries.push_back(std::move(entry));
+
+        out.append(map + pos, header.size);
+    });
+    munmap(mapped, committed);
+
+    g_mutex_lock(&lock);
+    result.fd = log.write_replacement(out);
+    g_mutex_unlock(&lock);
+    if (result.fd < 0) return false;
+    result.committed = out.size();
+
+    COLOSSUS_TRACE("offline archive compacted: %" G_GUINT64_FORMAT " → %zu KB\n",
+                   committed / 1024, out.size() / 1024);
+    return true;
+}
+
+namespace {
+
+struct LoadData {
+    std::shared_ptr<ArchiveFile> file;
+    ArchiveLoadResult result;
+};
+
+struct CompactData {
+    std::shared_ptr<ArchiveFile> file;
+    ArchiveCompactResult result;
+};
+
+struct WriteData {
+    std::shared_ptr<ArchiveFile> file;
+    std::string key;
+    std::string model;
+    std::vector<PageArchive::Image> images;
+    ArchiveWriteResult result;
+
+    ~WriteData()
+    {
+        for (auto& image : images) g_bytes_unref(image.second);
+    }
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+PageArchive::PageArchive(WebKitWebContext* context, const std::string& path)
+    : context_(context)
+{
+    cancellable_ = g_cancellable_new();
+
+    auto* registration = new Registration{ this };
+    g_object_set_data_full(G_OBJECT(context_), "colossus-page-archive", registration,
+                           [](gpointer p) { delete static_cast<Registration*>(p); });
+    webkit_web_context_register_uri_scheme(context_, SCHEME, s_request,
+                                           registration, nullptr);
+
+    WebKitSecurityManager* security = webkit_web_context_get_security_manager(context_);
+    webkit_security_manager_register_uri_scheme_as_no_access(security, SCHEME);
+
+    file_ = std::make_shared<ArchiveFile>(path);
+    if (!file_->log.open()) {
+        g_printerr("COLOSSUS-NAN: Offline archive disabled, cannot open %s: %s\n",
+                   path.c_str(), g_strerror(errno));
+        file_.reset();
+        loaded_ = true;
+        return;
+    }
+    committed_ = file_->log.committed;
+
+    auto* data = new LoadData;
+    data->file = file_;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_loaded, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<LoadData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_load_thread);
+    g_object_unref(task);
+}
+
+// Appends still in flight finish on their worker
+PageArchive::~PageArchive()
+{
+    auto* registration = static_cast<Registration*>(
+        g_object_get_data(G_OBJECT(context_), "colossus-page-archive"));
+    if (registration) registration->archive = nullptr;
+
+    g_cancellable_cancel(cancellable_);
+    g_clear_object(&cancellable_);
+
+    for (WebKitURISchemeRequest* request : before_load_) {
+        fail_request(request, "Shutting down");
+        g_object_unref(request);
+    }
+    before_load_.clear();
+
+    for (HeldPage& held : held_pages_) {
+        for (const Image& image : held.images) g_bytes_unref(image.second);
+    }
+
+    if (map_) munmap(const_cast<char*>(map_), map_size_);
+}
+
+// ───────────────────────────────────────────────
+//  URIs and keys
+// ───────────────────────────────────────────────
+
+std::string PageArchive::page_uri(const std::string& url)
+{
+    gchar* escaped = g_uri_escape_string(url.c_str(), nullptr, FALSE);
+    std::string out = std::string(PAGE_PREFIX) + escaped;
+    g_free(escaped);
+    return out;
+}
+
+std::string PageArchive::original_uri(const char* uri)
+{
+    if (!uri || !g_str_has_prefix(uri, PAGE_PREFIX)) return {};
+
+    gchar* url = g_uri_unescape_string(uri + strlen(PAGE_PREFIX), nullptr);
+    std::string out = url ? url : "";
+    g_free(url);
+    return out;
+}
+
+bool PageArchive::is_archive(const char* uri)
+{
+    return uri && g_str_has_prefix(uri, "colossus-archive:");
+}
+
+// The URL without its fragment
+std::string PageArchive::key_for(const std::string& url)
+{
+    return url.substr(0, url.find('#'));
+}
+
+bool PageArchive::has_page(const std::string& url) const
+{
+    return pages_.count(key_for(url)) != 0;
+}
+
+bool PageArchive::has_image(const std::string& src) const
+{
+    return images_.count(src) != 0;
+}
+
+// ───────────────────────────────────────────────
+//  Reading
+// ───────────────────────────────────────────────
+
+// From the mapping, which is redone when appends have outgrown it
+GBytes* PageArchive::read(const Slot& slot)
+{
+    if (!file_ || slot.offset + slot.stored > committed_) return nullptr;
+
+    if (slot.offset + slot.stored > map_size_) {
+        if (map_) munmap(const_cast<char*>(map_), map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+
+        void* mapped = mmap(nullptr, committed_, PROT_READ, MAP_SHARED, file_->log.fd, 0);
+        if (mapped == MAP_FAILED) return nullptr;
+        madvise(mapped, committed_, MADV_RANDOM);
+        map_ = static_cast<const char*>(mapped);
+        map_size_ = committed_;
+    }
+
+    const char* data = map_ + slot.offset;
+    if (!(slot.flags & RECORD_DEFLATED)) return g_bytes_new(data, slot.stored);
+
+    GBytes* inflated = inflate_bytes(data, slot.stored);
+    if (inflated && g_bytes_get_size(inflated) != slot.length) {
+        g_bytes_unref(inflated);
+        return nullptr;
+    }
+    return inflated;
+}
+
+// page/<URL>: a document carrying the model, which browser.js renders as
+// the terminal view. img/<source URL>: the PNG the image proxy made.
+void PageArchive::on_request(WebKitURISchemeRequest* request)
+{
+    if (!loaded_) {
+        before_load_.push_back(WEBKIT_URI_SCHEME_REQUEST(g_object_ref(request)));
+        return;
+    }
+
+    const gchar* uri = webkit_uri_scheme_request_get_uri(request);
+    bool page = g_str_has_prefix(uri, PAGE_PREFIX);
+    bool image = !page && g_str_has_prefix(uri, IMAGE_PREFIX);
+    if (!page && !image) {
+        fail_request(request, "Bad colossus-archive URI");
+        return;
+    }
+
+    // Thumbnails are for saved pages only; a web page embedding them could
+    // tell which pages were archived
+    WebKitWebView* view = webkit_uri_scheme_request_get_web_view(request);
+    if (image && !(view && is_archive(webkit_web_view_get_uri(view)))) {
+        fail_request(request, "Image not in the offline archive");
+        return;
+    }
+
+    gchar* decoded = g_uri_unescape_string(uri + (page ? strlen(PAGE_PREFIX)
+                                                       : strlen(IMAGE_PREFIX)), nullptr);
+    std::string key = decoded ? (page ? key_for(decoded) : decoded) : "";
+    g_free(decoded);
+
+    auto& index = page ? pages_ : images_;
+    auto it = index.find(key);
+    GBytes* data = it == index.end() ? nullptr : read(it->second);
+    if (!data) {
+        fail_request(request, page ? "Page not in the offline archive"
+                                   : "Image not in the offline archive");
+        return;
+    }
+
+    if (page) {
+        // '<' only occurs inside JSON strings; as \u003c it can neither end
+        // the script element nor open a comment in it
+        gsize size = 0;
+        const char* json = static_cast<const char*>(g_bytes_get_data(data, &size));
+        std::string html =
+            "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">"
+            "<script type=\"application/json\" id=\"colossus-archived-page\">";
+        for (gsize i = 0; i < size; ++i) {
+            if (json[i] == '<') html += "\\u003c";
+            else html += json[i];
+        }
+        html += "</script></head><body></body></html>";
+        g_bytes_unref(data);
+        data = g_bytes_new(html.data(), html.size());
+    }
+
+    GInputStream* stream = g_memory_input_stream_new_from_bytes(data);
+    webkit_uri_scheme_request_finish(request, stream,
+                                     static_cast<gint64>(g_bytes_get_size(data)),
+                                     page ? "text/html" : "image/png");
+    g_object_unref(stream);
+    g_bytes_unref(data);
+}
+
+// ───────────────────────────────────────────────
+//  Loading / writing
+// ───────────────────────────────────────────────
+
+void PageArchive::finish_load(ArchiveLoadResult& result)
+{
+    for (const ArchiveEntry& entry : result.entries) {
+        auto& index = entry.type == RECORD_PAGE ? pages_ : images_;
+        index[entry.key] = { entry.offset, entry.stored, entry.length, entry.flags };
+    }
+    committed_ = std::max(committed_, result.committed);
+    dead_bytes_ += result.dead_bytes;
+    loaded_ = true;
+    maybe_compact();
+
+    std::vector<WebKitURISchemeRequest*> waiting;
+    waiting.swap(before_load_);
+    for (WebKitURISchemeRequest* request : waiting) {
+        on_request(request);
+        g_object_unref(request);
+    }
+}
+
+void PageArchive::add_page(const std::string& url, std::string model,
+                           const std::vector<Image>& images)
+{
+    if (!file_ || model.empty()) return;
+
+    if (compacting_) {
+        HeldPage held{ url, std::move(model), images };
+        for (const Image& image : held.images) g_bytes_ref(image.second);
+        held_pages_.push_back(std::move(held));
+        return;
+    }
+
+    auto* data = new WriteData;
+    data->file = file_;
+    data->key = key_for(url);
+    data->model = std::move(model);
+    for (const Image& image : images) {
+        data->images.emplace_back(image.first, g_bytes_ref(image.second));
+    }
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_write_done, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<WriteData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_write_thread);
+    g_object_unref(task);
+    ++writes_in_flight_;
+}
+
+void PageArchive::finish_write(ArchiveWriteResult& result)
+{
+    for (const ArchiveEntry& entry : result.entries) {
+        auto& index = entry.type == RECORD_PAGE ? pages_ : images_;
+        auto it = index.find(entry.key);
+        if (it != index.end()) dead_bytes_ += record_size(entry.key.size(), it->second.stored);
+        index[entry.key] = { entry.offset, entry.stored, entry.length, entry.flags };
+    }
+    committed_ = std::max(committed_, result.committed);
+
+    --writes_in_flight_;
+    maybe_compact();
+}
+
+// Once over half the archive is superseded records, and only between
+// appends: those arriving meanwhile are held until it is done
+void PageArchive::maybe_compact()
+{
+    if (!file_ || !loaded_ || compacting_ || writes_in_flight_ > 0 ||
+        committed_ < COMPACT_MIN_BYTES || dead_bytes_ * 2 <= committed_) {
+        return;
+    }
+    compacting_ = true;
+
+    auto* data = new CompactData;
+    data->file = file_;
+
+    GTask* task = g_task_new(nullptr, cancellable_, s_compacted, this);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<CompactData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_compact_thread);
+    g_object_unref(task);
+}
+
+void PageArchive::finish_compaction(ArchiveCompactResult& result)
+{
+    compacting_ = false;
+
+    if (result.fd >= 0) {
+        if (map_) munmap(const_cast<char*>(map_), map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+
+        g_mutex_lock(&file_->lock);
+        file_->log.adopt(result.fd, result.committed);
+        g_mutex_unlock(&file_->lock);
+        result.fd = -1;
+
+        pages_.clear();
+        images_.clear();
+        for (const ArchiveEntry& entry : result.entries) {
+            auto& index = entry.type == RECORD_PAGE ? pages_ : images_;
+            index[entry.key] = { entry.offset, entry.stored, entry.length, entry.flags };
+        }
+        committed_ = result.committed;
+    }
+    // After a failure too, so it is not retried right away
+    dead_bytes_ = 0;
+
+    std::vector<HeldPage> held;
+    held.swap(held_pages_);
+    for (HeldPage& page : held) {
+        add_page(page.url, std::move(page.model), page.images);
+        for (const Image& image : page.images) g_bytes_unref(image.second);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+void PageArchive::s_request(WebKitURISchemeRequest* request, gpointer user_data)
+{
+    auto* registration = static_cast<Registration*>(user_data);
+    if (!registration || !registration->archive) {
+        fail_request(request, "Offline archive unavailable");
+        return;
+    }
+    registration->archive->on_request(request);
+}
+
+// Record headers and keys only; the data is not touched
+void PageArchive::s_load_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<LoadData*>(task_data);
+    ArchiveFile& file = *data->file;
+    ArchiveLoadResult& result = data->result;
+    gint64 started = g_get_monotonic_time();
+
+    g_mutex_lock(&file.lock);
+    guint64 committed = file.log.committed;
+    int fd = file.log.fd;
+    g_mutex_unlock(&file.lock);
+    result.committed = committed;
+
+    if (committed > AppendLog::HEADER_SIZE) {
+        void* mapped = mmap(nullptr, committed, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, committed, MADV_RANDOM);
+            const char* map = static_cast<const char*>(mapped);
+
+            // Record size by key, to count the superseded ones
+            std::unordered_map<std::string, guint32> sizes;
+            for_each_record(map, committed, [&](const RecordHeader& header, size_t pos) {
+                if (header.type != RECORD_PAGE && header.type != RECORD_IMAGE) {
+                    result.dead_bytes += header.size;
+                    return;
+                }
+
+                ArchiveEntry entry;
+                entry.type = header.type;
+                entry.key.assign(map + pos + sizeof(RecordHeader), header.key_length);
+                entry.offset = pos + sizeof(RecordHeader) + header.key_length;
+                entry.stored = header.stored;
+                entry.length = header.length;
+                entry.flags = header.flags;
+
+                guint32& size = sizes[index_key(entry.type, entry.key.data(), entry.key.size())];
+                result.dead_bytes += size;
+                size = header.size;
+
+                result.entries.push_back(std::move(entry));
+            });
+            munmap(mapped, committed);
+        }
+    }
+
+    COLOSSUS_TRACE("offline archive indexed: %zu records, %" G_GUINT64_FORMAT " KB in %.1f ms\n",
+                   result.entries.size(), committed / 1024,
+                   colossus_ms_between(started, g_get_monotonic_time()));
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void PageArchive::s_loaded(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<LoadData*>(g_task_get_task_data(task));
+    static_cast<PageArchive*>(user_data)->finish_load(data->result);
+}
+
+// Page and thumbnails go in as one append, so a page is never saved
+// without the images it refers to
+void PageArchive::s_write_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<WriteData*>(task_data);
+    ArchiveWriteResult& result = data->result;
+
+    GBytes* deflated = deflate_bytes(data->model);
+    if (!deflated) {
+        g_task_return_boolean(task, FALSE);
+        return;
+    }
+
+    std::string out;
+    std::vector<ArchiveEntry> entries;
+    auto add = [&](guint32 type, const std::string& key, const void* bytes,
+                   size_t stored, size_t length, guint32 flags) {
+        if (key.size() > MAX_KEY_BYTES || stored > MAX_DATA_BYTES) return;
+
+        ArchiveEntry entry;
+        entry.type = type;
+        entry.key = key;
+        entry.offset = out.size() + sizeof(RecordHeader) + key.size();  // relative for now
+        entry.stored = static_cast<guint32>(stored);
+        entry.length = static_cast<guint32>(length);
+        entry.flags = flags;
+        entries.push_back(std::move(entry));
+
+        append_record(out, type, key, bytes, stored, length, flags);
+    };
+
+    for (const auto& image : data->images) {
+        gsize size = 0;
+        gconstpointer png = g_bytes_get_data(image.second, &size);
+        add(RECORD_IMAGE, image.first, png, size, size, 0);
+    }
+
+    gsize size = 0;
+    gconstpointer model = g_bytes_get_data(deflated, &size);
+    add(RECORD_PAGE, data->key, model, size, data->model.size(), RECORD_DEFLATED);
+    g_bytes_unref(deflated);
+
+    guint64 at = 0;
+    if (!data->file->append(out, at)) {
+        g_printerr("COLOSSUS-NAN: Failed to write the offline archive: %s\n",
+                   g_strerror(errno));
+        g_task_return_boolean(task, FALSE);
+        return;
+    }
+
+    for (ArchiveEntry& entry : entries) entry.offset += at;
+    result.entries = std::move(entries);
+    result.committed = at + out.size();
+
+    COLOSSUS_TRACE("offline archive: saved %s (%zu → %" G_GSIZE_FORMAT " bytes, %zu images)\n",
+                   data->key.c_str(), data->model.size(), size, data->images.size());
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void PageArchive::s_write_done(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<WriteData*>(g_task_get_task_data(task));
+    static_cast<PageArchive*>(user_data)->finish_write(data->result);
+}
+
+void PageArchive::s_compact_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<CompactData*>(task_data);
+    g_task_return_boolean(task, data->file->compact(data->result));
+}
+
+void PageArchive::s_compacted(GObject*, GAsyncResult* result, gpointer user_data)
+{
+    GTask* task = G_TASK(result);
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) return;
+
+    auto* data = static_cast<CompactData*>(g_task_get_task_data(task));
+    static_cast<PageArchive*>(user_data)->finish_compaction(data->result);
+}
@@ -0,0 +1,121 @@
+// page_archive.h — COLOSSUS offline reading archive (colossus-archive:// scheme)
+
+#ifndef COLOSSUS_PAGE_ARCHIVE_H
+#define COLOSSUS_PAGE_ARCHIVE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+struct ArchiveFile;
+struct ArchiveLoadResult;
+struct ArchiveWriteResult;
+struct ArchiveCompactResult;
+
+// Saved pages for reading without a network: the page model browser.js
+// extracted ({ title, links, flow } JSON) plus the thumbnails it shows, in
+// one AppendLog of records (same file layout and crash rules as the history
+// log).
+//
+//  * Page models are deflated; thumbnails are the image proxy's PNGs as-is.
+//  * The offset index (key → record) is built from the record headers on a
+//    worker at startup. Records are read through one read-only mapping of
+//    the committed region, remapped when appends have grown it.
+//  * Appends are compressed and written on a worker; a record becomes
+//    visible once it is on disk. Saving a page again supersedes the old
+//    record, which stays in the file until over half of it is dead: then
+//    it is rewritten on a worker between appends and renamed over.
+//
+// colossus-archive://page/<encoded URL> serves a saved page as a document
+// carrying its model, which browser.js renders without extracting anything;
+// colossus-archive://img/<encoded source URL> serves a saved thumbnail, to
+// saved pages only. The scheme is no-access rather than local: a saved page
+// gets an opaque origin and no file:// access, and its model keeps only
+// http(s) links.
+class PageArchive {
+public:
+    static constexpr const char* SCHEME = "colossus-archive";
+
+    using Image = std::pair<std::string, GBytes*>;  // source URL, PNG
+
+    PageArchive(WebKitWebContext* context, const std::string& path);
+    ~PageArchive();
+
+    PageArchive(const PageArchive&) = delete;
+    PageArchive& operator=(const PageArchive&) = delete;
+
+    // colossus-archive://page/... for `url`, and back ("" when not one)
+    static std::string page_uri(const std::string& url);
+    static std::string original_uri(const char* uri);
+    static bool is_archive(const char* uri);
+
+    // False until the index has been read
+    bool has_page(const std::string& url) const;
+    bool has_image(const std::string& src) const;
+
+    // Save `model` for `url` along with its thumbnails (refs are taken)
+    void add_page(const std::string& url, std::string model,
+                  const std::vector<Image>& images);
+
+    guint pages() const { return static_cast<guint>(pages_.size()); }
+
+private:
+    struct Slot {
+        guint64 offset = 0;         // of the stored data
+        guint32 stored = 0;         // bytes in the file
+        guint32 length = 0;         // bytes once inflated
+        guint32 flags = 0;
+    };
+
+    // add_page() arguments while compacting, one ref per image
+    struct HeldPage {
+        std::string url;
+        std::string model;
+        std::vector<Image> images;
+    };
+
+    WebKitWebContext* context_ = nullptr;
+    std::shared_ptr<ArchiveFile> file_;
+    GCancellable* cancellable_ = nullptr;
+
+    bool loaded_ = false;
+    std::vector<WebKitURISchemeRequest*> before_load_;  // one ref each
+
+    std::unordered_map<std::string, Slot> pages_;      // by URL without fragment
+    std::unordered_map<std::string, Slot> images_;     // by source URL
+
+    // Committed region as seen by the main loop
+    const char* map_ = nullptr;
+    size_t map_size_ = 0;
+    guint64 committed_ = 0;
+    guint64 dead_bytes_ = 0;        // in superseded records
+
+    guint writes_in_flight_ = 0;
+    bool compacting_ = false;
+    std::vector<HeldPage> held_pages_;
+
+    static std::string key_for(const std::string& url);
+    GBytes* read(const Slot& slot);
+    void on_request(WebKitURISchemeRequest* request);
+    void finish_load(ArchiveLoadResult& result);
+    void finish_write(ArchiveWriteResult& result);
+    void maybe_compact();
+    void finish_compaction(ArchiveCompactResult& result);
+
+    static void s_request(WebKitURISchemeRequest* request, gpointer user_data);
+    static void s_load_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_loaded(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_write_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_write_done(GObject* source, GAsyncResult* result, gpointer user_data);
+    static void s_compact_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+    static void s_compacted(GObject* source, GAsyncResult* result, gpointer user_data);
+};
+
+#endif // COLOSSUS_PAGE_ARCHIVE_H
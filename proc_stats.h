@@ -0,0 +1,30 @@
+// proc_stats.h — COLOSSUS process figures read from /proc
+
+#ifndef COLOSSUS_PROC_STATS_H
+#define COLOSSUS_PROC_STATS_H
+
+#include <cstring>
+
+extern "C" {
+#include <glib.h>
+}
+
+// Resident set size (VmRSS) of a process in kB, or -1 when unknown
+inline double colossus_process_rss_kb(int pid)
+{
+    if (pid <= 0) return -1.0;
+
+    gchar* path = g_strdup_printf("/proc/%d/status", pid);
+    gchar* status = nullptr;
+    bool read = g_file_get_contents(path, &status, nullptr, nullptr);
+    g_free(path);
+    if (!read) return -1.0;
+
+    double kb = -1.0;
+    const char* line = strstr(status, "\nVmRSS:");
+    if (line) kb = g_ascii_strtod(line + 7, nullptr);
+    g_free(status);
+    return kb;
+}
+
+#endif // COLOSSUS_PROC_STATS_H
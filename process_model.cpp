@@ -0,0 +1,138 @@
+// process_model.cpp — COLOSSUS shared web context + web-process grouping hint
+
+#include "process_model.h"
+
+#include <algorithm>
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+ProcessModel::ProcessModel(guint process_hint)
+    : process_hint_(process_hint ? process_hint : 1)
+{
+    // One context for every tab: shared network/cache state and a single
+    // place to register schemes and download handlers.
+    context_ = WEBKIT_WEB_CONTEXT(g_object_ref(webkit_web_context_get_default()));
+    webkit_web_context_set_cache_model(context_, WEBKIT_CACHE_MODEL_WEB_BROWSER);
+
+    // Ignored by WebKitGTK >= 2.26, where related views are the only lever;
+    // still honoured by older releases.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    webkit_web_context_set_process_model(
+        context_, WEBKIT_PROCESS_MODEL_MULTIPLE_SECONDARY_PROCESSES);
+    webkit_web_context_set_web_process_count_limit(context_, process_hint_);
+#pragma GCC diagnostic pop
+
+    content_manager_ = webkit_user_content_manager_new();
+    settings_ = webkit_settings_new();
+    diet_settings_ = load_profile_diet_settings(settings_);
+}
+
+ProcessModel::~ProcessModel()
+{
+    for (auto& slot : slots_) {
+        for (WebKitWebView* view : slot.views) {
+            g_signal_handlers_disconnect_by_data(view, this);
+        }
+    }
+    slots_.clear();
+
+    g_clear_object(&diet_settings_);
+    g_clear_object(&settings_);
+    g_clear_object(&content_manager_);
+    g_clear_object(&context_);
+}
+
+WebKitSettings* ProcessModel::settings_for(LoadProfile profile) const
+{
+    return profile == LoadProfile::Diet ? diet_settings_ : settings_;
+}
+
+void ProcessModel::set_web_extensions_directory(const std::string& dir)
+{
+    webkit_web_context_set_web_extensions_directory(context_, dir.c_str());
+}
+
+// ───────────────────────────────────────────────
+//  Views
+// ───────────────────────────────────────────────
+
+WebKitWebView* ProcessModel::create_view(WebKitWebView* related)
+{
+    Slot* slot = related ? slot_for_view(related) : nullptr;
+
+    if (!slot && slots_.size() >= process_hint_) {
+        // At the hint: join the least-loaded group
+        auto it = std::min_element(slots_.begin(), slots_.end(),
+                                   [](const Slot& a, const Slot& b) {
+                                       return a.views.size() < b.views.size();
+                                   });
+        slot = &*it;
+    }
+
+    WebKitWebView* view = nullptr;
+    if (slot) {
+        // Related views inherit context, settings and content manager
+        view = WEBKIT_WEB_VIEW(
+            webkit_web_view_new_with_related_view(slot->views.front()));
+        // The anchor may currently run with another load profile's settings
+        webkit_web_view_set_settings(view, settings_);
+    } else {
+        view = WEBKIT_WEB_VIEW(g_object_new(WEBKIT_TYPE_WEB_VIEW,
+                                            "web-context", context_,
+                                            "user-content-manager", content_manager_,
+                                            "settings", settings_,
+                                            nullptr));
+        slots_.emplace_back();
+        slot = &slots_.back();
+    }
+
+    track_view(*slot, view);
+    return view;
+}
+
+ProcessModel::Slot* ProcessModel::slot_for_view(WebKitWebView* view)
+{
+    for (auto& slot : slots_) {
+        if (std::find(slot.views.begin(), slot.views.end(), view) != slot.views.end())
+            return &slot;
+    }
+    return nullptr;
+}
+
+void ProcessModel::track_view(Slot& slot, WebKitWebView* view)
+{
+    slot.views.push_back(view);
+    g_signal_connect(view, "destroy",
+                     G_CALLBACK(ProcessModel::s_view_destroyed), this);
+}
+
+void ProcessModel::on_view_destroyed(WebKitWebView* view)
+{
+    for (auto it = slots_.begin(); it != slots_.end(); ++it) {
+        auto& views = it->views;
+        auto pos = std::find(views.begin(), views.end(), view);
+        if (pos == views.end()) continue;
+
+        views.erase(pos);
+
+        // Last view gone: nothing left to relate new views to
+        if (views.empty()) {
+            slots_.erase(it);
+        }
+        return;
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+void ProcessModel::s_view_destroyed(GtkWidget* widget, gpointer user_data)
+{
+    auto* self = static_cast<ProcessModel*>(user_data);
+    if (!self) return;
+    self->on_view_destroyed(WEBKIT_WEB_VIEW(widget));
+}
@@ -0,0 +1,72 @@
+// process_model.h — COLOSSUS shared web context + web-process grouping hint
+
+#ifndef COLOSSUS_PROCESS_MODEL_H
+#define COLOSSUS_PROCESS_MODEL_H
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+#include "load_profile.h"
+
+// Owns the single WebKitWebContext, WebKitSettings and
+// WebKitUserContentManager shared by every tab, and hands out webviews in
+// at most `process_hint` groups. Views beyond that (and views with an
+// explicit related view) are created as related views of a group.
+//
+// This is a hint, not a cap: a related view starts in its group's web
+// process, but process swap on cross-site navigation (always on in
+// WebKitGTK >= 2.28, with no API to turn it off) moves it to a fresh
+// process as soon as it leaves the site. The real number of web processes
+// is counted from the PIDs the web extension reports (Browser).
+class ProcessModel {
+public:
+    explicit ProcessModel(guint process_hint);
+    ~ProcessModel();
+
+    ProcessModel(const ProcessModel&) = delete;
+    ProcessModel& operator=(const ProcessModel&) = delete;
+
+    WebKitWebContext* context() const { return context_; }
+    WebKitUserContentManager* content_manager() const { return content_manager_; }
+    WebKitSettings* settings() const { return settings_; }
+
+    // Shared settings object for each load profile
+    WebKitSettings* settings_for(LoadProfile profile) const;
+
+    // Create a view in the group of `related`, a new group while under the
+    // hint, or the least-loaded existing group otherwise.
+    WebKitWebView* create_view(WebKitWebView* related = nullptr);
+
+    // Must be called before the first view is created
+    void set_web_extensions_directory(const std::string& dir);
+
+    guint group_count() const { return static_cast<guint>(slots_.size()); }
+    guint process_hint() const { return process_hint_; }
+
+private:
+    // One slot per group of related views; views[0] anchors the others
+    struct Slot {
+        std::vector<WebKitWebView*> views;
+    };
+
+    WebKitWebContext* context_ = nullptr;
+    WebKitUserContentManager* content_manager_ = nullptr;
+    WebKitSettings* settings_ = nullptr;
+    WebKitSettings* diet_settings_ = nullptr;
+    guint process_hint_ = 0;
+
+    std::vector<Slot> slots_;
+
+    Slot* slot_for_view(WebKitWebView* view);
+    void track_view(Slot& slot, WebKitWebView* view);
+    void on_view_destroyed(WebKitWebView* view);
+
+    static void s_view_destroyed(GtkWidget* widget, gpointer user_data);
+};
+
+#endif // COLOSSUS_PROCESS_MODEL_H
@@ -9,6 +9,17 @@
 (function () {
     'use strict';
 
+    // The web-process extension's extractor (top frame only), taken off the
+    // global object before any page script can call or replace it
+    const NATIVE = window.colossusNative;
+    try { delete window.colossusNative; } catch (e) { }
+
+    // This view's page id, so metrics reach the right tab (0: route by URL)
+    const PAGE_ID = NATIVE && typeof NATIVE.pageId === 'number' ? NATIVE.pageId : 0;
+
+    // Our own pages (about:colossus) render themselves
+    if (window.location.protocol === 'colossus:') return;
+
     // Hide everything ASAP to prevent the "real" page from ever flashing
     try {
         // Don't hide Telehack; it needs to show its own xterm UI
@@ -21,26 +32,6 @@
     //  Helpers
     // ───────────────────────────────────────────────
 
-    function resolveUrl(href) {
-        try {
-            return new URL(href, window.location.href).toString();
-        } catch {
-            return href;
-        }
-    }
-
-    function isYouTubeUrl(href) {
-        if (!href) return false;
-        let u;
-        try {
-            u = new URL(href, window.location.href);
-        } catch {
-            return false;
-        }
-        const host = u.hostname.toLowerCase();
-        return host.includes('youtube.com') || host.includes('youtu.be');
-    }
-
     function isMediaUrl(href) {
         if (!href) return false;
         const l = href.toLowerCase();
@@ -56,8 +47,31 @@
         );
     }
 
-    function isPlayableUrl(href) {
-        return isYouTubeUrl(href) || isMediaUrl(href);
+    // Absolute URL and playability per href, parsed once: index pages
+    // repeat the same targets many times
+    const urlInfoCache = new Map();
+
+    function urlInfo(href) {
+        let info = urlInfoCache.get(href);
+        if (info) return info;
+
+        let url = href;
+        let host = '';
+        let web = false;
+        try {
+            const u = new URL(href, window.location.href);
+            url = u.toString();
+            host = u.hostname.toLowerCase();
+            web = u.protocol === 'http:' || u.protocol === 'https:';
+        } catch { }
+
+        info = {
+            url: url,
+            web: web,           // http(s): the only targets rows may follow
+            playable: host.includes('youtube.com') || host.includes('youtu.be') || isMediaUrl(url)
+        };
+        urlInfoCache.set(href, info);
+        return info;
     }
 
     function postToNative(url) {
@@ -87,17 +101,72 @@
         }
     }
 
-    function extractText(node) {
-        if (!node) return '';
-        const clone = node.cloneNode(true);
-        // Remove scripts/styles/nav aside etc. from text extraction
-        const kill = clone.querySelectorAll('script, style, nav, footer, header');
-        kill.forEach(el => el.remove());
-        let text = clone.textContent || '';
-        text = text.replace(/\s+/g, ' ').trim();
-        return text;
+    // Stream pre-resolution (Browser::on_resolver_message): yt-dlp starts on
+    // hover / scroll-into-view so the ▶ mpv click finds the stream ready.
+    // A URL is sent at most once per reason; hover outranks viewport.
+    const resolveRequested = new Map();
+
+    function postToResolver(url, reason) {
+        const previous = resolveRequested.get(url);
+        if (previous === 'hover' || previous === reason) return;
+        resolveRequested.set(url, reason);
+        try {
+            const h = window.webkit &&
+                      window.webkit.messageHandlers &&
+                      window.webkit.messageHandlers.streamResolver;
+            if (h && typeof h.postMessage === 'function') {
+                h.postMessage({ url: url, reason: reason });
+            }
+        } catch (e) { }
+    }
+
+    // Link speculation (Browser::on_speculation_message): a row reaching the
+    // top of the viewport or under the pointer has its host resolved; one the
+    // pointer stays on for SPECULATION_DWELL_MS is preloaded, so its click
+    // swaps in a view that is already loading. A URL is sent at most once
+    // per reason; dwell outranks hover, which outranks viewport.
+    const SPECULATION_DWELL_MS = 300;
+    const SPECULATION_RANK = { viewport: 1, hover: 2, dwell: 3 };
+    const speculated = new Map();
+
+    function postToSpeculation(url, reason, text) {
+        if (!/^https?:\/\//i.test(url)) return;
+        if ((speculated.get(url) || 0) >= SPECULATION_RANK[reason]) return;
+        speculated.set(url, SPECULATION_RANK[reason]);
+        try {
+            const h = window.webkit &&
+                      window.webkit.messageHandlers &&
+                      window.webkit.messageHandlers.speculation;
+            if (h && typeof h.postMessage === 'function') {
+                h.postMessage({ url: url, reason: reason, text: text || '' });
+            }
+        } catch (e) { }
+    }
+
+    // Timings for the UI process (Browser::on_metrics_message); top frame only
+    function reportMetric(event, data) {
+        if (window !== window.top) return;
+        try {
+            const h = window.webkit &&
+                      window.webkit.messageHandlers &&
+                      window.webkit.messageHandlers.colossusMetrics;
+            if (h && typeof h.postMessage === 'function') {
+                h.postMessage(Object.assign({
+                    event: event, url: window.location.href, page: PAGE_ID
+                }, data));
+            }
+        } catch (e) { }
     }
 
+    // Hosts shown natively (LoadProfile::Full); the list is written in from
+    // load_profile.cpp when the script is injected
+    const FULL_PROFILE_HOSTS = '@COLOSSUS_FULL_PROFILE_HOSTS@'
+        .split(',').filter(h => h && h[0] !== '@');
+
+    // Appended to a page image loaded directly after the proxy failed on it;
+    // the Diet content filter lets these through (DIET_FALLBACK_MARK)
+    const DIET_FALLBACK_MARK = '#colossus-fallback';
+
     // NEW: host check for Telehack
     function isTelehackHost() {
         try {
@@ -367,6 +436,15 @@ svg image:not(.no-amber) {
     margin: 0.25em 0;
 }
 
+/* -------------------------------------------------
+   PROXIED IMAGES — already scaled + tone mapped by
+   colossus-img:// (image_proxy.cpp); no filter chain
+---------------------------------------------------*/
+img.colossus-proxied:not(.no-amber) {
+    filter: none;
+    box-shadow: 0 0 5px #ffae00;
+}
+
 
 
     /* -------------------------------------------------
@@ -410,37 +488,933 @@ svg image:not(.no-amber) {
         display: none !important;
     }
 
+    /* Page nodes the progressive view has not moved aside yet */
+    html.colossus-streaming body > :not(#colossus-terminal-root) {
+        display: none !important;
+    }
+
+    /* -------------------------------------------------
+        Render-quality tiers (see renderQuality): one
+        soft shadow, then none; images keep their tint
+        but lose the drop-shadow
+    ---------------------------------------------------*/
+    html.colossus-fx-single,
+    html.colossus-fx-single * {
+        text-shadow: 0 0 3px currentColor !important;
+    }
+
+    html.colossus-fx-single #colossus-header-title,
+    html.colossus-fx-single .colossus-mpv-icon:hover,
+    html.colossus-fx-flat,
+    html.colossus-fx-flat * {
+        text-shadow: none !important;
+    }
+
+    html.colossus-fx-single .colossus-thumbnail,
+    html.colossus-fx-flat .colossus-thumbnail {
+        filter: grayscale(100%) brightness(0.95) contrast(125%) !important;
+    }
+
+    html.colossus-fx-single img:not(.no-amber):not(.colossus-thumbnail):not(.colossus-proxied),
+    html.colossus-fx-flat img:not(.no-amber):not(.colossus-thumbnail):not(.colossus-proxied) {
+        filter: grayscale(100%) sepia(100%) hue-rotate(-15deg)
+                saturate(250%) brightness(0.85) !important;
+    }
+
 `;
 
+        if (document.getElementById('colossus-style')) return;
+
         const style = document.createElement('style');
         style.id = 'colossus-style';
         style.textContent = css;
         document.documentElement.appendChild(style);
     }
 
+    // ───────────────────────────────────────────────
+    //  Render quality
+    // ───────────────────────────────────────────────
+    //
+    // The CRT glow is stacked text-shadows and drop-shadow filters, and on
+    // slow GPUs painting it is what drops frames while scrolling. Frame
+    // intervals are sampled with requestAnimationFrame only while the page
+    // scrolls; a sample averaging over FX_FRAME_BUDGET_MS steps the page
+    // down a tier (full glow → single shadow → flat). After FX_IDLE_MS
+    // without scrolling, a page whose last sample left enough headroom
+    // steps back up one tier, unless that tier already proved too slow:
+    // each tier remembers the mean that pushed the page off it and the
+    // first mean measured one tier down. The page goes back only when
+    // scaling the first by how the second has since improved lands within
+    // budget, or after a backoff that doubles with every demotion from that
+    // tier. Every sample is reported to the UI process
+    // (Browser::on_metrics_message). The browser can pin a tier for all
+    // pages (window.colossusRenderTier before this script, or pin() later),
+    // which stops the adaptation.
+
+    const FX_TIERS = ['full', 'single', 'flat'];
+    const FX_FRAME_BUDGET_MS = 25;      // mean frame interval (40 fps)
+    const FX_HEADROOM = 0.6;            // step up only from well under budget
+    const FX_SAMPLE_FRAMES = 20;
+    const FX_SCROLL_GAP_MS = 150;       // no scroll for this long ends a sample
+    const FX_IDLE_MS = 4000;
+    const FX_RETRY_MAX_MS = 5 * 60 * 1000;
+
+    const renderQuality = {
+        tier: 0,
+        pinned: false,
+        sampling: false,
+        lastFrame: 0,
+        lastScroll: 0,
+        frames: [],
+        meanMs: -1,                     // last sample, -1 before the first
+        idleTimer: 0,
+        // Per tier: times the page stepped down from it, the mean that did
+        // it, the first mean one tier down (-1 until sampled), and when
+        demotions: FX_TIERS.map(() => ({ count: 0, meanMs: -1, afterMs: -1, at: 0 }))
+    };
+
+    function setRenderTier(tier) {
+        renderQuality.tier = tier;
+        const root = document.documentElement;
+        root.classList.toggle('colossus-fx-single', FX_TIERS[tier] === 'single');
+        root.classList.toggle('colossus-fx-flat', FX_TIERS[tier] === 'flat');
+    }
+
+    function reportRenderQuality() {
+        reportMetric('render-quality', {
+            tier: FX_TIERS[renderQuality.tier],
+            frameMs: renderQuality.meanMs,
+            pinned: renderQuality.pinned
+        });
+    }
+
+    function pinRenderTier(name) {
+        const tier = FX_TIERS.indexOf(name);
+        renderQuality.pinned = tier >= 0;
+        setRenderTier(tier >= 0 ? tier : 0);
+        reportRenderQuality();
+    }
+
+    function onRenderScroll() {
+        const rq = renderQuality;
+        rq.lastScroll = performance.now();
+        if (!rq.pinned && !rq.sampling) {
+            rq.sampling = true;
+            rq.lastFrame = 0;
+            rq.frames.length = 0;
+            requestAnimationFrame(sampleFrame);
+        }
+
+        clearTimeout(rq.idleTimer);
+        rq.idleTimer = setTimeout(stepRenderTierUp, FX_IDLE_MS);
+    }
+
+    function sampleFrame(now) {
+        const rq = renderQuality;
+        if (rq.lastFrame) rq.frames.push(now - rq.lastFrame);
+        rq.lastFrame = now;
+
+        const scrolling = now - rq.lastScroll < FX_SCROLL_GAP_MS;
+        if (scrolling && rq.frames.length < FX_SAMPLE_FRAMES) {
+            requestAnimationFrame(sampleFrame);
+            return;
+        }
+
+        rq.sampling = false;
+        if (rq.frames.length < 5 || rq.pinned) return;    // a flick, not a scroll
+
+        rq.meanMs = rq.frames.reduce((sum, ms) => sum + ms, 0) / rq.frames.length;
+
+        const above = rq.tier > 0 ? rq.demotions[rq.tier - 1] : null;
+        if (above && above.count && above.afterMs < 0) above.afterMs = rq.meanMs;
+
+        if (rq.meanMs > FX_FRAME_BUDGET_MS && rq.tier < FX_TIERS.length - 1) {
+            const demotion = rq.demotions[rq.tier];
+            demotion.count++;
+            demotion.meanMs = rq.meanMs;
+            demotion.afterMs = -1;
+            demotion.at = now;
+            setRenderTier(rq.tier + 1);
+        }
+        reportRenderQuality();
+    }
+
+    function stepRenderTierUp() {
+        const rq = renderQuality;
+        if (rq.pinned || rq.tier === 0 || rq.meanMs < 0 ||
+            rq.meanMs > FX_FRAME_BUDGET_MS * FX_HEADROOM) {
+            return;
+        }
+
+        const demotion = rq.demotions[rq.tier - 1];
+        if (demotion.count) {
+            const projectedMs = demotion.afterMs > 0
+                ? demotion.meanMs * rq.meanMs / demotion.afterMs : Infinity;
+            const backoffMs = Math.min(FX_IDLE_MS * 2 ** demotion.count, FX_RETRY_MAX_MS);
+            const waitedMs = performance.now() - demotion.at;
+            if (projectedMs > FX_FRAME_BUDGET_MS && waitedMs < backoffMs) {
+                rq.idleTimer = setTimeout(stepRenderTierUp, backoffMs - waitedMs);
+                return;
+            }
+        }
+        setRenderTier(rq.tier - 1);
+        reportRenderQuality();
+    }
+
+    function startRenderQuality() {
+        if (window !== window.top) return;
+
+        const pinned = FX_TIERS.indexOf(window.colossusRenderTier);
+        if (pinned >= 0) {
+            renderQuality.pinned = true;
+            setRenderTier(pinned);
+        }
+        window.addEventListener('scroll', onRenderScroll, { passive: true });
+    }
+
+    // ───────────────────────────────────────────────
+    //  Page model (native extension first, JS fallback)
+    // ───────────────────────────────────────────────
+
+    // Same shape as web_extension.cpp builds natively:
+    //   { title, links: [{ url, text, thumb }],
+    //     flow: [{ tag: 'h1'|'h2'|'h3'|'p'|'li', text } | { tag: 'img', src }] }
+    //
+    // The JS path is a single pre-order walk per root. Text under open
+    // h1-h3/p/li/a elements goes into one buffer and each element takes its
+    // slice when the walk leaves it, so nested lists cost one pass instead of
+    // a clone and a textContent per item. Headings, paragraphs and list items
+    // skip the text of script/style/nav/footer/header inside them (recorded
+    // as ranges of the buffer); link text keeps everything, like textContent.
+    // Items are handed out in document order as soon as they are complete,
+    // which lets the walk stop at any node and resume in a later slice.
+
+    // Node.* without trusting the page's globals
+    const ELEMENT_NODE = 1;
+    const TEXT_NODE = 3;
+    const CDATA_SECTION_NODE = 4;
+
+    const TEXT_BLOCK_TAGS = new Set(['h1', 'h2', 'h3', 'p', 'li']);
+    const TEXT_EXCLUDED_TAGS = new Set(['script', 'style', 'nav', 'footer', 'header']);
+
+    function collapseWhitespace(text) {
+        return text.replace(/\s+/g, ' ').trim();
+    }
+
+    function createWalker(root, includeRoot) {
+        return {
+            root: root,
+            node: includeRoot ? root : root.firstChild,
+            open: [],           // entered elements that need leave(): blocks, anchors, excluded
+            text: '',           // text seen while a block or anchor was open
+            capturing: 0,       // open blocks + anchors
+            excluded: [],       // [start, end) of left excluded elements, in leave order
+            thumbless: [],      // open anchors still without an image
+            links: [],
+            flow: [],
+            linksOut: 0,        // links[] / flow[] before these were handed out
+            flowOut: 0
+        };
+    }
+
+    // Block text: its slice of the buffer minus excluded elements inside it.
+    // Those are the ranges left since the block was entered, at the tail.
+    function blockText(w, start) {
+        const cut = [];
+        for (let i = w.excluded.length - 1; i >= 0 && w.excluded[i][1] > start; i--) {
+            cut.push(w.excluded[i]);
+        }
+        if (!cut.length) return collapseWhitespace(w.text.slice(start));
+
+        cut.sort((a, b) => a[0] - b[0]);
+        let text = '';
+        let pos = start;
+        cut.forEach(range => {
+            if (range[0] > pos) text += w.text.slice(pos, range[0]);
+            if (range[1] > pos) pos = range[1];
+        });
+        return collapseWhitespace(text + w.text.slice(pos));
+    }
+
+    function enterElement(w, el) {
+        const tag = el.localName;
+
+        if (tag === 'a' && el.hasAttribute('href')) {
+            const href = el.getAttribute('href');
+            if (href) {
+                const link = { url: urlInfo(href).url, text: null, thumb: '' };
+                const entry = { node: el, link: link, start: w.text.length, alt: '' };
+                w.links.push(link);
+                w.open.push(entry);
+                w.thumbless.push(entry);
+                w.capturing++;
+                return;
+            }
+        }
+
+        if (tag === 'img') {
+            // a.querySelector('img'): the first image inside each open anchor
+            const src = el.src;
+            w.thumbless.forEach(entry => {
+                entry.link.thumb = src || '';
+                entry.alt = el.alt;
+            });
+            w.thumbless.length = 0;
+
+            if (src) w.flow.push({ tag: 'img', src: src });
+            return;
+        }
+
+        if (TEXT_BLOCK_TAGS.has(tag)) {
+            const item = { tag: tag, text: null };
+            w.flow.push(item);
+            w.open.push({ node: el, item: item, start: w.text.length });
+            w.capturing++;
+            return;
+        }
+
+        if (TEXT_EXCLUDED_TAGS.has(tag)) {
+            w.open.push({ node: el, excluded: true, start: w.text.length });
+        }
+    }
+
+    function leaveTop(w) {
+        const entry = w.open.pop();
+
+        if (entry.excluded) {
+            w.excluded.push([entry.start, w.text.length]);
+        } else if (entry.item) {
+            entry.item.text = blockText(w, entry.start);
+            w.capturing--;
+        } else {
+            const text = collapseWhitespace(w.text.slice(entry.start));
+            entry.link.text = text || entry.alt || entry.link.url;
+            if (w.thumbless[w.thumbless.length - 1] === entry) w.thumbless.pop();
+            w.capturing--;
+        }
+
+        // Nothing refers to the buffer any more
+        if (!w.open.length) {
+            w.text = '';
+            w.excluded.length = 0;
+        }
+    }
+
+    function leaveNode(w, node) {
+        if (w.open.length && w.open[w.open.length - 1].node === node) leaveTop(w);
+    }
+
+    // Page scripts run between slices. Open elements they removed would
+    // never be left (the walk climbs through the nodes' current parents), so
+    // their items would stay incomplete and hold back everything after them:
+    // close them with the text they had. Their descendants on the stack went
+    // with them. A removed resume point has no successor left to find; the
+    // root's walk ends there.
+    function closeDetached(w) {
+        const gone = w.open.findIndex(entry => !w.root.contains(entry.node));
+        if (gone >= 0) {
+            while (w.open.length > gone) leaveTop(w);
+        }
+        if (w.node && !w.root.contains(w.node)) w.node = null;
+    }
+
+    // Walk until the end of the root, `deadline` or `maxNodes`; true when done
+    function walk(w, deadline, maxNodes) {
+        closeDetached(w);
+
+        let node = w.node;
+        let visited = 0;
+
+        while (node) {
+            if (++visited > maxNodes ||
+                ((visited & 63) === 0 && performance.now() > deadline)) {
+                break;
+            }
+
+            const type = node.nodeType;
+            if (type === ELEMENT_NODE) {
+                enterElement(w, node);
+            } else if ((type === TEXT_NODE || type === CDATA_SECTION_NODE) && w.capturing) {
+                w.text += node.data;
+            }
+
+            // Pre-order successor within the root, leaving finished elements
+            let next = node.firstChild;
+            while (!next && node && node !== w.root) {
+                leaveNode(w, node);
+                next = node.nextSibling;
+                if (!next) node = node.parentNode;
+            }
+            node = next;
+        }
+
+        w.node = node;
+        if (node) return false;
+
+        // With includeRoot the root itself may still be open
+        while (w.open.length) leaveTop(w);
+        return true;
+    }
+
+    // Completed links and flow items not handed out yet, in document order
+    function takeCompleted(w) {
+        let l = w.linksOut;
+        while (l < w.links.length && w.links[l].text !== null) l++;
+        let f = w.flowOut;
+        while (f < w.flow.length && w.flow[f].text !== null) f++;
+
+        const model = {
+            title: document.title || '',
+            links: w.links.slice(w.linksOut, l),
+            flow: w.flow.slice(w.flowOut, f).filter(item => item.tag === 'img' || item.text)
+        };
+        w.linksOut = l;
+        w.flowOut = f;
+        return model;
+    }
+
+    function nativePageModel(root, includeRoot) {
+        try {
+            const n = NATIVE;
+            if (n && typeof n.extractPageModel === 'function') {
+                const json = n.extractPageModel(root, includeRoot);
+                if (json) return JSON.parse(json);
+            }
+        } catch (e) {
+            console.error('COLOSSUS native extractor failed:', e);
+        }
+        return null;
+    }
+
+    // colossus-bench only (the browser writes "1" over the mark when
+    // COLOSSUS_EXTRACT_CHECK is set): once the terminal view is done, the
+    // walker and the native extractor both run over the original content and
+    // the UI process is told whether their models are identical
+    const EXTRACT_CHECK = '@COLOSSUS_EXTRACT_CHECK@' === '1';
+
+    function firstDifference(a, b) {
+        const key = item => JSON.stringify(item, Object.keys(item).sort());
+        for (let i = 0; i < Math.max(a.length, b.length); i++) {
+            if (i >= a.length || i >= b.length || key(a[i]) !== key(b[i])) return i;
+        }
+        return -1;
+    }
+
+    function checkExtractors() {
+        const original = document.getElementById('colossus-original');
+        if (!EXTRACT_CHECK || !original) return;
+
+        // Without the web-process extension there is nothing to compare with
+        const native = nativePageModel(original, false);
+        if (!native) return;
+
+        const w = createWalker(original, false);
+        walk(w, Infinity, Infinity);
+        const js = takeCompleted(w);
+
+        const link = firstDifference(native.links, js.links);
+        const item = firstDifference(native.flow, js.flow);
+        let detail = '';
+        if (link >= 0) {
+            detail = 'link ' + link + ': native ' + JSON.stringify(native.links[link]) +
+                     ', walker ' + JSON.stringify(js.links[link]);
+        } else if (item >= 0) {
+            detail = 'flow ' + item + ': native ' + JSON.stringify(native.flow[item]) +
+                     ', walker ' + JSON.stringify(js.flow[item]);
+        }
+        reportMetric('extract-check', {
+            equal: !detail,
+            links: js.links.length,
+            flow: js.flow.length,
+            detail: detail
+        });
+    }
+
+    // ───────────────────────────────────────────────
+    //  Budgeted extraction
+    // ───────────────────────────────────────────────
+    //
+    // Roots queued for a terminal shell are extracted in slices of at most
+    // EXTRACT_SLICE_MS / EXTRACT_SLICE_NODES, rendering what each slice
+    // completed and yielding to the event loop in between, so a huge page
+    // never blocks input or painting for long. The native extractor takes a
+    // whole root at a time; the budget is checked between roots.
+
+    const EXTRACT_SLICE_MS = 8;
+    const EXTRACT_SLICE_NODES = 20000;
+
+    // Total time spent extracting, reported with the terminal view
+    let extractMs = 0;
+
+    function createExtraction(shell) {
+        return {
+            shell: shell,
+            queue: [],          // [root, includeRoot]
+            walker: null,
+            scheduled: false,
+            onSlice: null,      // after each slice's rows are rendered
+            onIdle: null        // once, when the queue is drained
+        };
+    }
+
+    function queueExtraction(job, root, includeRoot) {
+        job.queue.push([root, includeRoot]);
+    }
+
+    function extractionIdle(job) {
+        return !job.walker && !job.queue.length;
+    }
+
+    function runExtractionSlice(job) {
+        const started = performance.now();
+        const deadline = started + EXTRACT_SLICE_MS;
+
+        while (!extractionIdle(job) && performance.now() < deadline) {
+            if (!job.walker) {
+                const [root, includeRoot] = job.queue.shift();
+                const model = nativePageModel(root, includeRoot);
+                if (model) {
+                    renderModel(job.shell, model);
+                    continue;
+                }
+                job.walker = createWalker(root, includeRoot);
+            }
+
+            const done = walk(job.walker, deadline, EXTRACT_SLICE_NODES);
+            renderModel(job.shell, takeCompleted(job.walker));
+            if (done) job.walker = null;
+        }
+
+        extractMs += performance.now() - started;
+        if (job.onSlice) job.onSlice();
+
+        if (!extractionIdle(job)) {
+            if (!job.scheduled) {
+                job.scheduled = true;
+                setTimeout(() => {
+                    job.scheduled = false;
+                    runExtractionSlice(job);
+                }, 0);
+            }
+        } else if (job.onIdle) {
+            const onIdle = job.onIdle;
+            job.onIdle = null;
+            onIdle();
+        }
+    }
+
     // ───────────────────────────────────────────────
     //  Terminal-style rebuild
     // ───────────────────────────────────────────────
 
-    function buildTerminalView() {
-        if (!document.body) return;
+    // Rows are built once and then recycled by the virtual lists below, so
+    // they carry no per-row listeners (clicks are delegated from the list
+    // container) and keep references to their parts here.
+    const rowParts = new WeakMap();
+
+    function buildLinkRow() {
+        const row = document.createElement('div');
+        row.className = 'colossus-link-row';
+
+        const indexSpan = document.createElement('span');
+        indexSpan.className = 'colossus-link-index';
+
+        // Thumbnail next to link, if there is an image
+        const thumbWrapper = document.createElement('div');
+        const thumb = document.createElement('img');
+        thumb.className = 'colossus-thumbnail';
+        thumb.loading = 'lazy';
+        thumbWrapper.appendChild(thumb);
+
+        const main = document.createElement('div');
+        main.className = 'colossus-link-main';
+
+        const textSpan = document.createElement('span');
+        textSpan.className = 'colossus-link-text';
+
+        const linkEl = document.createElement('a');
+        textSpan.appendChild(linkEl);
+        main.appendChild(textSpan);
+
+        // Small URL line under the text (for context)
+        const urlLine = document.createElement('div');
+        urlLine.className = 'colossus-link-url';
+        main.appendChild(urlLine);
+
+        // MPV icon for playable URLs
+        const mpvIcon = document.createElement('span');
+        mpvIcon.className = 'colossus-mpv-icon';
+        mpvIcon.textContent = '▶ mpv';
+        main.appendChild(mpvIcon);
+
+        // index on the far left, then thumbnail, then text
+        row.appendChild(indexSpan);
+        row.appendChild(thumbWrapper);
+        row.appendChild(main);
+
+        rowParts.set(row, {
+            index: indexSpan,
+            thumbWrapper: thumbWrapper,
+            thumb: thumb,
+            link: linkEl,
+            url: urlLine,
+            mpv: mpvIcon
+        });
+        return row;
+    }
 
-        // Avoid double init
-        if (document.getElementById('colossus-terminal-root')) return;
+    function fillLinkRow(row, link, position) {
+        const parts = rowParts.get(row);
+
+        row.dataset.url = link.url;
+        parts.index.textContent = String(position + 1).padStart(2, ' ') + '.';
+        parts.link.href = link.url;
+        parts.link.textContent = link.text;
+        parts.url.textContent = link.url;
+
+        if (link.thumb) {
+            parts.thumbWrapper.style.display = '';
+            setProxiedImage(parts.thumb, link.thumb, 'amber', 145, 122);
+        } else {
+            parts.thumbWrapper.style.display = 'none';
+            parts.thumb.classList.remove('colossus-proxied');
+            parts.thumb.removeAttribute('src');
+        }
 
-        // Move original content aside so we can mine it without displaying.
-        const original = document.createElement('div');
-        original.id = 'colossus-original';
-        while (document.body.firstChild) {
-            original.appendChild(document.body.firstChild);
+        parts.mpv.style.display = link.playable ? '' : 'none';
+        row.dataset.playable = link.playable ? '1' : '';
+        observePlayableRow(row, link.playable);
+        observeSpeculationRow(row);
+    }
+
+    // Rows are recycled, so re-arm the observer on every fill
+    let playableObserver = null;
+
+    function observePlayableRow(row, playable) {
+        if (!('IntersectionObserver' in window)) return;
+        if (!playableObserver) {
+            playableObserver = new IntersectionObserver(entries => {
+                entries.forEach(entry => {
+                    if (!entry.isIntersecting || !entry.target.dataset.url) return;
+                    postToResolver(entry.target.dataset.url, 'viewport');
+                    playableObserver.unobserve(entry.target);
+                });
+            }, { threshold: 0.5 });
         }
-        original.style.display = 'none';
-        document.body.appendChild(original);
+        playableObserver.unobserve(row);
+        if (playable) playableObserver.observe(row);
+    }
+
+    // Rows entering the top quarter of the viewport are the next likely
+    // clicks while reading down the list
+    let speculationObserver = null;
+
+    function observeSpeculationRow(row) {
+        if (!('IntersectionObserver' in window)) return;
+        if (!speculationObserver) {
+            speculationObserver = new IntersectionObserver(entries => {
+                entries.forEach(entry => {
+                    if (!entry.isIntersecting || !entry.target.dataset.url) return;
+                    postToSpeculation(entry.target.dataset.url, 'viewport');
+                    speculationObserver.unobserve(entry.target);
+                });
+            }, { rootMargin: '0px 0px -75% 0px' });
+        }
+        speculationObserver.unobserve(row);
+        speculationObserver.observe(row);
+    }
+
+    // The row under the pointer and its pending dwell
+    let dwellRow = null;
+    let dwellTimer = 0;
+
+    function onLinkListHover(ev) {
+        const row = ev.target.closest('.colossus-link-row');
+        if (row === dwellRow) return;       // still within the same row
 
+        clearTimeout(dwellTimer);
+        dwellRow = row;
+        if (!row || !row.dataset.url) return;
+
+        // Rows are recycled while scrolling: the dwell is for this URL only
+        const url = row.dataset.url;
+        postToSpeculation(url, 'hover');
+        dwellTimer = setTimeout(() => {
+            if (dwellRow === row && row.dataset.url === url) {
+                postToSpeculation(url, 'dwell', row.textContent);
+            }
+        }, SPECULATION_DWELL_MS);
+
+        if (row.dataset.playable === '1') postToResolver(url, 'hover');
+    }
+
+    function onLinkListLeave() {
+        clearTimeout(dwellTimer);
+        dwellRow = null;
+    }
+
+    // ───────────────────────────────────────────────
+    //  Image proxy
+    // ───────────────────────────────────────────────
+    //
+    // Thumbnails and inline images load through colossus-img://, which hands
+    // back a small PNG already in the amber palette and caches it on disk.
+    // If the proxy fails (hotlink protection, unknown format) the image falls
+    // back to its original URL and the CSS filter chain. The proxy only
+    // answers URLs carrying its session token, which the browser writes in
+    // here when it injects this script.
+
+    const IMAGE_PROXY_PREFIX = 'colossus-img://@COLOSSUS_IMG_TOKEN@/';
+
+    // Pages saved for offline reading (page_archive.cpp) carry their
+    // thumbnails; a missing one falls back like a failed proxy fetch
+    const ARCHIVE_IMAGE_PREFIX = 'colossus-archive://img/';
+    const ARCHIVED_PAGE = window.location.protocol === 'colossus-archive:';
+
+    function proxiedImageUrl(src, tone, width, height) {
+        if (!/^https?:\/\//i.test(src)) return src;
+        const scale = Math.min(window.devicePixelRatio || 1, 2);
+        return IMAGE_PROXY_PREFIX + tone + '/' +
+            Math.round(width * scale) + 'x' + Math.round(height * scale) + '/' +
+            encodeURIComponent(src);
+    }
+
+    function setProxiedImage(img, src, tone, width, height) {
+        const proxied = ARCHIVED_PAGE && /^https?:\/\//i.test(src)
+            ? ARCHIVE_IMAGE_PREFIX + encodeURIComponent(src)
+            : proxiedImageUrl(src, tone, width, height);
+        img.dataset.originalSrc = src;
+        img.classList.toggle('colossus-proxied', proxied !== src);
+        img.src = proxied;
+    }
+
+    // Image errors do not bubble: listen in the capture phase on the lists
+    function onProxiedImageError(ev) {
+        const img = ev.target;
+        if (!img.classList || !img.classList.contains('colossus-proxied')) return;
+        img.classList.remove('colossus-proxied');
+        const src = img.dataset.originalSrc;
+        img.src = src && !src.includes('#') ? src + DIET_FALLBACK_MARK : src;
+    }
+
+    function onLinkListClick(ev) {
+        const row = ev.target.closest('.colossus-link-row');
+        if (!row || !row.dataset.url || !urlInfo(row.dataset.url).web) return;
+
+        if (ev.target.closest('.colossus-mpv-icon')) {
+            ev.preventDefault();
+            ev.stopPropagation();
+            postToNative(row.dataset.url);
+            return;
+        }
+
+        // Clicking anywhere on row follows the link
+        window.location.href = row.dataset.url;
+    }
+
+    function buildFlowItem() {
+        const div = document.createElement('div');
+        div.className = 'colossus-paragraph';
+
+        const img = document.createElement('img');
+        img.className = 'colossus-inline-image';
+        img.loading = 'lazy';
+
+        // Optional: a bit larger than the small thumbnails
+        img.style.maxWidth = '320px';
+        img.style.maxHeight = '240px';
+        img.style.display = 'block';
+        img.style.margin = '0.25em 0';
+
+        rowParts.set(div, { img: img });
+        return div;
+    }
+
+    function fillFlowItem(div, item) {
+        if (item.tag === 'img') {
+            const img = rowParts.get(div).img;
+            div.textContent = '';
+            setProxiedImage(img, item.src, 'amber', 320, 240);
+            div.appendChild(img);
+            return;
+        }
+
+        // Text nodes (h1/h2/h3/p/li)
+        div.textContent = item.text;
+    }
+
+    // Rough row heights for blocks that have never been laid out
+    function estimateLinkRow(link) {
+        return link.thumb ? 130 : 44;
+    }
+
+    function estimateFlowItem(item) {
+        if (item.tag === 'img') return 250;
+        return 21 * Math.max(1, Math.ceil(item.text.length / 110)) + 7;
+    }
+
+    // ───────────────────────────────────────────────
+    //  Virtualized lists
+    // ───────────────────────────────────────────────
+    //
+    // Items are grouped into fixed-size blocks. Only blocks near the viewport
+    // hold row nodes; the others are empty placeholders sized to their last
+    // measured (or estimated) height, so 50k links cost 1k placeholders.
+    // Rows of blocks that leave the window go back to a pool for reuse.
+
+    const BLOCK_SIZE = 50;
+    const RENDER_MARGIN_PX = 1500;
+    const MAX_POOLED_ROWS = 400;
+
+    function createVirtualList(container, buildRow, fillRow, estimate) {
+        const list = {
+            container: container,
+            buildRow: buildRow,
+            fillRow: fillRow,
+            estimate: estimate,
+            items: [],
+            blocks: [],
+            pool: [],
+            blockOf: new WeakMap(),
+            pastViewport: false,
+            observer: null
+        };
+
+        list.observer = new IntersectionObserver(entries => {
+            entries.forEach(entry => {
+                const block = list.blockOf.get(entry.target);
+                if (!block) return;
+                if (entry.isIntersecting) {
+                    renderBlock(list, block);
+                } else {
+                    releaseBlock(list, block);
+                }
+            });
+        }, { rootMargin: RENDER_MARGIN_PX + 'px 0px' });
+
+        return list;
+    }
+
+    function addBlock(list) {
+        const el = document.createElement('div');
+        el.className = 'colossus-block';
+
+        const block = {
+            el: el,
+            start: list.items.length,
+            count: 0,
+            rendered: false,
+            height: 0
+        };
+
+        list.blockOf.set(el, block);
+        list.blocks.push(block);
+        list.container.appendChild(el);
+        list.observer.observe(el);
+
+        // Render blocks that start on screen right away instead of waiting a
+        // frame for the observer, so first paint and streaming show rows.
+        // Blocks are only ever appended, so once one starts below the window
+        // every later one does too.
+        if (!list.pastViewport) {
+            if (el.getBoundingClientRect().top < window.innerHeight + RENDER_MARGIN_PX) {
+                block.rendered = true;
+            } else {
+                list.pastViewport = true;
+            }
+        }
+        return block;
+    }
+
+    function takeRow(list, position) {
+        const row = list.pool.pop() || list.buildRow();
+        list.fillRow(row, list.items[position], position);
+        return row;
+    }
+
+    function appendItems(list, items) {
+        items.forEach(item => {
+            let block = list.blocks[list.blocks.length - 1];
+            if (!block || block.count === BLOCK_SIZE) block = addBlock(list);
+
+            list.items.push(item);
+            block.count++;
+
+            if (block.rendered) {
+                block.el.appendChild(takeRow(list, list.items.length - 1));
+            } else {
+                block.height += list.estimate(item);
+                block.el.style.height = block.height + 'px';
+            }
+        });
+    }
+
+    // Replace a list's items, keeping the blocks before the first difference.
+    // Returns whether anything differed.
+    function patchList(list, items, same) {
+        const common = Math.min(list.items.length, items.length);
+        let first = 0;
+        while (first < common && same(list.items[first], items[first])) first++;
+        if (first === list.items.length && first === items.length) return false;
+
+        const keep = Math.floor(first / BLOCK_SIZE);
+        list.blocks.splice(keep).forEach(block => {
+            releaseBlock(list, block);
+            list.observer.unobserve(block.el);
+            block.el.remove();
+        });
+        list.items.length = keep * BLOCK_SIZE;
+
+        // Blocks are appended again, so the viewport check starts over
+        list.pastViewport = false;
+        appendItems(list, items.slice(keep * BLOCK_SIZE));
+        return true;
+    }
+
+    function renderBlock(list, block) {
+        if (block.rendered) return;
+
+        const frag = document.createDocumentFragment();
+        for (let i = block.start; i < block.start + block.count; i++) {
+            frag.appendChild(takeRow(list, i));
+        }
+
+        const above = block.el.getBoundingClientRect().bottom <= 0;
+
+        block.el.style.height = '';
+        block.el.appendChild(frag);
+        block.rendered = true;
+
+        // Keep the content under the viewport still when a block above it
+        // turns out taller or shorter than its placeholder
+        if (above) {
+            const delta = block.el.offsetHeight - block.height;
+            if (delta) window.scrollBy(0, delta);
+        }
+    }
+
+    function releaseBlock(list, block) {
+        if (!block.rendered) return;
+
+        block.height = block.el.offsetHeight;
+        block.el.style.height = block.height + 'px';
+
+        while (block.el.firstChild) {
+            const row = block.el.removeChild(block.el.firstChild);
+            if (list.pool.length < MAX_POOLED_ROWS) list.pool.push(row);
+        }
+        block.rendered = false;
+    }
+
+    // The terminal view of this page, once there is one
+    let activeShell = null;
+
+    // Terminal root shared by the one-shot and the progressive builders:
+    // header, "Links" section and content flow. Rows are appended later.
+    function createTerminalShell() {
         // Main terminal-style root
         const root = document.createElement('div');
         root.id = 'colossus-terminal-root';
-        document.body.insertBefore(root, original);
 
         // Header
         const header = document.createElement('div');
@@ -461,163 +1435,439 @@ svg image:not(.no-amber) {
 
         const content = document.createElement('div');
         content.id = 'colossus-content';
+        content.addEventListener('error', onProxiedImageError, true);
         root.appendChild(content);
 
-        // ── Main text (rough)
-    // ── Main content: text + inline images in document order
-    const mainTextTitle = document.createElement('div');
-    mainTextTitle.className = 'colossus-section-title';
-//  mainTextTitle.textContent = 'Content';
-//    content.appendChild(mainTextTitle);
-
-
         // ── Link list
         const linksTitle = document.createElement('div');
         linksTitle.className = 'colossus-section-title';
         linksTitle.textContent = 'Links';
         content.appendChild(linksTitle);
 
-        const anchors = original.querySelectorAll('a[href]');
-        let index = 1;
+        const linksBox = document.createElement('div');
+        linksBox.id = 'colossus-links';
+        linksBox.addEventListener('click', onLinkListClick);
+        linksBox.addEventListener('mouseover', onLinkListHover);
+        linksBox.addEventListener('mouseleave', onLinkListLeave);
+        content.appendChild(linksBox);
+
+        // ── Main content: text + inline images in document order
+        const flowBox = document.createElement('div');
+        flowBox.id = 'colossus-flow';
+        content.appendChild(flowBox);
+
+        activeShell = {
+            root: root,
+            content: content,
+            titleSpan: titleSpan,
+            links: createVirtualList(linksBox, buildLinkRow, fillLinkRow, estimateLinkRow),
+            flow: createVirtualList(flowBox, buildFlowItem, fillFlowItem, estimateFlowItem),
+            seenUrls: new Set(),
+            firstRowAt: 0,
+            live: null          // { links, flow } collected behind a cached view
+        };
+        return activeShell;
+    }
 
-        anchors.forEach(a => {
-            const href = a.getAttribute('href');
-            if (!href) return;
+    function renderModel(shell, model) {
+        // Index pages repeat the same target many times; list it once
+        const links = [];
+        model.links.forEach(link => {
+            if (shell.seenUrls.has(link.url) || !urlInfo(link.url).web) return;
+            shell.seenUrls.add(link.url);
+            link.playable = urlInfo(link.url).playable;
+            links.push(link);
+        });
 
-            const absUrl = resolveUrl(href);
+        // A cached view is on screen; the live rows replace it when complete
+        if (shell.live) {
+            links.forEach(link => shell.live.links.push(link));
+            model.flow.forEach(item => shell.live.flow.push(item));
+            return;
+        }
 
-            // Extract visible text
-            let text = a.textContent || '';
-            text = text.replace(/\s+/g, ' ').trim();
+        appendItems(shell.links, links);
 
-            // If the link is just an image, use alt/src
-            const img = a.querySelector('img');
-            if (!text) {
-                if (img && img.alt) {
-                    text = img.alt;
-                } else {
-                    text = absUrl;
-                }
-            }
+        // h1/h2/h3/p/li + img in DOM order
+        appendItems(shell.flow, model.flow);
+
+        if (!shell.firstRowAt && (shell.links.items.length || shell.flow.items.length)) {
+            shell.firstRowAt = performance.now();
+            reportMetric('first-row', { ms: shell.firstRowAt });
+        }
+    }
+
+    function finishTerminalShell(shell) {
+        // <title> may have changed while we were streaming
+        shell.titleSpan.textContent = document.title || '[No Title]';
+
+        // A cached view turns into the live one from the first block that differs
+        let changed = true;
+        if (shell.live) {
+            const linksChanged = patchList(shell.links, shell.live.links, sameLink);
+            const flowChanged = patchList(shell.flow, shell.live.flow, sameFlowItem);
+            changed = linksChanged || flowChanged;
+            shell.live = null;
+        }
+        offerViewModel(shell, changed);
+
+        // Footer hint
+        const footer = document.createElement('div');
+        footer.id = 'colossus-footer-hint';
+        footer.textContent =
+            'COLOSSUS SYSTEM ACTIVE // SECURITY CLEARANCE OMEGA // ALL CHANNELS MONITORED UNAUTHORIZED ACCESS PROHIBITED';
+        shell.content.appendChild(footer);
+    }
 
-            const row = document.createElement('div');
-            row.className = 'colossus-link-row';
+    // Move original content aside so we can mine it without displaying.
+    function moveOriginalAside(keep) {
+        const original = document.createElement('div');
+        original.id = 'colossus-original';
 
-            const indexSpan = document.createElement('span');
-            indexSpan.className = 'colossus-link-index';
-            indexSpan.textContent = String(index).padStart(2, ' ') + '.';
+        let node = document.body.firstChild;
+        while (node) {
+            const next = node.nextSibling;
+            if (node !== keep) original.appendChild(node);
+            node = next;
+        }
 
-            const main = document.createElement('div');
-            main.className = 'colossus-link-main';
+        original.style.display = 'none';
+        document.body.appendChild(original);
+        return original;
+    }
 
-            const textSpan = document.createElement('span');
-            textSpan.className = 'colossus-link-text';
+    // The first slice is rendered before this returns; `onDone` runs once
+    // the whole page has been extracted
+    function buildTerminalView(onDone) {
+        if (!document.body) return;
 
-            const linkEl = document.createElement('a');
-            linkEl.href = absUrl;
-            linkEl.textContent = text;
+        // Avoid double init
+        if (document.getElementById('colossus-terminal-root')) return;
 
-            textSpan.appendChild(linkEl);
-            main.appendChild(textSpan);
+        const original = moveOriginalAside(null);
 
-            // Small URL line under the text (for context)
-            const urlLine = document.createElement('div');
-            urlLine.className = 'colossus-link-url';
-            urlLine.textContent = absUrl;
-            main.appendChild(urlLine);
+        const shell = createTerminalShell();
+        document.body.insertBefore(shell.root, original);
 
-            // Thumbnail next to link, if there is an image
-            let thumbWrapper = null;
-            if (img && img.src) {
-                thumbWrapper = document.createElement('div');
-                const thumb = document.createElement('img');
-                thumb.className = 'colossus-thumbnail';
-                thumb.src = img.src;
-                thumbWrapper.appendChild(thumb);
-            }
+        const job = createExtraction(shell);
+        job.onIdle = () => {
+            finishTerminalShell(shell);
+            onDone();
+        };
+        queueExtraction(job, original, false);
+        runExtractionSlice(job);
+    }
 
-            // MPV icon for playable URLs
-            if (isPlayableUrl(absUrl)) {
-                const mpvIcon = document.createElement('span');
-                mpvIcon.className = 'colossus-mpv-icon';
-                mpvIcon.textContent = '▶ mpv';
+    // A saved page (colossus-archive://page/...) carries its model; it is
+    // rendered as it is, with nothing to extract
+    function buildArchivedView(onDone) {
+        if (!document.body) return;
 
-                mpvIcon.addEventListener('click', function (ev) {
-                    ev.preventDefault();
-                    ev.stopPropagation();
-                    postToNative(absUrl);
-                });
+        const data = document.getElementById('colossus-archived-page');
+        const model = JSON.parse(data ? data.textContent : 'null');
+        if (!model) return;
 
-                main.appendChild(mpvIcon);
-            }
+        const original = moveOriginalAside(null);
+        document.title = model.title || '';
+
+        const shell = createTerminalShell();
+        shell.root.querySelector('#colossus-header-url').textContent =
+            decodeURIComponent(window.location.pathname.replace(/^\//, '')) + ' [ARCHIVED]';
+        document.body.insertBefore(shell.root, original);
+
+        renderModel(shell, model);
+        finishTerminalShell(shell);
+        onDone();
+    }
 
-            // Clicking anywhere on row follows the link
-            row.addEventListener('click', function (ev) {
-                // If they clicked the mpv icon, that handler already ran
-                if (ev.target.closest('.colossus-mpv-icon')) return;
-                window.location.href = absUrl;
+    // ───────────────────────────────────────────────
+    //  Progressive terminal view
+    // ───────────────────────────────────────────────
+    //
+    // Instead of waiting for DOMContentLoaded, the terminal root is put in
+    // <body> as soon as it exists and every subtree the parser has finished
+    // is extracted as it arrives. The page is revealed once a screenful of
+    // rows exists; at DOMContentLoaded the rest is flushed and the original
+    // nodes are moved aside exactly like buildTerminalView() does.
+
+    const PROGRESSIVE_RENDERING = true;
+
+    // Elements that produce rows; never extracted while still being parsed
+    const OUTPUT_SELECTOR = 'a[href], h1, h2, h3, p, li, img';
+
+    let stream = null;
+
+    function startProgressiveView() {
+        const shell = createTerminalShell();
+        stream = {
+            shell: shell,
+            job: createExtraction(shell),
+            done: new WeakSet(),        // subtrees already extracted
+            split: new WeakSet(),       // open wrappers extracted child by child
+            cursor: new WeakMap(),      // first unfinished child index per parent
+            observer: null,
+            revealed: false
+        };
+        stream.done.add(stream.shell.root);
+        stream.job.onSlice = () => {
+            if (stream) revealIfScreenful(false);
+        };
+
+        document.documentElement.classList.add('colossus-streaming');
+
+        stream.observer = new MutationObserver(() => flushProgressive(false));
+
+        const attach = () => {
+            if (!document.body) return false;
+            document.body.insertBefore(stream.shell.root, document.body.firstChild);
+            stream.observer.observe(document.body, { childList: true, subtree: true });
+            flushProgressive(false);
+            return true;
+        };
+
+        if (!attach()) {
+            const waitForBody = new MutationObserver(() => {
+                if (stream && attach()) waitForBody.disconnect();
             });
+            waitForBody.observe(document.documentElement, { childList: true });
+        }
+    }
 
-            // index on the far left, then thumbnail, then text
-            row.appendChild(indexSpan);
-            if (thumbWrapper) {
-                row.appendChild(thumbWrapper);
+    // Collect subtrees under `parent` that the parser is done with. While
+    // `open`, the last element child may still be receiving nodes: plain
+    // wrappers are descended into, row-producing elements wait until closed.
+    function collectCompleted(parent, open, units, final) {
+        const kids = parent.children;
+        let firstPending = -1;
+
+        for (let i = final ? 0 : (stream.cursor.get(parent) || 0); i < kids.length; i++) {
+            const k = kids[i];
+            if (stream.done.has(k)) continue;
+
+            const stillOpen = open && i === kids.length - 1;
+
+            if (stream.split.has(k)) {
+                collectCompleted(k, stillOpen, units, final);
+                if (!stillOpen) stream.done.add(k);
+            } else if (!stillOpen) {
+                stream.done.add(k);
+                units.push(k);
+            } else if (!k.matches(OUTPUT_SELECTOR)) {
+                stream.split.add(k);
+                collectCompleted(k, true, units, final);
             }
-            row.appendChild(main);
 
-            content.appendChild(row);
-            index++;
-        });
+            if (!stream.done.has(k) && firstPending < 0) firstPending = i;
+        }
+
+        stream.cursor.set(parent, firstPending < 0 ? kids.length : firstPending);
+    }
 
-    // h1/h2/h3/p/li + img in DOM order
-    const flowNodes = original.querySelectorAll('h1, h2, h3, p, li, img');
-    let flowCount = 0;
-    const MAX_FLOW_ITEMS = 120; // safety so we don't flood on huge sites
+    function flushProgressive(final) {
+        if (!stream || !document.body) return;
 
-    flowNodes.forEach(node => {
-        if (flowCount >= MAX_FLOW_ITEMS) return;
+        const units = [];
+        collectCompleted(document.body, !final, units, final);
+        units.forEach(unit => queueExtraction(stream.job, unit, true));
 
-        if (node.tagName && node.tagName.toLowerCase() === 'img') {
-            const src = node.src;
-            if (!src) return;
+        // Renders what fits in one slice; the rest follows from timeouts
+        runExtractionSlice(stream.job);
+    }
 
-            const wrap = document.createElement('div');
-            wrap.className = 'colossus-paragraph';
+    function revealIfScreenful(final) {
+        // Our own rows are not page content
+        stream.observer.takeRecords();
 
-            const img = document.createElement('img');
-            img.src = src;
-            img.className = 'colossus-inline-image';
+        if (!stream.revealed &&
+            (final || stream.shell.root.offsetHeight >= window.innerHeight)) {
+            stream.revealed = true;
+            document.documentElement.style.visibility = 'visible';
+            reportMetric('first-screen', { ms: performance.now() });
+        }
+    }
 
-            // Optional: a bit larger than the small thumbnails
-            img.style.maxWidth = '320px';
-            img.style.maxHeight = '240px';
-            img.style.display = 'block';
-            img.style.margin = '0.25em 0';
+    // The parser is done; `onDone` runs once the queued subtrees are too.
+    // Moving the originals aside keeps any subtree still being walked intact.
+    function finishProgressiveView(onDone) {
+        const shell = stream.shell;
+        const job = stream.job;
+
+        flushProgressive(true);
+        revealIfScreenful(true);
+        stream.observer.disconnect();
+        stream = null;
+
+        moveOriginalAside(shell.root);
+        document.documentElement.classList.remove('colossus-streaming');
+
+        job.onSlice = null;
+        job.onIdle = () => {
+            finishTerminalShell(shell);
+            onDone();
+        };
+        if (extractionIdle(job)) runExtractionSlice(job);
+    }
 
-            wrap.appendChild(img);
-            content.appendChild(wrap);
-            flowCount++;
-            return;
+    // ───────────────────────────────────────────────
+    //  View cache (Browser::begin_cached_view)
+    // ───────────────────────────────────────────────
+    //
+    // After commit the UI process hands the page a token and, on a revisit,
+    // the model kept from last time. That model is shown at once and the
+    // live extraction runs behind it (shell.live); finishTerminalShell()
+    // patches the lists to the live result. The finished model goes back
+    // with the token, or just the token when the cached one was accurate.
+
+    const viewCache = {
+        token: '',
+        shell: null,        // finished shell waiting for the token
+        changed: false
+    };
+
+    function sameLink(a, b) {
+        return a.url === b.url && a.text === b.text && a.thumb === b.thumb;
+    }
+
+    function sameFlowItem(a, b) {
+        return a.tag === b.tag && a.text === b.text && a.src === b.src;
+    }
+
+    function shellModel(shell) {
+        return {
+            title: document.title || '',
+            links: shell.links.items.map(link =>
+                ({ url: link.url, text: link.text, thumb: link.thumb })),
+            flow: shell.flow.items
+        };
+    }
+
+    function beginCachedView(token, model) {
+        viewCache.token = token;
+
+        if (model && stream && !stream.shell.live &&
+            !stream.shell.links.items.length && !stream.shell.flow.items.length) {
+            renderModel(stream.shell, model);
+            stream.shell.live = { links: [], flow: [] };
+            stream.shell.seenUrls = new Set();
+            revealIfScreenful(true);
         }
 
-        // Text nodes (h1/h2/h3/p/li)
-        const txt = extractText(node);
-        if (!txt) return;
+        postViewModel();
+    }
 
-        const div = document.createElement('div');
-        div.className = 'colossus-paragraph';
-        div.textContent = txt;
-        content.appendChild(div);
-        flowCount++;
-    });
+    function offerViewModel(shell, changed) {
+        if (window !== window.top) return;
+        viewCache.shell = shell;
+        viewCache.changed = changed;
+        postViewModel();
+    }
 
+    function postViewModel() {
+        if (!viewCache.token || !viewCache.shell) return;
 
-        // Footer hint
-        const footer = document.createElement('div');
-        footer.id = 'colossus-footer-hint';
-        footer.textContent =
-            'COLOSSUS SYSTEM ACTIVE // SECURITY CLEARANCE OMEGA // ALL CHANNELS MONITORED UNAUTHORIZED ACCESS PROHIBITED';
-        content.appendChild(footer);
+        const message = { token: viewCache.token };
+        if (viewCache.changed) message.model = shellModel(viewCache.shell);
+        viewCache.token = '';
+        viewCache.shell = null;
+
+        try {
+            const h = window.webkit &&
+                      window.webkit.messageHandlers &&
+                      window.webkit.messageHandlers.viewCache;
+            if (h && typeof h.postMessage === 'function') {
+                h.postMessage(message);
+            }
+        } catch (e) { }
+    }
+
+    // ───────────────────────────────────────────────
+    //  Offline archive (Browser save / archive-links actions)
+    // ───────────────────────────────────────────────
+
+    // What is on screen, or null without a terminal view
+    function archiveModel() {
+        return activeShell ? shellModel(activeShell) : null;
+    }
+
+    // Link targets of the terminal view, or of the page as shown
+    function archiveLinks() {
+        if (activeShell) return activeShell.links.items.map(link => link.url);
+        return Array.from(document.querySelectorAll('a[href]'), a => a.href);
+    }
+
+    // ───────────────────────────────────────────────
+    //  Background throttling (Browser::throttle_page)
+    // ───────────────────────────────────────────────
+
+    // Between colossus:throttle and colossus:resume, page timers that come
+    // due are held and run together once per THROTTLE_WAKE_MS; an interval
+    // that comes due several times in between runs once. The wrappers are
+    // only in place while the tab is throttled: a page in the foreground
+    // keeps the native functions. Timers set before the throttle began are
+    // not held.
+    const THROTTLE_WAKE_MS = 1000;
+
+    function installTimerThrottling() {
+        const nativeSetTimeout = window.setTimeout;
+        const nativeSetInterval = window.setInterval;
+        const nativeClearTimeout = window.clearTimeout;
+        const nativeClearInterval = window.clearInterval;
+        const held = new Map();     // timer id → callback to run at the wakeup
+        let wakeTimer = 0;
+
+        function runHeld() {
+            const due = Array.from(held.values());
+            held.clear();
+            for (const run of due) {
+                try { run(); } catch (e) { console.error(e); }
+            }
+        }
+
+        // Timers set while throttled keep their wrapped callback after the
+        // resume; it then runs straight through
+        function wrap(native) {
+            return function (callback, delay, ...args) {
+                if (typeof callback !== 'function') {
+                    return native.call(window, callback, delay, ...args);
+                }
+                const run = () => callback.apply(window, args);
+                const id = native.call(window, () => {
+                    if (wakeTimer) held.set(id, run);
+                    else run();
+                }, delay);
+                return id;
+            };
+        }
+
+        function unwrap(native) {
+            return function (id) {
+                held.delete(id);
+                return native.call(window, id);
+            };
+        }
+
+        const wrapped = {
+            setTimeout: wrap(nativeSetTimeout),
+            setInterval: wrap(nativeSetInterval),
+            clearTimeout: unwrap(nativeClearTimeout),
+            clearInterval: unwrap(nativeClearInterval)
+        };
+
+        document.addEventListener('colossus:throttle', () => {
+            if (wakeTimer) return;
+            Object.assign(window, wrapped);
+            wakeTimer = nativeSetInterval.call(window, runHeld, THROTTLE_WAKE_MS);
+        });
+        document.addEventListener('colossus:resume', () => {
+            if (!wakeTimer) return;
+            nativeClearInterval.call(window, wakeTimer);
+            wakeTimer = 0;
+            window.setTimeout = nativeSetTimeout;
+            window.setInterval = nativeSetInterval;
+            window.clearTimeout = nativeClearTimeout;
+            window.clearInterval = nativeClearInterval;
+            runHeld();
+        });
     }
 
     // ───────────────────────────────────────────────
@@ -626,19 +1876,20 @@ svg image:not(.no-amber) {
 function isNativeAmberHost() {
     try {
         const host = window.location.hostname.toLowerCase();
-        return (
-            host.includes('@x421') ||     // Telehack special case
-            host.includes('https://searchtec.tech/krush')  ||     // ← add other domains here
-            host.includes('levidia.ch')      ||     // ← add more
-            false
-        );
+        return !isTelehackHost() && FULL_PROFILE_HOSTS.some(h => host.includes(h));
     } catch (e) {
         return false;
     }
 }
+    function reportTerminalView() {
+        reportMetric('terminal-view', { ms: performance.now(), extractMs: extractMs });
+        if (!ARCHIVED_PAGE) checkExtractors();
+    }
+
     function init() {
         try {
             injectCss();
+            startRenderQuality();
 
 if (isTelehackHost()) {
     // Telehack: keep xterm behavior + amber + native xterm bridge
@@ -650,9 +1901,17 @@ if (isTelehackHost()) {
     applyTelehackAmberTheme(); // ← reuse the same amber theme
     // No DOM rewrite, no COLOSSUS terminal layout
 
+} else if (ARCHIVED_PAGE) {
+    // Saved for offline reading: the model is in the page
+    buildArchivedView(reportTerminalView);
+
+} else if (stream) {
+    // Progressive view already streamed most rows; flush the rest
+    finishProgressiveView(reportTerminalView);
+
 } else {
     // Everything else gets full COLOSSUS retro terminal mode
-    buildTerminalView();
+    buildTerminalView(reportTerminalView);
 }
 
 
@@ -667,9 +1926,33 @@ if (isTelehackHost()) {
     }
 
     if (document.readyState === 'loading') {
+        if (PROGRESSIVE_RENDERING && !ARCHIVED_PAGE && !isTelehackHost() && !isNativeAmberHost()) {
+            try {
+                injectCss();
+                startProgressiveView();
+            } catch (e) {
+                console.error('COLOSSUS progressive view error:', e);
+                stream = null;
+            }
+        }
         document.addEventListener('DOMContentLoaded', init);
     } else {
         init();
     }
+
+    // The handshake may have come in before this script ran
+    if (window === window.top) {
+        installTimerThrottling();
+
+        window.colossusViewCache = { begin: beginCachedView };
+        window.colossusArchive = { model: archiveModel, links: archiveLinks };
+        window.colossusRenderQuality = { pin: pinRenderTier };
+
+        const pending = window.colossusViewCachePending;
+        if (Array.isArray(pending)) {
+            delete window.colossusViewCachePending;
+            beginCachedView(pending[0], pending[1]);
+        }
+    }
 })();
 
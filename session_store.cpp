@@ -0,0 +1,163 @@
+// session_store.cpp — COLOSSUS tab session file
+
+#include "session_store.h"
+#include "trace.h"
+
+namespace {
+
+const gint SESSION_VERSION = 1;
+
+struct WriteData {
+    std::shared_ptr<SessionFile> file;
+    guint64 generation = 0;
+    std::string contents;
+};
+
+} // namespace
+
+// Shared with writer threads. Generations are numbered on the main loop;
+// a writer that finds a newer generation already on disk does nothing.
+struct SessionFile {
+    std::string path;
+    GMutex lock;
+    guint64 written = 0;        // under lock
+    guint64 next = 1;           // main loop only
+
+    explicit SessionFile(const std::string& p) : path(p) { g_mutex_init(&lock); }
+    ~SessionFile() { g_mutex_clear(&lock); }
+
+    void write(guint64 generation, const std::string& contents)
+    {
+        g_mutex_lock(&lock);
+        if (generation > written) {
+            GError* error = nullptr;
+            if (g_file_set_contents(path.c_str(), contents.c_str(),
+                                    static_cast<gssize>(contents.size()), &error)) {
+                written = generation;
+            } else {
+                g_printerr("COLOSSUS-NAN: Failed to save session: %s\n",
+                           error ? error->message : "unknown error");
+                g_clear_error(&error);
+            }
+        }
+        g_mutex_unlock(&lock);
+    }
+};
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+SessionStore::SessionStore(const std::string& path)
+    : file_(std::make_shared<SessionFile>(path))
+{
+    gchar* dir = g_path_get_dirname(path.c_str());
+    g_mkdir_with_parents(dir, 0700);
+    g_free(dir);
+}
+
+SessionStore::~SessionStore() = default;
+
+// ───────────────────────────────────────────────
+//  Format
+// ───────────────────────────────────────────────
+//
+//   [session]            version, active, tabs
+//   [tab N]              uri, title, scroll, history
+
+std::string SessionStore::serialize(const Session& session)
+{
+    GKeyFile* key_file = g_key_file_new();
+    g_key_file_set_integer(key_file, "session", "version", SESSION_VERSION);
+    g_key_file_set_integer(key_file, "session", "active", session.active);
+    g_key_file_set_integer(key_file, "session", "tabs", static_cast<gint>(session.tabs.size()));
+
+    for (size_t i = 0; i < session.tabs.size(); ++i) {
+        const Tab& tab = session.tabs[i];
+        std::string group = "tab " + std::to_string(i);
+        g_key_file_set_string(key_file, group.c_str(), "uri", tab.uri.c_str());
+        g_key_file_set_string(key_file, group.c_str(), "title", tab.title.c_str());
+        g_key_file_set_double(key_file, group.c_str(), "scroll", tab.scroll_y);
+        if (!tab.history.empty()) {
+            g_key_file_set_string(key_file, group.c_str(), "history", tab.history.c_str());
+        }
+    }
+
+    gsize length = 0;
+    gchar* data = g_key_file_to_data(key_file, &length, nullptr);
+    std::string out(data ? data : "", length);
+    g_free(data);
+    g_key_file_free(key_file);
+    return out;
+}
+
+bool SessionStore::load(Session& session) const
+{
+    GKeyFile* key_file = g_key_file_new();
+    if (!g_key_file_load_from_file(key_file, file_->path.c_str(), G_KEY_FILE_NONE, nullptr) ||
+        g_key_file_get_integer(key_file, "session", "version", nullptr) != SESSION_VERSION) {
+        g_key_file_free(key_file);
+        return false;
+    }
+
+    auto get_string = [key_file](const std::string& group, const char* key) {
+        gchar* value = g_key_file_get_string(key_file, group.c_str(), key, nullptr);
+        std::string out(value ? value : "");
+        g_free(value);
+        return out;
+    };
+
+    gint count = g_key_file_get_integer(key_file, "session", "tabs", nullptr);
+    session.active = g_key_file_get_integer(key_file, "session", "active", nullptr);
+    session.tabs.clear();
+
+    for (gint i = 0; i < count; ++i) {
+        std::string group = "tab " + std::to_string(i);
+        Tab tab;
+        tab.uri = get_string(group, "uri");
+        if (tab.uri.empty()) continue;
+        tab.title = get_string(group, "title");
+        tab.scroll_y = g_key_file_get_double(key_file, group.c_str(), "scroll", nullptr);
+        tab.history = get_string(group, "history");
+        session.tabs.push_back(std::move(tab));
+    }
+    g_key_file_free(key_file);
+
+    if (session.active < 0 || session.active >= static_cast<int>(session.tabs.size())) {
+        session.active = 0;
+    }
+    return !session.tabs.empty();
+}
+
+// ───────────────────────────────────────────────
+//  Saving
+// ───────────────────────────────────────────────
+
+void SessionStore::save(const Session& session)
+{
+    auto* data = new WriteData;
+    data->file = file_;
+    data->generation = file_->next++;
+    data->contents = serialize(session);
+
+    GTask* task = g_task_new(nullptr, nullptr, nullptr, nullptr);
+    g_task_set_task_data(task, data, [](gpointer p) { delete static_cast<WriteData*>(p); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, s_write_thread);
+    g_object_unref(task);
+}
+
+void SessionStore::save_now(const Session& session)
+{
+    gint64 started = g_get_monotonic_time();
+    file_->write(file_->next++, serialize(session));
+    COLOSSUS_TRACE("session saved (%zu tabs) in %.1f ms\n", session.tabs.size(),
+                   colossus_ms_between(started, g_get_monotonic_time()));
+}
+
+void SessionStore::s_write_thread(GTask* task, gpointer, gpointer task_data, GCancellable*)
+{
+    auto* data = static_cast<WriteData*>(task_data);
+    data->file->write(data->generation, data->contents);
+    g_task_return_boolean(task, TRUE);
+}
@@ -0,0 +1,51 @@
+// session_store.h — COLOSSUS tab session file
+
+#ifndef COLOSSUS_SESSION_STORE_H
+#define COLOSSUS_SESSION_STORE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+struct SessionFile;
+
+// The open tabs as a GKeyFile (one group per tab), replaced atomically on
+// every save. Saves are serialized on the main loop and written by a
+// worker; a newer save always wins over an older one still in flight.
+class SessionStore {
+public:
+    struct Tab {
+        std::string uri;
+        std::string title;
+        double scroll_y = 0.0;
+        std::string history;    // base64 WebKitWebViewSessionState
+    };
+
+    struct Session {
+        std::vector<Tab> tabs;
+        int active = 0;
+    };
+
+    explicit SessionStore(const std::string& path);
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    bool load(Session& session) const;
+
+    void save(const Session& session);          // background
+    void save_now(const Session& session);      // blocking, for shutdown
+
+private:
+    std::shared_ptr<SessionFile> file_;
+
+    static std::string serialize(const Session& session);
+    static void s_write_thread(GTask* task, gpointer source, gpointer task_data, GCancellable* cancellable);
+};
+
+#endif // COLOSSUS_SESSION_STORE_H
@@ -0,0 +1,266 @@
+// speculator.cpp — COLOSSUS speculative navigation for terminal-view links
+
+#include "speculator.h"
+#include "process_model.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <libsoup/soup.h>
+}
+
+namespace {
+
+// An unused preload is dropped after this long; the page it shows goes
+// stale and it holds a share of a web process
+const guint PRELOAD_TTL_S = 30;
+
+std::string without_fragment(const std::string& url)
+{
+    return url.substr(0, url.find('#'));
+}
+
+bool is_http(const std::string& url)
+{
+    return g_str_has_prefix(url.c_str(), "http://") || g_str_has_prefix(url.c_str(), "https://");
+}
+
+// Registrable domain of `host` (public-suffix list), or the host itself for
+// addresses and names the list does not cover
+std::string site_of(const std::string& host)
+{
+    const char* base = host.empty() ? nullptr : soup_tld_get_base_domain(host.c_str(), nullptr);
+    return base ? base : host;
+}
+
+// GET links that change state are common enough ("Log out", ?action=delete)
+// that loading one unasked would act on the user's behalf
+const char* const STATE_CHANGING_WORDS[] = {
+    "logout", "log-out", "log_out", "log out", "logoff", "log off",
+    "signout", "sign-out", "sign_out", "sign out",
+    "delete", "remove", "unsubscribe", "destroy"
+};
+
+bool looks_state_changing(const std::string& url, const std::string& text)
+{
+    gchar* haystack = g_ascii_strdown((url + '\n' + text).c_str(), -1);
+    bool found = false;
+    for (const char* word : STATE_CHANGING_WORDS) {
+        if (strstr(haystack, word)) {
+            found = true;
+            break;
+        }
+    }
+    g_free(haystack);
+    return found;
+}
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+Speculator::Speculator(ProcessModel& processes,
+                       bool diet_enabled,
+                       guint max_dns,
+                       guint max_preloads,
+                       guint max_views)
+    : processes_(processes),
+      diet_enabled_(diet_enabled),
+      max_dns_(max_dns),
+      max_preloads_(max_views ? max_preloads : 0),
+      max_views_(max_views)
+{
+}
+
+Speculator::~Speculator()
+{
+    for (auto& preload : live_) {
+        destroy_holder(*preload);
+    }
+    live_.clear();
+}
+
+// ───────────────────────────────────────────────
+//  Hints
+// ───────────────────────────────────────────────
+
+// Only links to the page's own site are preloaded: a preload is a real
+// top-level load, with the user's cookies
+void Speculator::hint(const std::string& url, const std::string& page_url,
+                      const std::string& text, Hint hint)
+{
+    if (!is_http(url)) return;
+
+    prefetch_dns(url);
+    if (hint != Hint::Dwell || looks_state_changing(url, text)) return;
+
+    std::string site = site_of(host_of(url));
+    if (site.empty() || site != site_of(host_of(page_url))) return;
+    preload(without_fragment(url));
+}
+
+void Speculator::prefetch_dns(const std::string& url)
+{
+    if (resolved_hosts_.size() >= max_dns_) return;
+
+    std::string host = host_of(url);
+    if (host.empty() || !resolved_hosts_.insert(host).second) return;
+
+    webkit_web_context_prefetch_dns(processes_.context(), host.c_str());
+    ++dns_prefetches_;
+}
+
+// Laid out in an offscreen window like a pre-warmed view, so browser.js
+// builds the terminal view exactly as it would in a tab
+void Speculator::preload(const std::string& url)
+{
+    if (preloads_ >= max_preloads_) return;
+
+    for (auto& live : live_) {
+        if (live->url == url) return;
+    }
+    while (live_.size() >= max_views_) {
+        discard(live_.front().get());
+    }
+
+    auto owned = std::make_unique<Preload>();
+    Preload* preload = owned.get();
+    preload->owner = this;
+    preload->url = url;
+
+    Entry& entry = preload->entry;
+    entry.webview = processes_.create_view();
+    entry.profile = diet_enabled_ ? load_profile_for_uri(url) : LoadProfile::Full;
+    webkit_web_view_set_settings(entry.webview, processes_.settings_for(entry.profile));
+    webkit_web_view_set_is_muted(entry.webview, TRUE);
+
+    GdkRGBA black;
+    black.red   = 0.0;
+    black.green = 0.0;
+    black.blue  = 0.0;
+    black.alpha = 1.0;
+    webkit_web_view_set_background_color(entry.webview, &black);
+
+    preload->holder = gtk_offscreen_window_new();
+    gtk_window_set_default_size(GTK_WINDOW(preload->holder), 1100, 700);
+    gtk_container_add(GTK_CONTAINER(preload->holder), GTK_WIDGET(entry.webview));
+    gtk_widget_show_all(preload->holder);
+
+    g_signal_connect(entry.webview, "load-changed", G_CALLBACK(s_load_changed), preload);
+    g_signal_connect(entry.webview, "load-failed", G_CALLBACK(s_load_failed), preload);
+    preload->timeout = g_timeout_add_seconds(PRELOAD_TTL_S, s_timeout, preload);
+
+    COLOSSUS_TRACE("preloading %s\n", url.c_str());
+    entry.started_at = g_get_monotonic_time();
+    webkit_web_view_load_uri(entry.webview, url.c_str());
+    live_.push_back(std::move(owned));
+    ++preloads_;
+}
+
+// ───────────────────────────────────────────────
+//  Preloaded views
+// ───────────────────────────────────────────────
+
+bool Speculator::take(const std::string& url, Entry& out)
+{
+    ++navigations_;
+
+    std::string key = without_fragment(url);
+    auto it = std::find_if(live_.begin(), live_.end(),
+                           [&key](const std::unique_ptr<Preload>& p) { return p->url == key; });
+    if (it == live_.end()) return false;
+
+    std::unique_ptr<Preload> preload = std::move(*it);
+    live_.erase(it);
+
+    if (preload->timeout) g_source_remove(preload->timeout);
+    g_signal_handlers_disconnect_by_data(preload->entry.webview, preload.get());
+
+    out = preload->entry;
+    g_object_ref(out.webview);
+    gtk_container_remove(GTK_CONTAINER(preload->holder), GTK_WIDGET(out.webview));
+    gtk_widget_destroy(preload->holder);
+    webkit_web_view_set_is_muted(out.webview, FALSE);
+
+    // Whatever of the load happened before the click
+    gint64 now = g_get_monotonic_time();
+    double saved = colossus_ms_between(out.started_at, out.finished_at ? out.finished_at : now);
+    saved_ms_ += saved;
+    ++hits_;
+
+    COLOSSUS_TRACE("preload hit (%.1f ms ahead): %s\n", saved, key.c_str());
+    return true;
+}
+
+void Speculator::drain()
+{
+    while (!live_.empty()) {
+        discard(live_.front().get());
+    }
+}
+
+void Speculator::discard(Preload* preload)
+{
+    auto it = std::find_if(live_.begin(), live_.end(),
+                           [preload](const std::unique_ptr<Preload>& p) { return p.get() == preload; });
+    if (it == live_.end()) return;
+
+    std::unique_ptr<Preload> done = std::move(*it);
+    live_.erase(it);
+
+    destroy_holder(*done);
+    ++wasted_;
+}
+
+// Destroying the holder takes the view with it
+void Speculator::destroy_holder(Preload& preload)
+{
+    if (preload.timeout) g_source_remove(preload.timeout);
+    preload.timeout = 0;
+    g_signal_handlers_disconnect_by_data(preload.entry.webview, &preload);
+    gtk_widget_destroy(preload.holder);
+    preload.holder = nullptr;
+}
+
+void Speculator::on_load_changed(Preload& preload, WebKitLoadEvent event)
+{
+    if (event == WEBKIT_LOAD_COMMITTED) {
+        preload.entry.committed_at = g_get_monotonic_time();
+    } else if (event == WEBKIT_LOAD_FINISHED) {
+        preload.entry.finished_at = g_get_monotonic_time();
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+void Speculator::s_load_changed(WebKitWebView*, WebKitLoadEvent event, gpointer user_data)
+{
+    auto* preload = static_cast<Preload*>(user_data);
+    preload->owner->on_load_changed(*preload, event);
+}
+
+// A page that fails to load is left to the tab, which shows the error
+gboolean Speculator::s_load_failed(WebKitWebView*, WebKitLoadEvent, gchar*,
+                                   GError* error, gpointer user_data)
+{
+    // Cancelled: replaced by a redirect or a script navigation
+    if (g_error_matches(error, WEBKIT_NETWORK_ERROR, WEBKIT_NETWORK_ERROR_CANCELLED)) return TRUE;
+
+    auto* preload = static_cast<Preload*>(user_data);
+    preload->owner->discard(preload);
+    return TRUE;
+}
+
+gboolean Speculator::s_timeout(gpointer user_data)
+{
+    auto* preload = static_cast<Preload*>(user_data);
+    preload->timeout = 0;
+    preload->owner->discard(preload);
+    return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,116 @@
+// speculator.h — COLOSSUS speculative navigation for terminal-view links
+
+#ifndef COLOSSUS_SPECULATOR_H
+#define COLOSSUS_SPECULATOR_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+#include "load_profile.h"
+
+class ProcessModel;
+
+// Acts on browser.js's hints about which link is likely to be followed
+// next. A row reaching the top of the viewport or under the pointer gets
+// its host resolved (the web context's DNS prefetch; WebKitGTK has no
+// public preconnect). A sustained hover on a link to the same site as the
+// page loads the target in a muted, offscreen view, unless the link looks
+// state-changing (log out, delete, unsubscribe in its URL or text); when
+// the tab then navigates to that URL the browser takes the view and swaps
+// it in instead of starting a cold load.
+//
+// Per session at most `max_dns` hosts are resolved and `max_preloads`
+// views are started; at most `max_views` exist at once (the oldest gives
+// way) and each is dropped after PRELOAD_TTL_S unused. A navigation counts
+// as a hit when a preload was there to take; the time the preload had
+// already spent loading is the latency saved.
+class Speculator {
+public:
+    enum class Hint {
+        Viewport,   // row reached the top of the viewport
+        Hover,      // pointer on the row
+        Dwell       // pointer stayed on the row
+    };
+
+    // A preloaded view; the caller owns one reference to `webview`.
+    // Timestamps are monotonic µs, 0 when not reached yet.
+    struct Entry {
+        WebKitWebView* webview = nullptr;
+        LoadProfile profile = LoadProfile::Full;
+        gint64 started_at = 0;
+        gint64 committed_at = 0;
+        gint64 finished_at = 0;
+    };
+
+    Speculator(ProcessModel& processes,
+               bool diet_enabled,
+               guint max_dns,
+               guint max_preloads,
+               guint max_views);
+    ~Speculator();
+
+    Speculator(const Speculator&) = delete;
+    Speculator& operator=(const Speculator&) = delete;
+
+    // `page_url`: the page the link is on; `text`: the link's text
+    void hint(const std::string& url, const std::string& page_url,
+              const std::string& text, Hint hint);
+
+    // A tab is about to navigate to `url`: hand over its preload, if any
+    bool take(const std::string& url, Entry& out);
+
+    // Release every preload (memory pressure)
+    void drain();
+
+    guint64 dns_prefetches() const { return dns_prefetches_; }
+    guint64 preloads() const { return preloads_; }
+    guint64 hits() const { return hits_; }
+    guint64 misses() const { return navigations_ - hits_; }
+    guint64 wasted() const { return wasted_; }
+    double saved_ms() const { return saved_ms_; }
+
+private:
+    struct Preload {
+        Speculator* owner = nullptr;
+        std::string url;
+        GtkWidget* holder = nullptr;        // GtkOffscreenWindow
+        Entry entry;
+        guint timeout = 0;
+    };
+
+    ProcessModel& processes_;
+    bool diet_enabled_ = true;
+    guint max_dns_ = 0;
+    guint max_preloads_ = 0;
+    guint max_views_ = 0;
+
+    std::unordered_set<std::string> resolved_hosts_;
+    std::list<std::unique_ptr<Preload>> live_;     // oldest first
+
+    guint64 dns_prefetches_ = 0;
+    guint64 preloads_ = 0;
+    guint64 navigations_ = 0;
+    guint64 hits_ = 0;
+    guint64 wasted_ = 0;
+    double saved_ms_ = 0.0;
+
+    void prefetch_dns(const std::string& url);
+    void preload(const std::string& url);
+    void discard(Preload* preload);
+    void destroy_holder(Preload& preload);
+    void on_load_changed(Preload& preload, WebKitLoadEvent event);
+
+    static void s_load_changed(WebKitWebView* view, WebKitLoadEvent event, gpointer user_data);
+    static gboolean s_load_failed(WebKitWebView* view, WebKitLoadEvent event,
+                                  gchar* failing_uri, GError* error, gpointer user_data);
+    static gboolean s_timeout(gpointer user_data);
+};
+
+#endif // COLOSSUS_SPECULATOR_H
@@ -0,0 +1,385 @@
+// stream_resolver.cpp — COLOSSUS yt-dlp stream pre-resolution + expiring cache
+
+#include "stream_resolver.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glib/gstdio.h>
+
+namespace {
+
+// Used when the stream URLs carry no expire= parameter
+const gint64 DEFAULT_TTL_US = G_GINT64_CONSTANT(20) * 60 * G_USEC_PER_SEC;
+
+// Stop trusting a URL this long before it expires
+const gint64 EXPIRY_MARGIN_US = G_GINT64_CONSTANT(5) * 60 * G_USEC_PER_SEC;
+
+// A link yt-dlp could not resolve is left alone this long
+const gint64 FAILURE_TTL_US = G_GINT64_CONSTANT(10) * 60 * G_USEC_PER_SEC;
+
+const guint JOB_TIMEOUT_S = 45;
+const size_t MAX_QUEUED = 32;
+
+struct Pending {
+    StreamResolver* self;
+    std::string url;
+};
+
+} // namespace
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+StreamResolver::StreamResolver(const std::string& format, guint max_jobs,
+                               guint64 disk_limit_bytes)
+    : format_(format)
+    , max_jobs_(max_jobs ? max_jobs : 1)
+{
+    gchar* dir = g_build_filename(g_get_user_cache_dir(), "colossus-nan", "streams", nullptr);
+    cache_dir_ = dir;
+    g_free(dir);
+    g_mkdir_with_parents(cache_dir_.c_str(), 0700);
+
+    cancellable_ = g_cancellable_new();
+    disk_trimmer_.start(cache_dir_, disk_limit_bytes, cancellable_);
+}
+
+StreamResolver::~StreamResolver()
+{
+    g_cancellable_cancel(cancellable_);
+
+    for (auto& entry : jobs_) {
+        Job& job = *entry.second;
+        if (job.timeout_source) g_source_remove(job.timeout_source);
+        if (job.process) {
+            g_subprocess_force_exit(job.process);
+            g_object_unref(job.process);
+        }
+    }
+    jobs_.clear();
+
+    g_clear_object(&cancellable_);
+}
+
+bool StreamResolver::needs_resolution(const std::string& url)
+{
+    if (url.compare(0, 7, "http://") != 0 && url.compare(0, 8, "https://") != 0)
+        return false;
+
+    // Same list as isMediaUrl() in browser.js: mpv plays these as-is
+    std::string path = url.substr(0, url.find_first_of("?#"));
+    for (auto& c : path) c = g_ascii_tolower(c);
+    for (const char* ext : { ".mp4", ".webm", ".mkv", ".mov", ".mp3", ".ogg", ".flac", ".m4a" }) {
+        if (g_str_has_suffix(path.c_str(), ext)) return false;
+    }
+    return true;
+}
+
+// ───────────────────────────────────────────────
+//  Cache
+// ───────────────────────────────────────────────
+
+std::string StreamResolver::cache_path(const std::string& url) const
+{
+    std::string key = format_ + "|" + url;
+    gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), -1);
+    gchar* path = g_build_filename(cache_dir_.c_str(), hash, nullptr);
+    std::string out(path);
+    g_free(path);
+    g_free(hash);
+    return out;
+}
+
+const StreamResolver::Streams* StreamResolver::lookup(const std::string& url)
+{
+    gint64 now = g_get_real_time();
+
+    auto it = cache_.find(url);
+    if (it != cache_.end() && it->second.expires_at > now) return &it->second;
+    if (it != cache_.end()) cache_.erase(it);
+
+    if (!load_from_disk(url)) return nullptr;
+    return &cache_.at(url);
+}
+
+// File layout: expiry (µs, real time), title, then one stream URL per line
+bool StreamResolver::load_from_disk(const std::string& url)
+{
+    std::string path = cache_path(url);
+    gchar* contents = nullptr;
+    if (!g_file_get_contents(path.c_str(), &contents, nullptr, nullptr))
+        return false;
+
+    gchar** lines = g_strsplit(contents, "\n", -1);
+    g_free(contents);
+
+    Streams streams;
+    guint count = g_strv_length(lines);
+    if (count >= 3) {
+        streams.expires_at = g_ascii_strtoll(lines[0], nullptr, 10);
+        streams.title = lines[1];
+        for (guint i = 2; i < count; ++i) {
+            if (*lines[i]) streams.urls.push_back(lines[i]);
+        }
+    }
+    g_strfreev(lines);
+
+    if (streams.urls.empty() || streams.expires_at <= g_get_real_time()) {
+        g_unlink(path.c_str());
+        return false;
+    }
+
+    remember(url, std::move(streams));
+    return true;
+}
+
+// Expired entries go first; past MAX_CACHED, the ones expiring soonest
+const StreamResolver::Streams* StreamResolver::remember(const std::string& url, Streams streams)
+{
+    gint64 now = g_get_real_time();
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (it->second.expires_at <= now) it = cache_.erase(it);
+        else ++it;
+    }
+    while (cache_.size() >= MAX_CACHED && !cache_.count(url)) {
+        auto soonest = std::min_element(cache_.begin(), cache_.end(),
+                                        [](const auto& a, const auto& b) {
+                                            return a.second.expires_at < b.second.expires_at;
+                                        });
+        cache_.erase(soonest);
+    }
+    return &(cache_[url] = std::move(streams));
+}
+
+void StreamResolver::save_to_disk(const std::string& url, const Streams& streams)
+{
+    std::string contents = std::to_string(streams.expires_at) + "\n" + streams.title + "\n";
+    for (const auto& stream : streams.urls) contents += stream + "\n";
+
+    if (g_file_set_contents(cache_path(url).c_str(), contents.c_str(),
+                            static_cast<gssize>(contents.size()), nullptr)) {
+        disk_trimmer_.wrote(contents.size());
+    }
+}
+
+bool StreamResolver::recently_failed(const std::string& url)
+{
+    auto it = failed_.find(url);
+    if (it == failed_.end()) return false;
+    if (it->second > g_get_real_time()) return true;
+
+    failed_.erase(it);
+    return false;
+}
+
+// Bounded like cache_: lapsed entries go first, then the soonest to lapse
+void StreamResolver::remember_failure(const std::string& url)
+{
+    gint64 now = g_get_real_time();
+    for (auto it = failed_.begin(); it != failed_.end();) {
+        if (it->second <= now) it = failed_.erase(it);
+        else ++it;
+    }
+    while (failed_.size() >= MAX_CACHED && !failed_.count(url)) {
+        failed_.erase(std::min_element(failed_.begin(), failed_.end(),
+                                       [](const auto& a, const auto& b) {
+                                           return a.second < b.second;
+                                       }));
+    }
+    failed_[url] = now + FAILURE_TTL_US;
+}
+
+// Earliest expire= parameter among the stream URLs, minus a safety margin
+gint64 StreamResolver::expiry_for(const std::vector<std::string>& urls)
+{
+    gint64 now = g_get_real_time();
+    gint64 expires = now + DEFAULT_TTL_US;
+
+    for (const auto& url : urls) {
+        for (const char* marker : { "?expire=", "&expire=", "/expire/" }) {
+            size_t pos = url.find(marker);
+            if (pos == std::string::npos) continue;
+
+            gint64 seconds = g_ascii_strtoll(url.c_str() + pos + strlen(marker), nullptr, 10);
+            if (seconds > 0) {
+                expires = std::min(expires, seconds * G_USEC_PER_SEC - EXPIRY_MARGIN_US);
+            }
+            break;
+        }
+    }
+    return expires;
+}
+
+// ───────────────────────────────────────────────
+//  Requests
+// ───────────────────────────────────────────────
+
+void StreamResolver::prefetch(const std::string& url, Priority priority)
+{
+    if (!needs_resolution(url) || lookup(url) || recently_failed(url)) return;
+    enqueue(url, priority);
+}
+
+const StreamResolver::Streams* StreamResolver::for_play(const std::string& url)
+{
+    if (!needs_resolution(url)) return nullptr;
+
+    const Streams* streams = lookup(url);
+    if (streams) hits_++;
+    else misses_++;
+    return streams;
+}
+
+void StreamResolver::enqueue(const std::string& url, Priority priority)
+{
+    auto it = jobs_.find(url);
+    if (it == jobs_.end()) {
+        auto job = std::make_unique<Job>();
+        job->url = url;
+        jobs_.emplace(url, std::move(job));
+    } else if (it->second->started || priority == Priority::Viewport) {
+        start_jobs();
+        return;
+    } else {
+        // Hovered while waiting: move it to the front
+        queue_.erase(std::remove(queue_.begin(), queue_.end(), url), queue_.end());
+    }
+
+    if (priority == Priority::Viewport) {
+        queue_.push_back(url);
+    } else {
+        queue_.push_front(url);
+    }
+
+    // A long results page should not pile up stale work
+    while (queue_.size() > MAX_QUEUED) {
+        jobs_.erase(queue_.back());
+        queue_.pop_back();
+    }
+
+    start_jobs();
+}
+
+void StreamResolver::start_jobs()
+{
+    while (running_ < max_jobs_ && !queue_.empty()) {
+        std::string url = queue_.front();
+        queue_.pop_front();
+
+        auto it = jobs_.find(url);
+        if (it != jobs_.end()) start_job(*it->second);
+    }
+}
+
+void StreamResolver::start_job(Job& job)
+{
+    const gchar* argv[] = {
+        "yt-dlp",
+        "--no-playlist",
+        "--no-warnings",
+        "--get-title",
+        "-g",
+        "-f", format_.c_str(),
+        "--", job.url.c_str(),
+        nullptr
+    };
+
+    GError* error = nullptr;
+    job.process = g_subprocess_newv(argv,
+                                    static_cast<GSubprocessFlags>(
+                                        G_SUBPROCESS_FLAGS_STDOUT_PIPE |
+                                        G_SUBPROCESS_FLAGS_STDERR_SILENCE),
+                                    &error);
+    job.started = true;
+    ++running_;
+
+    if (!job.process) {
+        COLOSSUS_TRACE("yt-dlp failed to start: %s\n", error ? error->message : "unknown");
+        if (error) g_error_free(error);
+        on_job_done(job.url, nullptr, false);
+        return;
+    }
+
+    COLOSSUS_TRACE("resolving %s\n", job.url.c_str());
+
+    auto* pending = new Pending{ this, job.url };
+    g_subprocess_communicate_utf8_async(job.process, nullptr, cancellable_,
+                                        s_communicated, pending);
+    job.timeout_source = g_timeout_add_seconds(JOB_TIMEOUT_S, s_timeout, job.process);
+}
+
+void StreamResolver::on_job_done(const std::string& url, const char* output, bool ok)
+{
+    auto it = jobs_.find(url);
+    if (it == jobs_.end()) return;
+
+    std::unique_ptr<Job> job = std::move(it->second);
+    jobs_.erase(it);
+    --running_;
+
+    if (job->timeout_source) g_source_remove(job->timeout_source);
+    g_clear_object(&job->process);
+
+    // --get-title prints the title first, then one URL per line
+    Streams streams;
+    if (ok && output) {
+        gchar** lines = g_strsplit(output, "\n", -1);
+        for (gchar** line = lines; *line; ++line) {
+            g_strstrip(*line);
+            if (!**line) continue;
+            if (g_str_has_prefix(*line, "http://") || g_str_has_prefix(*line, "https://")) {
+                streams.urls.push_back(*line);
+            } else if (streams.title.empty() && streams.urls.empty()) {
+                streams.title = *line;
+            }
+        }
+        g_strfreev(lines);
+    }
+
+    if (!streams.urls.empty()) {
+        streams.expires_at = expiry_for(streams.urls);
+        save_to_disk(url, streams);
+        COLOSSUS_TRACE("resolved %s (%zu streams)\n", url.c_str(), streams.urls.size());
+        remember(url, std::move(streams));
+    } else {
+        COLOSSUS_TRACE("could not resolve %s\n", url.c_str());
+        remember_failure(url);
+    }
+
+    start_jobs();
+}
+
+// ───────────────────────────────────────────────
+//  Static callbacks
+// ───────────────────────────────────────────────
+
+void StreamResolver::s_communicated(GObject* source, GAsyncResult* result, gpointer user_data)
+{
+    std::unique_ptr<Pending> pending(static_cast<Pending*>(user_data));
+
+    gchar* output = nullptr;
+    GError* error = nullptr;
+    gboolean ok = g_subprocess_communicate_utf8_finish(G_SUBPROCESS(source), result,
+                                                      &output, nullptr, &error);
+    if (error && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        g_free(output);
+        return;
+    }
+    if (error) g_error_free(error);
+
+    ok = ok && g_subprocess_get_successful(G_SUBPROCESS(source));
+    pending->self->on_job_done(pending->url, output, ok);
+    g_free(output);
+}
+
+gboolean StreamResolver::s_timeout(gpointer user_data)
+{
+    // Killing it completes the communicate call, which retires the job and
+    // removes this source
+    g_subprocess_force_exit(G_SUBPROCESS(user_data));
+    return G_SOURCE_CONTINUE;
+}
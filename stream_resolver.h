@@ -0,0 +1,113 @@
+// stream_resolver.h — COLOSSUS yt-dlp stream pre-resolution + expiring cache
+
+#ifndef COLOSSUS_STREAM_RESOLVER_H
+#define COLOSSUS_STREAM_RESOLVER_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache_trim.h"
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+// Runs `yt-dlp --get-title -g -f <format>` for playable links before they
+// are clicked, so mpv gets direct stream URLs instead of resolving them
+// itself. Results are cached in memory and on disk until the stream URLs
+// expire (googlevideo's expire= parameter, or a fixed TTL); the in-memory
+// cache drops expired entries and keeps at most MAX_CACHED, the directory
+// is trimmed to `disk_limit_bytes`. A link yt-dlp could not resolve is not
+// tried again for a few minutes. At most
+// `max_jobs` yt-dlp processes run at once; hover requests jump the queue,
+// viewport requests wait behind them and the oldest are dropped when the
+// queue is full.
+//
+// A click never waits for yt-dlp: an unresolved link is played from its
+// page URL and mpv's own ytdl hook resolves it, so plays start at once and
+// reach mpv in click order.
+class StreamResolver {
+public:
+    struct Streams {
+        std::string title;
+        std::vector<std::string> urls;  // video (+ separate audio)
+        gint64 expires_at = 0;          // real time, µs
+    };
+
+    enum class Priority {
+        Viewport,   // link scrolled into view
+        Hover       // pointer on the link
+    };
+
+    static constexpr size_t MAX_CACHED = 256;
+
+    StreamResolver(const std::string& format, guint max_jobs, guint64 disk_limit_bytes);
+    ~StreamResolver();
+
+    StreamResolver(const StreamResolver&) = delete;
+    StreamResolver& operator=(const StreamResolver&) = delete;
+
+    // Links mpv can open directly (plain media files) are not resolved
+    static bool needs_resolution(const std::string& url);
+
+    // Start resolving in the background (no-op if cached or pending)
+    void prefetch(const std::string& url, Priority priority);
+
+    // Fresh cache entry, or nullptr
+    const Streams* lookup(const std::string& url);
+
+    // Fresh streams for a link being played now, or nullptr: the caller
+    // then hands mpv the page URL. Counted as a hit or a miss.
+    const Streams* for_play(const std::string& url);
+
+    guint cached() const { return static_cast<guint>(cache_.size()); }
+    guint running() const { return running_; }
+
+    // for_play() calls answered from the cache / left to mpv's ytdl hook
+    guint64 hits() const { return hits_; }
+    guint64 misses() const { return misses_; }
+
+private:
+    struct Job {
+        std::string url;
+        bool started = false;
+        GSubprocess* process = nullptr;
+        guint timeout_source = 0;
+    };
+
+    std::string format_;
+    guint max_jobs_ = 0;
+    std::string cache_dir_;
+    GCancellable* cancellable_ = nullptr;
+    ColossusCacheTrimmer disk_trimmer_;
+
+    std::map<std::string, Streams> cache_;              // by URL
+    std::map<std::string, gint64> failed_;              // URL → retry after (real time, µs)
+    std::map<std::string, std::unique_ptr<Job>> jobs_;  // by URL
+    std::deque<std::string> queue_;                     // not started, front first
+    guint running_ = 0;
+    guint64 hits_ = 0;
+    guint64 misses_ = 0;
+
+    std::string cache_path(const std::string& url) const;
+    bool load_from_disk(const std::string& url);
+    const Streams* remember(const std::string& url, Streams streams);
+    void save_to_disk(const std::string& url, const Streams& streams);
+    bool recently_failed(const std::string& url);
+    void remember_failure(const std::string& url);
+
+    void enqueue(const std::string& url, Priority priority);
+    void start_jobs();
+    void start_job(Job& job);
+    void on_job_done(const std::string& url, const char* output, bool ok);
+
+    static gint64 expiry_for(const std::vector<std::string>& urls);
+
+    static void s_communicated(GObject* source, GAsyncResult* result, gpointer user_data);
+    static gboolean s_timeout(gpointer user_data);
+};
+
+#endif // COLOSSUS_STREAM_RESOLVER_H
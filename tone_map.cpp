@@ -0,0 +1,172 @@
+// tone_map.cpp — COLOSSUS monochrome / amber tone mapping for RGBA pixels
+//
+// Every filter in the CSS chains starts with grayscale(100%), so the output
+// depends only on luminance: the kernel computes luminance (SSE2 when
+// available, four pixels per step) and looks the final colour up in a
+// 256-entry table built once per tone from the CSS filter matrices.
+
+#include "tone_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct Rgb {
+    uint8_t r, g, b;
+};
+
+// Rec. 709 weights used by CSS grayscale(), in 1/256 fixed point
+const int WEIGHT_R = 54;
+const int WEIGHT_G = 183;
+const int WEIGHT_B = 19;
+
+float clamp01(float v)
+{
+    return std::min(1.0f, std::max(0.0f, v));
+}
+
+// Apply a 3x3 CSS filter matrix, clamping like a filter step boundary does
+void apply_matrix(const float m[9], float& r, float& g, float& b)
+{
+    float nr = m[0] * r + m[1] * g + m[2] * b;
+    float ng = m[3] * r + m[4] * g + m[5] * b;
+    float nb = m[6] * r + m[7] * g + m[8] * b;
+    r = clamp01(nr);
+    g = clamp01(ng);
+    b = clamp01(nb);
+}
+
+Rgb mono_for(float y)
+{
+    // brightness(0.95) contrast(125%)
+    float v = clamp01((y * 0.95f - 0.5f) * 1.25f + 0.5f);
+    auto c = static_cast<uint8_t>(std::lround(v * 255.0f));
+    return { c, c, c };
+}
+
+Rgb amber_for(float y)
+{
+    float r = y, g = y, b = y;
+
+    static const float sepia[9] = {
+        0.393f, 0.769f, 0.189f,
+        0.349f, 0.686f, 0.168f,
+        0.272f, 0.534f, 0.131f
+    };
+    apply_matrix(sepia, r, g, b);
+
+    const float angle = -15.0f * static_cast<float>(M_PI) / 180.0f;
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const float hue[9] = {
+        0.213f + c * 0.787f - s * 0.213f, 0.715f - c * 0.715f - s * 0.715f, 0.072f - c * 0.072f + s * 0.928f,
+        0.213f - c * 0.213f + s * 0.143f, 0.715f + c * 0.285f + s * 0.140f, 0.072f - c * 0.072f - s * 0.283f,
+        0.213f - c * 0.213f - s * 0.787f, 0.715f - c * 0.715f + s * 0.715f, 0.072f + c * 0.928f + s * 0.072f
+    };
+    apply_matrix(hue, r, g, b);
+
+    const float sat = 2.5f;
+    const float saturate[9] = {
+        0.213f + 0.787f * sat, 0.715f - 0.715f * sat, 0.072f - 0.072f * sat,
+        0.213f - 0.213f * sat, 0.715f + 0.285f * sat, 0.072f - 0.072f * sat,
+        0.213f - 0.213f * sat, 0.715f - 0.715f * sat, 0.072f + 0.928f * sat
+    };
+    apply_matrix(saturate, r, g, b);
+
+    // brightness(0.85)
+    return {
+        static_cast<uint8_t>(std::lround(clamp01(r * 0.85f) * 255.0f)),
+        static_cast<uint8_t>(std::lround(clamp01(g * 0.85f) * 255.0f)),
+        static_cast<uint8_t>(std::lround(clamp01(b * 0.85f) * 255.0f))
+    };
+}
+
+struct ToneTable {
+    Rgb entries[256];
+
+    explicit ToneTable(Tone tone)
+    {
+        for (int i = 0; i < 256; ++i) {
+            float y = static_cast<float>(i) / 255.0f;
+            entries[i] = tone == Tone::Mono ? mono_for(y) : amber_for(y);
+        }
+    }
+};
+
+const ToneTable& table_for(Tone tone)
+{
+    static const ToneTable mono(Tone::Mono);
+    static const ToneTable amber(Tone::Amber);
+    return tone == Tone::Mono ? mono : amber;
+}
+
+inline uint8_t luminance(const uint8_t* px)
+{
+    return static_cast<uint8_t>(
+        (WEIGHT_R * px[0] + WEIGHT_G * px[1] + WEIGHT_B * px[2]) >> 8);
+}
+
+inline void store(uint8_t* px, const Rgb& c)
+{
+    px[0] = c.r;
+    px[1] = c.g;
+    px[2] = c.b;
+}
+
+void map_row(uint8_t* row, int width, const ToneTable& table)
+{
+    int x = 0;
+
+#if defined(__SSE2__)
+    // 4 RGBA pixels per iteration: widen to 16 bits, multiply-add the
+    // weights pairwise, then fold (R*wr + G*wg) + (B*wb + A*0) per pixel.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(WEIGHT_R, WEIGHT_G, WEIGHT_B, 0,
+                                           WEIGHT_R, WEIGHT_G, WEIGHT_B, 0);
+    alignas(16) int32_t sums[4];
+
+    for (; x + 4 <= width; x += 4) {
+        uint8_t* px = row + x * 4;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(px));
+
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+
+        // lo = [p0 rg, p0 ba, p1 rg, p1 ba] → [p0, p1, p2, p3]
+        __m128i even = _mm_castps_si128(_mm_shuffle_ps(
+            _mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i odd = _mm_castps_si128(_mm_shuffle_ps(
+            _mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i y = _mm_srli_epi32(_mm_add_epi32(even, odd), 8);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums), y);
+
+        store(px,      table.entries[sums[0]]);
+        store(px + 4,  table.entries[sums[1]]);
+        store(px + 8,  table.entries[sums[2]]);
+        store(px + 12, table.entries[sums[3]]);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        uint8_t* px = row + x * 4;
+        store(px, table.entries[luminance(px)]);
+    }
+}
+
+} // namespace
+
+void tone_map_rgba(uint8_t* pixels, int width, int height, int rowstride, Tone tone)
+{
+    if (!pixels || width <= 0 || height <= 0) return;
+
+    const ToneTable& table = table_for(tone);
+    for (int y = 0; y < height; ++y) {
+        map_row(pixels + static_cast<size_t>(y) * rowstride, width, table);
+    }
+}
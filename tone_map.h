@@ -0,0 +1,17 @@
+// tone_map.h — COLOSSUS monochrome / amber tone mapping for RGBA pixels
+
+#ifndef COLOSSUS_TONE_MAP_H
+#define COLOSSUS_TONE_MAP_H
+
+#include <cstdint>
+
+enum class Tone {
+    Mono,   // .colossus-thumbnail: grayscale, brightness(0.95), contrast(125%)
+    Amber   // img: grayscale, sepia, hue-rotate(-15deg), saturate(250%), brightness(0.85)
+};
+
+// Rewrite RGBA pixels in place with the same result the CSS filter chains in
+// browser.js produce, minus drop-shadow. Alpha is left untouched.
+void tone_map_rgba(uint8_t* pixels, int width, int height, int rowstride, Tone tone);
+
+#endif // COLOSSUS_TONE_MAP_H
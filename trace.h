@@ -0,0 +1,79 @@
+// trace.h — COLOSSUS timing trace (enable with COLOSSUS_TRACE=1)
+
+#ifndef COLOSSUS_TRACE_H
+#define COLOSSUS_TRACE_H
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <glib.h>
+}
+
+inline bool colossus_trace_enabled()
+{
+    static const bool enabled = [] {
+        const gchar* value = g_getenv("COLOSSUS_TRACE");
+        return value && *value && g_strcmp0(value, "0") != 0;
+    }();
+    return enabled;
+}
+
+// Milliseconds between two g_get_monotonic_time() stamps
+inline double colossus_ms_between(gint64 start, gint64 end)
+{
+    return static_cast<double>(end - start) / 1000.0;
+}
+
+// One decimal, '.' whatever the locale: metric values in JSON and reports
+inline std::string colossus_format_metric(double value)
+{
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+    return g_ascii_formatd(buf, sizeof buf, "%.1f", value);
+}
+
+#define COLOSSUS_TRACE(...)                                 \
+    do {                                                    \
+        if (colossus_trace_enabled()) {                     \
+            g_printerr("COLOSSUS-NAN[trace]: " __VA_ARGS__); \
+        }                                                   \
+    } while (0)
+
+// Startup phases, relative to the first mark (made at the top of main()).
+// Kept rather than only traced, so the time-to-first-paint budget check can
+// report where the time went.
+struct ColossusStartupMark {
+    const char* phase;
+    gint64 at;                  // monotonic µs
+};
+
+inline std::vector<ColossusStartupMark>& colossus_startup_marks()
+{
+    static std::vector<ColossusStartupMark> marks;
+    return marks;
+}
+
+inline void colossus_startup_mark(const char* phase)
+{
+    auto& marks = colossus_startup_marks();
+    gint64 now = g_get_monotonic_time();
+    marks.push_back({ phase, now });
+    COLOSSUS_TRACE("startup: %-22s %7.1f ms\n", phase,
+                   colossus_ms_between(marks.front().at, now));
+}
+
+// "phase=ms phase=ms ..." for budget reports
+inline std::string colossus_startup_summary()
+{
+    const auto& marks = colossus_startup_marks();
+    std::string out;
+    for (const auto& mark : marks) {
+        gchar* part = g_strdup_printf("%s%s=%.1f", out.empty() ? "" : " ", mark.phase,
+                                      colossus_ms_between(marks.front().at, mark.at));
+        out += part;
+        g_free(part);
+    }
+    return out;
+}
+
+#endif // COLOSSUS_TRACE_H
@@ -0,0 +1,191 @@
+// view_cache.cpp — COLOSSUS per-URL cache of extracted terminal views
+
+#include "view_cache.h"
+#include "load_profile.h"
+#include "trace.h"
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+ViewCache::ViewCache(guint64 memory_limit_bytes,
+                     guint64 disk_limit_bytes,
+                     const std::string& skip_hosts)
+    : memory_limit_bytes_(memory_limit_bytes)
+{
+    gchar* dir = g_build_filename(g_get_user_cache_dir(), "colossus-nan", "views", nullptr);
+    cache_dir_ = dir;
+    g_free(dir);
+
+    if (g_mkdir_with_parents(cache_dir_.c_str(), 0700) != 0) {
+        g_printerr("COLOSSUS-NAN: Cannot create view cache %s\n", cache_dir_.c_str());
+    }
+
+    gchar** hosts = g_strsplit(skip_hosts.c_str(), ",", -1);
+    for (gchar** host = hosts; *host; ++host) {
+        gchar* trimmed = g_ascii_strdown(g_strstrip(*host), -1);
+        if (*trimmed) skip_hosts_.push_back(trimmed);
+        g_free(trimmed);
+    }
+    g_strfreev(hosts);
+
+    cancellable_ = g_cancellable_new();
+    disk_trimmer_.start(cache_dir_, disk_limit_bytes, cancellable_);
+}
+
+// What is still only in memory is written out, so the next session starts
+// with it
+ViewCache::~ViewCache()
+{
+    g_cancellable_cancel(cancellable_);
+    g_clear_object(&cancellable_);
+
+    for (const Entry& entry : lru_) {
+        if (!entry.on_disk) spill(entry);
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Keys
+// ───────────────────────────────────────────────
+
+// The URL without its fragment; "" when it is not cacheable
+std::string ViewCache::key_for(const std::string& uri)
+{
+    if (!g_str_has_prefix(uri.c_str(), "http://") && !g_str_has_prefix(uri.c_str(), "https://"))
+        return {};
+    return uri.substr(0, uri.find('#'));
+}
+
+bool ViewCache::enabled_for(const std::string& uri) const
+{
+    if (key_for(uri).empty()) return false;
+
+    std::string host = host_of(uri);
+    for (const auto& skip : skip_hosts_) {
+        if (host == skip) return false;
+        if (host.size() > skip.size() &&
+            host.compare(host.size() - skip.size(), skip.size(), skip) == 0 &&
+            host[host.size() - skip.size() - 1] == '.')
+            return false;
+    }
+    return true;
+}
+
+std::string ViewCache::cache_path(const std::string& key) const
+{
+    gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), -1);
+    gchar* path = g_build_filename(cache_dir_.c_str(), hash, nullptr);
+    std::string out(path);
+    g_free(path);
+    g_free(hash);
+    return out;
+}
+
+// The model is JSON that jsc_value_to_json() wrote, so it is passed as a
+// literal. The handshake may arrive before browser.js has run; it then
+// picks it up from window.colossusViewCachePending.
+std::string ViewCache::begin_script(const std::string& token, const std::string* model)
+{
+    return "(function (token, model) {"
+           " const cache = window.colossusViewCache;"
+           " if (cache) cache.begin(token, model);"
+           " else window.colossusViewCachePending = [token, model];"
+           " })(\"" + token + "\", " + (model ? *model : "null") + ");";
+}
+
+// ───────────────────────────────────────────────
+//  Lookup / store
+// ───────────────────────────────────────────────
+
+const std::string* ViewCache::lookup(const std::string& uri)
+{
+    if (!enabled_for(uri)) return nullptr;
+    std::string key = key_for(uri);
+
+    auto it = index_.find(key);
+    if (it == index_.end() && load_from_disk(key)) it = index_.find(key);
+
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+
+    hits_++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->model;
+}
+
+void ViewCache::store(const std::string& uri, std::string model)
+{
+    if (model.empty() || !enabled_for(uri)) return;
+    insert(key_for(uri), std::move(model), false);
+}
+
+void ViewCache::touch(const std::string& uri)
+{
+    auto it = index_.find(key_for(uri));
+    if (it != index_.end()) lru_.splice(lru_.begin(), lru_, it->second);
+}
+
+void ViewCache::insert(std::string key, std::string model, bool on_disk)
+{
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        memory_bytes_ -= it->second->model.size();
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    memory_bytes_ += model.size();
+    lru_.push_front({ key, std::move(model), on_disk });
+    index_[lru_.front().key] = lru_.begin();
+
+    evict();
+}
+
+// Least recently used entries go to disk until memory is within its limit;
+// the newest entry always stays, however large
+void ViewCache::evict()
+{
+    while (memory_bytes_ > memory_limit_bytes_ && lru_.size() > 1) {
+        Entry& oldest = lru_.back();
+        if (!oldest.on_disk) disk_trimmer_.wrote(spill(oldest));
+        memory_bytes_ -= oldest.model.size();
+        index_.erase(oldest.key);
+        lru_.pop_back();
+    }
+}
+
+// ───────────────────────────────────────────────
+//  Disk
+// ───────────────────────────────────────────────
+
+// File layout: the key, then the model JSON. Returns the bytes written.
+size_t ViewCache::spill(const Entry& entry) const
+{
+    std::string contents = entry.key + "\n" + entry.model;
+    if (!g_file_set_contents(cache_path(entry.key).c_str(), contents.c_str(),
+                             static_cast<gssize>(contents.size()), nullptr))
+        return 0;
+    return contents.size();
+}
+
+bool ViewCache::load_from_disk(const std::string& key)
+{
+    gchar* contents = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents(cache_path(key).c_str(), &contents, &length, nullptr))
+        return false;
+
+    std::string data(contents, length);
+    g_free(contents);
+
+    size_t newline = data.find('\n');
+    if (newline == std::string::npos || data.compare(0, newline, key) != 0)
+        return false;
+
+    COLOSSUS_TRACE("view cache: %s read back from disk\n", key.c_str());
+    insert(key, data.substr(newline + 1), true);
+    return true;
+}
@@ -0,0 +1,81 @@
+// view_cache.h — COLOSSUS per-URL cache of extracted terminal views
+
+#ifndef COLOSSUS_VIEW_CACHE_H
+#define COLOSSUS_VIEW_CACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cache_trim.h"
+
+extern "C" {
+#include <gio/gio.h>
+}
+
+// Page models (browser.js's { title, links, flow } JSON) by URL, so a
+// revisited page can show its terminal view as soon as the load commits
+// while the live page is extracted behind it. An LRU of up to
+// `memory_limit_bytes` lives in memory; entries it evicts, and whatever it
+// still holds at exit, spill to ~/.cache/colossus-nan/views, which is
+// trimmed to `disk_limit_bytes` at start and as spills add up. Hosts in
+// `skip_hosts` (and their subdomains) are never cached.
+class ViewCache {
+public:
+    ViewCache(guint64 memory_limit_bytes,
+              guint64 disk_limit_bytes,
+              const std::string& skip_hosts);     // comma-separated
+    ~ViewCache();
+
+    ViewCache(const ViewCache&) = delete;
+    ViewCache& operator=(const ViewCache&) = delete;
+
+    // Script handing a committed page its handshake token and the cached
+    // model (nullptr for none); the finished model comes back with the token
+    // as a viewCache script message
+    static std::string begin_script(const std::string& token, const std::string* model);
+
+    // False for non-http(s) URLs and skipped hosts
+    bool enabled_for(const std::string& uri) const;
+
+    // The cached model, or nullptr. Counts a hit or a miss.
+    const std::string* lookup(const std::string& uri);
+
+    // Replace the model for `uri` / mark it recently used
+    void store(const std::string& uri, std::string model);
+    void touch(const std::string& uri);
+
+    guint64 hits() const { return hits_; }
+    guint64 misses() const { return misses_; }
+    guint cached() const { return static_cast<guint>(index_.size()); }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string model;
+        bool on_disk = false;   // the spill file already has this model
+    };
+
+    guint64 memory_limit_bytes_ = 0;
+    std::string cache_dir_;
+    std::vector<std::string> skip_hosts_;
+    GCancellable* cancellable_ = nullptr;
+    ColossusCacheTrimmer disk_trimmer_;
+
+    std::list<Entry> lru_;      // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    guint64 memory_bytes_ = 0;
+
+    guint64 hits_ = 0;
+    guint64 misses_ = 0;
+
+    static std::string key_for(const std::string& uri);
+    std::string cache_path(const std::string& key) const;
+    bool load_from_disk(const std::string& key);
+    size_t spill(const Entry& entry) const;
+    void insert(std::string key, std::string model, bool on_disk);
+    void evict();
+};
+
+#endif // COLOSSUS_VIEW_CACHE_H
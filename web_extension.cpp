@@ -0,0 +1,455 @@
+// web_extension.cpp — COLOSSUS web-process extension
+//
+// Loaded into every web process (see ProcessModel). Exposes
+// window.colossusNative.extractPageModel(root, includeRoot) to the page's
+// script world; browser.js calls it with the moved-aside original body (or,
+// while streaming, with each finished subtree) and gets back the page model
+// as JSON, built by walking the DOM natively instead of with
+// querySelectorAll/cloneNode in JavaScript. browser.js keeps its own JS
+// extractor as a fallback when the extension is not installed. The object
+// is only a main-world global until browser.js captures and deletes it at
+// document start. The web process's PID goes straight to the UI process as
+// a "web-process" metrics message.
+//
+// Page model (identical for the native and the JS path):
+//   { "title": "...",
+//     "links": [ { "url": "...", "text": "...", "thumb": "..." }, ... ],
+//     "flow":  [ { "tag": "h1|h2|h3|p|li", "text": "..." },
+//                { "tag": "img", "src": "..." }, ... ] }
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+extern "C" {
+#include <webkit2/webkit-web-extension.h>
+}
+
+// The GObject DOM bindings are deprecated upstream but remain the only
+// native DOM access in the webkit2gtk-4.x extension API.
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+namespace {
+
+const gushort ELEMENT_NODE = 1;
+const gushort TEXT_NODE = 3;
+const gushort CDATA_SECTION_NODE = 4;
+
+// ───────────────────────────────────────────────
+//  Text helpers
+// ───────────────────────────────────────────────
+
+// Length of the UTF-8 whitespace sequence at `p` matching JS /\s/, or 0
+size_t whitespace_length(const unsigned char* p)
+{
+    switch (p[0]) {
+    case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+        return 1;
+    case 0xC2:
+        return p[1] == 0xA0 ? 2 : 0;                            // U+00A0
+    case 0xE1:
+        return (p[1] == 0x9A && p[2] == 0x80) ? 3 : 0;          // U+1680
+    case 0xE2:
+        if (p[1] == 0x80 && ((p[2] >= 0x80 && p[2] <= 0x8A) ||  // U+2000..200A
+                             p[2] == 0xA8 || p[2] == 0xA9 ||    // U+2028/2029
+                             p[2] == 0xAF))                     // U+202F
+            return 3;
+        return (p[1] == 0x81 && p[2] == 0x9F) ? 3 : 0;          // U+205F
+    case 0xE3:
+        return (p[1] == 0x80 && p[2] == 0x80) ? 3 : 0;          // U+3000
+    case 0xEF:
+        return (p[1] == 0xBB && p[2] == 0xBF) ? 3 : 0;          // U+FEFF
+    default:
+        return 0;
+    }
+}
+
+// JS: text.replace(/\s+/g, ' ').trim()
+std::string collapse_whitespace(const std::string& in)
+{
+    std::string out;
+    out.reserve(in.size());
+
+    const auto* p = reinterpret_cast<const unsigned char*>(in.c_str());
+    bool pending_space = false;
+
+    while (*p) {
+        size_t ws = whitespace_length(p);
+        if (ws) {
+            pending_space = !out.empty();
+            p += ws;
+            continue;
+        }
+        if (pending_space) {
+            out += ' ';
+            pending_space = false;
+        }
+        out += static_cast<char>(*p++);
+    }
+    return out;
+}
+
+void append_json_string(std::string& out, const std::string& s)
+{
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                g_snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    out += '"';
+}
+
+// Take ownership of a gchar* from the DOM API
+std::string take_string(gchar* s)
+{
+    if (!s) return {};
+    std::string out(s);
+    g_free(s);
+    return out;
+}
+
+std::string lower_tag(WebKitDOMElement* el)
+{
+    std::string tag = take_string(webkit_dom_element_get_tag_name(el));
+    for (auto& c : tag) c = g_ascii_tolower(c);
+    return tag;
+}
+
+// ───────────────────────────────────────────────
+//  DOM walking
+// ───────────────────────────────────────────────
+
+// Pre-order successor of `node` within `root`, calling `leave` for every
+// element whose subtree is finished. Iterative so deep DOMs cannot overflow
+// the stack.
+template <typename Leave>
+WebKitDOMNode* next_node(WebKitDOMNode* node, WebKitDOMNode* root,
+                         bool descend, Leave&& leave)
+{
+    if (descend) {
+        if (WebKitDOMNode* child = webkit_dom_node_get_first_child(node))
+            return child;
+    }
+
+    while (node && node != root) {
+        leave(node);
+        if (WebKitDOMNode* sibling = webkit_dom_node_get_next_sibling(node))
+            return sibling;
+        node = webkit_dom_node_get_parent_node(node);
+    }
+    return nullptr;
+}
+
+bool is_text_block(const std::string& tag)
+{
+    return tag == "h1" || tag == "h2" || tag == "h3" || tag == "p" || tag == "li";
+}
+
+bool is_text_excluded(const std::string& tag)
+{
+    return tag == "script" || tag == "style" || tag == "nav" ||
+           tag == "footer" || tag == "header";
+}
+
+struct Link {
+    std::string url;
+    std::string text;
+    std::string thumb;
+    std::string alt;
+    bool has_image = false;
+};
+
+struct FlowItem {
+    std::string tag;
+    std::string text;           // h1-h3/p/li
+    std::string src;            // img
+};
+
+// An entered element that needs its leave: a text block, an anchor, or an
+// excluded element whose text blocks leave out
+struct OpenElement {
+    enum Kind { BLOCK, ANCHOR, EXCLUDED };
+
+    WebKitDOMNode* node;
+    Kind kind;
+    size_t index;               // into flow (BLOCK) or links (ANCHOR)
+    size_t start;               // in the text buffer
+};
+
+// Same single pass as browser.js's walker: text under open blocks and
+// anchors goes into one buffer, each element takes its slice on leave, so
+// nested blocks do not walk their subtrees again
+struct PageWalker {
+    std::vector<Link> links;
+    std::vector<FlowItem> flow;
+    std::vector<OpenElement> open;
+    std::string text;
+    size_t capturing = 0;
+    std::vector<std::pair<size_t, size_t>> excluded;   // left, in leave order
+
+    // Block text: its slice minus excluded elements inside it, which are
+    // the ranges left since it was entered, at the tail
+    std::string block_text(size_t start) const
+    {
+        std::vector<std::pair<size_t, size_t>> cut;
+        for (size_t i = excluded.size(); i > 0 && excluded[i - 1].second > start; --i) {
+            cut.push_back(excluded[i - 1]);
+        }
+        if (cut.empty()) return collapse_whitespace(text.substr(start));
+
+        std::sort(cut.begin(), cut.end());
+        std::string out;
+        size_t pos = start;
+        for (const auto& range : cut) {
+            if (range.first > pos) out.append(text, pos, range.first - pos);
+            if (range.second > pos) pos = range.second;
+        }
+        out.append(text, pos, std::string::npos);
+        return collapse_whitespace(out);
+    }
+
+    void enter(WebKitDOMNode* node)
+    {
+        auto* el = WEBKIT_DOM_ELEMENT(node);
+        std::string tag = lower_tag(el);
+
+        if (tag == "a" && webkit_dom_element_has_attribute(el, "href")) {
+            std::string href = take_string(webkit_dom_element_get_attribute(el, "href"));
+            Link link;
+            link.url = WEBKIT_DOM_IS_HTML_ANCHOR_ELEMENT(node)
+                ? take_string(webkit_dom_html_anchor_element_get_href(
+                      WEBKIT_DOM_HTML_ANCHOR_ELEMENT(node)))
+                : href;
+            if (link.url.empty()) link.url = href;
+            if (!href.empty()) {
+                links.push_back(std::move(link));
+                open.push_back({ node, OpenElement::ANCHOR, links.size() - 1, text.size() });
+                ++capturing;
+                return;
+            }
+        }
+
+        if (tag == "img" && WEBKIT_DOM_IS_HTML_IMAGE_ELEMENT(node)) {
+            auto* img = WEBKIT_DOM_HTML_IMAGE_ELEMENT(node);
+            std::string src = take_string(webkit_dom_html_image_element_get_src(img));
+
+            // a.querySelector('img'): first image inside each open anchor
+            for (const OpenElement& entry : open) {
+                if (entry.kind != OpenElement::ANCHOR) continue;
+                Link& link = links[entry.index];
+                if (link.has_image) continue;
+                link.has_image = true;
+                link.thumb = src;
+                link.alt = take_string(webkit_dom_html_image_element_get_alt(img));
+            }
+
+            if (!src.empty()) flow.push_back({ "img", "", src });
+            return;
+        }
+
+        if (is_text_block(tag)) {
+            flow.push_back({ tag, "", "" });
+            open.push_back({ node, OpenElement::BLOCK, flow.size() - 1, text.size() });
+            ++capturing;
+            return;
+        }
+
+        if (is_text_excluded(tag)) {
+            open.push_back({ node, OpenElement::EXCLUDED, 0, text.size() });
+        }
+    }
+
+    void leave_top()
+    {
+        OpenElement entry = open.back();
+        open.pop_back();
+
+        if (entry.kind == OpenElement::EXCLUDED) {
+            excluded.emplace_back(entry.start, text.size());
+        } else if (entry.kind == OpenElement::BLOCK) {
+            flow[entry.index].text = block_text(entry.start);
+            --capturing;
+        } else {
+            links[entry.index].text = collapse_whitespace(text.substr(entry.start));
+            --capturing;
+        }
+
+        // Nothing refers to the buffer any more
+        if (open.empty()) {
+            text.clear();
+            excluded.clear();
+        }
+    }
+
+    void leave(WebKitDOMNode* node)
+    {
+        if (!open.empty() && open.back().node == node) leave_top();
+    }
+};
+
+std::string build_page_model(WebKitDOMNode* root, bool include_root)
+{
+    PageWalker w;
+    auto leave = [&w](WebKitDOMNode* n) { w.leave(n); };
+
+    WebKitDOMNode* node = include_root ? root : webkit_dom_node_get_first_child(root);
+    while (node) {
+        gushort type = webkit_dom_node_get_node_type(node);
+        if (type == ELEMENT_NODE) {
+            w.enter(node);
+        } else if ((type == TEXT_NODE || type == CDATA_SECTION_NODE) && w.capturing) {
+            gchar* value = webkit_dom_node_get_node_value(node);
+            if (value) {
+                w.text += value;
+                g_free(value);
+            }
+        }
+
+        node = next_node(node, root, type == ELEMENT_NODE, leave);
+    }
+
+    // With include_root the root itself may still be open
+    while (!w.open.empty()) w.leave_top();
+
+    std::string json = "{\"title\":";
+    WebKitDOMDocument* doc = webkit_dom_node_get_owner_document(root);
+    append_json_string(json, doc ? take_string(webkit_dom_document_get_title(doc)) : "");
+
+    json += ",\"links\":[";
+    for (size_t i = 0; i < w.links.size(); ++i) {
+        const Link& link = w.links[i];
+        if (i) json += ',';
+
+        // Same fallbacks as the JS path: image alt, then the URL itself
+        std::string text = link.text;
+        if (text.empty()) text = !link.alt.empty() ? link.alt : link.url;
+
+        json += "{\"url\":";
+        append_json_string(json, link.url);
+        json += ",\"text\":";
+        append_json_string(json, text);
+        json += ",\"thumb\":";
+        append_json_string(json, link.thumb);
+        json += '}';
+    }
+    json += "],\"flow\":[";
+    bool first = true;
+    for (const FlowItem& item : w.flow) {
+        bool image = item.tag == "img";
+        if (!image && item.text.empty()) continue;
+        if (!first) json += ',';
+        first = false;
+
+        json += "{\"tag\":\"" + item.tag + (image ? "\",\"src\":" : "\",\"text\":");
+        append_json_string(json, image ? item.src : item.text);
+        json += '}';
+    }
+    json += "]}";
+
+    return json;
+}
+
+// ───────────────────────────────────────────────
+//  JS bindings
+// ───────────────────────────────────────────────
+
+JSCValue* extract_page_model(JSCValue* root_value, gboolean include_root, gpointer)
+{
+    JSCContext* context = jsc_value_get_context(root_value);
+
+    WebKitDOMNode* root = webkit_dom_node_for_js_value(root_value);
+    if (!root)
+        return jsc_value_new_null(context);
+
+    std::string json = build_page_model(root, include_root);
+    return jsc_value_new_string(context, json.c_str());
+}
+
+// The web process's PID goes to the UI process over the metrics message
+// handler, before any page script runs; pages never see it. The page id
+// tells the UI process which view it came from.
+void report_pid(JSCContext* context, WebKitFrame* frame, guint64 page_id)
+{
+    JSCValue* handler = jsc_context_evaluate(
+        context, "window.webkit.messageHandlers.colossusMetrics", -1);
+    if (handler && jsc_value_is_object(handler)) {
+        JSCValue* message = jsc_value_new_object(context, nullptr, nullptr);
+        JSCValue* event = jsc_value_new_string(context, "web-process");
+        JSCValue* url = jsc_value_new_string(context, webkit_frame_get_uri(frame));
+        JSCValue* pid = jsc_value_new_number(context, static_cast<double>(getpid()));
+        JSCValue* page = jsc_value_new_number(context, static_cast<double>(page_id));
+        jsc_value_object_set_property(message, "event", event);
+        jsc_value_object_set_property(message, "url", url);
+        jsc_value_object_set_property(message, "pid", pid);
+        jsc_value_object_set_property(message, "page", page);
+
+        JSCValue* result = jsc_value_object_invoke_method(handler, "postMessage",
+                                                          JSC_TYPE_VALUE, message,
+                                                          G_TYPE_NONE);
+        if (result) g_object_unref(result);
+        g_object_unref(page);
+        g_object_unref(pid);
+        g_object_unref(url);
+        g_object_unref(event);
+        g_object_unref(message);
+    }
+    if (handler) g_object_unref(handler);
+}
+
+// Top frame only, where browser.js builds the terminal view. It takes the
+// object and deletes the global at document start, before page scripts
+// could call or replace it. pageId (webkit_web_view_get_page_id() in the
+// UI process) goes with browser.js's metrics so they reach the right tab.
+void on_window_object_cleared(WebKitScriptWorld*,
+                              WebKitWebPage* page,
+                              WebKitFrame* frame,
+                              gpointer)
+{
+    if (!webkit_frame_is_main_frame(frame)) return;
+
+    JSCContext* context = webkit_frame_get_js_context(frame);
+
+    JSCValue* fn = jsc_value_new_function(context, "extractPageModel",
+                                          G_CALLBACK(extract_page_model),
+                                          nullptr, nullptr,
+                                          JSC_TYPE_VALUE, 2,
+                                          JSC_TYPE_VALUE, G_TYPE_BOOLEAN);
+    guint64 page_id = webkit_web_page_get_id(page);
+    JSCValue* id = jsc_value_new_number(context, static_cast<double>(page_id));
+    JSCValue* native = jsc_value_new_object(context, nullptr, nullptr);
+    jsc_value_object_set_property(native, "extractPageModel", fn);
+    jsc_value_object_set_property(native, "pageId", id);
+    jsc_context_set_value(context, "colossusNative", native);
+
+    report_pid(context, frame, page_id);
+
+    g_object_unref(native);
+    g_object_unref(id);
+    g_object_unref(fn);
+    g_object_unref(context);
+}
+
+} // namespace
+
+extern "C" G_MODULE_EXPORT void
+webkit_web_extension_initialize(WebKitWebExtension*)
+{
+    g_signal_connect(webkit_script_world_get_default(), "window-object-cleared",
+                     G_CALLBACK(on_window_object_cleared), nullptr);
+}
@@ -0,0 +1,203 @@
+// webview_pool.cpp — COLOSSUS pre-warmed webviews for instant new tabs
+
+#include "webview_pool.h"
+#include "process_model.h"
+
+#include <algorithm>
+
+// Demand window for sizing, and how long a quiet pool keeps extra entries
+static const gint64 DEMAND_WINDOW_US = 60 * G_USEC_PER_SEC;
+
+// ───────────────────────────────────────────────
+//  Constructor / destructor
+// ───────────────────────────────────────────────
+
+WebviewPool::WebviewPool(ProcessModel& processes,
+                         const std::string& preload_uri,
+                         guint max_size)
+    : processes_(processes),
+      preload_uri_(preload_uri),
+      max_size_(max_size)
+{
+}
+
+WebviewPool::~WebviewPool()
+{
+    if (refill_source_) {
+        g_source_remove(refill_source_);
+        refill_source_ = 0;
+    }
+    for (auto& warm : entries_) {
+        destroy_entry(*warm);
+    }
+    entries_.clear();
+}
+
+// ───────────────────────────────────────────────
+//  Sizing
+// ───────────────────────────────────────────────
+
+guint WebviewPool::target() const
+{
+    if (drained_ || max_size_ == 0) return 0;
+
+    guint wanted = 1 + static_cast<guint>(recent_takes_.size());
+    return std::min(wanted, max_size_);
+}
+
+void WebviewPool::prune_takes(gint64 now)
+{
+    recent_takes_.erase(
+        std::remove_if(recent_takes_.begin(), recent_takes_.end(),
+                       [now](gint64 t) { return now - t > DEMAND_WINDOW_US; }),
+        recent_takes_.end());
+}
+
+void WebviewPool::trim()
+{
+    prune_takes(g_get_monotonic_time());
+
+    while (entries_.size() > target()) {
+        destroy_entry(*entries_.back());
+        entries_.pop_back();
+    }
+}
+
+void WebviewPool::drain()
+{
+    drained_ = true;
+    if (refill_source_) {
+        g_source_remove(refill_source_);
+        refill_source_ = 0;
+    }
+    for (auto& warm : entries_) {
+        destroy_entry(*warm);
+    }
+    entries_.clear();
+}
+
+// ───────────────────────────────────────────────
+//  Entries
+// ───────────────────────────────────────────────
+
+bool WebviewPool::take(Entry& out)
+{
+    gint64 now = g_get_monotonic_time();
+    prune_takes(now);
+    recent_takes_.push_back(now);
+    drained_ = false;
+
+    if (entries_.empty()) {
+        schedule_refill();
+        return false;
+    }
+
+    // Oldest entry first: it has had the most time to finish loading
+    std::unique_ptr<Warm> warm = std::move(entries_.front());
+    entries_.erase(entries_.begin());
+
+    g_signal_handlers_disconnect_by_data(warm->entry.webview, warm.get());
+    g_object_ref(warm->entry.scrolled);
+    gtk_container_remove(GTK_CONTAINER(warm->holder), warm->entry.scrolled);
+    gtk_widget_destroy(warm->holder);
+
+    out = warm->entry;
+
+    schedule_refill();
+    return true;
+}
+
+void WebviewPool::destroy_entry(Warm& warm)
+{
+    // Destroying the holder takes the scrolled window and view with it
+    if (warm.holder) {
+        g_signal_handlers_disconnect_by_data(warm.entry.webview, &warm);
+        gtk_widget_destroy(warm.holder);
+    }
+    warm = Warm();
+}
+
+bool WebviewPool::refill_one()
+{
+    if (entries_.size() >= target()) return false;
+
+    auto owned = std::make_unique<Warm>();
+    Warm& warm = *owned;
+    Entry& entry = warm.entry;
+
+    entry.scrolled = gtk_scrolled_window_new(nullptr, nullptr);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(entry.scrolled),
+                                   GTK_POLICY_AUTOMATIC,
+                                   GTK_POLICY_AUTOMATIC);
+
+    entry.webview = processes_.create_view();
+
+    GdkRGBA black;
+    black.red   = 0.0;
+    black.green = 0.0;
+    black.blue  = 0.0;
+    black.alpha = 1.0;
+    webkit_web_view_set_background_color(entry.webview, &black);
+
+    gtk_container_add(GTK_CONTAINER(entry.scrolled), GTK_WIDGET(entry.webview));
+
+    // Offscreen toplevel so the view is realized and laid out before use
+    warm.holder = gtk_offscreen_window_new();
+    gtk_window_set_default_size(GTK_WINDOW(warm.holder), 1100, 700);
+    gtk_container_add(GTK_CONTAINER(warm.holder), entry.scrolled);
+    gtk_widget_show_all(warm.holder);
+
+    if (!preload_uri_.empty()) {
+        g_signal_connect(entry.webview, "load-changed", G_CALLBACK(s_load_changed), &warm);
+        g_signal_connect(entry.webview, "load-failed", G_CALLBACK(s_load_failed), &warm);
+        entry.started_at = g_get_monotonic_time();
+        webkit_web_view_load_uri(entry.webview, preload_uri_.c_str());
+    }
+
+    entries_.push_back(std::move(owned));
+    return entries_.size() < target();
+}
+
+void WebviewPool::schedule_refill()
+{
+    if (refill_source_ || entries_.size() >= target()) return;
+
+    refill_source_ = g_idle_add_full(G_PRIORITY_LOW,
+                                     WebviewPool::s_refill, this, nullptr);
+}
+
+// ───────────────────────────────────────────────
+//  Static trampolines
+// ───────────────────────────────────────────────
+
+gboolean WebviewPool::s_refill(gpointer user_data)
+{
+    auto* self = static_cast<WebviewPool*>(user_data);
+    if (!self) return G_SOURCE_REMOVE;
+
+    // One entry per idle dispatch keeps each slice short
+    if (self->refill_one()) return G_SOURCE_CONTINUE;
+
+    self->refill_source_ = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void WebviewPool::s_load_changed(WebKitWebView*, WebKitLoadEvent event, gpointer user_data)
+{
+    Entry& entry = static_cast<Warm*>(user_data)->entry;
+    if (event == WEBKIT_LOAD_COMMITTED) {
+        entry.committed_at = g_get_monotonic_time();
+    } else if (event == WEBKIT_LOAD_FINISHED) {
+        entry.finished_at = g_get_monotonic_time();
+    }
+}
+
+// WebKit still shows its error page; the tab loads the URI again instead
+gboolean WebviewPool::s_load_failed(WebKitWebView*, WebKitLoadEvent, gchar*,
+                                    GError* error, gpointer user_data)
+{
+    if (!g_error_matches(error, WEBKIT_NETWORK_ERROR, WEBKIT_NETWORK_ERROR_CANCELLED)) {
+        static_cast<Warm*>(user_data)->entry.failed = true;
+    }
+    return FALSE;
+}
@@ -0,0 +1,86 @@
+// webview_pool.h — COLOSSUS pre-warmed webviews for instant new tabs
+
+#ifndef COLOSSUS_WEBVIEW_POOL_H
+#define COLOSSUS_WEBVIEW_POOL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+}
+
+class ProcessModel;
+
+// Keeps a few scrolled-window + webview pairs alive in offscreen windows,
+// already realized and with `preload_uri` loading, so create_tab only has
+// to reparent one. Refills happen on the main loop at idle priority. The
+// target size follows recent demand (1 + tabs opened in the last minute, up
+// to `max_size`) and falls back to one entry after a quiet period.
+//
+// The preload's milestones are kept while the entry waits, since the page
+// may well finish before the view is taken and the tab connects its own
+// load handlers.
+class WebviewPool {
+public:
+    // Timestamps are monotonic µs, 0 when not reached yet
+    struct Entry {
+        GtkWidget* scrolled = nullptr;      // caller owns one reference
+        WebKitWebView* webview = nullptr;
+        gint64 started_at = 0;
+        gint64 committed_at = 0;
+        gint64 finished_at = 0;
+        bool failed = false;                // preload_uri did not load
+    };
+
+    WebviewPool(ProcessModel& processes,
+                const std::string& preload_uri,
+                guint max_size);
+    ~WebviewPool();
+
+    WebviewPool(const WebviewPool&) = delete;
+    WebviewPool& operator=(const WebviewPool&) = delete;
+
+    // Hand out a warm entry; false when the pool is empty
+    bool take(Entry& out);
+
+    // Shrink towards the current target after quiet periods
+    void trim();
+
+    // Release everything (memory pressure); refills resume on next take
+    void drain();
+
+    void schedule_refill();
+
+    guint size() const { return static_cast<guint>(entries_.size()); }
+    guint target() const;
+    const std::string& preload_uri() const { return preload_uri_; }
+
+private:
+    struct Warm {
+        GtkWidget* holder = nullptr;        // GtkOffscreenWindow
+        Entry entry;
+    };
+
+    ProcessModel& processes_;
+    std::string preload_uri_;
+    guint max_size_ = 0;
+    bool drained_ = false;
+
+    std::vector<std::unique_ptr<Warm>> entries_;    // signal data: kept in place
+    std::vector<gint64> recent_takes_;      // monotonic µs
+    guint refill_source_ = 0;
+
+    void prune_takes(gint64 now);
+    void destroy_entry(Warm& warm);
+    bool refill_one();
+
+    static gboolean s_refill(gpointer user_data);
+    static void s_load_changed(WebKitWebView* view, WebKitLoadEvent event, gpointer user_data);
+    static gboolean s_load_failed(WebKitWebView* view, WebKitLoadEvent event,
+                                  gchar* uri, GError* error, gpointer user_data);
+};
+
+#endif // COLOSSUS_WEBVIEW_POOL_H